@@ -25,6 +25,18 @@ const char app_nvs_sta_creds_namespace[] = "stacreds";
 // NVS namespace used for Ethernet configuration
 const char app_nvs_eth_config_namespace[] = "ethconfig";
 
+// NVS namespace used for the resumable OTA session
+const char app_nvs_ota_session_namespace[] = "otasession";
+
+// NVS namespace used for the post-OTA self-test baseline
+const char app_nvs_self_test_namespace[] = "selftest";
+
+// NVS namespace used for the tuned W5500 SPI clock
+const char app_nvs_eth_spi_namespace[] = "ethspi";
+
+// NVS namespace used for the last Ethernet DHCP lease
+const char app_nvs_eth_lease_namespace[] = "ethlease";
+
 esp_err_t app_nvs_save_sta_creds(void)
 {
 	nvs_handle handle;
@@ -373,4 +385,284 @@ esp_err_t app_nvs_clear_eth_config(void)
     ESP_LOGI(TAG, "app_nvs_clear_eth_config: Ethernet configuration cleared successfully");
     
     return ESP_OK;
-}
\ No newline at end of file
+}
+
+/**
+ * Save the OTA session to NVS, once per verified chunk
+ */
+esp_err_t app_nvs_save_ota_session(const ota_session_t* session)
+{
+    nvs_handle handle;
+    esp_err_t esp_err;
+
+    esp_err = nvs_open(app_nvs_ota_session_namespace, NVS_READWRITE, &handle);
+    if (esp_err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "app_nvs_save_ota_session: Error (%s) opening NVS handle!", esp_err_to_name(esp_err));
+        return esp_err;
+    }
+
+    // One blob, the offset never gets ahead of the rest of the session
+    esp_err = nvs_set_blob(handle, "session", session, sizeof(ota_session_t));
+    if (esp_err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "app_nvs_save_ota_session: Error (%s) setting session to NVS!", esp_err_to_name(esp_err));
+        nvs_close(handle);
+        return esp_err;
+    }
+
+    esp_err = nvs_commit(handle);
+    if (esp_err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "app_nvs_save_ota_session: Error (%s) committing session to NVS!", esp_err_to_name(esp_err));
+        nvs_close(handle);
+        return esp_err;
+    }
+
+    nvs_close(handle);
+    return ESP_OK;
+}
+
+/**
+ * Load the OTA session from NVS
+ */
+bool app_nvs_load_ota_session(ota_session_t* session)
+{
+    nvs_handle handle;
+    size_t required_size = sizeof(ota_session_t);
+
+    if (nvs_open(app_nvs_ota_session_namespace, NVS_READONLY, &handle) != ESP_OK)
+    {
+        return false;
+    }
+
+    // A blob of another size was written by a different firmware layout
+    esp_err_t esp_err = nvs_get_blob(handle, "session", session, &required_size);
+    nvs_close(handle);
+
+    return esp_err == ESP_OK && required_size == sizeof(ota_session_t);
+}
+
+/**
+ * Clear the OTA session from NVS
+ */
+esp_err_t app_nvs_clear_ota_session(void)
+{
+    nvs_handle handle;
+    esp_err_t esp_err;
+
+    esp_err = nvs_open(app_nvs_ota_session_namespace, NVS_READWRITE, &handle);
+    if (esp_err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "app_nvs_clear_ota_session: Error (%s) opening NVS handle!", esp_err_to_name(esp_err));
+        return esp_err;
+    }
+
+    esp_err = nvs_erase_all(handle);
+    if (esp_err == ESP_OK)
+    {
+        esp_err = nvs_commit(handle);
+    }
+    nvs_close(handle);
+
+    return esp_err;
+}
+
+/**
+ * Save the self-test baseline to NVS
+ */
+esp_err_t app_nvs_save_self_test_baseline(const self_test_results_t* baseline)
+{
+    nvs_handle handle;
+    esp_err_t esp_err;
+
+    ESP_LOGI(TAG, "app_nvs_save_self_test_baseline: Saving self-test baseline to flash");
+
+    esp_err = nvs_open(app_nvs_self_test_namespace, NVS_READWRITE, &handle);
+    if (esp_err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "app_nvs_save_self_test_baseline: Error (%s) opening NVS handle!", esp_err_to_name(esp_err));
+        return esp_err;
+    }
+
+    esp_err = nvs_set_blob(handle, "baseline", baseline, sizeof(self_test_results_t));
+    if (esp_err == ESP_OK)
+    {
+        esp_err = nvs_commit(handle);
+    }
+    if (esp_err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "app_nvs_save_self_test_baseline: Error (%s) saving baseline to NVS!", esp_err_to_name(esp_err));
+    }
+
+    nvs_close(handle);
+    return esp_err;
+}
+
+/**
+ * Load the self-test baseline from NVS
+ */
+bool app_nvs_load_self_test_baseline(self_test_results_t* baseline)
+{
+    nvs_handle handle;
+    size_t required_size = sizeof(self_test_results_t);
+
+    if (nvs_open(app_nvs_self_test_namespace, NVS_READONLY, &handle) != ESP_OK)
+    {
+        return false;
+    }
+
+    esp_err_t esp_err = nvs_get_blob(handle, "baseline", baseline, &required_size);
+    nvs_close(handle);
+
+    return esp_err == ESP_OK && required_size == sizeof(self_test_results_t);
+}
+
+/**
+ * Save the tuned W5500 SPI clock to NVS
+ */
+esp_err_t app_nvs_save_eth_spi_clock(uint32_t clock_hz)
+{
+    nvs_handle handle;
+    esp_err_t esp_err;
+
+    ESP_LOGI(TAG, "app_nvs_save_eth_spi_clock: Saving SPI clock %lu Hz to flash", clock_hz);
+
+    esp_err = nvs_open(app_nvs_eth_spi_namespace, NVS_READWRITE, &handle);
+    if (esp_err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "app_nvs_save_eth_spi_clock: Error (%s) opening NVS handle!", esp_err_to_name(esp_err));
+        return esp_err;
+    }
+
+    esp_err = nvs_set_u32(handle, "clock_hz", clock_hz);
+    if (esp_err == ESP_OK)
+    {
+        esp_err = nvs_commit(handle);
+    }
+    if (esp_err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "app_nvs_save_eth_spi_clock: Error (%s) saving SPI clock to NVS!", esp_err_to_name(esp_err));
+    }
+
+    nvs_close(handle);
+    return esp_err;
+}
+
+/**
+ * Load the tuned W5500 SPI clock from NVS
+ */
+bool app_nvs_load_eth_spi_clock(uint32_t* clock_hz)
+{
+    nvs_handle handle;
+
+    if (nvs_open(app_nvs_eth_spi_namespace, NVS_READONLY, &handle) != ESP_OK)
+    {
+        return false;
+    }
+
+    esp_err_t esp_err = nvs_get_u32(handle, "clock_hz", clock_hz);
+    nvs_close(handle);
+
+    return esp_err == ESP_OK;
+}
+
+/**
+ * Clear the tuned W5500 SPI clock from NVS
+ */
+esp_err_t app_nvs_clear_eth_spi_clock(void)
+{
+    nvs_handle handle;
+    esp_err_t esp_err;
+
+    esp_err = nvs_open(app_nvs_eth_spi_namespace, NVS_READWRITE, &handle);
+    if (esp_err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "app_nvs_clear_eth_spi_clock: Error (%s) opening NVS handle!", esp_err_to_name(esp_err));
+        return esp_err;
+    }
+
+    esp_err = nvs_erase_all(handle);
+    if (esp_err == ESP_OK)
+    {
+        esp_err = nvs_commit(handle);
+    }
+    nvs_close(handle);
+
+    return esp_err;
+}
+
+/**
+ * Save the last Ethernet DHCP lease to NVS
+ */
+esp_err_t app_nvs_save_eth_dhcp_lease(const eth_dhcp_lease_t* lease)
+{
+    nvs_handle handle;
+    esp_err_t esp_err;
+
+    ESP_LOGI(TAG, "app_nvs_save_eth_dhcp_lease: Saving DHCP lease to flash");
+
+    esp_err = nvs_open(app_nvs_eth_lease_namespace, NVS_READWRITE, &handle);
+    if (esp_err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "app_nvs_save_eth_dhcp_lease: Error (%s) opening NVS handle!", esp_err_to_name(esp_err));
+        return esp_err;
+    }
+
+    esp_err = nvs_set_blob(handle, "lease", lease, sizeof(eth_dhcp_lease_t));
+    if (esp_err == ESP_OK)
+    {
+        esp_err = nvs_commit(handle);
+    }
+    if (esp_err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "app_nvs_save_eth_dhcp_lease: Error (%s) saving DHCP lease to NVS!", esp_err_to_name(esp_err));
+    }
+
+    nvs_close(handle);
+    return esp_err;
+}
+
+/**
+ * Load the last Ethernet DHCP lease from NVS
+ */
+bool app_nvs_load_eth_dhcp_lease(eth_dhcp_lease_t* lease)
+{
+    nvs_handle handle;
+    size_t required_size = sizeof(eth_dhcp_lease_t);
+
+    if (nvs_open(app_nvs_eth_lease_namespace, NVS_READONLY, &handle) != ESP_OK)
+    {
+        return false;
+    }
+
+    esp_err_t esp_err = nvs_get_blob(handle, "lease", lease, &required_size);
+    nvs_close(handle);
+
+    return esp_err == ESP_OK && required_size == sizeof(eth_dhcp_lease_t);
+}
+
+/**
+ * Clear the last Ethernet DHCP lease from NVS
+ */
+esp_err_t app_nvs_clear_eth_dhcp_lease(void)
+{
+    nvs_handle handle;
+    esp_err_t esp_err;
+
+    esp_err = nvs_open(app_nvs_eth_lease_namespace, NVS_READWRITE, &handle);
+    if (esp_err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "app_nvs_clear_eth_dhcp_lease: Error (%s) opening NVS handle!", esp_err_to_name(esp_err));
+        return esp_err;
+    }
+
+    esp_err = nvs_erase_all(handle);
+    if (esp_err == ESP_OK)
+    {
+        esp_err = nvs_commit(handle);
+    }
+    nvs_close(handle);
+
+    return esp_err;
+}
@@ -9,6 +9,8 @@
 
 #include "esp_err.h"
 #include "ethernet_app.h" // For eth_ip_config_t
+#include "ota_session.h" // For ota_session_t
+#include "self_test.h" // For self_test_results_t
 
 /**
  * Saves station mode WiFi credentials to NVS
@@ -48,4 +50,78 @@ bool app_nvs_load_eth_config(eth_ip_config_t* eth_config);
  */
 esp_err_t app_nvs_clear_eth_config(void);
 
+/**
+ * Saves the resumable OTA session to NVS
+ * @param session Pointer to the session
+ * @return ESP_OK if successful.
+ */
+esp_err_t app_nvs_save_ota_session(const ota_session_t* session);
+
+/**
+ * Loads the previously saved OTA session from NVS.
+ * @param session Pointer to store the loaded session
+ * @return true if a previously saved session was found.
+ */
+bool app_nvs_load_ota_session(ota_session_t* session);
+
+/**
+ * Clears the OTA session from NVS
+ * @return ESP_OK if successful.
+ */
+esp_err_t app_nvs_clear_ota_session(void);
+
+/**
+ * Saves the self-test baseline to NVS
+ * @param baseline Pointer to the benchmark results
+ * @return ESP_OK if successful.
+ */
+esp_err_t app_nvs_save_self_test_baseline(const self_test_results_t* baseline);
+
+/**
+ * Loads the previously saved self-test baseline from NVS.
+ * @param baseline Pointer to store the loaded results
+ * @return true if a previously saved baseline was found.
+ */
+bool app_nvs_load_self_test_baseline(self_test_results_t* baseline);
+
+/**
+ * Saves the tuned W5500 SPI clock to NVS
+ * @param clock_hz SPI clock in Hz
+ * @return ESP_OK if successful.
+ */
+esp_err_t app_nvs_save_eth_spi_clock(uint32_t clock_hz);
+
+/**
+ * Loads the previously tuned W5500 SPI clock from NVS.
+ * @param clock_hz Pointer to store the clock in Hz
+ * @return true if a previously tuned clock was found.
+ */
+bool app_nvs_load_eth_spi_clock(uint32_t* clock_hz);
+
+/**
+ * Clears the tuned W5500 SPI clock from NVS, the next boot probes again
+ * @return ESP_OK if successful.
+ */
+esp_err_t app_nvs_clear_eth_spi_clock(void);
+
+/**
+ * Saves the last DHCP lease of the Ethernet interface to NVS
+ * @param lease Pointer to the lease
+ * @return ESP_OK if successful.
+ */
+esp_err_t app_nvs_save_eth_dhcp_lease(const eth_dhcp_lease_t* lease);
+
+/**
+ * Loads the previously saved DHCP lease from NVS.
+ * @param lease Pointer to store the loaded lease
+ * @return true if a previously saved lease was found.
+ */
+bool app_nvs_load_eth_dhcp_lease(eth_dhcp_lease_t* lease);
+
+/**
+ * Clears the DHCP lease from NVS
+ * @return ESP_OK if successful.
+ */
+esp_err_t app_nvs_clear_eth_dhcp_lease(void);
+
 #endif /* MAIN_APP_NVS_H_ */
\ No newline at end of file
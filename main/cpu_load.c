@@ -0,0 +1,44 @@
+/*
+ * cpu_load.c
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+
+#include "cpu_load.h"
+
+void cpu_load_sample(cpu_load_sample_t *sample)
+{
+	sample->time_us = esp_timer_get_time();
+
+	for (int core = 0; core < portNUM_PROCESSORS; core++)
+	{
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+		// The run time counter is clocked by esp_timer, i.e. in microseconds
+		sample->idle_us[core] = (uint32_t)ulTaskGetRunTimeCounter(xTaskGetIdleTaskHandleForCore(core));
+#else
+		sample->idle_us[core] = 0;
+#endif
+	}
+}
+
+uint32_t cpu_load_percent(const cpu_load_sample_t *start, const cpu_load_sample_t *end, int core)
+{
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+	int64_t elapsed_us = end->time_us - start->time_us;
+	uint32_t idle_us = end->idle_us[core] - start->idle_us[core];
+
+	if (elapsed_us <= 0 || idle_us >= elapsed_us)
+	{
+		return 0;
+	}
+
+	return (uint32_t)(100 - idle_us * 100 / elapsed_us);
+#else
+	return 0;
+#endif
+}
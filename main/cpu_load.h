@@ -0,0 +1,38 @@
+/*
+ * cpu_load.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef MAIN_CPU_LOAD_H_
+#define MAIN_CPU_LOAD_H_
+
+#include <stdint.h>
+
+#include "freertos/FreeRTOS.h"
+
+/**
+ * Idle time of each core at one point in time.
+ */
+typedef struct cpu_load_sample
+{
+	int64_t time_us;
+	uint32_t idle_us[portNUM_PROCESSORS];	// Run time of the core's idle task (wraps)
+} cpu_load_sample_t;
+
+/**
+ * Takes a sample.
+ * @param sample receives the sample.
+ */
+void cpu_load_sample(cpu_load_sample_t *sample);
+
+/**
+ * Load of a core between two samples: the time its idle task did not run.
+ * @param start earlier sample.
+ * @param end later sample.
+ * @param core core number.
+ * @return load in percent, 0 without CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS.
+ */
+uint32_t cpu_load_percent(const cpu_load_sample_t *start, const cpu_load_sample_t *end, int core);
+
+#endif /* MAIN_CPU_LOAD_H_ */
@@ -0,0 +1,371 @@
+/*
+ * delta_patch.c
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "mbedtls/sha256.h"
+
+#include "delta_patch.h"
+
+// Tag used for ESP serial console messages
+static const char TAG[] = "delta_patch";
+
+#define DELTA_PATCH_HEADER_LEN		(DELTA_PATCH_MAGIC_LEN + 4 + 4 + 32 + 32)
+
+// Source bytes read from flash at a time
+#define DELTA_PATCH_BUFFER_LEN		4096
+
+/**
+ * Parts of the patch, fixed size parts are collected in delta_patch_t.field.
+ */
+typedef enum delta_patch_state
+{
+	DELTA_PATCH_STATE_HEADER = 0,
+	DELTA_PATCH_STATE_OPCODE,
+	DELTA_PATCH_STATE_ARGS,			// Arguments of the current command
+	DELTA_PATCH_STATE_ADD,			// Added bytes of an ADD command
+	DELTA_PATCH_STATE_DATA,			// New bytes of a DATA command
+	DELTA_PATCH_STATE_DONE,
+} delta_patch_state_e;
+
+struct delta_patch
+{
+	delta_patch_state_e state;
+	const esp_partition_t *source;
+	uint32_t source_size;
+	uint32_t target_size;
+	uint8_t target_sha256[32];
+	uint8_t field[DELTA_PATCH_HEADER_LEN];
+	size_t field_len;				// Bytes collected in field
+	uint8_t opcode;
+	uint32_t offset;				// Source offset of the current COPY/ADD command
+	uint32_t remaining;				// Bytes left in the current command
+	size_t out_len;
+	mbedtls_sha256_context sha;
+	delta_patch_data_cb_t on_data;
+	void *ctx;
+	uint8_t buffer[DELTA_PATCH_BUFFER_LEN];
+};
+
+static inline uint32_t delta_patch_le32(const uint8_t *p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/**
+ * Collects the bytes of a fixed size part.
+ * @return true once field holds len bytes.
+ */
+static bool delta_patch_collect(delta_patch_t *p, const uint8_t **data, size_t *len, size_t field_len)
+{
+	size_t n = field_len - p->field_len;
+	if (n > *len)
+	{
+		n = *len;
+	}
+
+	memcpy(p->field + p->field_len, *data, n);
+	p->field_len += n;
+	*data += n;
+	*len -= n;
+
+	if (p->field_len < field_len)
+	{
+		return false;
+	}
+
+	p->field_len = 0;
+	return true;
+}
+
+/**
+ * Passes target bytes on, hashing them on the way.
+ */
+static esp_err_t delta_patch_emit(delta_patch_t *p, const uint8_t *data, size_t len)
+{
+	if (len > p->target_size - p->out_len)
+	{
+		return ESP_ERR_INVALID_RESPONSE;
+	}
+
+	mbedtls_sha256_update(&p->sha, data, len);
+	p->out_len += len;
+
+	return p->on_data(p->ctx, (const char*)data, len);
+}
+
+/**
+ * Checks the SHA-256 of the source image against the header, so a patch made for another
+ * firmware fails before anything is written.
+ */
+static esp_err_t delta_patch_check_source(delta_patch_t *p, const uint8_t *source_sha256)
+{
+	mbedtls_sha256_context sha;
+	uint8_t digest[32];
+	esp_err_t err = ESP_OK;
+
+	if (p->source_size > p->source->size)
+	{
+		return ESP_ERR_INVALID_VERSION;
+	}
+
+	mbedtls_sha256_init(&sha);
+	mbedtls_sha256_starts(&sha, 0);
+
+	for (uint32_t offset = 0; offset < p->source_size && err == ESP_OK; offset += DELTA_PATCH_BUFFER_LEN)
+	{
+		size_t n = p->source_size - offset;
+		if (n > DELTA_PATCH_BUFFER_LEN)
+		{
+			n = DELTA_PATCH_BUFFER_LEN;
+		}
+
+		err = esp_partition_read(p->source, offset, p->buffer, n);
+		mbedtls_sha256_update(&sha, p->buffer, n);
+	}
+
+	mbedtls_sha256_finish(&sha, digest);
+	mbedtls_sha256_free(&sha);
+
+	if (err != ESP_OK)
+	{
+		return err;
+	}
+	if (memcmp(digest, source_sha256, sizeof(digest)) != 0)
+	{
+		ESP_LOGI(TAG, "delta_patch_check_source: the patch is for another firmware");
+		return ESP_ERR_INVALID_VERSION;
+	}
+
+	return ESP_OK;
+}
+
+/**
+ * Parses the header and verifies the source image.
+ */
+static esp_err_t delta_patch_header(delta_patch_t *p)
+{
+	if (memcmp(p->field, DELTA_PATCH_MAGIC, DELTA_PATCH_MAGIC_LEN) != 0)
+	{
+		return ESP_ERR_INVALID_RESPONSE;
+	}
+
+	p->source_size = delta_patch_le32(p->field + DELTA_PATCH_MAGIC_LEN);
+	p->target_size = delta_patch_le32(p->field + DELTA_PATCH_MAGIC_LEN + 4);
+	memcpy(p->target_sha256, p->field + DELTA_PATCH_MAGIC_LEN + 8 + 32, 32);
+
+	ESP_LOGI(TAG, "delta_patch_header: %lu byte source, %lu byte target", p->source_size, p->target_size);
+
+	return delta_patch_check_source(p, p->field + DELTA_PATCH_MAGIC_LEN + 8);
+}
+
+/**
+ * Runs a COPY command: the source bytes as they are.
+ */
+static esp_err_t delta_patch_copy(delta_patch_t *p)
+{
+	esp_err_t err = ESP_OK;
+
+	while (p->remaining > 0 && err == ESP_OK)
+	{
+		size_t n = (p->remaining < DELTA_PATCH_BUFFER_LEN) ? p->remaining : DELTA_PATCH_BUFFER_LEN;
+
+		err = esp_partition_read(p->source, p->offset, p->buffer, n);
+		if (err == ESP_OK)
+		{
+			err = delta_patch_emit(p, p->buffer, n);
+		}
+		p->offset += n;
+		p->remaining -= n;
+	}
+
+	return err;
+}
+
+/**
+ * Runs the ADD bytes available in the input: source byte plus patch byte, modulo 256.
+ */
+static esp_err_t delta_patch_add(delta_patch_t *p, const uint8_t **data, size_t *len)
+{
+	size_t n = p->remaining;
+	if (n > *len)
+	{
+		n = *len;
+	}
+	if (n > DELTA_PATCH_BUFFER_LEN)
+	{
+		n = DELTA_PATCH_BUFFER_LEN;
+	}
+
+	esp_err_t err = esp_partition_read(p->source, p->offset, p->buffer, n);
+	if (err != ESP_OK)
+	{
+		return err;
+	}
+
+	for (size_t i = 0; i < n; i++)
+	{
+		p->buffer[i] += (*data)[i];
+	}
+
+	*data += n;
+	*len -= n;
+	p->offset += n;
+	p->remaining -= n;
+
+	return delta_patch_emit(p, p->buffer, n);
+}
+
+/**
+ * Starts the command whose arguments were collected.
+ */
+static esp_err_t delta_patch_command(delta_patch_t *p)
+{
+	if (p->opcode == DELTA_PATCH_OP_DATA)
+	{
+		p->remaining = delta_patch_le32(p->field);
+		p->state = (p->remaining > 0) ? DELTA_PATCH_STATE_DATA : DELTA_PATCH_STATE_OPCODE;
+		return ESP_OK;
+	}
+
+	p->offset = delta_patch_le32(p->field);
+	p->remaining = delta_patch_le32(p->field + 4);
+
+	if (p->offset > p->source_size || p->remaining > p->source_size - p->offset)
+	{
+		return ESP_ERR_INVALID_RESPONSE;
+	}
+
+	if (p->opcode == DELTA_PATCH_OP_ADD && p->remaining > 0)
+	{
+		p->state = DELTA_PATCH_STATE_ADD;
+		return ESP_OK;
+	}
+
+	p->state = DELTA_PATCH_STATE_OPCODE;
+	return delta_patch_copy(p);
+}
+
+delta_patch_t* delta_patch_create(const esp_partition_t *source, delta_patch_data_cb_t on_data, void *ctx)
+{
+	delta_patch_t *p = calloc(1, sizeof(delta_patch_t));
+	if (p == NULL)
+	{
+		return NULL;
+	}
+
+	p->state = DELTA_PATCH_STATE_HEADER;
+	p->source = source;
+	p->on_data = on_data;
+	p->ctx = ctx;
+	mbedtls_sha256_init(&p->sha);
+	mbedtls_sha256_starts(&p->sha, 0);
+
+	return p;
+}
+
+esp_err_t delta_patch_feed(delta_patch_t *p, const char *data, size_t len)
+{
+	const uint8_t *d = (const uint8_t*)data;
+	esp_err_t err = ESP_OK;
+
+	while (len > 0 && err == ESP_OK)
+	{
+		switch (p->state)
+		{
+			case DELTA_PATCH_STATE_HEADER:
+				if (delta_patch_collect(p, &d, &len, DELTA_PATCH_HEADER_LEN))
+				{
+					err = delta_patch_header(p);
+					p->state = DELTA_PATCH_STATE_OPCODE;
+				}
+				break;
+
+			case DELTA_PATCH_STATE_OPCODE:
+				p->opcode = *d++;
+				len--;
+				if (p->opcode == DELTA_PATCH_OP_END)
+				{
+					p->state = DELTA_PATCH_STATE_DONE;
+				}
+				else if (p->opcode <= DELTA_PATCH_OP_DATA)
+				{
+					p->state = DELTA_PATCH_STATE_ARGS;
+				}
+				else
+				{
+					err = ESP_ERR_INVALID_RESPONSE;
+				}
+				break;
+
+			case DELTA_PATCH_STATE_ARGS:
+				if (delta_patch_collect(p, &d, &len, (p->opcode == DELTA_PATCH_OP_DATA) ? 4 : 8))
+				{
+					err = delta_patch_command(p);
+				}
+				break;
+
+			case DELTA_PATCH_STATE_ADD:
+				err = delta_patch_add(p, &d, &len);
+				if (p->remaining == 0)
+				{
+					p->state = DELTA_PATCH_STATE_OPCODE;
+				}
+				break;
+
+			case DELTA_PATCH_STATE_DATA:
+			{
+				size_t n = (p->remaining < len) ? p->remaining : len;
+				err = delta_patch_emit(p, d, n);
+				d += n;
+				len -= n;
+				p->remaining -= n;
+				if (p->remaining == 0)
+				{
+					p->state = DELTA_PATCH_STATE_OPCODE;
+				}
+				break;
+			}
+
+			case DELTA_PATCH_STATE_DONE:
+				// Nothing may follow the END command
+				return ESP_ERR_INVALID_RESPONSE;
+		}
+	}
+
+	return err;
+}
+
+esp_err_t delta_patch_finish(delta_patch_t *p)
+{
+	uint8_t digest[32];
+
+	if (p->state != DELTA_PATCH_STATE_DONE)
+	{
+		return ESP_ERR_INVALID_RESPONSE;
+	}
+
+	mbedtls_sha256_finish(&p->sha, digest);
+	if (p->out_len != p->target_size || memcmp(digest, p->target_sha256, sizeof(digest)) != 0)
+	{
+		ESP_LOGI(TAG, "delta_patch_finish: target image mismatch");
+		return ESP_ERR_INVALID_CRC;
+	}
+
+	return ESP_OK;
+}
+
+void delta_patch_delete(delta_patch_t *p)
+{
+	if (p != NULL)
+	{
+		mbedtls_sha256_free(&p->sha);
+		free(p);
+	}
+}
@@ -0,0 +1,86 @@
+/*
+ * delta_patch.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef MAIN_DELTA_PATCH_H_
+#define MAIN_DELTA_PATCH_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "esp_partition.h"
+
+/*
+ * Patch format (made by tools/delta_patch.py, integers little endian):
+ *
+ *   header   "EDP1", u32 source size, u32 target size, source SHA-256, target SHA-256
+ *   commands u8 opcode and arguments:
+ *     DELTA_PATCH_OP_COPY  u32 source offset, u32 length
+ *     DELTA_PATCH_OP_ADD   u32 source offset, u32 length, length bytes added to the source bytes (bsdiff)
+ *     DELTA_PATCH_OP_DATA  u32 length, length bytes of new data
+ *     DELTA_PATCH_OP_END
+ *
+ * The source is the image in the running partition, the commands rebuild the target image in order.
+ */
+
+// First bytes of a patch
+#define DELTA_PATCH_MAGIC			"EDP1"
+#define DELTA_PATCH_MAGIC_LEN		4
+
+#define DELTA_PATCH_OP_END			0x00
+#define DELTA_PATCH_OP_COPY			0x01
+#define DELTA_PATCH_OP_ADD			0x02
+#define DELTA_PATCH_OP_DATA			0x03
+
+/**
+ * Receives the rebuilt target image.
+ * @param ctx context given to delta_patch_create.
+ * @param data target image bytes.
+ * @param len number of bytes.
+ * @return ESP_OK to continue, otherwise the patching stops and reports the error.
+ */
+typedef esp_err_t (*delta_patch_data_cb_t)(void *ctx, const char *data, size_t len);
+
+/**
+ * Streaming patch applier, fed with the patch in chunks of any size.
+ */
+typedef struct delta_patch delta_patch_t;
+
+/**
+ * Allocates a patch applier.
+ * @param source partition holding the source image (the running partition).
+ * @param on_data callback receiving the target image in order.
+ * @param ctx context passed to the callback.
+ * @return applier, NULL if out of memory.
+ */
+delta_patch_t* delta_patch_create(const esp_partition_t *source, delta_patch_data_cb_t on_data, void *ctx);
+
+/**
+ * Applies the next chunk of the patch. The source image is checked against the
+ * SHA-256 of the header before the first command.
+ * @param p applier.
+ * @param data patch bytes.
+ * @param len number of bytes.
+ * @return ESP_OK, ESP_ERR_INVALID_VERSION if the patch is for another source image,
+ * ESP_ERR_INVALID_RESPONSE for a malformed patch, otherwise the error returned by the callback.
+ */
+esp_err_t delta_patch_feed(delta_patch_t *p, const char *data, size_t len);
+
+/**
+ * Ends the patch and verifies the target image.
+ * @param p applier.
+ * @return ESP_OK if the patch was complete and the image matches the target size and SHA-256,
+ * ESP_ERR_INVALID_RESPONSE for a truncated patch, ESP_ERR_INVALID_CRC for a mismatch.
+ */
+esp_err_t delta_patch_finish(delta_patch_t *p);
+
+/**
+ * Frees a patch applier.
+ * @param p applier, may be NULL.
+ */
+void delta_patch_delete(delta_patch_t *p);
+
+#endif /* MAIN_DELTA_PATCH_H_ */
@@ -0,0 +1,116 @@
+/*
+ * device_state.c
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include <stdatomic.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+
+#include "device_state.h"
+#include "http_server.h"
+
+// Sequence number, odd while an update is in progress
+static atomic_uint s_seq = 0;
+
+// Published state, only written between two increments of s_seq
+static device_state_t s_state = {
+	.version = 1,
+	.wifi_connect_status = NONE,
+	.eth_connect_status = HTTP_ETH_STATUS_NONE,
+	.ota_update_status = OTA_UPDATE_PENDING,
+	.local_time_set = false,
+	.eth_ip_config = {
+		.ip = ETH_DEFAULT_IP,
+		.gateway = ETH_DEFAULT_GATEWAY,
+		.netmask = ETH_DEFAULT_NETMASK,
+		.dns = ETH_DEFAULT_DNS,
+		.dhcp_enabled = true
+	}
+};
+
+// Serializes the writers, they run on both cores. Held for a few dozen cycles at most.
+static portMUX_TYPE s_writer_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * Starts an update: readers retry until device_state_write_end.
+ */
+static void device_state_write_begin(void)
+{
+	taskENTER_CRITICAL(&s_writer_lock);
+	atomic_fetch_add_explicit(&s_seq, 1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+}
+
+/**
+ * Ends an update and publishes it as a new version.
+ */
+static void device_state_write_end(void)
+{
+	s_state.version++;
+	atomic_fetch_add_explicit(&s_seq, 1, memory_order_release);
+	taskEXIT_CRITICAL(&s_writer_lock);
+}
+
+void device_state_get(device_state_t *state)
+{
+	unsigned int seq;
+
+	do
+	{
+		// A writer on this core cannot be preempted, so only one on the other core is waited for
+		while ((seq = atomic_load_explicit(&s_seq, memory_order_acquire)) & 1)
+		{
+		}
+
+		memcpy(state, &s_state, sizeof(device_state_t));
+
+		atomic_thread_fence(memory_order_acquire);
+	} while (atomic_load_explicit(&s_seq, memory_order_relaxed) != seq);
+}
+
+uint32_t device_state_version(void)
+{
+	device_state_t state;
+
+	device_state_get(&state);
+
+	return state.version;
+}
+
+void device_state_set_wifi_connect_status(int status)
+{
+	device_state_write_begin();
+	s_state.wifi_connect_status = status;
+	device_state_write_end();
+}
+
+void device_state_set_eth_connect_status(int status)
+{
+	device_state_write_begin();
+	s_state.eth_connect_status = status;
+	device_state_write_end();
+}
+
+void device_state_set_ota_update_status(int status)
+{
+	device_state_write_begin();
+	s_state.ota_update_status = status;
+	device_state_write_end();
+}
+
+void device_state_set_local_time_set(void)
+{
+	device_state_write_begin();
+	s_state.local_time_set = true;
+	device_state_write_end();
+}
+
+void device_state_set_eth_ip_config(const eth_ip_config_t *config)
+{
+	device_state_write_begin();
+	memcpy(&s_state.eth_ip_config, config, sizeof(eth_ip_config_t));
+	device_state_write_end();
+}
@@ -0,0 +1,71 @@
+/*
+ * device_state.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef MAIN_DEVICE_STATE_H_
+#define MAIN_DEVICE_STATE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ethernet_app.h"
+
+/**
+ * Device state shown by the web page, published by the WiFi/Ethernet applications and the
+ * HTTP server monitor and read by the HTTP handlers.
+ * Readers get a consistent copy without locking (sequence lock), see device_state_get.
+ */
+typedef struct device_state
+{
+	uint32_t version;				// Incremented by every update
+	int wifi_connect_status;		// HTTP_WIFI_STATUS_*
+	int eth_connect_status;			// HTTP_ETH_STATUS_*
+	int ota_update_status;			// OTA_UPDATE_*
+	bool local_time_set;
+	eth_ip_config_t eth_ip_config;	// Configured mode and addresses, the leased ones with DHCP
+} device_state_t;
+
+/**
+ * Copies the current state. Lock-free: retries while an update is in progress,
+ * so the copy never mixes two versions (e.g. a half written IP string).
+ * @param state receives the copy.
+ */
+void device_state_get(device_state_t *state);
+
+/**
+ * @return version of the current state.
+ */
+uint32_t device_state_version(void);
+
+/**
+ * Updates the WiFi connect status.
+ * @param status HTTP_WIFI_STATUS_*.
+ */
+void device_state_set_wifi_connect_status(int status);
+
+/**
+ * Updates the Ethernet connect status.
+ * @param status HTTP_ETH_STATUS_*.
+ */
+void device_state_set_eth_connect_status(int status);
+
+/**
+ * Updates the firmware update status.
+ * @param status OTA_UPDATE_*.
+ */
+void device_state_set_ota_update_status(int status);
+
+/**
+ * Marks the local time as set (SNTP synchronized).
+ */
+void device_state_set_local_time_set(void);
+
+/**
+ * Publishes the Ethernet IP configuration.
+ * @param config configuration, the leased addresses with DHCP.
+ */
+void device_state_set_eth_ip_config(const eth_ip_config_t *config);
+
+#endif /* MAIN_DEVICE_STATE_H_ */
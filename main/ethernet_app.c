@@ -4,6 +4,9 @@
  *  Created on: Jul 25, 2024
  */
 
+#include <stddef.h>
+#include <time.h>
+
 #include "freertos/FreeRTOS.h"
 #include "freertos/event_groups.h"
 #include "freertos/task.h"
@@ -16,15 +19,23 @@
 #include "esp_event.h"
 #include "esp_netif.h"
 #include "esp_check.h"
+#include "esp_timer.h"
 #include "driver/gpio.h"
 #include "driver/spi_master.h"
+#include "lwip/dhcp.h"
 #include "lwip/dns.h"
 #include "lwip/sockets.h"
+#include "lwip/tcpip.h"
 
+#include "device_state.h"
 #include "ethernet_app.h"
 #include "http_server.h"
 #include "tasks_common.h"
 #include "app_nvs.h"
+#include "w5500_burst_rx.h"
+#include "w5500_rx_mode.h"
+#include "w5500_sg_tx.h"
+#include "w5500_spi.h"
 
 // Tag used for ESP serial console messages
 static const char TAG[] = "eth_app";
@@ -44,7 +55,28 @@ static esp_eth_handle_t s_eth_handle = NULL;
 // DHCP timeout timer
 static TimerHandle_t s_dhcp_timer = NULL;
 
-// Current Ethernet IP configuration
+// Time since boot when the first IP address was assigned, 0 until then
+static int64_t s_first_ip_us = 0;
+
+// Time since boot when the link first came up, 0 until then
+static int64_t s_first_link_us = 0;
+
+// Last DHCP lease, from NVS or the last ACK, owned by the Ethernet task
+static eth_dhcp_lease_t s_lease;
+static bool s_lease_valid = false;
+
+// Set while the address is the cached lease and DHCP has not confirmed it yet
+static bool s_lease_in_use = false;
+
+// Where the current address came from
+static eth_ip_source_e s_ip_source = ETH_IP_SOURCE_NONE;
+
+#if CONFIG_ETH_DHCP_CACHED_LEASE
+// Starts DHCP a while after link up on the cached lease
+static TimerHandle_t s_lease_timer = NULL;
+#endif
+
+// Current Ethernet IP configuration, owned by the Ethernet task and published in device_state
 static eth_ip_config_t s_eth_ip_config = {
     .ip = ETH_DEFAULT_IP,
     .gateway = ETH_DEFAULT_GATEWAY,
@@ -79,6 +111,28 @@ static void dhcp_timeout_callback(TimerHandle_t xTimer)
     ethernet_app_send_message(ETHERNET_APP_MSG_DHCP_TIMEOUT, NULL);
 }
 
+#if CONFIG_ETH_DHCP_CACHED_LEASE
+/**
+ * Cached lease timer callback
+ * @param xTimer Timer handle that expired
+ */
+static void lease_confirm_callback(TimerHandle_t xTimer)
+{
+    ethernet_app_send_message(ETHERNET_APP_MSG_DHCP_CONFIRM_LEASE, NULL);
+}
+#endif
+
+/**
+ * Records the time of the first IP address
+ */
+static void eth_first_ip(void)
+{
+    if (s_first_ip_us == 0) {
+        s_first_ip_us = esp_timer_get_time();
+        ESP_LOGI(TAG, "First IP address %lu ms after boot", ethernet_app_get_boot_to_ip_ms());
+    }
+}
+
 /**
  * SPI bus initialization for W5500
  */
@@ -113,6 +167,10 @@ static esp_err_t spi_bus_init(void)
         .sclk_io_num = ETH_SPI_SCLK_GPIO,
         .quadwp_io_num = -1,
         .quadhd_io_num = -1,
+#if CONFIG_ETH_RX_BURST
+        // Whole RX bursts in one DMA transfer, the default is 4092 bytes
+        .max_transfer_sz = CONFIG_ETH_RX_BURST_SIZE + 4,
+#endif
     };
     
     ret = spi_bus_initialize(ETH_SPI_HOST, &buscfg, SPI_DMA_CH_AUTO);
@@ -154,11 +212,21 @@ static esp_eth_handle_t eth_init_w5500(void)
         ESP_LOGE(TAG, "SPI bus init failed");
         return NULL;
     }
+
+#if CONFIG_ETH_SPI_CLOCK_AUTO
+    // Fastest clock the board passes with margin, ETH_SPI_CLOCK_MHZ if none does
+    spi_devcfg.clock_speed_hz = w5500_spi_tune_clock(ETH_SPI_HOST, ETH_SPI_CS_GPIO, spi_devcfg.clock_speed_hz);
+#endif
+    ESP_LOGI(TAG, "W5500 SPI clock %d Hz", spi_devcfg.clock_speed_hz);
     
     // W5500 specific configuration
     eth_w5500_config_t w5500_config = ETH_W5500_DEFAULT_CONFIG(ETH_SPI_HOST, &spi_devcfg);
     w5500_config.int_gpio_num = ETH_SPI_INT_GPIO;
     w5500_config.poll_period_ms = ETH_SPI_POLLING_MS;
+#if CONFIG_ETH_RX_BURST || CONFIG_ETH_TX_SG
+    // The burst RX and scatter-gather TX paths share the driver's SPI device
+    w5500_config.custom_spi_driver = w5500_spi_custom_driver(ETH_SPI_HOST, &spi_devcfg);
+#endif
     
     // Create MAC and PHY instances for W5500
     esp_eth_mac_t *mac = esp_eth_mac_new_w5500(&w5500_config, &mac_config);
@@ -293,12 +361,181 @@ static esp_err_t configure_static_ip(void)
     ESP_LOGI(TAG, "Configured netmask: %s", s_eth_ip_config.netmask);
     ESP_LOGI(TAG, "Configured DNS: %s", s_eth_ip_config.dns);
     
+    s_lease_in_use = false;
+    s_ip_source = ETH_IP_SOURCE_STATIC;
+    eth_first_ip();
+
     xEventGroupSetBits(ethernet_app_event_group, ETHERNET_APP_ETH_USING_STATIC_IP_BIT);
     ethernet_app_send_message(ETHERNET_APP_MSG_ETH_CONNECTED_GOT_IP, NULL);
     
     return ESP_OK;
 }
 
+// DHCP lease read in the TCP/IP thread
+typedef struct eth_dhcp_lease_call
+{
+    struct tcpip_api_call_data call;
+    eth_dhcp_lease_t *lease;
+} eth_dhcp_lease_call_t;
+
+/**
+ * Publishes s_eth_ip_config and has the HTTP server monitor push it to the web page
+ */
+static void eth_publish_ip_config(void)
+{
+    device_state_set_eth_ip_config(&s_eth_ip_config);
+    http_server_monitor_send_message(HTTP_MSG_ETH_IP_CONFIG_CHANGED);
+}
+
+/**
+ * Reads the DHCP server and lease time of the bound lease, in the TCP/IP thread
+ */
+static err_t eth_read_dhcp_lease(struct tcpip_api_call_data *call)
+{
+    eth_dhcp_lease_t *lease = ((eth_dhcp_lease_call_t *)call)->lease;
+    struct netif *netif = esp_netif_get_netif_impl(esp_netif_eth);
+
+    // Not bound for a static address or the cached lease
+    if (netif == NULL || !dhcp_supplied_address(netif)) {
+        return ERR_VAL;
+    }
+
+    struct dhcp *dhcp = netif_dhcp_data(netif);
+    lease->server.addr = ip4_addr_get_u32(ip_2_ip4(&dhcp->server_ip_addr));
+    lease->lease_s = dhcp->offered_t0_lease;
+
+    return ERR_OK;
+}
+
+/**
+ * Keeps the lease the DHCP client is bound to, in NVS for the next boot
+ * @param ip_info addresses of the lease
+ */
+static void eth_save_dhcp_lease(const esp_netif_ip_info_t *ip_info)
+{
+    eth_dhcp_lease_t lease = {
+        .ip = ip_info->ip,
+        .netmask = ip_info->netmask,
+        .gateway = ip_info->gw,
+    };
+    eth_dhcp_lease_call_t call = { .lease = &lease };
+    esp_netif_dns_info_t dns;
+    time_t now = time(NULL);
+
+    if (tcpip_api_call(eth_read_dhcp_lease, &call.call) != ERR_OK) {
+        return;
+    }
+    if (esp_netif_get_dns_info(esp_netif_eth, ESP_NETIF_DNS_MAIN, &dns) == ESP_OK) {
+        lease.dns = dns.ip.u_addr.ip4;
+    }
+    lease.obtained = (now >= ETH_DHCP_LEASE_CLOCK_SET) ? now : 0;
+
+    // Renewals bind the same lease again, only written once half of it has passed since the last write
+    if (s_lease_valid && memcmp(&lease, &s_lease, offsetof(eth_dhcp_lease_t, obtained)) == 0
+        && (lease.obtained == 0 || (s_lease.obtained != 0 && lease.obtained - s_lease.obtained < lease.lease_s / 2))) {
+        return;
+    }
+
+    ESP_LOGI(TAG, "DHCP lease " IPSTR " from " IPSTR " for %lu s", IP2STR(&lease.ip), IP2STR(&lease.server), lease.lease_s);
+
+    if (app_nvs_save_eth_dhcp_lease(&lease) == ESP_OK) {
+        s_lease = lease;
+        s_lease_valid = true;
+    }
+}
+
+#if CONFIG_ETH_DHCP_CACHED_LEASE
+/**
+ * Checks if the cached lease may still be used
+ * @return true unless it is missing or known to have expired
+ */
+static bool eth_cached_lease_usable(void)
+{
+    time_t now = time(NULL);
+
+    if (!s_lease_valid) {
+        return false;
+    }
+
+    // Without a set clock (power cycle, no SNTP yet) its age is unknown, DHCP confirms it after link up
+    if (s_lease.obtained == 0 || now < ETH_DHCP_LEASE_CLOCK_SET) {
+        return true;
+    }
+
+    return now < s_lease.obtained + (int64_t)s_lease.lease_s;
+}
+
+/**
+ * Uses the cached lease as the address without waiting for DHCP
+ */
+static esp_err_t apply_cached_lease(void)
+{
+    esp_netif_ip_info_t ip_info = {
+        .ip = s_lease.ip,
+        .netmask = s_lease.netmask,
+        .gw = s_lease.gateway,
+    };
+    esp_netif_dns_info_t dns = {
+        .ip.u_addr.ip4 = s_lease.dns,
+        .ip.type = ESP_IPADDR_TYPE_V4,
+    };
+
+    esp_netif_dhcpc_stop(esp_netif_eth);
+
+    esp_err_t ret = esp_netif_set_ip_info(esp_netif_eth, &ip_info);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to set cached lease: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    if (s_lease.dns.addr != 0) {
+        esp_netif_set_dns_info(esp_netif_eth, ESP_NETIF_DNS_MAIN, &dns);
+    }
+
+    ESP_LOGI(TAG, "Using cached DHCP lease: " IPSTR, IP2STR(&s_lease.ip));
+
+    s_lease_in_use = true;
+    s_ip_source = ETH_IP_SOURCE_CACHED_LEASE;
+
+    return ESP_OK;
+}
+
+// DHCP start on the cached lease in the TCP/IP thread
+typedef struct eth_lease_confirm_call
+{
+    struct tcpip_api_call_data call;
+    esp_err_t err;
+} eth_lease_confirm_call_t;
+
+/**
+ * Starts the DHCP client and puts the cached lease back on the netif, in the TCP/IP thread
+ */
+static err_t eth_confirm_cached_lease(struct tcpip_api_call_data *call)
+{
+    eth_lease_confirm_call_t *confirm = (eth_lease_confirm_call_t *)call;
+    struct netif *netif = esp_netif_get_netif_impl(esp_netif_eth);
+    ip4_addr_t ip = { .addr = s_lease.ip.addr };
+    ip4_addr_t netmask = { .addr = s_lease.netmask.addr };
+    ip4_addr_t gw = { .addr = s_lease.gateway.addr };
+
+    // Called from the TCP/IP thread, esp_netif runs it right here: no packet is handled before the address is back
+    confirm->err = esp_netif_dhcpc_start(esp_netif_eth);
+    if (confirm->err != ESP_OK || netif == NULL) {
+        return ERR_VAL;
+    }
+
+    // esp_netif unsets the address when it starts the client. Set from 0.0.0.0 it aborts no connection,
+    // the DHCP client only replaces it on a NAK or an ACK for a different address.
+    netif_set_addr(netif, &ip, &netmask, &gw);
+
+    if (s_lease.dns.addr != 0) {
+        ip_addr_t dns = { .u_addr.ip4.addr = s_lease.dns.addr, .type = IPADDR_TYPE_V4 };
+        dns_setserver(0, &dns);
+    }
+
+    return ERR_OK;
+}
+#endif
+
 /**
  * Ethernet application event handler
  * @param arg data, aside from event data, that is passed to the handler when it is called
@@ -313,14 +550,29 @@ static void ethernet_app_event_handler(void *arg, esp_event_base_t event_base, i
             case ETHERNET_EVENT_CONNECTED:
                 ESP_LOGI(TAG, "Ethernet Link Up");
                 xEventGroupSetBits(ethernet_app_event_group, ETHERNET_APP_ETH_CONNECTED_BIT);
+                if (s_first_link_us == 0) {
+                    s_first_link_us = esp_timer_get_time();
+                }
                 
                 // Tambahkan ini: Kirim pesan ke HTTP server
                 http_server_monitor_send_message(HTTP_MSG_ETH_CONNECT_INIT);
                 
+#if CONFIG_ETH_TX_SG
+                // The netif was added on start, its link output can be replaced now
+                if (w5500_sg_tx_start(esp_netif_eth) != ESP_OK) {
+                    ESP_LOGW(TAG, "Scatter-gather TX not available, frames sent by the driver");
+                }
+#endif
+                
                 // Start DHCP timer only if DHCP is enabled
                 if (s_eth_ip_config.dhcp_enabled) {
+#if CONFIG_ETH_DHCP_CACHED_LEASE
+                    // Up on the cached lease already, DHCP confirms it a little later
+                    xTimerStart(s_lease_in_use ? s_lease_timer : s_dhcp_timer, 0);
+#else
                     // Start timer for DHCP timeout
                     xTimerStart(s_dhcp_timer, 0);
+#endif
                 } else {
                     // Configure static IP immediately
                     configure_static_ip();
@@ -341,6 +593,11 @@ static void ethernet_app_event_handler(void *arg, esp_event_base_t event_base, i
                 if (xTimerIsTimerActive(s_dhcp_timer)) {
                     xTimerStop(s_dhcp_timer, 0);
                 }
+#if CONFIG_ETH_DHCP_CACHED_LEASE
+                if (s_lease_timer != NULL) {
+                    xTimerStop(s_lease_timer, 0);
+                }
+#endif
                 
                 ethernet_app_send_message(ETHERNET_APP_MSG_ETH_DISCONNECTED, NULL);
                 break;
@@ -366,10 +623,6 @@ static void ethernet_app_event_handler(void *arg, esp_event_base_t event_base, i
         switch (event_id) {
             case IP_EVENT_ETH_GOT_IP:
                 // Stop DHCP timer as we got an IP
-                
-                // Tambahkan ini: Kirim pesan ke HTTP server
-                http_server_monitor_send_message(HTTP_MSG_ETH_CONNECT_SUCCESS);
-                
                 if (xTimerIsTimerActive(s_dhcp_timer)) {
                     xTimerStop(s_dhcp_timer, 0);
                 }
@@ -382,16 +635,19 @@ static void ethernet_app_event_handler(void *arg, esp_event_base_t event_base, i
                 ESP_LOGI(TAG, "ETHGW: " IPSTR, IP2STR(&event->ip_info.gw));
                 ESP_LOGI(TAG, "~~~~~~~~~~~");
                 
-                // Update current IP configuration from DHCP result
-                if (!(xEventGroupGetBits(ethernet_app_event_group) & ETHERNET_APP_ETH_USING_STATIC_IP_BIT)) {
-                    sprintf(s_eth_ip_config.ip, IPSTR, IP2STR(&event->ip_info.ip));
-                    sprintf(s_eth_ip_config.gateway, IPSTR, IP2STR(&event->ip_info.gw));
-                    sprintf(s_eth_ip_config.netmask, IPSTR, IP2STR(&event->ip_info.netmask));
-                    // DNS will remain as previously configured
-                }
-                
+                eth_first_ip();
+
                 xEventGroupSetBits(ethernet_app_event_group, ETHERNET_APP_ETH_GOT_IP_BIT);
-                ethernet_app_send_message(ETHERNET_APP_MSG_ETH_CONNECTED_GOT_IP, NULL);
+                
+                // The Ethernet task takes the addresses over into s_eth_ip_config (freed there)
+                esp_netif_ip_info_t *ip_info = malloc(sizeof(esp_netif_ip_info_t));
+                if (ip_info != NULL) {
+                    memcpy(ip_info, &event->ip_info, sizeof(esp_netif_ip_info_t));
+                }
+                if (ip_info == NULL || ethernet_app_send_message(ETHERNET_APP_MSG_ETH_CONNECTED_GOT_IP, ip_info) != pdTRUE) {
+                    free(ip_info);
+                    http_server_monitor_send_message(HTTP_MSG_ETH_CONNECT_SUCCESS);
+                }
                 break;
                 
             default:
@@ -430,6 +686,23 @@ static void ethernet_app_task(void *pvParameters)
         return;
     }
     
+#if CONFIG_ETH_DHCP_CACHED_LEASE
+    // Create the timer that has DHCP confirm the cached lease after link up
+    s_lease_timer = xTimerCreate(
+        "lease_timer",
+        pdMS_TO_TICKS(CONFIG_ETH_DHCP_CACHED_LEASE_CONFIRM_S * 1000),
+        pdFALSE,  // Don't auto reload
+        NULL,     // Timer ID
+        lease_confirm_callback
+    );
+    
+    if (s_lease_timer == NULL) {
+        ESP_LOGE(TAG, "Failed to create lease timer");
+        vTaskDelete(NULL);
+        return;
+    }
+#endif
+    
     // Try to load saved IP configuration
     eth_ip_config_t loaded_config;
     if (app_nvs_load_eth_config(&loaded_config)) {
@@ -438,6 +711,13 @@ static void ethernet_app_task(void *pvParameters)
     } else {
         ESP_LOGI(TAG, "No saved Ethernet configuration found, using defaults");
     }
+    device_state_set_eth_ip_config(&s_eth_ip_config);
+    
+    // Last DHCP lease, the DHCP client asks for its address again (INIT-REBOOT, CONFIG_LWIP_DHCP_RESTORE_LAST_IP)
+    s_lease_valid = app_nvs_load_eth_dhcp_lease(&s_lease);
+    if (s_lease_valid) {
+        ESP_LOGI(TAG, "Last DHCP lease " IPSTR " from " IPSTR, IP2STR(&s_lease.ip), IP2STR(&s_lease.server));
+    }
     
     // Initialize TCP/IP network interface (should be called only once in application)
     if (esp_netif_eth == NULL) {
@@ -462,10 +742,29 @@ static void ethernet_app_task(void *pvParameters)
         ESP_LOGI(TAG, "Using static IP configuration");
         configure_static_ip();
     }
+#if CONFIG_ETH_DHCP_CACHED_LEASE
+    else if (eth_cached_lease_usable()) {
+        // Up on the last lease at link up, DHCP confirms it CONFIG_ETH_DHCP_CACHED_LEASE_CONFIRM_S later
+        apply_cached_lease();
+    }
+#endif
+    
+    TaskHandle_t rx_task = NULL;
+#if CONFIG_ETH_RX_BURST
+    // Frames read in SPI bursts straight into pbufs, taken over while the driver is not started yet
+    if (w5500_burst_rx_start(esp_netif_eth, ETH_SPI_INT_GPIO, &rx_task) != ESP_OK) {
+        ESP_LOGW(TAG, "Burst RX not available, frames read by the driver");
+    }
+#endif
     
     // Start Ethernet driver
     ESP_ERROR_CHECK(esp_eth_start(s_eth_handle));
     
+    // RX wakeups by the INT pin, a poll timer or both depending on the rate (CONFIG_ETH_RX_MODE)
+    if (w5500_rx_mode_start(s_eth_handle, esp_netif_eth, ETH_SPI_INT_GPIO, rx_task) != ESP_OK) {
+        ESP_LOGW(TAG, "RX mode control not available, interrupt mode only");
+    }
+    
     ESP_LOGI(TAG, "Ethernet started successfully");
     
     for(;;)
@@ -484,6 +783,30 @@ static void ethernet_app_task(void *pvParameters)
                 case ETHERNET_APP_MSG_ETH_CONNECTED_GOT_IP:
                     ESP_LOGI(TAG, "ETHERNET_APP_MSG_ETH_CONNECTED_GOT_IP");
                     
+                    // Sent by the IP event with the addresses, by configure_static_ip without
+                    if (msg.data != NULL) {
+                        esp_netif_ip_info_t *ip_info = (esp_netif_ip_info_t*)msg.data;
+                        
+                        // Update current IP configuration from DHCP result
+                        if (!(xEventGroupGetBits(ethernet_app_event_group) & ETHERNET_APP_ETH_USING_STATIC_IP_BIT)) {
+                            sprintf(s_eth_ip_config.ip, IPSTR, IP2STR(&ip_info->ip));
+                            sprintf(s_eth_ip_config.gateway, IPSTR, IP2STR(&ip_info->gw));
+                            sprintf(s_eth_ip_config.netmask, IPSTR, IP2STR(&ip_info->netmask));
+                            // DNS will remain as previously configured
+                            eth_publish_ip_config();
+                            
+                            // The cached lease has nothing new until DHCP confirmed it
+                            if (!s_lease_in_use) {
+                                s_ip_source = ETH_IP_SOURCE_DHCP;
+                                eth_save_dhcp_lease(ip_info);
+                            }
+                        }
+                        free(msg.data);
+                        
+                        // Kirim pesan ke HTTP server setelah alamat dipublikasikan
+                        http_server_monitor_send_message(HTTP_MSG_ETH_CONNECT_SUCCESS);
+                    }
+                    
                     // Check for connection callback
                     if (ethernet_connected_event_cb) {
                         ethernet_app_call_callback();
@@ -505,6 +828,13 @@ static void ethernet_app_task(void *pvParameters)
                     ESP_LOGI(TAG, "ETHERNET_APP_MSG_ETH_STOP");
                     
                     if (s_eth_handle != NULL) {
+                        w5500_rx_mode_stop();
+#if CONFIG_ETH_RX_BURST
+                        w5500_burst_rx_stop();
+#endif
+#if CONFIG_ETH_TX_SG
+                        w5500_sg_tx_stop();
+#endif
                         ESP_ERROR_CHECK(esp_eth_stop(s_eth_handle));
                         ESP_ERROR_CHECK(eth_deinit_w5500(s_eth_handle));
                         s_eth_handle = NULL;
@@ -513,6 +843,12 @@ static void ethernet_app_task(void *pvParameters)
                             xTimerDelete(s_dhcp_timer, 0);
                             s_dhcp_timer = NULL;
                         }
+#if CONFIG_ETH_DHCP_CACHED_LEASE
+                        if (s_lease_timer != NULL) {
+                            xTimerDelete(s_lease_timer, 0);
+                            s_lease_timer = NULL;
+                        }
+#endif
                     }
                     
                     break;
@@ -520,11 +856,37 @@ static void ethernet_app_task(void *pvParameters)
                 case ETHERNET_APP_MSG_DHCP_TIMEOUT:
                     ESP_LOGI(TAG, "ETHERNET_APP_MSG_DHCP_TIMEOUT - Switching to static IP");
                     
+#if CONFIG_ETH_DHCP_CACHED_LEASE
+                    // The last lease if it has not expired, kept until the next link up tries DHCP again
+                    if (s_eth_ip_config.dhcp_enabled && eth_cached_lease_usable() && apply_cached_lease() == ESP_OK) {
+                        break;
+                    }
+#endif
+                    
                     // Switch to static IP configuration
                     configure_static_ip();
                     
                     break;
                     
+#if CONFIG_ETH_DHCP_CACHED_LEASE
+                case ETHERNET_APP_MSG_DHCP_CONFIRM_LEASE:
+                    ESP_LOGI(TAG, "ETHERNET_APP_MSG_DHCP_CONFIRM_LEASE");
+                    
+                    // DHCP asks for the cached address again while it stays in use; a NAK starts over with DISCOVER
+                    if (s_lease_in_use && s_eth_ip_config.dhcp_enabled &&
+                        (xEventGroupGetBits(ethernet_app_event_group) & ETHERNET_APP_ETH_CONNECTED_BIT)) {
+                        eth_lease_confirm_call_t call = { .err = ESP_FAIL };
+
+                        s_lease_in_use = false;
+                        if (tcpip_api_call(eth_confirm_cached_lease, &call.call) != ERR_OK) {
+                            ESP_LOGW(TAG, "DHCP not started on the cached lease: %s", esp_err_to_name(call.err));
+                        }
+                        xTimerStart(s_dhcp_timer, 0);
+                    }
+                    
+                    break;
+#endif
+                    
                 case ETHERNET_APP_MSG_UPDATE_IP_CONFIG:
                     ESP_LOGI(TAG, "ETHERNET_APP_MSG_UPDATE_IP_CONFIG");
                     
@@ -534,9 +896,16 @@ static void ethernet_app_task(void *pvParameters)
                         // Check if we're changing from DHCP to static or vice versa
                         bool mode_changing = (s_eth_ip_config.dhcp_enabled != new_config->dhcp_enabled);
                         
+                        // A lease from before a static configuration is not asked for again
+                        if (mode_changing && !new_config->dhcp_enabled && s_lease_valid) {
+                            s_lease_valid = false;
+                            app_nvs_clear_eth_dhcp_lease();
+                        }
+                        
                         // Update IP configuration
                         memcpy(&s_eth_ip_config, new_config, sizeof(eth_ip_config_t));
                         free(msg.data);  // Free the allocated memory for the message data
+                        eth_publish_ip_config();
                         
                         // Save configuration to NVS
                         app_nvs_save_eth_config(&s_eth_ip_config);
@@ -548,6 +917,7 @@ static void ethernet_app_task(void *pvParameters)
                                     // Switch to DHCP
                                     ESP_LOGI(TAG, "Switching to DHCP");
                                     xEventGroupClearBits(ethernet_app_event_group, ETHERNET_APP_ETH_USING_STATIC_IP_BIT);
+                                    s_lease_in_use = false;
                                     esp_netif_dhcpc_start(esp_netif_eth);
                                     
                                     // Start DHCP timeout timer
@@ -602,6 +972,30 @@ void ethernet_app_call_callback(void)
     }
 }
 
+/**
+ * Time from boot to the first Ethernet IP address
+ */
+uint32_t ethernet_app_get_boot_to_ip_ms(void)
+{
+    return (uint32_t)(s_first_ip_us / 1000);
+}
+
+/**
+ * Time from boot to the first link up
+ */
+uint32_t ethernet_app_get_boot_to_link_ms(void)
+{
+    return (uint32_t)(s_first_link_us / 1000);
+}
+
+/**
+ * Where the current Ethernet address came from
+ */
+eth_ip_source_e ethernet_app_get_ip_source(void)
+{
+    return s_ip_source;
+}
+
 /**
  * Get the Ethernet handle
  */
@@ -611,7 +1005,7 @@ esp_eth_handle_t ethernet_app_get_eth_handle(void)
 }
 
 /**
- * Get the current Ethernet IP configuration
+ * Get the current Ethernet IP configuration (published copy, safe from any task)
  */
 esp_err_t ethernet_app_get_ip_config(eth_ip_config_t* config)
 {
@@ -619,7 +1013,9 @@ esp_err_t ethernet_app_get_ip_config(eth_ip_config_t* config)
         return ESP_ERR_INVALID_ARG;
     }
     
-    memcpy(config, &s_eth_ip_config, sizeof(eth_ip_config_t));
+    device_state_t state;
+    device_state_get(&state);
+    memcpy(config, &state.eth_ip_config, sizeof(eth_ip_config_t));
     return ESP_OK;
 }
 
@@ -665,6 +1061,7 @@ esp_err_t ethernet_app_apply_ip_config(void)
         // Switch to DHCP
         ESP_LOGI(TAG, "Applying DHCP configuration");
         xEventGroupClearBits(ethernet_app_event_group, ETHERNET_APP_ETH_USING_STATIC_IP_BIT);
+        s_lease_in_use = false;
         esp_netif_dhcpc_start(esp_netif_eth);
         
         // Start DHCP timeout timer
@@ -20,7 +20,7 @@ typedef void (*ethernet_connected_event_callback_t)(void);
 
 // W5500 SPI Ethernet configuration
 #define ETH_SPI_HOST          SPI2_HOST
-#define ETH_SPI_CLOCK_MHZ     25      // MHz
+#define ETH_SPI_CLOCK_MHZ     25      // MHz, also the fallback of CONFIG_ETH_SPI_CLOCK_AUTO
 #define ETH_SPI_MISO_GPIO     13      // Customize these pins for your setup
 #define ETH_SPI_MOSI_GPIO     11
 #define ETH_SPI_SCLK_GPIO     12
@@ -28,7 +28,7 @@ typedef void (*ethernet_connected_event_callback_t)(void);
 #define ETH_SPI_INT_GPIO      4       // Interrupt pin
 #define ETH_SPI_PHY_RST_GPIO  -1      // -1 means not connected
 #define ETH_SPI_PHY_ADDR      0       // W5500 doesn't use PHY address
-#define ETH_SPI_POLLING_MS    0       // 0 means using interrupt mode
+#define ETH_SPI_POLLING_MS    0       // 0 means using interrupt mode (polling: CONFIG_ETH_RX_MODE)
 
 // Default static IP configuration (used if DHCP fails)
 #define ETH_DEFAULT_IP        "192.168.0.101"
@@ -39,6 +39,9 @@ typedef void (*ethernet_connected_event_callback_t)(void);
 // DHCP timeout in milliseconds
 #define ETH_DHCP_TIMEOUT_MS   15000   // 15 seconds
 
+// Wall clock times before this were never set (2016-01-01), the age of a lease is unknown then
+#define ETH_DHCP_LEASE_CLOCK_SET  1451606400
+
 // netif object for the Ethernet
 extern esp_netif_t* esp_netif_eth;
 
@@ -51,6 +54,28 @@ typedef struct {
     bool dhcp_enabled;    // Whether to use DHCP or static IP
 } eth_ip_config_t;
 
+// Last DHCP lease, kept in NVS for the next boot
+typedef struct {
+    esp_ip4_addr_t ip;
+    esp_ip4_addr_t netmask;
+    esp_ip4_addr_t gateway;
+    esp_ip4_addr_t dns;       // Primary DNS server
+    esp_ip4_addr_t server;    // DHCP server that granted it
+    uint32_t lease_s;         // Lease time in seconds
+    int64_t obtained;         // Wall clock time of the ACK in seconds, 0 if the clock was not set
+} eth_dhcp_lease_t;
+
+/**
+ * Where the current Ethernet address came from
+ */
+typedef enum eth_ip_source
+{
+    ETH_IP_SOURCE_NONE = 0,
+    ETH_IP_SOURCE_DHCP,
+    ETH_IP_SOURCE_CACHED_LEASE,
+    ETH_IP_SOURCE_STATIC
+} eth_ip_source_e;
+
 /**
  * Message IDs for the Ethernet application task
  */
@@ -61,7 +86,8 @@ typedef enum ethernet_app_message
     ETHERNET_APP_MSG_ETH_DISCONNECTED,
     ETHERNET_APP_MSG_ETH_STOP,
     ETHERNET_APP_MSG_DHCP_TIMEOUT,
-    ETHERNET_APP_MSG_UPDATE_IP_CONFIG
+    ETHERNET_APP_MSG_UPDATE_IP_CONFIG,
+    ETHERNET_APP_MSG_DHCP_CONFIRM_LEASE
 } ethernet_app_message_e;
 
 typedef struct ethernet_app_queue_message
@@ -83,6 +109,24 @@ BaseType_t ethernet_app_send_message(ethernet_app_message_e msgID, void* data);
  */
 void ethernet_app_start(void);
 
+/**
+ * Gets the time from boot to the first Ethernet IP address (DHCP or static)
+ * @return milliseconds, 0 while no address was assigned yet
+ */
+uint32_t ethernet_app_get_boot_to_ip_ms(void);
+
+/**
+ * Gets the time from boot to the first Ethernet link up
+ * @return milliseconds, 0 while the link never came up
+ */
+uint32_t ethernet_app_get_boot_to_link_ms(void);
+
+/**
+ * Gets where the current Ethernet address came from
+ * @return DHCP, the cached lease (CONFIG_ETH_DHCP_CACHED_LEASE) or the static configuration
+ */
+eth_ip_source_e ethernet_app_get_ip_source(void);
+
 /**
  * Gets the Ethernet handle
  */
@@ -0,0 +1,287 @@
+/*
+ * gzip_inflate.c
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_rom_crc.h"
+#include "miniz.h"
+
+#include "gzip_inflate.h"
+
+// Header flags (RFC 1952)
+#define GZIP_FLAG_HCRC			0x02
+#define GZIP_FLAG_EXTRA			0x04
+#define GZIP_FLAG_NAME			0x08
+#define GZIP_FLAG_COMMENT		0x10
+#define GZIP_FLAG_RESERVED		0xe0
+
+// Compression method deflate
+#define GZIP_METHOD_DEFLATE		8
+
+/**
+ * Parts of the gzip stream, fixed size parts are collected in gzip_inflate_t.field.
+ */
+typedef enum gzip_inflate_state
+{
+	GZIP_STATE_HEADER = 0,		// Fixed 10 byte header
+	GZIP_STATE_EXTRA_LEN,		// Length of the extra field
+	GZIP_STATE_EXTRA,			// Extra field, skipped
+	GZIP_STATE_NAME,			// Null terminated file name, skipped
+	GZIP_STATE_COMMENT,			// Null terminated comment, skipped
+	GZIP_STATE_HEADER_CRC,		// CRC-16 of the header, not checked
+	GZIP_STATE_DATA,			// Deflate stream
+	GZIP_STATE_TRAILER,			// CRC-32 and size of the decompressed data
+	GZIP_STATE_DONE,
+} gzip_inflate_state_e;
+
+struct gzip_inflate
+{
+	gzip_inflate_state_e state;
+	uint8_t flags;
+	uint8_t field[10];
+	size_t field_len;				// Bytes collected in field
+	size_t skip;					// Bytes of the extra field left
+	uint32_t crc;
+	size_t out_len;
+	gzip_inflate_data_cb_t on_data;
+	void *ctx;
+	size_t dict_ofs;				// Write position in the window
+	tinfl_decompressor inflator;
+	uint8_t dict[TINFL_LZ_DICT_SIZE];	// Deflate window, also the output buffer
+};
+
+static inline uint32_t gzip_inflate_le32(const uint8_t *p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/**
+ * Collects the bytes of a fixed size part.
+ * @return true once field holds len bytes.
+ */
+static bool gzip_inflate_collect(gzip_inflate_t *g, const uint8_t **data, size_t *len, size_t field_len)
+{
+	size_t n = field_len - g->field_len;
+	if (n > *len)
+	{
+		n = *len;
+	}
+
+	memcpy(g->field + g->field_len, *data, n);
+	g->field_len += n;
+	*data += n;
+	*len -= n;
+
+	if (g->field_len < field_len)
+	{
+		return false;
+	}
+
+	g->field_len = 0;
+	return true;
+}
+
+/**
+ * Moves on to the next optional header part present in the flags, or to the data.
+ */
+static void gzip_inflate_next_header_part(gzip_inflate_t *g)
+{
+	if (g->state < GZIP_STATE_EXTRA_LEN && (g->flags & GZIP_FLAG_EXTRA))
+	{
+		g->state = GZIP_STATE_EXTRA_LEN;
+	}
+	else if (g->state < GZIP_STATE_NAME && (g->flags & GZIP_FLAG_NAME))
+	{
+		g->state = GZIP_STATE_NAME;
+	}
+	else if (g->state < GZIP_STATE_COMMENT && (g->flags & GZIP_FLAG_COMMENT))
+	{
+		g->state = GZIP_STATE_COMMENT;
+	}
+	else if (g->state < GZIP_STATE_HEADER_CRC && (g->flags & GZIP_FLAG_HCRC))
+	{
+		g->state = GZIP_STATE_HEADER_CRC;
+	}
+	else
+	{
+		g->state = GZIP_STATE_DATA;
+	}
+}
+
+/**
+ * Inflates as much of the input as possible, passing the output on a window at a time.
+ * @return ESP_OK, also when the deflate stream ended (state then GZIP_STATE_TRAILER).
+ */
+static esp_err_t gzip_inflate_data(gzip_inflate_t *g, const uint8_t **data, size_t *len)
+{
+	tinfl_status status;
+
+	do
+	{
+		size_t in_size = *len;
+		size_t out_size = TINFL_LZ_DICT_SIZE - g->dict_ofs;
+
+		status = tinfl_decompress(&g->inflator, *data, &in_size, g->dict, g->dict + g->dict_ofs, &out_size,
+				TINFL_FLAG_HAS_MORE_INPUT);
+
+		*data += in_size;
+		*len -= in_size;
+
+		if (out_size > 0)
+		{
+			g->crc = esp_rom_crc32_le(g->crc, g->dict + g->dict_ofs, out_size);
+			g->out_len += out_size;
+
+			esp_err_t err = g->on_data(g->ctx, (const char*)g->dict + g->dict_ofs, out_size);
+			if (err != ESP_OK)
+			{
+				return err;
+			}
+
+			g->dict_ofs = (g->dict_ofs + out_size) & (TINFL_LZ_DICT_SIZE - 1);
+		}
+
+		if (status < TINFL_STATUS_DONE)
+		{
+			return ESP_ERR_INVALID_RESPONSE;
+		}
+		if (status == TINFL_STATUS_DONE)
+		{
+			g->state = GZIP_STATE_TRAILER;
+			return ESP_OK;
+		}
+	} while (*len > 0 || status == TINFL_STATUS_HAS_MORE_OUTPUT);
+
+	return ESP_OK;
+}
+
+gzip_inflate_t* gzip_inflate_create(gzip_inflate_data_cb_t on_data, void *ctx)
+{
+	gzip_inflate_t *g = malloc(sizeof(gzip_inflate_t));
+	if (g == NULL)
+	{
+		return NULL;
+	}
+
+	g->state = GZIP_STATE_HEADER;
+	g->flags = 0;
+	g->field_len = 0;
+	g->skip = 0;
+	g->crc = 0;
+	g->out_len = 0;
+	g->on_data = on_data;
+	g->ctx = ctx;
+	g->dict_ofs = 0;
+	tinfl_init(&g->inflator);
+
+	return g;
+}
+
+esp_err_t gzip_inflate_feed(gzip_inflate_t *g, const char *data, size_t len)
+{
+	const uint8_t *p = (const uint8_t*)data;
+	esp_err_t err = ESP_OK;
+
+	while (len > 0 && err == ESP_OK)
+	{
+		switch (g->state)
+		{
+			case GZIP_STATE_HEADER:
+				if (gzip_inflate_collect(g, &p, &len, 10))
+				{
+					if (g->field[0] != GZIP_INFLATE_MAGIC_0 || g->field[1] != GZIP_INFLATE_MAGIC_1
+							|| g->field[2] != GZIP_METHOD_DEFLATE || (g->field[3] & GZIP_FLAG_RESERVED))
+					{
+						return ESP_ERR_INVALID_RESPONSE;
+					}
+					g->flags = g->field[3];
+					gzip_inflate_next_header_part(g);
+				}
+				break;
+
+			case GZIP_STATE_EXTRA_LEN:
+				if (gzip_inflate_collect(g, &p, &len, 2))
+				{
+					g->skip = g->field[0] | (g->field[1] << 8);
+					g->state = GZIP_STATE_EXTRA;
+				}
+				break;
+
+			case GZIP_STATE_EXTRA:
+			{
+				size_t n = (g->skip < len) ? g->skip : len;
+				g->skip -= n;
+				p += n;
+				len -= n;
+				if (g->skip == 0)
+				{
+					gzip_inflate_next_header_part(g);
+				}
+				break;
+			}
+
+			case GZIP_STATE_NAME:
+			case GZIP_STATE_COMMENT:
+			{
+				const uint8_t *end = memchr(p, '\0', len);
+				size_t n = (end != NULL) ? (size_t)(end - p) + 1 : len;
+				p += n;
+				len -= n;
+				if (end != NULL)
+				{
+					gzip_inflate_next_header_part(g);
+				}
+				break;
+			}
+
+			case GZIP_STATE_HEADER_CRC:
+				if (gzip_inflate_collect(g, &p, &len, 2))
+				{
+					gzip_inflate_next_header_part(g);
+				}
+				break;
+
+			case GZIP_STATE_DATA:
+				err = gzip_inflate_data(g, &p, &len);
+				break;
+
+			case GZIP_STATE_TRAILER:
+				if (gzip_inflate_collect(g, &p, &len, 8))
+				{
+					// ISIZE is the size modulo 2^32
+					if (gzip_inflate_le32(g->field) != g->crc || gzip_inflate_le32(g->field + 4) != (uint32_t)g->out_len)
+					{
+						return ESP_ERR_INVALID_CRC;
+					}
+					g->state = GZIP_STATE_DONE;
+				}
+				break;
+
+			case GZIP_STATE_DONE:
+				// Only one member, nothing may follow
+				return ESP_ERR_INVALID_RESPONSE;
+		}
+	}
+
+	return err;
+}
+
+esp_err_t gzip_inflate_finish(gzip_inflate_t *g)
+{
+	return (g->state == GZIP_STATE_DONE) ? ESP_OK : ESP_ERR_INVALID_RESPONSE;
+}
+
+size_t gzip_inflate_out_len(const gzip_inflate_t *g)
+{
+	return g->out_len;
+}
+
+void gzip_inflate_delete(gzip_inflate_t *g)
+{
+	free(g);
+}
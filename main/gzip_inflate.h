@@ -0,0 +1,70 @@
+/*
+ * gzip_inflate.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef MAIN_GZIP_INFLATE_H_
+#define MAIN_GZIP_INFLATE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+// First two bytes of a gzip stream
+#define GZIP_INFLATE_MAGIC_0		0x1f
+#define GZIP_INFLATE_MAGIC_1		0x8b
+
+/**
+ * Receives the decompressed bytes.
+ * @param ctx context given to gzip_inflate_create.
+ * @param data decompressed bytes.
+ * @param len number of bytes.
+ * @return ESP_OK to continue, otherwise the decompression stops and reports the error.
+ */
+typedef esp_err_t (*gzip_inflate_data_cb_t)(void *ctx, const char *data, size_t len);
+
+/**
+ * Streaming gzip decompressor (ROM miniz inflate), fed with the compressed stream in chunks
+ * of any size. Holds the 32 kB deflate window, about 43 kB of heap in total.
+ */
+typedef struct gzip_inflate gzip_inflate_t;
+
+/**
+ * Allocates a decompressor.
+ * @param on_data callback receiving the decompressed data, in pieces of up to 32 kB.
+ * @param ctx context passed to the callback.
+ * @return decompressor, NULL if out of memory.
+ */
+gzip_inflate_t* gzip_inflate_create(gzip_inflate_data_cb_t on_data, void *ctx);
+
+/**
+ * Decompresses the next chunk of the gzip stream.
+ * @param g decompressor.
+ * @param data compressed bytes.
+ * @param len number of bytes.
+ * @return ESP_OK, ESP_ERR_INVALID_RESPONSE for a corrupt stream, otherwise the error returned by the callback.
+ */
+esp_err_t gzip_inflate_feed(gzip_inflate_t *g, const char *data, size_t len);
+
+/**
+ * Ends the stream.
+ * @param g decompressor.
+ * @return ESP_OK if the whole stream was decompressed and its CRC-32 and size match,
+ * ESP_ERR_INVALID_RESPONSE for a truncated stream, ESP_ERR_INVALID_CRC for a mismatch.
+ */
+esp_err_t gzip_inflate_finish(gzip_inflate_t *g);
+
+/**
+ * @return number of decompressed bytes passed to the callback.
+ */
+size_t gzip_inflate_out_len(const gzip_inflate_t *g);
+
+/**
+ * Frees a decompressor.
+ * @param g decompressor, may be NULL.
+ */
+void gzip_inflate_delete(gzip_inflate_t *g);
+
+#endif /* MAIN_GZIP_INFLATE_H_ */
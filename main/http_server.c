@@ -5,6 +5,10 @@
  *      Author: LattePanda
  */
 
+#include <strings.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
 
 #include "esp_http_server.h"
 #include "esp_log.h"
@@ -13,29 +17,106 @@
 #include "esp_timer.h"
 #include "esp_wifi.h"
 #include "lwip/ip4_addr.h"
+#include "lwip/sockets.h"
 #include "sys/param.h"
+#include "cJSON.h"
 
 #include "http_server.h"
 
+#include "device_state.h"
 #include "ethernet_app.h"
+#include "json_writer.h"
+#include "multipart_parser.h"
+#include "net_bench.h"
+#include "ota_image.h"
+#include "ota_pull.h"
+#include "ota_session.h"
+#include "ota_writer.h"
+#include "self_test.h"
 #include "sntp_time_sync.h"
 #include "tasks_common.h"
+#include "w5500_burst_rx.h"
+#include "w5500_rx_mode.h"
+#include "w5500_sg_tx.h"
+#include "web_assets.h"
 #include "wifi_app.h"
 
 // Tag used for ESP serial console message
 static const char TAG[] = "http_server";
 
-// WiFi connect status
-static int g_wifi_connect_status = NONE;
+// Cache-Control for assets requested with their current ?v= version: the URL changes with the content
+#define HTTP_CACHE_CONTROL_VERSIONED	"public, max-age=31536000, immutable"
+
+// Cache-Control for everything else: browsers may keep a copy but must revalidate it (ETag)
+#define HTTP_CACHE_CONTROL_REVALIDATE	"no-cache"
+
+// Asset bodies larger than this are streamed by the asset sender tasks instead of the httpd task
+#define HTTP_ASSET_ASYNC_THRESHOLD		8192
+
+// Bytes per httpd_resp_send_chunk call when streaming an asset
+#define HTTP_ASSET_CHUNK_SIZE			4096
+
+// Number of asset sender tasks, i.e. large downloads in flight without stalling other requests
+#define HTTP_ASSET_SENDER_COUNT			2
+
+// Dashboards connected to /events at once, each one keeps a socket open
+#define HTTP_SSE_MAX_CLIENTS			3
+
+// Interval of the keep-alive (local time) event on /events, also how fast dead clients are dropped
+#define HTTP_SSE_KEEPALIVE_MS			10000
+
+// Largest Server-Sent Event frame (event name plus JSON data)
+#define HTTP_SSE_FRAME_LEN				160
 
-// Ethernet connect status
-static int g_eth_connect_status = NONE; // Gunakan HTTP_ETH_STATUS_NONE pada http_server.h yang diperbarui
+// Dashboards connected to /ws at once
+#define HTTP_WS_MAX_CLIENTS				3
 
-// Firmware update status
-static int g_fw_update_status = OTA_UPDATE_PENDING;
+// Size of the device state JSON pushed to the /ws clients
+#define HTTP_STATUS_JSON_LEN			1024
+
+// Staging buffer of the JSON responses streamed in httpd chunks (/status.json)
+#define HTTP_JSON_CHUNK_LEN				256
+
+// /status.json?since= requests held at once waiting for a state change
+#define HTTP_STATUS_MAX_POLLS			3
+
+// How long /status.json?since= is held without a change, the monitor wakes up for the earliest timeout
+#define HTTP_STATUS_POLL_TIMEOUT_MS		20000
+
+// Largest command frame accepted on /ws
+#define HTTP_WS_MAX_FRAME_LEN			256
+
+// Bytes per send or receive call of /bench/download and /bench/upload, the payload is generated, never stored
+#define HTTP_BENCH_CHUNK_SIZE			4096
+
+// /bench/download size without ?size=, and the largest one
+#define HTTP_BENCH_DEFAULT_SIZE			(1024 * 1024)
+#define HTTP_BENCH_MAX_SIZE				(1024 * 1024 * 1024)
+
+/**
+ * Dashboard topics of the /events stream, one event each
+ */
+typedef enum http_server_sse_topic
+{
+	HTTP_SSE_TOPIC_WIFI = 0,
+	HTTP_SSE_TOPIC_ETH,
+	HTTP_SSE_TOPIC_OTA,
+	HTTP_SSE_TOPIC_TIME,
+	HTTP_SSE_TOPIC_COUNT,
+	HTTP_SSE_TOPIC_NONE = HTTP_SSE_TOPIC_COUNT
+} http_server_sse_topic_e;
 
-// Local Time status
-static bool g_is_local_time_set = false;
+/**
+ * Response decided for a web asset request, sent inline or by an asset sender task
+ */
+typedef struct http_server_asset_response
+{
+	httpd_req_t *req;
+	const web_asset_t *asset;
+	const char *cache_control;
+	bool gzip;
+	char etag[24];
+} http_server_asset_response_t;
 
 // HTTP server task handle
 static httpd_handle_t http_server_handle = NULL;
@@ -46,6 +127,49 @@ static TaskHandle_t task_http_server_monitor = NULL;
 // Queue handle used to manipulate the main queue of events
 static QueueHandle_t http_server_monitor_queue_handle;
 
+// Asset sender task handles and the queue of asset responses they stream
+static TaskHandle_t task_http_asset_sender[HTTP_ASSET_SENDER_COUNT];
+static QueueHandle_t http_asset_sender_queue_handle;
+
+// Server-Sent Events clients (async copies of their /events requests) and the mutex guarding them.
+// The clients are sent to from the httpd task only, the mutex keeps http_server_stop out meanwhile.
+static httpd_req_t *g_sse_clients[HTTP_SSE_MAX_CLIENTS];
+static SemaphoreHandle_t g_sse_clients_mutex;
+
+/**
+ * /status.json?since= request held until the device state changes
+ */
+typedef struct http_server_status_poll
+{
+	httpd_req_t *req;
+	int64_t deadline_us;
+} http_server_status_poll_t;
+
+// Held /status.json requests (async copies) and the mutex guarding them
+static http_server_status_poll_t g_status_polls[HTTP_STATUS_MAX_POLLS];
+static SemaphoreHandle_t g_status_polls_mutex;
+
+// WebSocket clients (sockets of their /ws connections), only touched from the httpd task
+static int g_ws_clients[HTTP_WS_MAX_CLIENTS];
+static volatile int g_ws_client_count = 0;
+
+/**
+ * Server-side timing of a /bench/download or /bench/upload request
+ */
+typedef struct http_server_bench_stats
+{
+	char netif[4];					// Interface the request came in on: "eth", "sta", "ap", "" if unknown
+	uint32_t bytes;					// Payload bytes sent or received
+	uint32_t first_byte_us;			// From the handler call to the first payload byte sent or received
+	uint32_t elapsed_us;			// Handler call to the last byte
+	uint32_t blocked_us;			// Time spent in httpd_resp_send_chunk or httpd_req_recv
+	uint32_t bytes_per_s;
+} http_server_bench_stats_t;
+
+// Last download and upload, only touched from the httpd task
+static http_server_bench_stats_t g_bench_download;
+static http_server_bench_stats_t g_bench_upload;
+
 /**
  * ESP32 timer configuration passed to esp_timer_create.
  */
@@ -57,24 +181,15 @@ const esp_timer_create_args_t fw_update_reset_args = {
 };
 esp_timer_handle_t fw_update_reset;
 
-// Embedded files: JQuery, index.html, app.css, app.js and favicon.ico files
-extern const uint8_t jquery_3_3_1_min_js_start[]	asm("_binary_jquery_3_3_1_min_js_start");
-extern const uint8_t jquery_3_3_1_min_js_end[]		asm("_binary_jquery_3_3_1_min_js_end");
-extern const uint8_t index_html_start[]				asm("_binary_index_html_start");
-extern const uint8_t index_html_end[]				asm("_binary_index_html_end");
-extern const uint8_t app_css_start[]				asm("_binary_app_css_start");
-extern const uint8_t app_css_end[]					asm("_binary_app_css_end");
-extern const uint8_t app_js_start[]					asm("_binary_app_js_start");
-extern const uint8_t app_js_end[]					asm("_binary_app_js_end");
-extern const uint8_t favicon_ico_start[]			asm("_binary_favicon_ico_start");
-extern const uint8_t favicon_ico_end[]				asm("_binary_favicon_ico_end");
-
 /**
- * Checks the g_fw_update_status and creates the fw_update_reset timer if g_fw_update_status is true.
+ * Checks the firmware update status and creates the fw_update_reset timer if the update was successful.
  */
 static void http_server_fw_update_reset_timer(void)
 {
-	if (g_fw_update_status == OTA_UPDATE_SUCCESSFUL)
+	device_state_t state;
+	device_state_get(&state);
+
+	if (state.ota_update_status == OTA_UPDATE_SUCCESSFUL)
 	{
 		ESP_LOGI(TAG, "http_server_fw_update_reset_timer: FW updated successful starting FW update reset timer");
 
@@ -89,282 +204,1974 @@ static void http_server_fw_update_reset_timer(void)
 }
 
 /**
- * HTTP server monitor task used to track events of the HTTP server
- * @param pvParameters parameters which can be passed tp the task.
+ * Formats one Server-Sent Event frame.
+ * @param buff buffer of HTTP_SSE_FRAME_LEN bytes receiving the frame.
+ * @param event event name, NULL formats a keep-alive comment.
+ * @param data event data (JSON), ignored for keep-alive comments.
+ * @return length of the frame, cut to the buffer.
  */
-static void http_server_monitor(void *parameter)
+static size_t http_server_sse_format_frame(char *buff, const char *event, const char *data)
 {
-	http_server_queue_message_t msg;
+	int len;
 
-	for(;;)
+	if (event == NULL)
+	{
+		len = snprintf(buff, HTTP_SSE_FRAME_LEN, ": keep-alive\n\n");
+	}
+	else
+	{
+		len = snprintf(buff, HTTP_SSE_FRAME_LEN, "event: %s\ndata: %s\n\n", event, data);
+	}
+
+	return MIN(len, HTTP_SSE_FRAME_LEN - 1);
+}
+
+/**
+ * Sends one Server-Sent Event on an /events stream.
+ * @param req async /events request.
+ * @param event event name, NULL sends a keep-alive comment.
+ * @param data event data (JSON), ignored for keep-alive comments.
+ * @return ESP_OK, otherwise the error from httpd_resp_send_chunk
+ */
+static esp_err_t http_server_sse_send(httpd_req_t *req, const char *event, const char *data)
+{
+	char sse_buff[HTTP_SSE_FRAME_LEN];
+	size_t len = http_server_sse_format_frame(sse_buff, event, data);
+
+	return httpd_resp_send_chunk(req, sse_buff, len);
+}
+
+/**
+ * Maps a monitor message to the /events topic whose state it changed.
+ * @param msgID message handled by the monitor.
+ * @return topic, HTTP_SSE_TOPIC_NONE if the message has no event.
+ */
+static http_server_sse_topic_e http_server_sse_topic(http_server_message_e msgID)
+{
+	switch (msgID)
+	{
+		case HTTP_MSG_WIFI_CONNECT_INIT:
+		case HTTP_MSG_WIFI_CONNECT_SUCCESS:
+		case HTTP_MSG_WIFI_CONNECT_FAIL:
+		case HTTP_MSG_WIFI_USER_DISCONNECT:
+			return HTTP_SSE_TOPIC_WIFI;
+
+		case HTTP_MSG_ETH_CONNECT_INIT:
+		case HTTP_MSG_ETH_CONNECT_SUCCESS:
+		case HTTP_MSG_ETH_CONNECT_FAIL:
+		case HTTP_MSG_ETH_USER_DISCONNECT:
+		case HTTP_MSG_ETH_IP_CONFIG_CHANGED:
+			return HTTP_SSE_TOPIC_ETH;
+
+		case HTTP_MSG_OTA_UPDATE_SUCCESSFUL:
+		case HTTP_MSG_OTA_UPDATE_FAILED:
+			return HTTP_SSE_TOPIC_OTA;
+
+		case HTTP_MSG_TIME_SERVICE_INITIALIZED:
+			return HTTP_SSE_TOPIC_TIME;
+
+		default:
+			return HTTP_SSE_TOPIC_NONE;
+	}
+}
+
+/**
+ * Formats the event carrying the current state of a topic.
+ * @param topic /events topic.
+ * @param data buffer receiving the event data (JSON).
+ * @param len size of the data buffer.
+ * @return event name, or NULL if the topic has no event.
+ */
+static const char* http_server_sse_format_event(http_server_sse_topic_e topic, char *data, size_t len)
+{
+	const char *event = NULL;
+	device_state_t state;
+	json_writer_t w;
+
+	device_state_get(&state);
+
+	json_writer_init(&w, data, len, NULL, NULL);
+	json_writer_begin_object(&w, NULL);
+
+	switch (topic)
+	{
+		case HTTP_SSE_TOPIC_WIFI:
+			json_writer_int(&w, "wifi_connect_status", state.wifi_connect_status);
+			event = "wifi";
+			break;
+
+		case HTTP_SSE_TOPIC_ETH:
+			json_writer_int(&w, "eth_connect_status", state.eth_connect_status);
+			event = "eth";
+			break;
+
+		case HTTP_SSE_TOPIC_OTA:
+			json_writer_int(&w, "ota_update_status", state.ota_update_status);
+			event = "ota";
+			break;
+
+		case HTTP_SSE_TOPIC_TIME:
+			json_writer_string(&w, "time", sntp_time_sync_get_time());
+			event = "time";
+			break;
+
+		default:
+			break;
+	}
+
+	json_writer_end_object(&w);
+
+	return json_writer_finish(&w) == ESP_OK ? event : NULL;
+}
+
+/**
+ * Sends the current state of every topic on a new /events stream.
+ * The time event is left out until the local time is set.
+ * @param req async /events request.
+ * @return ESP_OK, otherwise the error from httpd_resp_send_chunk
+ */
+static esp_err_t http_server_sse_send_initial_state(httpd_req_t *req)
+{
+	device_state_t state;
+	esp_err_t err = ESP_OK;
+
+	device_state_get(&state);
+
+	for (int topic = 0; topic < HTTP_SSE_TOPIC_COUNT && err == ESP_OK; topic++)
 	{
-		if (xQueueReceive(http_server_monitor_queue_handle, &msg, portMAX_DELAY))
+		char data[128];
+		const char *event = http_server_sse_format_event(topic, data, sizeof(data));
+
+		if (event != NULL && (topic != HTTP_SSE_TOPIC_TIME || state.local_time_set))
 		{
-			switch (msg.msgID)
-			{
-				case HTTP_MSG_WIFI_CONNECT_INIT:
-					ESP_LOGI(TAG, "HTTP_MSG_WIFI_CONNECT_INIT");
+			err = http_server_sse_send(req, event, data);
+		}
+	}
 
-					g_wifi_connect_status = HTTP_WIFI_STATUS_CONNECTING;
+	return err;
+}
 
-					break;
+/**
+ * Ends an /events stream and closes its socket.
+ * @param req async /events request.
+ */
+static void http_server_sse_close(httpd_req_t *req)
+{
+	int sockfd = httpd_req_to_sockfd(req);
 
-				case HTTP_MSG_WIFI_CONNECT_SUCCESS:
-					ESP_LOGI(TAG, "HTTP_MSG_WIFI_CONNECT_SUCCESS");
+	httpd_req_async_handler_complete(req);
+	httpd_sess_trigger_close(http_server_handle, sockfd);
+}
 
-					g_wifi_connect_status = HTTP_WIFI_STATUS_CONNECT_SUCCESS;
+/**
+ * Sends an event frame to every /events client, dropping clients whose send fails.
+ * Queued with httpd_queue_work, so it runs in the httpd task like the /events handler
+ * and a slow client never holds the client list while another task waits for it.
+ * @param arg event frame (heap, HTTP_SSE_FRAME_LEN bytes), freed here.
+ */
+static void http_server_sse_broadcast_frame(void *arg)
+{
+	char *frame = (char*)arg;
+	size_t len = strlen(frame);
 
-					break;
+	xSemaphoreTake(g_sse_clients_mutex, portMAX_DELAY);
 
-				case HTTP_MSG_WIFI_CONNECT_FAIL:
-					ESP_LOGI(TAG, "HTTP_MSG_WIFI_CONNECT_FAIL");
+	for (int i = 0; i < HTTP_SSE_MAX_CLIENTS; i++)
+	{
+		if (g_sse_clients[i] != NULL && httpd_resp_send_chunk(g_sse_clients[i], frame, len) != ESP_OK)
+		{
+			ESP_LOGI(TAG, "http_server_sse_broadcast_frame: dropping /events client %d", i);
+			http_server_sse_close(g_sse_clients[i]);
+			g_sse_clients[i] = NULL;
+		}
+	}
 
-					g_wifi_connect_status = HTTP_WIFI_STATUS_CONNECT_FAILED;
+	xSemaphoreGive(g_sse_clients_mutex);
 
-					break;
+	free(frame);
+}
 
-				case HTTP_MSG_WIFI_USER_DISCONNECT:
-					ESP_LOGI(TAG, "HTTP_MSG_WIFI_USER_DISCONNECT");
+/**
+ * Hands an event over to the httpd task for every /events client.
+ * @param event event name, NULL sends a keep-alive comment.
+ * @param data event data (JSON).
+ */
+static void http_server_sse_broadcast(const char *event, const char *data)
+{
+	if (http_server_handle == NULL)
+	{
+		return;
+	}
 
-					g_wifi_connect_status = HTTP_WIFI_STATUS_DISCONNECTED;
+	char *frame = malloc(HTTP_SSE_FRAME_LEN);
+	if (frame == NULL)
+	{
+		return;
+	}
 
-					break;
+	http_server_sse_format_frame(frame, event, data);
 
-				case HTTP_MSG_OTA_UPDATE_SUCCESSFUL:
-					ESP_LOGI(TAG, "HTTP_MSG_OTA_UPDATE_SUCCESSFUL");
-					g_fw_update_status = OTA_UPDATE_SUCCESSFUL;
-					http_server_fw_update_reset_timer();
+	if (httpd_queue_work(http_server_handle, http_server_sse_broadcast_frame, frame) != ESP_OK)
+	{
+		free(frame);
+	}
+}
 
-					break;
+/**
+ * Publishes the current state of a topic to the /events clients.
+ * @param topic /events topic, HTTP_SSE_TOPIC_NONE publishes nothing.
+ */
+static void http_server_sse_publish(http_server_sse_topic_e topic)
+{
+	char data[128];
+	const char *event;
 
-				case HTTP_MSG_OTA_UPDATE_FAILED:
-					ESP_LOGI(TAG, "HTTP_MSG_OTA_UPDATE_FAIL");
-					g_fw_update_status = OTA_UPDATE_FAILED;
+	if (topic == HTTP_SSE_TOPIC_NONE)
+	{
+		return;
+	}
 
-					break;
+	event = http_server_sse_format_event(topic, data, sizeof(data));
+	if (event != NULL)
+	{
+		http_server_sse_broadcast(event, data);
+	}
+}
 
-				case HTTP_MSG_TIME_SERVICE_INITIALIZED:
-					ESP_LOGI(TAG, "HTTP_MSG_TIME_SERVICE_INITIALIZED");
-					g_is_local_time_set = true;
+/**
+ * Keep-alive on the /events streams, carries the local time once it is set.
+ */
+static void http_server_sse_keepalive(void)
+{
+	device_state_t state;
+	device_state_get(&state);
 
-					break;
-					
-				case HTTP_MSG_ETH_CONNECT_INIT:
-				    ESP_LOGI(TAG, "HTTP_MSG_ETH_CONNECT_INIT");
-				    g_eth_connect_status = HTTP_ETH_STATUS_CONNECTING;
-				    break;
-				
-				case HTTP_MSG_ETH_CONNECT_SUCCESS:
-				    ESP_LOGI(TAG, "HTTP_MSG_ETH_CONNECT_SUCCESS");
-				    g_eth_connect_status = HTTP_ETH_STATUS_CONNECT_SUCCESS;
-				    break;
-				
-				case HTTP_MSG_ETH_CONNECT_FAIL:
-				    ESP_LOGI(TAG, "HTTP_MSG_ETH_CONNECT_FAIL");
-				    g_eth_connect_status = HTTP_ETH_STATUS_CONNECT_FAILED;
-				    break;
-				
-				case HTTP_MSG_ETH_USER_DISCONNECT:
-				    ESP_LOGI(TAG, "HTTP_MSG_ETH_USER_DISCONNECT");
-				    g_eth_connect_status = HTTP_ETH_STATUS_DISCONNECTED;
-				    break;
+	if (state.local_time_set)
+	{
+		http_server_sse_publish(HTTP_SSE_TOPIC_TIME);
+	}
+	else
+	{
+		http_server_sse_broadcast(NULL, NULL);
+	}
+}
+
+/**
+ * Stages JSON responses in httpd chunks, flush callback of the chunked JSON writers.
+ */
+static esp_err_t http_server_json_flush(void *ctx, const char *data, size_t len)
+{
+	return httpd_resp_send_chunk((httpd_req_t*)ctx, data, len);
+}
+
+/**
+ * Sends the JSON built in a writer's buffer as the response.
+ * @param req HTTP request to respond to.
+ * @param w writer without flush callback.
+ * @return ESP_OK, otherwise the error from httpd_resp_send
+ */
+static esp_err_t http_server_send_json(httpd_req_t *req, json_writer_t *w)
+{
+	if (json_writer_finish(w) != ESP_OK)
+	{
+		ESP_LOGE(TAG, "http_server_send_json: %s response does not fit its buffer", req->uri);
+		return httpd_resp_send_500(req);
+	}
+
+	httpd_resp_set_type(req, "application/json");
+	return httpd_resp_send(req, w->buf, json_writer_len(w));
+}
+
+/**
+ * Writes the station connection info (IP, netmask, gateway and AP SSID),
+ * an empty object while the station is not connected.
+ * @param w JSON writer.
+ * @param key member name, NULL for the top level object.
+ * @param state device state snapshot.
+ */
+static void http_server_write_wifi_info(json_writer_t *w, const char *key, const device_state_t *state)
+{
+	char ip[IP4ADDR_STRLEN_MAX];
+	char netmask[IP4ADDR_STRLEN_MAX];
+	char gw[IP4ADDR_STRLEN_MAX];
+	wifi_ap_record_t wifi_data;
+	esp_netif_ip_info_t ip_info;
+
+	json_writer_begin_object(w, key);
+
+	if (state->wifi_connect_status == HTTP_WIFI_STATUS_CONNECT_SUCCESS &&
+			esp_wifi_sta_get_ap_info(&wifi_data) == ESP_OK && esp_netif_get_ip_info(esp_netif_sta, &ip_info) == ESP_OK)
+	{
+		esp_ip4addr_ntoa(&ip_info.ip, ip, IP4ADDR_STRLEN_MAX);
+		esp_ip4addr_ntoa(&ip_info.netmask, netmask, IP4ADDR_STRLEN_MAX);
+		esp_ip4addr_ntoa(&ip_info.gw, gw, IP4ADDR_STRLEN_MAX);
+
+		json_writer_string(w, "ip", ip);
+		json_writer_string(w, "netmask", netmask);
+		json_writer_string(w, "gw", gw);
+		json_writer_string_n(w, "ap", (const char*)wifi_data.ssid, sizeof(wifi_data.ssid));
+	}
+
+	json_writer_end_object(w);
+}
+
+/**
+ * Formats the Ethernet MAC address as xx:xx:xx:xx:xx:xx.
+ * @param mac_str buffer of at least 18 bytes.
+ */
+static void http_server_format_eth_mac(char *mac_str)
+{
+    uint8_t mac_addr[6];
+    esp_eth_handle_t eth_handle = ethernet_app_get_eth_handle();
+
+    if (eth_handle != NULL && esp_eth_ioctl(eth_handle, ETH_CMD_G_MAC_ADDR, mac_addr) == ESP_OK)
+    {
+        sprintf(mac_str, "%02x:%02x:%02x:%02x:%02x:%02x",
+                mac_addr[0], mac_addr[1], mac_addr[2], mac_addr[3], mac_addr[4], mac_addr[5]);
+    }
+    else
+    {
+        strcpy(mac_str, "00:00:00:00:00:00");
+    }
+}
+
+/**
+ * Names where the Ethernet address came from.
+ * @param source address source.
+ * @return the name.
+ */
+static const char* http_server_eth_ip_source_name(eth_ip_source_e source)
+{
+    switch (source)
+    {
+        case ETH_IP_SOURCE_DHCP:
+            return "dhcp";
+        case ETH_IP_SOURCE_CACHED_LEASE:
+            return "cached";
+        case ETH_IP_SOURCE_STATIC:
+            return "static";
+        default:
+            return "";
+    }
+}
+
+/**
+ * Writes the Ethernet connection info (IP, netmask, gateway, MAC, mode, where the address came from
+ * and the time from boot to the first address), an empty object while Ethernet is not connected.
+ * @param w JSON writer.
+ * @param key member name, NULL for the top level object.
+ * @param state device state snapshot.
+ */
+static void http_server_write_eth_info(json_writer_t *w, const char *key, const device_state_t *state)
+{
+    const eth_ip_config_t *eth_config = &state->eth_ip_config;
+    char mac_str[18];
+
+    json_writer_begin_object(w, key);
+
+    if (state->eth_connect_status == HTTP_ETH_STATUS_CONNECT_SUCCESS)
+    {
+        http_server_format_eth_mac(mac_str);
+
+        json_writer_string(w, "ip", eth_config->ip);
+        json_writer_string(w, "netmask", eth_config->netmask);
+        json_writer_string(w, "gw", eth_config->gateway);
+        json_writer_string(w, "mac", mac_str);
+        json_writer_string(w, "mode", eth_config->dhcp_enabled ? "DHCP" : "Static");
+        json_writer_string(w, "source", http_server_eth_ip_source_name(ethernet_app_get_ip_source()));
+        json_writer_uint(w, "boot_to_ip_ms", ethernet_app_get_boot_to_ip_ms());
+    }
+
+    json_writer_end_object(w);
+}
+
+/**
+ * Writes the stored Ethernet configuration (mode, addresses and MAC).
+ * @param w JSON writer.
+ * @param key member name, NULL for the top level object.
+ * @param state device state snapshot.
+ */
+static void http_server_write_eth_config(json_writer_t *w, const char *key, const device_state_t *state)
+{
+    const eth_ip_config_t *eth_config = &state->eth_ip_config;
+    char mac_str[18];
+
+    http_server_format_eth_mac(mac_str);
+
+    json_writer_begin_object(w, key);
+    json_writer_int(w, "mode", eth_config->dhcp_enabled ? ETH_MANAGER_IP_DHCP : ETH_MANAGER_IP_STATIC);
+    json_writer_string(w, "ip", eth_config->ip);
+    json_writer_string(w, "subnet", eth_config->netmask);
+    json_writer_string(w, "gateway", eth_config->gateway);
+    json_writer_string(w, "mac", mac_str);
+    json_writer_string(w, "dns", eth_config->dns);
+    json_writer_end_object(w);
+}
+
+/**
+ * Writes the SSID of the ESP32's access point.
+ * @param w JSON writer.
+ * @param key member name.
+ */
+static void http_server_write_ap_ssid(json_writer_t *w, const char *key)
+{
+	wifi_config_t ap_config;
+
+	// Read into a local copy, the WiFi application's configuration holds the station credentials
+	if (esp_wifi_get_config(ESP_IF_WIFI_AP, &ap_config) == ESP_OK)
+	{
+		// Not null terminated when 32 bytes long
+		json_writer_string_n(w, key, (const char*)ap_config.ap.ssid, sizeof(ap_config.ap.ssid));
+	}
+	else
+	{
+		json_writer_string(w, key, "");
+	}
+}
+
+/**
+ * Writes the whole device state served by /status.json and pushed to the /ws clients:
+ * the state version, connect and OTA statuses, local time, AP SSID,
+ * the WiFi and Ethernet connection info and the Ethernet configuration.
+ * @param w JSON writer.
+ */
+static void http_server_write_status(json_writer_t *w)
+{
+	// One snapshot, the version and the fields always match
+	device_state_t state;
+	device_state_get(&state);
+
+	json_writer_begin_object(w, NULL);
+	json_writer_string(w, "type", "status");
+	json_writer_uint(w, "version", state.version);
+	json_writer_int(w, "wifi_connect_status", state.wifi_connect_status);
+	json_writer_int(w, "eth_connect_status", state.eth_connect_status);
+	json_writer_int(w, "ota_update_status", state.ota_update_status);
+	json_writer_string(w, "time", state.local_time_set ? sntp_time_sync_get_time() : "");
+	http_server_write_ap_ssid(w, "ap_ssid");
+	http_server_write_wifi_info(w, "wifi", &state);
+	http_server_write_eth_info(w, "eth", &state);
+	http_server_write_eth_config(w, "eth_config", &state);
+	json_writer_end_object(w);
+}
+
+/**
+ * Formats the device state into a buffer, for the /ws status messages.
+ * @param buf buffer receiving the JSON.
+ * @param len size of the buffer.
+ * @return ESP_OK, or ESP_ERR_INVALID_SIZE if the state does not fit the buffer
+ */
+static esp_err_t http_server_format_status(char *buf, size_t len)
+{
+	json_writer_t w;
+
+	json_writer_init(&w, buf, len, NULL, NULL);
+	http_server_write_status(&w);
+
+	return json_writer_finish(&w);
+}
+
+/**
+ * Sends the device state as the response to a /status.json request, streamed in httpd chunks.
+ * @param req /status.json request, synchronous or async.
+ * @return ESP_OK, otherwise the error from httpd_resp_send_chunk
+ */
+static esp_err_t http_server_status_send(httpd_req_t *req)
+{
+	char chunk[HTTP_JSON_CHUNK_LEN];
+	json_writer_t w;
+
+	httpd_resp_set_type(req, "application/json");
+	httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+
+	json_writer_init(&w, chunk, sizeof(chunk), http_server_json_flush, req);
+	http_server_write_status(&w);
+
+	esp_err_t err = json_writer_finish(&w);
+	if (err == ESP_OK)
+	{
+		err = httpd_resp_send_chunk(req, NULL, 0);
+	}
+
+	return err;
+}
+
+/**
+ * Answers the held /status.json requests.
+ * They are taken out of the list under the mutex and answered after releasing it,
+ * so a slow client never blocks the /status.json handler.
+ * @param all true after a state change, false to only answer the requests whose timeout expired.
+ */
+static void http_server_status_release(bool all)
+{
+	httpd_req_t *release[HTTP_STATUS_MAX_POLLS];
+	int count = 0;
+	int64_t now = esp_timer_get_time();
+
+	xSemaphoreTake(g_status_polls_mutex, portMAX_DELAY);
+
+	for (int i = 0; i < HTTP_STATUS_MAX_POLLS; i++)
+	{
+		if (g_status_polls[i].req != NULL && (all || now >= g_status_polls[i].deadline_us))
+		{
+			release[count++] = g_status_polls[i].req;
+			g_status_polls[i].req = NULL;
+		}
+	}
+
+	xSemaphoreGive(g_status_polls_mutex);
+
+	for (int i = 0; i < count; i++)
+	{
+		http_server_status_send(release[i]);
+		httpd_req_async_handler_complete(release[i]);
+	}
+}
+
+/**
+ * Earliest timeout of the held /status.json requests.
+ * @param latest_us returned if no request is held or all of them time out later.
+ * @return time (esp_timer_get_time) at which the monitor has to answer the next request.
+ */
+static int64_t http_server_status_next_deadline(int64_t latest_us)
+{
+	int64_t deadline_us = latest_us;
+
+	xSemaphoreTake(g_status_polls_mutex, portMAX_DELAY);
+
+	for (int i = 0; i < HTTP_STATUS_MAX_POLLS; i++)
+	{
+		if (g_status_polls[i].req != NULL && g_status_polls[i].deadline_us < deadline_us)
+		{
+			deadline_us = g_status_polls[i].deadline_us;
+		}
+	}
+
+	xSemaphoreGive(g_status_polls_mutex);
+
+	return deadline_us;
+}
+
+/**
+ * Adds a /ws client, called from the httpd task only.
+ * @param sockfd socket of the client.
+ * @return false if all client slots are taken.
+ */
+static bool http_server_ws_add_client(int sockfd)
+{
+	int slot = -1;
+
+	for (int i = 0; i < HTTP_WS_MAX_CLIENTS; i++)
+	{
+		// A reused socket number replaces the stale entry
+		if (g_ws_clients[i] == sockfd)
+		{
+			return true;
+		}
+		if (g_ws_clients[i] < 0 && slot < 0)
+		{
+			slot = i;
+		}
+	}
+
+	if (slot < 0)
+	{
+		return false;
+	}
+
+	g_ws_clients[slot] = sockfd;
+	g_ws_client_count++;
+
+	return true;
+}
+
+/**
+ * Removes a /ws client, called from the httpd task only.
+ * @param slot client slot.
+ */
+static void http_server_ws_remove_client(int slot)
+{
+	g_ws_clients[slot] = -1;
+	g_ws_client_count--;
+}
+
+/**
+ * Sends a status message to every /ws client, dropping the closed ones.
+ * Queued with httpd_queue_work, so it runs in the httpd task like the /ws handler.
+ * @param arg status message (heap), freed here.
+ */
+static void http_server_ws_broadcast(void *arg)
+{
+	char *status = (char*)arg;
+	httpd_ws_frame_t frame = {
+			.final = true,
+			.type = HTTPD_WS_TYPE_TEXT,
+			.payload = (uint8_t*)status,
+			.len = strlen(status)
+	};
+
+	for (int i = 0; i < HTTP_WS_MAX_CLIENTS; i++)
+	{
+		int sockfd = g_ws_clients[i];
+
+		if (sockfd < 0)
+		{
+			continue;
+		}
+
+		if (httpd_ws_get_fd_info(http_server_handle, sockfd) != HTTPD_WS_CLIENT_WEBSOCKET)
+		{
+			ESP_LOGI(TAG, "http_server_ws_broadcast: /ws client on socket %d is gone", sockfd);
+			http_server_ws_remove_client(i);
+		}
+		else if (httpd_ws_send_frame_async(http_server_handle, sockfd, &frame) != ESP_OK)
+		{
+			ESP_LOGI(TAG, "http_server_ws_broadcast: dropping /ws client on socket %d", sockfd);
+			http_server_ws_remove_client(i);
+			httpd_sess_trigger_close(http_server_handle, sockfd);
+		}
+	}
+
+	free(status);
+}
+
+/**
+ * Pushes the current device state to the /ws clients.
+ */
+static void http_server_ws_publish(void)
+{
+	if (g_ws_client_count == 0 || http_server_handle == NULL)
+	{
+		return;
+	}
+
+	char *status = malloc(HTTP_STATUS_JSON_LEN);
+	if (status == NULL)
+	{
+		return;
+	}
+
+	if (http_server_format_status(status, HTTP_STATUS_JSON_LEN) != ESP_OK ||
+			httpd_queue_work(http_server_handle, http_server_ws_broadcast, status) != ESP_OK)
+	{
+		free(status);
+	}
+}
+
+/**
+ * HTTP server monitor task used to track events of the HTTP server
+ * @param pvParameters parameters which can be passed tp the task.
+ */
+static void http_server_monitor(void *parameter)
+{
+	http_server_queue_message_t msg;
+	int64_t keepalive_us = esp_timer_get_time() + (int64_t)HTTP_SSE_KEEPALIVE_MS * 1000;
+
+	for(;;)
+	{
+		// Sleep until the next /events keep-alive or the earliest /status.json timeout, whichever comes first.
+		// A request held meanwhile times out after the next keep-alive, so it never needs an earlier wake-up.
+		int64_t now = esp_timer_get_time();
+		int64_t wakeup_us = http_server_status_next_deadline(keepalive_us);
+		TickType_t wait = wakeup_us > now ? pdMS_TO_TICKS((wakeup_us - now) / 1000) + 1 : 0;
+
+		if (xQueueReceive(http_server_monitor_queue_handle, &msg, wait))
+		{
+			switch (msg.msgID)
+			{
+				case HTTP_MSG_WIFI_CONNECT_INIT:
+					ESP_LOGI(TAG, "HTTP_MSG_WIFI_CONNECT_INIT");
+
+					device_state_set_wifi_connect_status(HTTP_WIFI_STATUS_CONNECTING);
+
+					break;
+
+				case HTTP_MSG_WIFI_CONNECT_SUCCESS:
+					ESP_LOGI(TAG, "HTTP_MSG_WIFI_CONNECT_SUCCESS");
+
+					device_state_set_wifi_connect_status(HTTP_WIFI_STATUS_CONNECT_SUCCESS);
+
+					break;
+
+				case HTTP_MSG_WIFI_CONNECT_FAIL:
+					ESP_LOGI(TAG, "HTTP_MSG_WIFI_CONNECT_FAIL");
+
+					device_state_set_wifi_connect_status(HTTP_WIFI_STATUS_CONNECT_FAILED);
+
+					break;
+
+				case HTTP_MSG_WIFI_USER_DISCONNECT:
+					ESP_LOGI(TAG, "HTTP_MSG_WIFI_USER_DISCONNECT");
+
+					device_state_set_wifi_connect_status(HTTP_WIFI_STATUS_DISCONNECTED);
+
+					break;
+
+				case HTTP_MSG_OTA_UPDATE_SUCCESSFUL:
+					ESP_LOGI(TAG, "HTTP_MSG_OTA_UPDATE_SUCCESSFUL");
+					device_state_set_ota_update_status(OTA_UPDATE_SUCCESSFUL);
+					http_server_fw_update_reset_timer();
+
+					break;
+
+				case HTTP_MSG_OTA_UPDATE_FAILED:
+					ESP_LOGI(TAG, "HTTP_MSG_OTA_UPDATE_FAIL");
+					device_state_set_ota_update_status(OTA_UPDATE_FAILED);
+
+					break;
+
+				case HTTP_MSG_TIME_SERVICE_INITIALIZED:
+					ESP_LOGI(TAG, "HTTP_MSG_TIME_SERVICE_INITIALIZED");
+					device_state_set_local_time_set();
+
+					break;
+					
+				case HTTP_MSG_ETH_CONNECT_INIT:
+				    ESP_LOGI(TAG, "HTTP_MSG_ETH_CONNECT_INIT");
+				    device_state_set_eth_connect_status(HTTP_ETH_STATUS_CONNECTING);
+				    break;
+				
+				case HTTP_MSG_ETH_CONNECT_SUCCESS:
+				    ESP_LOGI(TAG, "HTTP_MSG_ETH_CONNECT_SUCCESS");
+				    device_state_set_eth_connect_status(HTTP_ETH_STATUS_CONNECT_SUCCESS);
+				    break;
+				
+				case HTTP_MSG_ETH_CONNECT_FAIL:
+				    ESP_LOGI(TAG, "HTTP_MSG_ETH_CONNECT_FAIL");
+				    device_state_set_eth_connect_status(HTTP_ETH_STATUS_CONNECT_FAILED);
+				    break;
+				
+				case HTTP_MSG_ETH_USER_DISCONNECT:
+				    ESP_LOGI(TAG, "HTTP_MSG_ETH_USER_DISCONNECT");
+				    device_state_set_eth_connect_status(HTTP_ETH_STATUS_DISCONNECTED);
+				    break;
+
+				case HTTP_MSG_ETH_IP_CONFIG_CHANGED:
+				    // Already published by the Ethernet application, only pushed from here
+				    ESP_LOGI(TAG, "HTTP_MSG_ETH_IP_CONFIG_CHANGED");
+				    break;
+
+//				case HTTP_MSG_OTA_UPDATE_INITIALIZED:
+//					ESP_LOGI(TAG, "HTTP_MSG_OTA_UPDATE_INITIALIZED");
+//
+//					break;
+
+				default:
+					break;
+			}
+
+			// Push the new state to the connected dashboards
+			http_server_sse_publish(http_server_sse_topic(msg.msgID));
+			http_server_ws_publish();
+			http_server_status_release(true);
+		}
+
+		now = esp_timer_get_time();
+		if (now >= keepalive_us)
+		{
+			http_server_sse_keepalive();
+			http_server_ws_publish();
+			keepalive_us = now + (int64_t)HTTP_SSE_KEEPALIVE_MS * 1000;
+		}
+
+		http_server_status_release(false);
+	}
+}
+
+/**
+ * Checks the Accept-Encoding request header for gzip support.
+ * @param req HTTP request to inspect.
+ * @return true if the client accepts gzip encoded content.
+ */
+static bool http_server_accepts_gzip(httpd_req_t *req)
+{
+	char accept_encoding[64] = {0};
+
+	// A truncated value still holds the leading encodings, which is where browsers list gzip
+	esp_err_t err = httpd_req_get_hdr_value_str(req, "Accept-Encoding", accept_encoding, sizeof(accept_encoding));
+	if (err != ESP_OK && err != ESP_ERR_HTTPD_RESULT_TRUNC)
+	{
+		return false;
+	}
+
+	return strstr(accept_encoding, "gzip") != NULL;
+}
+
+/**
+ * Checks whether the request carries the ?v= query matching the asset version.
+ * @param req HTTP request to inspect.
+ * @param version current content version of the requested asset.
+ * @return true if the request addresses this exact version of the asset.
+ */
+static bool http_server_is_versioned_request(httpd_req_t *req, const char *version)
+{
+	char query[48];
+	char value[24];
+
+	if (httpd_req_get_url_query_str(req, query, sizeof(query)) != ESP_OK)
+	{
+		return false;
+	}
+	if (httpd_query_key_value(query, "v", value, sizeof(value)) != ESP_OK)
+	{
+		return false;
+	}
+
+	return strcmp(value, version) == 0;
+}
+
+/**
+ * Sets the validator, caching and content headers of an asset response.
+ * @param req HTTP request the response belongs to.
+ * @param resp asset response, must stay valid until the response is sent.
+ */
+static void http_server_set_asset_headers(httpd_req_t *req, const http_server_asset_response_t *resp)
+{
+	httpd_resp_set_hdr(req, "ETag", resp->etag);
+	httpd_resp_set_hdr(req, "Cache-Control", resp->cache_control);
+
+	// Caches must keep the encoded and identity responses apart
+	httpd_resp_set_hdr(req, "Vary", "Accept-Encoding");
+
+	httpd_resp_set_type(req, resp->asset->type);
+	if (resp->gzip)
+	{
+		httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+	}
+}
+
+/**
+ * Sends the asset body in HTTP_ASSET_CHUNK_SIZE chunks, so one send never blocks for the whole file.
+ * @param resp asset response, headers already set on resp->req.
+ * @return ESP_OK, otherwise the error from httpd_resp_send_chunk
+ */
+static esp_err_t http_server_send_asset_chunks(const http_server_asset_response_t *resp)
+{
+	const uint8_t *data = resp->gzip ? resp->asset->gz_start : resp->asset->start;
+	const uint8_t *end = resp->gzip ? resp->asset->gz_end : resp->asset->end;
+
+	while (data < end)
+	{
+		size_t chunk_len = MIN(end - data, HTTP_ASSET_CHUNK_SIZE);
+		esp_err_t err = httpd_resp_send_chunk(resp->req, (const char *)data, chunk_len);
+		if (err != ESP_OK)
+		{
+			return err;
+		}
+		data += chunk_len;
+	}
+
+	// Terminating chunk
+	return httpd_resp_send_chunk(resp->req, NULL, 0);
+}
+
+/**
+ * Asset sender task, streams large assets of async requests handed over by the httpd task.
+ * @param pvParameters parameter which can be passed to the task
+ */
+static void http_server_asset_sender(void *pvParameters)
+{
+	http_server_asset_response_t resp;
+
+	for (;;)
+	{
+		if (xQueueReceive(http_asset_sender_queue_handle, &resp, portMAX_DELAY))
+		{
+			http_server_set_asset_headers(resp.req, &resp);
+
+			if (http_server_send_asset_chunks(&resp) != ESP_OK)
+			{
+				ESP_LOGW(TAG, "http_server_asset_sender: sending %s failed", resp.asset->path);
+			}
+
+			httpd_req_async_handler_complete(resp.req);
+		}
+	}
+}
+
+/**
+ * Sends an embedded web asset, using its gzip variant when the client accepts it.
+ * Answers 304 Not Modified without a body when If-None-Match holds the current ETag.
+ * Large bodies are handed to an asset sender task, so the httpd task stays free for other requests.
+ * @param req HTTP request for which the uri needs to be handled.
+ * @param asset asset from the generated web asset table.
+ * @return ESP_OK, otherwise the error from httpd_resp_send
+ */
+static esp_err_t http_server_send_web_asset(httpd_req_t *req, const web_asset_t *asset)
+{
+	http_server_asset_response_t resp = {
+			.req = req,
+			.asset = asset,
+			.cache_control = http_server_is_versioned_request(req, asset->version) ? HTTP_CACHE_CONTROL_VERSIONED : HTTP_CACHE_CONTROL_REVALIDATE,
+			.gzip = http_server_accepts_gzip(req)
+	};
+	char if_none_match[64];
+
+	snprintf(resp.etag, sizeof(resp.etag), "\"%s\"", asset->version);
+
+	if (httpd_req_get_hdr_value_str(req, "If-None-Match", if_none_match, sizeof(if_none_match)) == ESP_OK
+			&& strstr(if_none_match, resp.etag) != NULL)
+	{
+		// Validators and caching policy go out with the 304 as well
+		httpd_resp_set_hdr(req, "ETag", resp.etag);
+		httpd_resp_set_hdr(req, "Cache-Control", resp.cache_control);
+		httpd_resp_set_hdr(req, "Vary", "Accept-Encoding");
+		httpd_resp_set_status(req, "304 Not Modified");
+		return httpd_resp_send(req, NULL, 0);
+	}
+
+	size_t body_len = resp.gzip ? asset->gz_end - asset->gz_start : asset->end - asset->start;
+
+	if (body_len <= HTTP_ASSET_ASYNC_THRESHOLD)
+	{
+		http_server_set_asset_headers(req, &resp);
+		return httpd_resp_send(req, (const char *)(resp.gzip ? asset->gz_start : asset->start), body_len);
+	}
+
+	// The httpd task is the only producer, so a free slot checked here is still free below
+	if (uxQueueSpacesAvailable(http_asset_sender_queue_handle) > 0
+			&& httpd_req_async_handler_begin(req, &resp.req) == ESP_OK)
+	{
+		xQueueSend(http_asset_sender_queue_handle, &resp, 0);
+		return ESP_OK;
+	}
+
+	// All senders busy: stream it from here, still in bounded chunks
+	http_server_set_asset_headers(req, &resp);
+	return http_server_send_asset_chunks(&resp);
+}
+
+/**
+ * Static asset handler, serves every embedded web page file from the generated asset table.
+ * @param req HTTP request for which the uri needs to be handled.
+ * @return ESP_OK, otherwise the error from httpd_resp_send
+ */
+static esp_err_t http_server_web_asset_handler(httpd_req_t *req)
+{
+	// The path ends where the query string (e.g. the ?v= cache buster) starts
+	size_t path_len = strcspn(req->uri, "?");
+
+	const web_asset_t *asset = web_assets_find(req->uri, path_len);
+	if (asset == NULL)
+	{
+		ESP_LOGI(TAG, "%s not found", req->uri);
+		return httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "Not found");
+	}
+
+	ESP_LOGI(TAG, "%s requested", asset->path);
+
+	return http_server_send_web_asset(req, asset);
+}
+
+/**
+ * events handler opens a Server-Sent Events stream. The current state is sent right away,
+ * afterwards the HTTP server monitor pushes every change, so dashboards don't need to poll.
+ * @param req HTTP request for which the uri needs to be handled.
+ * @return ESP_OK
+ */
+static esp_err_t http_server_events_handler(httpd_req_t *req)
+{
+	ESP_LOGI(TAG, "/events requested");
+
+	xSemaphoreTake(g_sse_clients_mutex, portMAX_DELAY);
+
+	int slot = -1;
+	for (int i = 0; i < HTTP_SSE_MAX_CLIENTS; i++)
+	{
+		if (g_sse_clients[i] == NULL)
+		{
+			slot = i;
+			break;
+		}
+	}
+
+	// The browser retries later, the page keeps polling meanwhile
+	httpd_req_t *async_req = NULL;
+	if (slot < 0 || httpd_req_async_handler_begin(req, &async_req) != ESP_OK)
+	{
+		xSemaphoreGive(g_sse_clients_mutex);
+		httpd_resp_set_status(req, "503 Service Unavailable");
+		httpd_resp_set_hdr(req, "Retry-After", "30");
+		return httpd_resp_send(req, NULL, 0);
+	}
+
+	httpd_resp_set_type(async_req, "text/event-stream");
+	httpd_resp_set_hdr(async_req, "Cache-Control", "no-cache");
+
+	// Initial state, so the page does not have to request it separately
+	esp_err_t err = http_server_sse_send_initial_state(async_req);
+
+	if (err == ESP_OK)
+	{
+		g_sse_clients[slot] = async_req;
+	}
+	else
+	{
+		http_server_sse_close(async_req);
+	}
+
+	xSemaphoreGive(g_sse_clients_mutex);
+
+	return ESP_OK;
+}
+
+// Upload progress is printed every time this many more bytes were received
+#define HTTP_OTA_PROGRESS_STEP			(64 * 1024)
+
+/**
+ * OTA writer sink for multipart uploads: the parser runs in the writer task as well.
+ * @param ctx multipart parser.
+ * @param data received bytes.
+ * @param len number of bytes.
+ * @return result of multipart_parser_feed.
+ */
+static esp_err_t http_server_OTA_parse(void *ctx, const char *data, size_t len)
+{
+	return multipart_parser_feed((multipart_parser_t*)ctx, data, len);
+}
+
+/**
+ * Receives the firmware image, either as the file of a multipart/form-data upload (web page form)
+ * or as the raw request body (application/octet-stream), and writes it to the next OTA partition.
+ * The image may be gzip compressed, or a delta patch against the running image.
+ * The httpd task only receives into the OTA writer buffers, the writer task parses and flashes them,
+ * so the socket is read while the flash is erased and programmed.
+ * @param req HTTP request for which the uri needs to be handled.
+ * @return ESP_OK, otherwise ESP_FAIL if the update cannot be started
+ */
+esp_err_t http_server_OTA_update_handler(httpd_req_t *req)
+{
+	ota_image_t image = {0};
+	multipart_parser_t parser;
+
+	char content_type[128];
+	int content_length = req->content_len;
+	int content_received = 0;
+	int progress_printed = 0;
+	int recv_len;
+	bool is_multipart = false;
+	esp_err_t err = ESP_OK;
+
+	// Without Content-Type the body is taken as the raw image
+	if (httpd_req_get_hdr_value_str(req, "Content-Type", content_type, sizeof(content_type)) == ESP_OK
+			&& strncasecmp(content_type, "application/octet-stream", 24) != 0)
+	{
+		if (multipart_parser_init(&parser, content_type, ota_image_write, &image) != ESP_OK)
+		{
+			ESP_LOGI(TAG, "http_server_OTA_update_handler: Unsupported Content-Type %s", content_type);
+			return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Expected multipart/form-data or application/octet-stream");
+		}
+		is_multipart = true;
+	}
+
+	printf("http_server_OTA_update_handler: OTA file size: %d\r\n", content_length);
+
+	// A raw body is the image, a form holds it: the body size bounds the image either way
+	switch (ota_image_begin(&image, is_multipart ? 0 : content_length))
+	{
+		case ESP_OK:
+			break;
+		case ESP_ERR_INVALID_STATE:
+			httpd_resp_set_status(req, "409 Conflict");
+			return httpd_resp_sendstr(req, "OTA update already running");
+		case ESP_ERR_NOT_FOUND:
+			return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "No OTA partition");
+		case ESP_ERR_INVALID_SIZE:
+			return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Image larger than the OTA partition");
+		default:
+			printf("http_server_OTA_update_handler: Error with OTA begin, cancelling OTA\r\n");
+			return ESP_FAIL;
+	}
+
+	// Boundaries and form headers may be split between two buffers, the parser carries them over
+	if (ota_writer_start(is_multipart ? http_server_OTA_parse : ota_image_write,
+			is_multipart ? (void*)&parser : (void*)&image,
+			image.partition, image.partition->erase_size, content_length, CONFIG_HTTP_OTA_RECV_BUFFER_SIZE) != ESP_OK)
+	{
+		ESP_LOGI(TAG, "http_server_OTA_update_handler: No memory for the OTA writer");
+		ota_image_end(&image, ESP_ERR_NO_MEM);
+		return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, NULL);
+	}
+
+	while (content_received < content_length)
+	{
+		size_t buff_size;
+		char *ota_buff = ota_writer_get_buffer(&buff_size);
+
+		// NULL once the writer failed, the rest of the upload is not read
+		if (ota_buff == NULL)
+		{
+			break;
+		}
+
+		// Read the data for the request
+		if ((recv_len = httpd_req_recv(req, ota_buff, MIN(content_length - content_received, buff_size))) <= 0)
+		{
+			ota_writer_submit(ota_buff, 0);
+
+			// Check if timeout occurred
+			if (recv_len == HTTPD_SOCK_ERR_TIMEOUT)
+			{
+				ESP_LOGI(TAG, "http_server_OTA_update_handler: Socket Timeout");
+				continue; ////> Retry receiving if timeout occurred
+			}
+			ESP_LOGI(TAG, "http_server_OTA_update_handler: OTA other Error %d", recv_len);
+			err = ESP_FAIL;
+			break;
+		}
+		content_received += recv_len;
+		ota_writer_submit(ota_buff, recv_len);
+
+		// Printing on every read would hold up the receive loop
+		if (content_received - progress_printed >= HTTP_OTA_PROGRESS_STEP || content_received == content_length)
+		{
+			printf("http_server_OTA_update_handler: OTA RX: %d of %d\r", content_received, content_length);
+			progress_printed = content_received;
+		}
+	}
+
+	// Waits until everything received is written
+	esp_err_t write_err = ota_writer_finish();
+	if (err == ESP_OK)
+	{
+		err = write_err;
+	}
+
+	if (err == ESP_OK && is_multipart)
+	{
+		err = multipart_parser_finish(&parser);
+	}
+
+	// Checks the image, switches the boot partition and sends the status to the monitor
+	ota_image_end(&image, err);
+
+	return ESP_OK;
+}
+
+/**
+ * OTA status handler responds with the firmware update status after the OTA update is started
+ * and responds with the compile time/date when the page is first requested
+ * @param req HTTP request for which the url needs to be handled
+ * @return ESP_OK
+ */
+esp_err_t http_server_OTA_status_handler(httpd_req_t *req)
+{
+	char otaJSON[512];
+	device_state_t state;
+	ota_writer_stats_t stats;
+	ota_pull_status_t pull;
+	json_writer_t w;
+
+	ESP_LOGI(TAG, "OTAstatus requested");
+
+	device_state_get(&state);
+
+	json_writer_init(&w, otaJSON, sizeof(otaJSON), NULL, NULL);
+	json_writer_begin_object(&w, NULL);
+	json_writer_int(&w, "ota_update_status", state.ota_update_status);
+	json_writer_string(&w, "compile_time", __TIME__);
+	json_writer_string(&w, "compile_date", __DATE__);
+
+	// Throughput and stage times of the last upload
+	ota_writer_get_stats(&stats);
+	json_writer_begin_object(&w, "ota_stats");
+	json_writer_uint(&w, "bytes", stats.bytes);
+	json_writer_uint(&w, "elapsed_ms", stats.elapsed_ms);
+	json_writer_uint(&w, "kbytes_per_s", stats.elapsed_ms > 0 ? (uint32_t)((uint64_t)stats.bytes * 1000 / 1024 / stats.elapsed_ms) : 0);
+	json_writer_uint(&w, "recv_ms", stats.recv_ms);
+	json_writer_uint(&w, "recv_stall_ms", stats.recv_stall_ms);
+	json_writer_uint(&w, "write_ms", stats.write_ms);
+	json_writer_uint(&w, "write_stall_ms", stats.write_stall_ms);
+	json_writer_uint(&w, "erase_bytes", stats.erase_bytes);
+	json_writer_uint(&w, "erase_ms", stats.erase_ms);
+	json_writer_end_object(&w);
+
+	// Progress of the last pull update (/OTApull)
+	ota_pull_get_status(&pull);
+	json_writer_begin_object(&w, "ota_pull");
+	json_writer_int(&w, "state", pull.state);
+	json_writer_uint(&w, "bytes", pull.bytes);
+	json_writer_uint(&w, "total", pull.total);
+	json_writer_uint(&w, "retries", pull.retries);
+	if (pull.state == OTA_PULL_FAILED)
+	{
+		json_writer_string(&w, "error", esp_err_to_name(pull.err));
+	}
+	json_writer_end_object(&w);
+	json_writer_end_object(&w);
+
+	return http_server_send_json(req, &w);
+}
+
+/**
+ * Responds with the resumable OTA session: image and chunk size and the verified offset to
+ * continue at, or active false without a session.
+ * @param req HTTP request.
+ * @param err result of the request, the HTTP status and "error" member are set from it.
+ * @return result of sending the response.
+ */
+static esp_err_t http_server_OTA_session_send(httpd_req_t *req, esp_err_t err)
+{
+	char sessionJSON[192];
+	ota_session_t session;
+	json_writer_t w;
+
+	switch (err)
+	{
+		case ESP_OK:				break;
+		case ESP_ERR_NOT_FOUND:		httpd_resp_set_status(req, "404 Not Found"); break;
+		case ESP_ERR_INVALID_STATE:	httpd_resp_set_status(req, "409 Conflict"); break;
+		case ESP_ERR_INVALID_ARG:
+		case ESP_ERR_INVALID_SIZE:
+		case ESP_ERR_INVALID_CRC:	httpd_resp_set_status(req, HTTPD_400); break;
+		default:					httpd_resp_set_status(req, HTTPD_500); break;
+	}
+
+	json_writer_init(&w, sessionJSON, sizeof(sessionJSON), NULL, NULL);
+	json_writer_begin_object(&w, NULL);
+	if (ota_session_get(&session) == ESP_OK)
+	{
+		json_writer_bool(&w, "active", true);
+		json_writer_uint(&w, "image_size", session.image_size);
+		json_writer_uint(&w, "chunk_size", session.chunk_size);
+		json_writer_uint(&w, "offset", session.offset);
+	}
+	else
+	{
+		json_writer_bool(&w, "active", false);
+	}
+	if (err != ESP_OK)
+	{
+		json_writer_string(&w, "error", esp_err_to_name(err));
+	}
+	json_writer_end_object(&w);
+
+	return http_server_send_json(req, &w);
+}
+
+/**
+ * Reads a request header as an unsigned number.
+ * @param req HTTP request.
+ * @param field header name.
+ * @param base 10 or 16.
+ * @param value receives the number.
+ * @return true if the header is present and a number.
+ */
+static bool http_server_get_header_uint(httpd_req_t *req, const char *field, int base, uint32_t *value)
+{
+	char str[16];
+	char *end;
+
+	if (httpd_req_get_hdr_value_str(req, field, str, sizeof(str)) != ESP_OK || str[0] == '\0')
+	{
+		return false;
+	}
+
+	*value = strtoul(str, &end, base);
+	return *end == '\0';
+}
+
+/**
+ * Writes benchmark results of the self-test.
+ * @param w JSON writer.
+ * @param key member name.
+ * @param results results, baseline or thresholds.
+ */
+static void http_server_write_self_test_results(json_writer_t *w, const char *key, const self_test_results_t *results)
+{
+	json_writer_begin_object(w, key);
+	json_writer_uint(w, "boot_to_ip_ms", results->boot_to_ip_ms);
+	json_writer_uint(w, "http_latency_us", results->http_latency_us);
+	json_writer_uint(w, "loop_latency_us", results->loop_latency_us);
+	json_writer_uint(w, "min_free_heap", results->min_free_heap);
+	json_writer_end_object(w);
+}
+
+/**
+ * selftest.json handler responds with the post-OTA self-test: state of this boot, results,
+ * the baseline they are compared with and the thresholds derived from it.
+ * @param req HTTP request for which the uri needs to be handled.
+ * @return ESP_OK
+ */
+esp_err_t http_server_self_test_json_handler(httpd_req_t *req)
+{
+	char selfTestJSON[512];
+	self_test_report_t report;
+	json_writer_t w;
+
+	self_test_get_report(&report);
+
+	json_writer_init(&w, selfTestJSON, sizeof(selfTestJSON), NULL, NULL);
+	json_writer_begin_object(&w, NULL);
+	json_writer_int(&w, "state", report.state);
+	json_writer_uint(&w, "regression_percent", CONFIG_SELF_TEST_REGRESSION_PERCENT);
+	json_writer_uint(&w, "failed", report.failed);
+	json_writer_uint(&w, "inconclusive", report.inconclusive);
+	json_writer_uint(&w, "boot_to_link_ms", report.boot_to_link_ms);
+	http_server_write_self_test_results(&w, "results", &report.results);
+	if (report.has_baseline)
+	{
+		http_server_write_self_test_results(&w, "baseline", &report.baseline);
+		http_server_write_self_test_results(&w, "thresholds", &report.thresholds);
+	}
+	json_writer_end_object(&w);
+
+	return http_server_send_json(req, &w);
+}
+
+/**
+ * ethRxMode.json handler responds with the W5500 RX wakeup mode, the RX counters,
+ * the CPU load per core and the burst RX counters (null without CONFIG_ETH_RX_BURST).
+ * @param req HTTP request for which the uri needs to be handled.
+ * @return ESP_OK
+ */
+esp_err_t http_server_eth_rx_mode_json_handler(httpd_req_t *req)
+{
+	char rxModeJSON[512];
+	w5500_rx_mode_stats_t stats;
+	json_writer_t w;
+
+	w5500_rx_mode_get_stats(&stats);
+
+	json_writer_init(&w, rxModeJSON, sizeof(rxModeJSON), NULL, NULL);
+	json_writer_begin_object(&w, NULL);
+	json_writer_string(&w, "mode", w5500_rx_mode_name(stats.mode));
+	json_writer_bool(&w, "polling", stats.polling);
+	json_writer_uint(&w, "rx_frames", stats.rx_frames);
+	json_writer_uint(&w, "rx_bytes", stats.rx_bytes);
+	json_writer_uint(&w, "rx_fps", stats.rx_fps);
+	json_writer_uint(&w, "polls", stats.polls);
+	json_writer_uint(&w, "to_polling", stats.to_polling);
+	json_writer_uint(&w, "to_interrupt", stats.to_interrupt);
+	json_writer_begin_array(&w, "cpu_load");
+	for (int core = 0; core < portNUM_PROCESSORS; core++)
+	{
+		json_writer_uint(&w, NULL, stats.cpu_load[core]);
+	}
+	json_writer_end_array(&w);
+#if CONFIG_ETH_RX_BURST
+	w5500_burst_rx_stats_t burst;
+	w5500_burst_rx_get_stats(&burst);
+	json_writer_begin_object(&w, "burst");
+	json_writer_uint(&w, "bursts", burst.bursts);
+	json_writer_uint(&w, "frames", burst.frames);
+	json_writer_uint(&w, "copied", burst.copied);
+	json_writer_uint(&w, "dropped", burst.dropped);
+	json_writer_uint(&w, "flushed", burst.flushed);
+	json_writer_end_object(&w);
+#else
+	json_writer_null(&w, "burst");
+#endif
+	json_writer_end_object(&w);
+
+	return http_server_send_json(req, &w);
+}
+
+/**
+ * Sets the W5500 RX wakeup mode (POST /ethRxMode).
+ * Header: eth-rx-mode, "interrupt", "polling" or "adaptive".
+ * @param req HTTP request for which the uri needs to be handled.
+ * @return ESP_OK
+ */
+esp_err_t http_server_eth_rx_mode_handler(httpd_req_t *req)
+{
+	char name[16];
+	w5500_rx_mode_e mode;
+
+	if (httpd_req_get_hdr_value_str(req, "eth-rx-mode", name, sizeof(name)) != ESP_OK
+			|| !w5500_rx_mode_from_name(name, &mode))
+	{
+		return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Expected eth-rx-mode: interrupt, polling or adaptive");
+	}
+
+	if (w5500_rx_mode_set(mode) != ESP_OK)
+	{
+		httpd_resp_set_status(req, "409 Conflict");
+		return httpd_resp_sendstr(req, "Ethernet not started");
+	}
+
+	return httpd_resp_sendstr(req, w5500_rx_mode_name(mode));
+}
+
+/**
+ * ethTx.json handler responds with the counters of the scatter-gather TX path
+ * (all null without CONFIG_ETH_TX_SG).
+ * @param req HTTP request for which the uri needs to be handled.
+ * @return ESP_OK
+ */
+esp_err_t http_server_eth_tx_json_handler(httpd_req_t *req)
+{
+	char txJSON[160];
+	json_writer_t w;
+
+	json_writer_init(&w, txJSON, sizeof(txJSON), NULL, NULL);
+	json_writer_begin_object(&w, NULL);
+#if CONFIG_ETH_TX_SG
+	w5500_sg_tx_stats_t stats;
+	w5500_sg_tx_get_stats(&stats);
+	json_writer_uint(&w, "frames", stats.frames);
+	json_writer_uint(&w, "segments", stats.segments);
+	json_writer_uint(&w, "copied", stats.copied);
+	json_writer_uint(&w, "send_waits", stats.send_waits);
+	json_writer_uint(&w, "errors", stats.errors);
+#else
+	json_writer_null(&w, "frames");
+	json_writer_null(&w, "segments");
+	json_writer_null(&w, "copied");
+	json_writer_null(&w, "send_waits");
+	json_writer_null(&w, "errors");
+#endif
+	json_writer_end_object(&w);
+
+	return http_server_send_json(req, &w);
+}
+
+/**
+ * netBench.json handler responds with the progress or result of the last network benchmark run.
+ * @param req HTTP request for which the uri needs to be handled.
+ * @return ESP_OK
+ */
+esp_err_t http_server_net_bench_json_handler(httpd_req_t *req)
+{
+	char netBenchJSON[384];
+	net_bench_result_t result;
+	json_writer_t w;
+
+	net_bench_get_result(&result);
+
+	json_writer_init(&w, netBenchJSON, sizeof(netBenchJSON), NULL, NULL);
+	json_writer_begin_object(&w, NULL);
+	json_writer_int(&w, "state", result.state);
+	json_writer_string(&w, "proto", result.udp ? "udp" : "tcp");
+	json_writer_string(&w, "role", (result.role == NET_BENCH_SERVER) ? "server" : "client");
+	json_writer_string(&w, "netif", result.netif);
+	json_writer_uint(&w, "kbytes", result.bytes / 1024);
+	json_writer_uint(&w, "elapsed_ms", result.elapsed_ms);
+	json_writer_uint(&w, "kbps", result.kbps);
+	if (result.retransmits >= 0)
+	{
+		json_writer_int(&w, "retransmits", result.retransmits);
+	}
+	else
+	{
+		json_writer_null(&w, "retransmits");
+	}
+	if (result.udp)
+	{
+		json_writer_uint(&w, "datagrams", result.datagrams);
+		json_writer_uint(&w, "lost", result.lost);
+		json_writer_uint(&w, "out_of_order", result.out_of_order);
+	}
+	json_writer_begin_array(&w, "cpu_load");
+	for (int core = 0; core < portNUM_PROCESSORS; core++)
+	{
+		json_writer_uint(&w, NULL, result.cpu_load[core]);
+	}
+	json_writer_end_array(&w);
+	if (result.state == NET_BENCH_FAILED)
+	{
+		json_writer_string(&w, "error", esp_err_to_name(result.err));
+	}
+	json_writer_end_object(&w);
+
+	return http_server_send_json(req, &w);
+}
+
+/**
+ * Starts a network benchmark run (POST /netBench), the host side is iperf 2 (tools/net_bench.py).
+ * Headers: bench-proto "tcp" or "udp", bench-role "server" (the device receives) or "client",
+ * bench-netif "eth", "sta" or "ap" (any interface without it), bench-host (client runs),
+ * optional bench-port, bench-time in s and bench-bandwidth in kbit/s (UDP client runs).
+ * Header bench-stop ends the current run instead.
+ * @param req HTTP request for which the uri needs to be handled.
+ * @return ESP_OK
+ */
+esp_err_t http_server_net_bench_handler(httpd_req_t *req)
+{
+	char proto[4] = "tcp";
+	char role[8] = "server";
+	char netif[4];
+	char host[16];
+	uint32_t port = 0;
+	net_bench_config_t config = {0};
+
+	if (httpd_req_get_hdr_value_len(req, "bench-stop") > 0)
+	{
+		net_bench_stop();
+		return httpd_resp_sendstr(req, "Benchmark stopped");
+	}
+
+	httpd_req_get_hdr_value_str(req, "bench-proto", proto, sizeof(proto));
+	httpd_req_get_hdr_value_str(req, "bench-role", role, sizeof(role));
+	http_server_get_header_uint(req, "bench-port", 10, &port);
+	http_server_get_header_uint(req, "bench-time", 10, &config.time_s);
+	http_server_get_header_uint(req, "bench-bandwidth", 10, &config.bandwidth_kbps);
+
+	if ((strcmp(proto, "tcp") != 0 && strcmp(proto, "udp") != 0)
+			|| (strcmp(role, "server") != 0 && strcmp(role, "client") != 0) || port > 65535)
+	{
+		return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Expected bench-proto tcp|udp, bench-role server|client");
+	}
+
+	config.udp = (strcmp(proto, "udp") == 0);
+	config.role = (strcmp(role, "client") == 0) ? NET_BENCH_CLIENT : NET_BENCH_SERVER;
+	config.port = port;
+	if (httpd_req_get_hdr_value_str(req, "bench-netif", netif, sizeof(netif)) == ESP_OK)
+	{
+		config.netif = netif;
+	}
+	if (httpd_req_get_hdr_value_str(req, "bench-host", host, sizeof(host)) == ESP_OK)
+	{
+		config.host = host;
+	}
+
+	esp_err_t err = net_bench_start(&config);
+	if (err == ESP_ERR_INVALID_STATE)
+	{
+		httpd_resp_set_status(req, "409 Conflict");
+		return httpd_resp_sendstr(req, "Benchmark running or interface down");
+	}
+	if (err != ESP_OK)
+	{
+		return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, esp_err_to_name(err));
+	}
+
+	httpd_resp_set_status(req, "202 Accepted");
+	return httpd_resp_sendstr(req, "Benchmark started");
+}
+
+/**
+ * Finds the interface a request came in on from the local address of its socket.
+ * @param req HTTP request.
+ * @param netif receives "eth", "sta", "ap" or "" (4 bytes).
+ */
+static void http_server_bench_netif(httpd_req_t *req, char *netif)
+{
+	static const struct { const char *name; esp_netif_t **netif; } netifs[] = {
+			{ "eth", &esp_netif_eth },
+			{ "sta", &esp_netif_sta },
+			{ "ap", &esp_netif_ap },
+	};
+	struct sockaddr_storage addr;
+	socklen_t addr_len = sizeof(addr);
+	uint32_t ip = 0;
+
+	netif[0] = '\0';
+
+	if (getsockname(httpd_req_to_sockfd(req), (struct sockaddr*)&addr, &addr_len) != 0)
+	{
+		return;
+	}
+	if (addr.ss_family == AF_INET)
+	{
+		ip = ((struct sockaddr_in*)&addr)->sin_addr.s_addr;
+	}
+#if CONFIG_LWIP_IPV6
+	else if (addr.ss_family == AF_INET6)
+	{
+		// IPv4-mapped address of a dual-stack socket
+		memcpy(&ip, &((struct sockaddr_in6*)&addr)->sin6_addr.s6_addr[12], sizeof(ip));
+	}
+#endif
 
-//				case HTTP_MSG_OTA_UPDATE_INITIALIZED:
-//					ESP_LOGI(TAG, "HTTP_MSG_OTA_UPDATE_INITIALIZED");
-//
-//					break;
+	for (int i = 0; i < sizeof(netifs) / sizeof(netifs[0]); i++)
+	{
+		esp_netif_ip_info_t ip_info;
 
-				default:
-					break;
-			}
+		if (*netifs[i].netif != NULL && esp_netif_get_ip_info(*netifs[i].netif, &ip_info) == ESP_OK
+				&& ip_info.ip.addr == ip)
+		{
+			strcpy(netif, netifs[i].name);
+			return;
 		}
 	}
 }
 
 /**
- * Jquery get handler is requested when accessing the web page.
- * @param req HTTP request for which the uri needs to be handled.
- * @return ESP_OK
+ * Completes the timing of a bench request.
+ * @param stats timing, bytes, first_byte_us and blocked_us set.
+ * @param start_us time of the handler call.
  */
-static esp_err_t http_server_jquery_handler(httpd_req_t *req)
+static void http_server_bench_finish(http_server_bench_stats_t *stats, int64_t start_us)
 {
-	ESP_LOGI(TAG, "Jquery requested");
-
-	httpd_resp_set_type(req, "application/javascript");
-	httpd_resp_send(req, (const char *)jquery_3_3_1_min_js_start, jquery_3_3_1_min_js_end - jquery_3_3_1_min_js_start);
+	stats->elapsed_us = esp_timer_get_time() - start_us;
+	stats->bytes_per_s = (stats->elapsed_us > 0) ? (uint64_t)stats->bytes * 1000000 / stats->elapsed_us : 0;
+}
 
-	return ESP_OK;
+/**
+ * Writes the timing of a bench request.
+ * @param w JSON writer.
+ * @param key member name, NULL for a value.
+ * @param stats timing.
+ */
+static void http_server_write_bench_stats(json_writer_t *w, const char *key, const http_server_bench_stats_t *stats)
+{
+	json_writer_begin_object(w, key);
+	json_writer_string(w, "netif", stats->netif);
+	json_writer_uint(w, "bytes", stats->bytes);
+	json_writer_uint(w, "first_byte_us", stats->first_byte_us);
+	json_writer_uint(w, "elapsed_us", stats->elapsed_us);
+	json_writer_uint(w, "blocked_us", stats->blocked_us);
+	json_writer_uint(w, "bytes_per_s", stats->bytes_per_s);
+	json_writer_end_object(w);
 }
 
 /**
- * Sends the index.html page
+ * Download benchmark (GET /bench/download?size=N): streams N generated bytes (HTTP_BENCH_DEFAULT_SIZE
+ * without size) from one HTTP_BENCH_CHUNK_SIZE buffer. The server-side timing is reported by /bench/stats.json.
  * @param req HTTP request for which the uri needs to be handled.
- * @return ESP_OK
+ * @return ESP_OK, ESP_FAIL if the client went away.
  */
-static esp_err_t http_server_index_html_handler(httpd_req_t *req)
+esp_err_t http_server_bench_download_handler(httpd_req_t *req)
 {
-	ESP_LOGI(TAG, "index.html requested");
+	int64_t start_us = esp_timer_get_time();
+	http_server_bench_stats_t stats = {0};
+	uint32_t size = HTTP_BENCH_DEFAULT_SIZE;
+	char query[32];
+	char value[16];
+	esp_err_t err = ESP_OK;
+
+	if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK
+			&& httpd_query_key_value(query, "size", value, sizeof(value)) == ESP_OK)
+	{
+		char *end;
+		size = strtoul(value, &end, 10);
+		if (*end != '\0' || size > HTTP_BENCH_MAX_SIZE)
+		{
+			return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Expected size in bytes, at most 1 GB");
+		}
+	}
 
-	httpd_resp_set_type(req, "text/html");
-	httpd_resp_send(req, (const char *)index_html_start, index_html_end - index_html_start);
+	char *chunk = malloc(HTTP_BENCH_CHUNK_SIZE);
+	if (chunk == NULL)
+	{
+		return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, NULL);
+	}
+	for (int i = 0; i < HTTP_BENCH_CHUNK_SIZE; i++)
+	{
+		chunk[i] = 'a' + i % 26;
+	}
 
-	return ESP_OK;
+	http_server_bench_netif(req, stats.netif);
+	httpd_resp_set_type(req, "application/octet-stream");
+	httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+
+	while (stats.bytes < size)
+	{
+		size_t len = MIN(HTTP_BENCH_CHUNK_SIZE, size - stats.bytes);
+		int64_t send_us = esp_timer_get_time();
+
+		err = httpd_resp_send_chunk(req, chunk, len);
+		stats.blocked_us += esp_timer_get_time() - send_us;
+		if (err != ESP_OK)
+		{
+			break;
+		}
+		if (stats.bytes == 0)
+		{
+			stats.first_byte_us = esp_timer_get_time() - start_us;
+		}
+		stats.bytes += len;
+	}
+	free(chunk);
+
+	if (err == ESP_OK)
+	{
+		err = httpd_resp_send_chunk(req, NULL, 0);
+	}
+
+	http_server_bench_finish(&stats, start_us);
+	g_bench_download = stats;
+
+	ESP_LOGI(TAG, "http_server_bench_download_handler: %lu bytes via %s in %lu us, %lu us blocked, %lu bytes/s",
+			stats.bytes, stats.netif[0] ? stats.netif : "?", stats.elapsed_us, stats.blocked_us, stats.bytes_per_s);
+
+	return err;
 }
 
 /**
- * app.css get handler is requested when accessing the web page.
+ * Upload benchmark (POST /bench/upload): reads and drops the body in HTTP_BENCH_CHUNK_SIZE pieces,
+ * responds with the server-side timing.
  * @param req HTTP request for which the uri needs to be handled.
- * @return ESP_OK
+ * @return ESP_OK, ESP_FAIL if the client went away.
  */
-static esp_err_t http_server_app_css_handler(httpd_req_t *req)
+esp_err_t http_server_bench_upload_handler(httpd_req_t *req)
 {
-	ESP_LOGI(TAG, "app.js requested");
+	int64_t start_us = esp_timer_get_time();
+	http_server_bench_stats_t stats = {0};
+	char benchJSON[192];
+	json_writer_t w;
+
+	char *chunk = malloc(HTTP_BENCH_CHUNK_SIZE);
+	if (chunk == NULL)
+	{
+		return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, NULL);
+	}
 
-	httpd_resp_set_type(req, "text/css");
-	httpd_resp_send(req, (const char *)app_css_start, app_css_end - app_css_start);
+	http_server_bench_netif(req, stats.netif);
 
-	return ESP_OK;
+	while (stats.bytes < req->content_len)
+	{
+		int64_t recv_us = esp_timer_get_time();
+		int recv_len = httpd_req_recv(req, chunk, MIN(HTTP_BENCH_CHUNK_SIZE, req->content_len - stats.bytes));
+		stats.blocked_us += esp_timer_get_time() - recv_us;
+
+		if (recv_len == HTTPD_SOCK_ERR_TIMEOUT)
+		{
+			continue;
+		}
+		if (recv_len <= 0)
+		{
+			ESP_LOGI(TAG, "http_server_bench_upload_handler: receive error %d after %lu bytes", recv_len, stats.bytes);
+			free(chunk);
+			return ESP_FAIL;
+		}
+		if (stats.bytes == 0)
+		{
+			stats.first_byte_us = esp_timer_get_time() - start_us;
+		}
+		stats.bytes += recv_len;
+	}
+	free(chunk);
+
+	http_server_bench_finish(&stats, start_us);
+	g_bench_upload = stats;
+
+	ESP_LOGI(TAG, "http_server_bench_upload_handler: %lu bytes via %s in %lu us, %lu us blocked, %lu bytes/s",
+			stats.bytes, stats.netif[0] ? stats.netif : "?", stats.elapsed_us, stats.blocked_us, stats.bytes_per_s);
+
+	json_writer_init(&w, benchJSON, sizeof(benchJSON), NULL, NULL);
+	http_server_write_bench_stats(&w, NULL, &stats);
+
+	return http_server_send_json(req, &w);
 }
 
 /**
- * app.js get handler is requested when accessing the web page.
+ * bench/stats.json handler responds with the server-side timing of the last download and upload.
  * @param req HTTP request for which the uri needs to be handled.
  * @return ESP_OK
  */
-static esp_err_t http_server_app_js_handler(httpd_req_t *req)
+esp_err_t http_server_bench_stats_json_handler(httpd_req_t *req)
 {
-	ESP_LOGI(TAG, "app.js requested");
+	char benchJSON[384];
+	json_writer_t w;
 
-	httpd_resp_set_type(req, "application/javascript");
-	httpd_resp_send(req, (const char *)app_js_start, app_js_end - app_js_start);
+	json_writer_init(&w, benchJSON, sizeof(benchJSON), NULL, NULL);
+	json_writer_begin_object(&w, NULL);
+	http_server_write_bench_stats(&w, "download", &g_bench_download);
+	http_server_write_bench_stats(&w, "upload", &g_bench_upload);
+	json_writer_end_object(&w);
 
-	return ESP_OK;
+	return http_server_send_json(req, &w);
 }
 
 /**
- * Receive the .bin file via the web page and handles the firmware update
+ * Starts a pull update (POST /OTApull): the device fetches the image itself, see ota_pull_start.
+ * Header: ota-manifest-url, the http:// or https:// URL of the manifest.
+ * Progress is reported by OTAstatus, the result like an upload.
  * @param req HTTP request for which the uri needs to be handled.
  * @return ESP_OK
  */
-static esp_err_t http_server_favicon_ico_handler(httpd_req_t *req)
+esp_err_t http_server_OTA_pull_handler(httpd_req_t *req)
 {
-	ESP_LOGI(TAG, "favicon.ico requested");
+	char url[OTA_PULL_URL_LEN];
 
-	httpd_resp_set_type(req, "image/x-icon");
-	httpd_resp_send(req, (const char *)favicon_ico_start, favicon_ico_end - favicon_ico_start);
+	if (httpd_req_get_hdr_value_str(req, "ota-manifest-url", url, sizeof(url)) != ESP_OK)
+	{
+		return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Expected ota-manifest-url");
+	}
 
-	return ESP_OK;
+	esp_err_t err = ota_pull_start(url);
+	if (err == ESP_ERR_INVALID_STATE)
+	{
+		httpd_resp_set_status(req, "409 Conflict");
+		return httpd_resp_sendstr(req, "Pull update already running");
+	}
+	if (err != ESP_OK)
+	{
+		return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, esp_err_to_name(err));
+	}
+
+	ESP_LOGI(TAG, "http_server_OTA_pull_handler: pulling %s", url);
+	httpd_resp_set_status(req, "202 Accepted");
+	return httpd_resp_sendstr(req, "Pull update started");
 }
 
 /**
- * Sends the .ico (icon) file when accessing the web page.
+ * Starts or resumes a resumable OTA session (POST /OTAsession).
+ * Headers: ota-image-size in bytes, optional ota-image-sha256 as 64 hex digits.
+ * A session for the same image is resumed, the response tells the offset to continue at.
  * @param req HTTP request for which the uri needs to be handled.
- * @return ESP_OK, otherwise ESP_FAIL if timeout occurs and the update cannot be started
+ * @return ESP_OK
  */
-esp_err_t http_server_OTA_update_handler(httpd_req_t *req)
+esp_err_t http_server_OTA_session_begin_handler(httpd_req_t *req)
 {
-	esp_ota_handle_t ota_handle;
-
-	char ota_buff[1024];
-	int content_length = req->content_len;
-	int content_received = 0;
-	int recv_len;
-	bool is_req_body_started = false;
-	bool flash_successful = false;
+	char sha256_str[65];
+	uint8_t sha256[32];
+	bool has_sha256 = false;
+	uint32_t image_size;
+	ota_session_t session;
 
-	const esp_partition_t *update_partition = esp_ota_get_next_update_partition(NULL);
+	if (!http_server_get_header_uint(req, "ota-image-size", 10, &image_size))
+	{
+		return http_server_OTA_session_send(req, ESP_ERR_INVALID_ARG);
+	}
 
-	do
+	if (httpd_req_get_hdr_value_str(req, "ota-image-sha256", sha256_str, sizeof(sha256_str)) == ESP_OK)
 	{
-		// Read the data for the request
-		if ((recv_len = httpd_req_recv(req, ota_buff, MIN(content_length, sizeof(ota_buff)))) < 0)
-				{
-					// Check if timeout occurred
-					if (recv_len == HTTPD_SOCK_ERR_TIMEOUT)
-			{
-				ESP_LOGI(TAG, "http_server_OTA_update_handler: Socket Timeout");
-				continue; ////> Retry receiving if timeout occurred
-			}
-			ESP_LOGI(TAG, "http_server_OTA_update_handler: OTA other Error %d", recv_len);
+		if (strlen(sha256_str) != 64)
+		{
+			return http_server_OTA_session_send(req, ESP_ERR_INVALID_ARG);
 		}
-		printf("http_server_OTA_update_handler: OTA RX: %d of %d\r", content_received, content_length);
-
-		// Is this the first data we are receiving
-		// If so, it will have the information in the header that we need.
-		if (!is_req_body_started)
+		for (int i = 0; i < 32; i++)
 		{
-			is_req_body_started = true;
-
-			// Get the location of the .bin file content (remove the web form data)
-			char *body_start_p = strstr(ota_buff, "\r\n\r\n") + 4;
-			int body_part_len = recv_len - (body_start_p - ota_buff);
+			char byte_str[3] = { sha256_str[2 * i], sha256_str[2 * i + 1], '\0' };
+			char *end;
 
-			printf("http_server_OTA_update_handler: OTA file size: %d\r\n", content_length);
-
-			esp_err_t err = esp_ota_begin(update_partition, OTA_SIZE_UNKNOWN, &ota_handle);
-			if (err != ESP_OK)
+			sha256[i] = strtoul(byte_str, &end, 16);
+			if (*end != '\0')
 			{
-				printf("http_server_OTA_update_handler: Error with OTA begin, cancelling OTA\r\n");
-				return ESP_FAIL;
+				return http_server_OTA_session_send(req, ESP_ERR_INVALID_ARG);
 			}
-			else
-			{
-				printf("http_server_OTA_update_handler: Writing to partition subtype %d at offset 0x%lx\r\n", update_partition->subtype, update_partition->address);
+		}
+		has_sha256 = true;
+	}
 
-			}
+	return http_server_OTA_session_send(req, ota_session_begin(image_size, has_sha256 ? sha256 : NULL, &session));
+}
 
-			// Write this first part of the data
-			esp_ota_write(ota_handle, body_start_p, body_part_len);
-			content_received += body_part_len;
-		}
-		else
-		{
-			//Write OTA data
-			esp_ota_write(ota_handle, ota_buff, recv_len);
-			content_received += recv_len;
-		}
-	} while (recv_len > 0 && content_received < content_length);
+/**
+ * Receives one chunk of a resumable OTA session (PUT /OTAsession).
+ * Headers: ota-chunk-offset in bytes, ota-chunk-crc as CRC-32 (zlib) in hex.
+ * Responds 409 with the session offset if the chunk is not the next one.
+ * @param req HTTP request for which the uri needs to be handled.
+ * @return ESP_OK, otherwise ESP_FAIL if the connection failed
+ */
+esp_err_t http_server_OTA_session_chunk_handler(httpd_req_t *req)
+{
+	ota_session_t session;
+	uint32_t offset;
+	uint32_t crc;
+	size_t received = 0;
+	esp_err_t err;
+
+	if (!http_server_get_header_uint(req, "ota-chunk-offset", 10, &offset)
+			|| !http_server_get_header_uint(req, "ota-chunk-crc", 16, &crc))
+	{
+		return http_server_OTA_session_send(req, ESP_ERR_INVALID_ARG);
+	}
+
+	// Checked before the body is read, a client out of step learns the offset right away
+	if ((err = ota_session_get(&session)) != ESP_OK)
+	{
+		return http_server_OTA_session_send(req, err);
+	}
+	if (offset != session.offset)
+	{
+		return http_server_OTA_session_send(req, ESP_ERR_INVALID_STATE);
+	}
+	if (req->content_len == 0 || req->content_len > session.chunk_size)
+	{
+		return http_server_OTA_session_send(req, ESP_ERR_INVALID_SIZE);
+	}
+
+	char *chunk = malloc(req->content_len);
+	if (chunk == NULL)
+	{
+		return http_server_OTA_session_send(req, ESP_ERR_NO_MEM);
+	}
 
-	if (esp_ota_end(ota_handle) ==  ESP_OK)
+	while (received < req->content_len)
 	{
-		if (esp_ota_set_boot_partition(update_partition) == ESP_OK)
+		int recv_len = httpd_req_recv(req, chunk + received, req->content_len - received);
+		if (recv_len == HTTPD_SOCK_ERR_TIMEOUT)
 		{
-			const esp_partition_t *boot_partition = esp_ota_get_boot_partition();
-			ESP_LOGI(TAG, "http_server_OTA_update_handler: Next boot partition subtype %d at offset 0x%lx", boot_partition->subtype, boot_partition->address);
-			flash_successful = true;
+			continue;
 		}
-		else
+		if (recv_len <= 0)
 		{
-			ESP_LOGI(TAG, "http_server_OTA_update_handler: FLASHED ERROR!!!");
+			// The session offset is unchanged, the client sends the chunk again
+			ESP_LOGI(TAG, "http_server_OTA_session_chunk_handler: Receive error %d at %lu", recv_len, offset + received);
+			free(chunk);
+			return ESP_FAIL;
 		}
-	}
-	else
-	{
-		ESP_LOGI(TAG, "http_server_OTA_update_handler: esp_ota_end ERROR!!!");
+		received += recv_len;
 	}
 
-	// We won't update the global variables throughout the file, so send the message about the status
-	if (flash_successful){ http_server_monitor_send_message(HTTP_MSG_OTA_UPDATE_SUCCESSFUL); } else { http_server_monitor_send_message(HTTP_MSG_OTA_UPDATE_FAILED); }
+	err = ota_session_write(offset, chunk, received, crc);
+	free(chunk);
 
-	return ESP_OK;
+	return http_server_OTA_session_send(req, err);
 }
 
 /**
- * OTA status handler responds with the firmware update status after the OTA update is started
- * and responds with the compile time/date when the page is first requested
- * @param req HTTP request for which the url needs to be handled
+ * Responds with the resumable OTA session (GET /OTAsession).
+ * @param req HTTP request for which the uri needs to be handled.
  * @return ESP_OK
  */
-esp_err_t http_server_OTA_status_handler(httpd_req_t *req)
+esp_err_t http_server_OTA_session_status_handler(httpd_req_t *req)
 {
-	char otaJSON[100];
+	return http_server_OTA_session_send(req, ESP_OK);
+}
 
-	ESP_LOGI(TAG, "OTAstatus requested");
+/**
+ * Ends the resumable OTA session without an update (DELETE /OTAsession).
+ * @param req HTTP request for which the uri needs to be handled.
+ * @return ESP_OK
+ */
+esp_err_t http_server_OTA_session_abort_handler(httpd_req_t *req)
+{
+	return http_server_OTA_session_send(req, ota_session_abort());
+}
+
+/**
+ * Verifies the image of a complete resumable OTA session and boots it (POST /OTAsession/finalize),
+ * the device restarts like after /OTAupdate.
+ * @param req HTTP request for which the uri needs to be handled.
+ * @return ESP_OK
+ */
+esp_err_t http_server_OTA_session_finalize_handler(httpd_req_t *req)
+{
+	esp_err_t err = ota_session_finalize();
 
-	sprintf(otaJSON, "{\"ota_update_status\":%d,\"compile_time\":\"%s\",\"compile_date\":\"%s\"}", g_fw_update_status, __TIME__, __DATE__);
+	ESP_LOGI(TAG, "http_server_OTA_session_finalize_handler: %s", esp_err_to_name(err));
 
-	httpd_resp_set_type(req, "application/json");
-	httpd_resp_send(req, otaJSON, strlen(otaJSON));
+	// A failed check keeps the session, only missing chunks can be sent again
+	if (err == ESP_OK)
+	{
+		http_server_monitor_send_message(HTTP_MSG_OTA_UPDATE_SUCCESSFUL);
+	}
+	else if (err != ESP_ERR_NOT_FOUND && err != ESP_ERR_INVALID_STATE)
+	{
+		http_server_monitor_send_message(HTTP_MSG_OTA_UPDATE_FAILED);
+	}
+
+	return http_server_OTA_session_send(req, err);
+}
+
+/**
+ * Updates the station configuration and asks the WiFi application to connect.
+ * Shared by the wifiConnect.json handler and the WebSocket wifiConnect command.
+ * @param ssid SSID of the access point.
+ * @param pass password of the access point.
+ * @return ESP_OK, or ESP_ERR_INVALID_ARG if the credentials are empty or too long
+ */
+static esp_err_t http_server_request_wifi_connect(const char *ssid, const char *pass)
+{
+	size_t len_ssid = strlen(ssid);
+	size_t len_pass = strlen(pass);
+
+	if (len_ssid == 0 || len_ssid > MAX_SSID_LEN || len_pass > MAX_PASS_LEN)
+	{
+		ESP_LOGE(TAG, "http_server_request_wifi_connect: invalid SSID or password length");
+		return ESP_ERR_INVALID_ARG;
+	}
+
+	wifi_config_t* wifi_config = wifi_app_get_wifi_config();
+	memset(wifi_config, 0x00, sizeof(wifi_config_t));
+	memcpy(wifi_config->sta.ssid, ssid, len_ssid);
+	memcpy(wifi_config->sta.password, pass, len_pass);
+	wifi_app_send_message(WIFI_APP_MSG_CONNECTING_FROM_HTTP_SERVER);
 
 	return ESP_OK;
 }
@@ -421,11 +2228,7 @@ static esp_err_t http_server_wifi_connect_json_handler(httpd_req_t *req)
 	    }
 
 	// Update the WiFi networks configuration and let the WiFi application know
-	wifi_config_t* wifi_config = wifi_app_get_wifi_config();
-	memset(wifi_config, 0x00, sizeof(wifi_config_t));
-	memcpy(wifi_config->sta.ssid, ssid_str, len_ssid);
-	memcpy(wifi_config->sta.password, pass_str, len_pass);
-	wifi_app_send_message(WIFI_APP_MSG_CONNECTING_FROM_HTTP_SERVER);
+	http_server_request_wifi_connect(ssid_str, pass_str);
 
 	free(ssid_str);
 	free(pass_str);
@@ -443,14 +2246,18 @@ static esp_err_t http_server_wifi_connect_status_json_handler(httpd_req_t *req)
 {
 	ESP_LOGI(TAG, "/wifiConnectStatus requested");
 
-	char statusJSON[100];
+	char statusJSON[32];
+	device_state_t state;
+	json_writer_t w;
 
-	sprintf(statusJSON, "{\"wifi_connect_status\":%d}", g_wifi_connect_status);
+	device_state_get(&state);
 
-	httpd_resp_set_type(req, "application/json");
-	httpd_resp_send(req, statusJSON, strlen(statusJSON));
+	json_writer_init(&w, statusJSON, sizeof(statusJSON), NULL, NULL);
+	json_writer_begin_object(&w, NULL);
+	json_writer_int(&w, "wifi_connect_status", state.wifi_connect_status);
+	json_writer_end_object(&w);
 
-	return ESP_OK;
+	return http_server_send_json(req, &w);
 }
 
 /**
@@ -462,32 +2269,21 @@ static esp_err_t http_server_get_wifi_connect_info_json_handler(httpd_req_t *req
 {
 	ESP_LOGI(TAG, "/wifiConnectInfo.json requested");
 
-	char ipInfoJSON[200];
-	memset(ipInfoJSON, 0, sizeof(ipInfoJSON));
+	// Room for an SSID of 32 escaped bytes
+	char ipInfoJSON[320];
+	device_state_t state;
+	json_writer_t w;
 
-	char ip[IP4ADDR_STRLEN_MAX];
-	char netmask[IP4ADDR_STRLEN_MAX];
-	char gw[IP4ADDR_STRLEN_MAX];
+	device_state_get(&state);
 
-	if (g_wifi_connect_status == HTTP_WIFI_STATUS_CONNECT_SUCCESS)
+	// Empty response while not connected
+	json_writer_init(&w, ipInfoJSON, sizeof(ipInfoJSON), NULL, NULL);
+	if (state.wifi_connect_status == HTTP_WIFI_STATUS_CONNECT_SUCCESS)
 	{
-		wifi_ap_record_t wifi_data;
-		ESP_ERROR_CHECK(esp_wifi_sta_get_ap_info(&wifi_data));
-		char *ssid = (char*)wifi_data.ssid;
-
-		esp_netif_ip_info_t ip_info;
-		ESP_ERROR_CHECK(esp_netif_get_ip_info(esp_netif_sta, &ip_info));
-		esp_ip4addr_ntoa(&ip_info.ip, ip, IP4ADDR_STRLEN_MAX);
-		esp_ip4addr_ntoa(&ip_info.netmask, netmask, IP4ADDR_STRLEN_MAX);
-		esp_ip4addr_ntoa(&ip_info.gw, gw, IP4ADDR_STRLEN_MAX);
-
-		sprintf(ipInfoJSON, "{\"ip\":\"%s\",\"netmask\":\"%s\",\"gw\":\"%s\",\"ap\":\"%s\"}", ip, netmask, gw, ssid);
+		http_server_write_wifi_info(&w, NULL, &state);
 	}
 
-	httpd_resp_set_type(req, "application/json");
-	httpd_resp_send(req, ipInfoJSON, strlen(ipInfoJSON));
-
-	return ESP_OK;
+	return http_server_send_json(req, &w);
 }
 
 /**
@@ -513,17 +2309,21 @@ static esp_err_t http_server_get_local_time_json_handler(httpd_req_t *req)
 {
 	ESP_LOGI(TAG, "/localTime.json requested");
 
-	char localTimeJSON[100] = {0};
+	char localTimeJSON[100];
+	device_state_t state;
+	json_writer_t w;
+
+	device_state_get(&state);
 
-	if (g_is_local_time_set)
+	json_writer_init(&w, localTimeJSON, sizeof(localTimeJSON), NULL, NULL);
+	if (state.local_time_set)
 	{
-		sprintf(localTimeJSON, "{\"time\":\"%s\"}", sntp_time_sync_get_time());
+		json_writer_begin_object(&w, NULL);
+		json_writer_string(&w, "time", sntp_time_sync_get_time());
+		json_writer_end_object(&w);
 	}
 
-	httpd_resp_set_type(req, "application/json");
-	httpd_resp_send(req, localTimeJSON, strlen(localTimeJSON));
-
-	return ESP_OK;
+	return http_server_send_json(req, &w);
 }
 
 /**
@@ -535,18 +2335,74 @@ static esp_err_t http_server_get_ap_ssid_json_handler(httpd_req_t* req)
 {
 	ESP_LOGI(TAG, "/apSSID.json requested");
 
-	char ssidJSON[50];
+	// Room for an SSID of 32 escaped bytes
+	char ssidJSON[128];
+	json_writer_t w;
 
-	wifi_config_t *wifi_config = wifi_app_get_wifi_config();
-	esp_wifi_get_config(ESP_IF_WIFI_AP, wifi_config);
-	char *ssid = (char*)wifi_config->ap.ssid;
+	json_writer_init(&w, ssidJSON, sizeof(ssidJSON), NULL, NULL);
+	json_writer_begin_object(&w, NULL);
+	http_server_write_ap_ssid(&w, "ssid");
+	json_writer_end_object(&w);
 
-	sprintf(ssidJSON, "{\"ssid\":\"%s\"}", ssid);
+	return http_server_send_json(req, &w);
+}
 
-	httpd_resp_set_type(req, "application/json");
-	httpd_resp_send(req, ssidJSON, strlen(ssidJSON));
+/**
+ * Stores a new Ethernet IP configuration and applies it.
+ * Shared by the ethConnect.json handler and the WebSocket ethConnect command.
+ * @param dhcp_enabled true for DHCP, the static addresses are ignored then.
+ * @param ip static IP address.
+ * @param netmask static subnet mask.
+ * @param gateway static gateway.
+ * @param dns static DNS server.
+ * @return ESP_OK, otherwise the error from ethernet_app_set_ip_config
+ */
+static esp_err_t http_server_request_eth_connect(bool dhcp_enabled, const char *ip, const char *netmask, const char *gateway, const char *dns)
+{
+    // Prepare and update Ethernet configuration
+    eth_ip_config_t eth_config;
+    memset(&eth_config, 0, sizeof(eth_ip_config_t));
+    
+    // Set DHCP flag
+    eth_config.dhcp_enabled = dhcp_enabled;
+    
+    // If static mode, set the IP configuration
+    if (!dhcp_enabled)
+    {
+        strncpy(eth_config.ip, ip, sizeof(eth_config.ip) - 1);
+        strncpy(eth_config.netmask, netmask, sizeof(eth_config.netmask) - 1);
+        strncpy(eth_config.gateway, gateway, sizeof(eth_config.gateway) - 1);
+        strncpy(eth_config.dns, dns, sizeof(eth_config.dns) - 1);
+    }
+    else
+    {
+        // For DHCP, use default values (will be overwritten by DHCP)
+        strncpy(eth_config.ip, ETH_DEFAULT_IP, sizeof(eth_config.ip) - 1);
+        strncpy(eth_config.netmask, ETH_DEFAULT_NETMASK, sizeof(eth_config.netmask) - 1);
+        strncpy(eth_config.gateway, ETH_DEFAULT_GATEWAY, sizeof(eth_config.gateway) - 1);
+        strncpy(eth_config.dns, ETH_DEFAULT_DNS, sizeof(eth_config.dns) - 1);
+    }
+    
+    // Update Ethernet configuration
+    esp_err_t ret = ethernet_app_set_ip_config(&eth_config);
+    if (ret != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Failed to update Ethernet configuration: %s", esp_err_to_name(ret));
+        return ret;
+    }
 
-	return ESP_OK;
+    // Notify user that configuration was successful
+    http_server_monitor_send_message(HTTP_MSG_ETH_CONNECT_INIT);
+
+    // Apply configuration
+    ret = ethernet_app_apply_ip_config();
+    if (ret != ESP_OK)
+    {
+        ESP_LOGW(TAG, "Failed to apply Ethernet configuration immediately: %s", esp_err_to_name(ret));
+        // Not returning error as configuration will be applied on next connection
+    }
+
+    return ESP_OK;
 }
 
 /**
@@ -641,50 +2497,13 @@ static esp_err_t http_server_eth_connect_json_handler(httpd_req_t *req)
             httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid static IP configuration");
             return ESP_FAIL;
         }
-    }
-
-    // Prepare and update Ethernet configuration
-    eth_ip_config_t eth_config;
-    memset(&eth_config, 0, sizeof(eth_ip_config_t));
-    
-    // Set DHCP flag
-    eth_config.dhcp_enabled = dhcp_enabled;
-    
-    // If static mode, set the IP configuration
-    if (!dhcp_enabled)
-    {
-        strncpy(eth_config.ip, static_ip_str, sizeof(eth_config.ip) - 1);
-        strncpy(eth_config.netmask, static_subnet_str, sizeof(eth_config.netmask) - 1);
-        strncpy(eth_config.gateway, static_gateway_str, sizeof(eth_config.gateway) - 1);
-        strncpy(eth_config.dns, static_dns_str, sizeof(eth_config.dns) - 1);
-    }
-    else
-    {
-        // For DHCP, use default values (will be overwritten by DHCP)
-        strncpy(eth_config.ip, ETH_DEFAULT_IP, sizeof(eth_config.ip) - 1);
-        strncpy(eth_config.netmask, ETH_DEFAULT_NETMASK, sizeof(eth_config.netmask) - 1);
-        strncpy(eth_config.gateway, ETH_DEFAULT_GATEWAY, sizeof(eth_config.gateway) - 1);
-        strncpy(eth_config.dns, ETH_DEFAULT_DNS, sizeof(eth_config.dns) - 1);
-    }
-    
-    // Update Ethernet configuration
-    esp_err_t ret = ethernet_app_set_ip_config(&eth_config);
-    if (ret != ESP_OK)
-    {
-        ESP_LOGE(TAG, "Failed to update Ethernet configuration: %s", esp_err_to_name(ret));
-        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to update Ethernet configuration");
-        return ESP_FAIL;
-    }
-
-    // Notify user that configuration was successful
-    http_server_monitor_send_message(HTTP_MSG_ETH_CONNECT_INIT);
+    }
 
-    // Apply configuration
-    ret = ethernet_app_apply_ip_config();
+    esp_err_t ret = http_server_request_eth_connect(dhcp_enabled, static_ip_str, static_subnet_str, static_gateway_str, static_dns_str);
     if (ret != ESP_OK)
     {
-        ESP_LOGW(TAG, "Failed to apply Ethernet configuration immediately: %s", esp_err_to_name(ret));
-        // Not returning error as configuration will be applied on next connection
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to update Ethernet configuration");
+        return ESP_FAIL;
     }
 
     return ESP_OK;
@@ -699,14 +2518,18 @@ static esp_err_t http_server_eth_connect_status_json_handler(httpd_req_t *req)
 {
     ESP_LOGI(TAG, "/ethConnectStatus requested");
 
-    char statusJSON[100];
+    char statusJSON[32];
+    device_state_t state;
+    json_writer_t w;
 
-    sprintf(statusJSON, "{\"eth_connect_status\":%d}", g_eth_connect_status);
+    device_state_get(&state);
 
-    httpd_resp_set_type(req, "application/json");
-    httpd_resp_send(req, statusJSON, strlen(statusJSON));
+    json_writer_init(&w, statusJSON, sizeof(statusJSON), NULL, NULL);
+    json_writer_begin_object(&w, NULL);
+    json_writer_int(&w, "eth_connect_status", state.eth_connect_status);
+    json_writer_end_object(&w);
 
-    return ESP_OK;
+    return http_server_send_json(req, &w);
 }
 
 /**
@@ -718,45 +2541,33 @@ static esp_err_t http_server_get_eth_connect_info_json_handler(httpd_req_t *req)
 {
     ESP_LOGI(TAG, "/ethConnectInfo.json requested");
 
-    char ipInfoJSON[300];
-    memset(ipInfoJSON, 0, sizeof(ipInfoJSON));
+    char ipInfoJSON[256];
+    device_state_t state;
+    json_writer_t w;
 
-    if (g_eth_connect_status == HTTP_ETH_STATUS_CONNECT_SUCCESS)
+    device_state_get(&state);
+
+    // Empty response while not connected
+    json_writer_init(&w, ipInfoJSON, sizeof(ipInfoJSON), NULL, NULL);
+    if (state.eth_connect_status == HTTP_ETH_STATUS_CONNECT_SUCCESS)
     {
-        eth_ip_config_t eth_config;
-        esp_err_t ret = ethernet_app_get_ip_config(&eth_config);
-        
-        // Get MAC address
-        uint8_t mac_addr[6];
-        char mac_str[18];
-        esp_eth_handle_t eth_handle = ethernet_app_get_eth_handle();
-        if (eth_handle != NULL)
-        {
-            esp_eth_ioctl(eth_handle, ETH_CMD_G_MAC_ADDR, mac_addr);
-            sprintf(mac_str, "%02x:%02x:%02x:%02x:%02x:%02x", 
-                    mac_addr[0], mac_addr[1], mac_addr[2], mac_addr[3], mac_addr[4], mac_addr[5]);
-        }
-        else
-        {
-            strcpy(mac_str, "00:00:00:00:00:00");
-        }
-        
-        if (ret == ESP_OK)
-        {
-            sprintf(ipInfoJSON, 
-                "{\"ip\":\"%s\",\"netmask\":\"%s\",\"gw\":\"%s\",\"mac\":\"%s\",\"mode\":\"%s\"}",
-                eth_config.ip, 
-                eth_config.netmask, 
-                eth_config.gateway, 
-                mac_str,
-                eth_config.dhcp_enabled ? "DHCP" : "Static");
-        }
+        http_server_write_eth_info(&w, NULL, &state);
     }
 
-    httpd_resp_set_type(req, "application/json");
-    httpd_resp_send(req, ipInfoJSON, strlen(ipInfoJSON));
+    return http_server_send_json(req, &w);
+}
 
-    return ESP_OK;
+/**
+ * Stops the Ethernet interface.
+ * Shared by the ethDisconnect.json handler and the WebSocket ethDisconnect command.
+ */
+static void http_server_request_eth_disconnect(void)
+{
+    // Send stop message to Ethernet task
+    ethernet_app_send_message(ETHERNET_APP_MSG_ETH_STOP, NULL);
+
+    // Update status
+    http_server_monitor_send_message(HTTP_MSG_ETH_USER_DISCONNECT);
 }
 
 /**
@@ -768,11 +2579,7 @@ static esp_err_t http_server_eth_disconnect_json_handler(httpd_req_t *req)
 {
     ESP_LOGI(TAG, "ethDisconnect.json requested");
 
-    // Send stop message to Ethernet task
-    ethernet_app_send_message(ETHERNET_APP_MSG_ETH_STOP, NULL);
-
-    // Update status
-    http_server_monitor_send_message(HTTP_MSG_ETH_USER_DISCONNECT);
+    http_server_request_eth_disconnect();
 
     return ESP_OK;
 }
@@ -786,51 +2593,269 @@ static esp_err_t http_server_get_eth_config_json_handler(httpd_req_t *req)
 {
     ESP_LOGI(TAG, "/ethConfig.json requested");
 
-    char configJSON[300];
-    memset(configJSON, 0, sizeof(configJSON));
+    char configJSON[200];
+    device_state_t state;
+    json_writer_t w;
 
-    eth_ip_config_t eth_config;
-    esp_err_t ret = ethernet_app_get_ip_config(&eth_config);
-    
-    // Get MAC address
-    uint8_t mac_addr[6];
-    char mac_str[18];
-    esp_eth_handle_t eth_handle = ethernet_app_get_eth_handle();
-    if (eth_handle != NULL)
-    {
-        esp_eth_ioctl(eth_handle, ETH_CMD_G_MAC_ADDR, mac_addr);
-        sprintf(mac_str, "%02x:%02x:%02x:%02x:%02x:%02x", 
-                mac_addr[0], mac_addr[1], mac_addr[2], mac_addr[3], mac_addr[4], mac_addr[5]);
-    }
-    else
-    {
-        strcpy(mac_str, "00:00:00:00:00:00");
-    }
-    
-    if (ret == ESP_OK)
-    {
-        sprintf(configJSON, 
-            "{\"mode\":%d,\"ip\":\"%s\",\"subnet\":\"%s\",\"gateway\":\"%s\",\"mac\":\"%s\",\"dns\":\"%s\"}",
-            eth_config.dhcp_enabled ? ETH_MANAGER_IP_DHCP : ETH_MANAGER_IP_STATIC,
-            eth_config.ip, 
-            eth_config.netmask, 
-            eth_config.gateway, 
-            mac_str,
-            eth_config.dns);
-    }
-    else
-    {
-        // Provide default empty JSON if unable to get config
-        sprintf(configJSON, "{\"mode\":%d,\"ip\":\"\",\"subnet\":\"\",\"gateway\":\"\",\"mac\":\"\",\"dns\":\"\"}", 
-                ETH_MANAGER_IP_DHCP);
-    }
+    device_state_get(&state);
 
-    httpd_resp_set_type(req, "application/json");
-    httpd_resp_send(req, configJSON, strlen(configJSON));
+    json_writer_init(&w, configJSON, sizeof(configJSON), NULL, NULL);
+    http_server_write_eth_config(&w, NULL, &state);
 
-    return ESP_OK;
+    return http_server_send_json(req, &w);
+}
+
+
+/**
+ * status.json handler responds with the whole device state in one snapshot.
+ * With ?since=<version> matching the current version the request is held until the state
+ * changes or HTTP_STATUS_POLL_TIMEOUT_MS passes (long-poll), otherwise it is answered right away.
+ * @param req HTTP request for which the uri needs to be handled.
+ * @return ESP_OK, otherwise the error from httpd_resp_send
+ */
+static esp_err_t http_server_status_json_handler(httpd_req_t *req)
+{
+	char query[64];
+	char since[12];
+
+	ESP_LOGI(TAG, "/status.json requested");
+
+	if (httpd_req_get_url_query_str(req, query, sizeof(query)) != ESP_OK ||
+			httpd_query_key_value(query, "since", since, sizeof(since)) != ESP_OK)
+	{
+		return http_server_status_send(req);
+	}
+
+	// Every device state update bumps the version before the monitor answers the held requests
+	// under this mutex, so a change is either seen here or releases the request below
+	xSemaphoreTake(g_status_polls_mutex, portMAX_DELAY);
+
+	if (strtoul(since, NULL, 10) != device_state_version())
+	{
+		xSemaphoreGive(g_status_polls_mutex);
+		return http_server_status_send(req);
+	}
+
+	int slot = -1;
+	for (int i = 0; i < HTTP_STATUS_MAX_POLLS; i++)
+	{
+		if (g_status_polls[i].req == NULL)
+		{
+			slot = i;
+			break;
+		}
+	}
+
+	// No room to hold it: answer with the unchanged state, the page polls again later
+	httpd_req_t *async_req = NULL;
+	if (slot < 0 || httpd_req_async_handler_begin(req, &async_req) != ESP_OK)
+	{
+		xSemaphoreGive(g_status_polls_mutex);
+		return http_server_status_send(req);
+	}
+
+	g_status_polls[slot].req = async_req;
+	g_status_polls[slot].deadline_us = esp_timer_get_time() + (int64_t)HTTP_STATUS_POLL_TIMEOUT_MS * 1000;
+
+	xSemaphoreGive(g_status_polls_mutex);
+
+	return ESP_OK;
+}
+
+/**
+ * Reads a string member of a /ws command.
+ * @param cmd parsed command.
+ * @param name member name.
+ * @return the string, or "" if the member is missing or not a string.
+ */
+static const char* http_server_ws_get_string(const cJSON *cmd, const char *name)
+{
+	const cJSON *item = cJSON_GetObjectItemCaseSensitive(cmd, name);
+
+	return cJSON_IsString(item) ? item->valuestring : "";
+}
+
+/**
+ * Sends the current device state to one /ws client.
+ * @param req /ws request of the client.
+ * @return ESP_OK, otherwise the error from httpd_ws_send_frame
+ */
+static esp_err_t http_server_ws_send_status(httpd_req_t *req)
+{
+	char *status = malloc(HTTP_STATUS_JSON_LEN);
+	if (status == NULL)
+	{
+		return ESP_ERR_NO_MEM;
+	}
+
+	esp_err_t err = http_server_format_status(status, HTTP_STATUS_JSON_LEN);
+	if (err == ESP_OK)
+	{
+		httpd_ws_frame_t frame = {
+				.final = true,
+				.type = HTTPD_WS_TYPE_TEXT,
+				.payload = (uint8_t*)status,
+				.len = strlen(status)
+		};
+		err = httpd_ws_send_frame(req, &frame);
+	}
+
+	free(status);
+
+	return err;
+}
+
+/**
+ * Executes a /ws command and acknowledges it, the resulting state changes follow as status messages.
+ * Commands: {"cmd":"wifiConnect","ssid":..,"pwd":..}, {"cmd":"wifiDisconnect"},
+ * {"cmd":"ethConnect","mode":"dhcp"|"static","ip":..,"subnet":..,"gateway":..,"dns":..},
+ * {"cmd":"ethDisconnect"} and {"cmd":"status"}.
+ * @param req /ws request of the client.
+ * @param text command frame (JSON).
+ * @return ESP_OK, otherwise the error from httpd_ws_send_frame
+ */
+static esp_err_t http_server_ws_handle_command(httpd_req_t *req, const char *text)
+{
+	cJSON *cmd = cJSON_Parse(text);
+	const char *name = http_server_ws_get_string(cmd, "cmd");
+	const char *ack_name = "";
+	esp_err_t result = ESP_ERR_NOT_SUPPORTED;
+	bool send_status = false;
+
+	if (strcmp(name, "wifiConnect") == 0)
+	{
+		ack_name = "wifiConnect";
+		result = http_server_request_wifi_connect(http_server_ws_get_string(cmd, "ssid"), http_server_ws_get_string(cmd, "pwd"));
+	}
+	else if (strcmp(name, "wifiDisconnect") == 0)
+	{
+		ack_name = "wifiDisconnect";
+		wifi_app_send_message(WIFI_APP_MSG_USER_REQUESTED_STA_DISCONNECT);
+		result = ESP_OK;
+	}
+	else if (strcmp(name, "ethConnect") == 0)
+	{
+		bool dhcp_enabled = strcmp(http_server_ws_get_string(cmd, "mode"), "static") != 0;
+		const char *ip = http_server_ws_get_string(cmd, "ip");
+		const char *subnet = http_server_ws_get_string(cmd, "subnet");
+		const char *gateway = http_server_ws_get_string(cmd, "gateway");
+		const char *dns = http_server_ws_get_string(cmd, "dns");
+
+		// Same rules as the ethConnect.json headers
+		if (dns[0] == '\0')
+		{
+			dns = "8.8.8.8";
+		}
+
+		ack_name = "ethConnect";
+		if (!dhcp_enabled && (ip[0] == '\0' || subnet[0] == '\0' || gateway[0] == '\0' ||
+				strlen(ip) >= IP4ADDR_STRLEN_MAX || strlen(subnet) >= IP4ADDR_STRLEN_MAX ||
+				strlen(gateway) >= IP4ADDR_STRLEN_MAX || strlen(dns) >= IP4ADDR_STRLEN_MAX))
+		{
+			ESP_LOGE(TAG, "Invalid static IP configuration");
+			result = ESP_ERR_INVALID_ARG;
+		}
+		else
+		{
+			result = http_server_request_eth_connect(dhcp_enabled, ip, subnet, gateway, dns);
+		}
+	}
+	else if (strcmp(name, "ethDisconnect") == 0)
+	{
+		ack_name = "ethDisconnect";
+		http_server_request_eth_disconnect();
+		result = ESP_OK;
+	}
+	else if (strcmp(name, "status") == 0)
+	{
+		ack_name = "status";
+		result = ESP_OK;
+		send_status = true;
+	}
+
+	cJSON_Delete(cmd);
+
+	ESP_LOGI(TAG, "http_server_ws_handle_command: '%s' => %s", ack_name, esp_err_to_name(result));
+
+	char ack[96];
+	json_writer_t w;
+
+	json_writer_init(&w, ack, sizeof(ack), NULL, NULL);
+	json_writer_begin_object(&w, NULL);
+	json_writer_string(&w, "type", "ack");
+	json_writer_string(&w, "cmd", ack_name);
+	json_writer_bool(&w, "ok", result == ESP_OK);
+	json_writer_string(&w, "error", result == ESP_OK ? "" : esp_err_to_name(result));
+	json_writer_end_object(&w);
+	json_writer_finish(&w);
+
+	httpd_ws_frame_t frame = {
+			.final = true,
+			.type = HTTPD_WS_TYPE_TEXT,
+			.payload = (uint8_t*)ack,
+			.len = json_writer_len(&w)
+	};
+	esp_err_t err = httpd_ws_send_frame(req, &frame);
+
+	if (err == ESP_OK && send_status)
+	{
+		err = http_server_ws_send_status(req);
+	}
+
+	return err;
 }
 
+/**
+ * /ws handler: registers the client after the WebSocket handshake and executes its command frames.
+ * The client receives the device state right away and then every time it changes,
+ * replacing the status polling and the custom-header POST requests.
+ * @param req HTTP request for which the uri needs to be handled.
+ * @return ESP_OK, otherwise an error, which closes the connection
+ */
+static esp_err_t http_server_ws_handler(httpd_req_t *req)
+{
+	if (req->method == HTTP_GET)
+	{
+		int sockfd = httpd_req_to_sockfd(req);
+
+		if (!http_server_ws_add_client(sockfd))
+		{
+			ESP_LOGW(TAG, "/ws: all client slots taken, closing socket %d", sockfd);
+			return ESP_FAIL;
+		}
+
+		ESP_LOGI(TAG, "/ws: client connected on socket %d", sockfd);
+
+		return http_server_ws_send_status(req);
+	}
+
+	// Frame length first, then the payload
+	httpd_ws_frame_t frame;
+	memset(&frame, 0, sizeof(httpd_ws_frame_t));
+
+	esp_err_t err = httpd_ws_recv_frame(req, &frame, 0);
+	if (err != ESP_OK)
+	{
+		return err;
+	}
+
+	if (frame.len > HTTP_WS_MAX_FRAME_LEN)
+	{
+		ESP_LOGW(TAG, "/ws: frame of %d bytes too large", (int)frame.len);
+		return ESP_FAIL;
+	}
+
+	uint8_t buf[HTTP_WS_MAX_FRAME_LEN + 1] = {0};
+	frame.payload = buf;
+
+	err = httpd_ws_recv_frame(req, &frame, frame.len);
+	if (err != ESP_OK || frame.type != HTTPD_WS_TYPE_TEXT)
+	{
+		return err;
+	}
+
+	return http_server_ws_handle_command(req, (const char*)buf);
+}
 
 /**
  * Sets up the default httpd server configuration.
@@ -849,6 +2874,28 @@ static httpd_handle_t http_server_configure(void)
 			HTTP_SERVER_MONITOR_STACK_SIZE, NULL, HTTP_SERVER_MONITOR_PRIORITY,
 			&task_http_server_monitor, HTTP_SERVER_MONITOR_CORE_ID);
 
+	// create the /events client list mutex
+	g_sse_clients_mutex = xSemaphoreCreateMutex();
+
+	// create the held /status.json request list mutex
+	g_status_polls_mutex = xSemaphoreCreateMutex();
+
+	// empty /ws client list
+	for (int i = 0; i < HTTP_WS_MAX_CLIENTS; i++)
+	{
+		g_ws_clients[i] = -1;
+	}
+	g_ws_client_count = 0;
+
+	// create the asset sender queue and tasks
+	http_asset_sender_queue_handle = xQueueCreate(HTTP_ASSET_SENDER_COUNT, sizeof(http_server_asset_response_t));
+	for (int i = 0; i < HTTP_ASSET_SENDER_COUNT; i++)
+	{
+		xTaskCreatePinnedToCore(&http_server_asset_sender, "http_asset_sender",
+				HTTP_ASSET_SENDER_STACK_SIZE, NULL, HTTP_ASSET_SENDER_PRIORITY,
+				&task_http_asset_sender[i], HTTP_ASSET_SENDER_CORE_ID);
+	}
+
 	// The core that the HTTP server will run on
 	config.core_id =  HTTP_SERVER_TASK_CORE_ID;
 
@@ -860,7 +2907,10 @@ static httpd_handle_t http_server_configure(void)
 
 	// Increase uri handlers
 	config.lru_purge_enable = true;
-	config.max_uri_handlers = 20;
+	config.max_uri_handlers = 33;
+
+	// Wildcard matching for the static asset handler ("/*"), the other URIs stay exact matches
+	config.uri_match_fn = httpd_uri_match_wildcard;
 
 	// Increase the timeout limits
 	config.recv_wait_timeout = 30;
@@ -878,68 +2928,73 @@ static httpd_handle_t http_server_configure(void)
 	{
 		ESP_LOGI(TAG, "http_server_configure: Registering URI handlers");
 
-		// register query handler
-		httpd_uri_t jquery_js = {
-				.uri = "/jquery-3.3.1.min.js",
-				.method = HTTP_GET,
-				.handler = http_server_jquery_handler,
+		// register OTAupdate handler
+		httpd_uri_t OTA_update = {
+				.uri = "/OTAupdate",
+				.method = HTTP_POST,
+				.handler = http_server_OTA_update_handler,
 				.user_ctx = NULL
 		};
-		httpd_register_uri_handler(http_server_handle, &jquery_js);
+		httpd_register_uri_handler(http_server_handle, &OTA_update);
 
-		// register index.html handler
-		httpd_uri_t index_html = {
-				.uri = "/index.html",
-				.method = HTTP_GET,
-				.handler = http_server_index_html_handler,
+		// register OTAstatus handler
+		httpd_uri_t OTA_status = {
+				.uri = "/OTAstatus",
+				.method = HTTP_POST,
+				.handler = http_server_OTA_status_handler,
+				.user_ctx = NULL
+		};
+		httpd_register_uri_handler(http_server_handle, &OTA_status);
+
+		// register OTApull handler
+		httpd_uri_t OTA_pull = {
+				.uri = "/OTApull",
+				.method = HTTP_POST,
+				.handler = http_server_OTA_pull_handler,
 				.user_ctx = NULL
 		};
-		httpd_register_uri_handler(http_server_handle, &index_html);
+		httpd_register_uri_handler(http_server_handle, &OTA_pull);
 
-		// register app.css handler
-		httpd_uri_t app_css = {
-				.uri = "/app.css",
-				.method = HTTP_GET,
-				.handler = http_server_app_css_handler,
+		// register the resumable OTA session handlers, one URI with a method per step
+		httpd_uri_t OTA_session_begin = {
+				.uri = "/OTAsession",
+				.method = HTTP_POST,
+				.handler = http_server_OTA_session_begin_handler,
 				.user_ctx = NULL
 		};
-		httpd_register_uri_handler(http_server_handle, &app_css);
+		httpd_register_uri_handler(http_server_handle, &OTA_session_begin);
 
-		// register app.js handler
-		httpd_uri_t app_js = {
-				.uri = "/app.js",
-				.method = HTTP_GET,
-				.handler = http_server_app_js_handler,
+		httpd_uri_t OTA_session_chunk = {
+				.uri = "/OTAsession",
+				.method = HTTP_PUT,
+				.handler = http_server_OTA_session_chunk_handler,
 				.user_ctx = NULL
 		};
-		httpd_register_uri_handler(http_server_handle, &app_js);
+		httpd_register_uri_handler(http_server_handle, &OTA_session_chunk);
 
-		// register favicon.ico handler
-		httpd_uri_t favicon_ico = {
-				.uri = "/favicon.ico",
+		httpd_uri_t OTA_session_status = {
+				.uri = "/OTAsession",
 				.method = HTTP_GET,
-				.handler = http_server_favicon_ico_handler,
+				.handler = http_server_OTA_session_status_handler,
 				.user_ctx = NULL
 		};
-		httpd_register_uri_handler(http_server_handle, &favicon_ico);
+		httpd_register_uri_handler(http_server_handle, &OTA_session_status);
 
-		// register OTAupdate handler
-		httpd_uri_t OTA_update = {
-				.uri = "/OTAupdate",
-				.method = HTTP_POST,
-				.handler = http_server_OTA_update_handler,
+		httpd_uri_t OTA_session_abort = {
+				.uri = "/OTAsession",
+				.method = HTTP_DELETE,
+				.handler = http_server_OTA_session_abort_handler,
 				.user_ctx = NULL
 		};
-		httpd_register_uri_handler(http_server_handle, &OTA_update);
+		httpd_register_uri_handler(http_server_handle, &OTA_session_abort);
 
-		// register OTAstatus handler
-		httpd_uri_t OTA_status = {
-				.uri = "/OTAstatus",
+		httpd_uri_t OTA_session_finalize = {
+				.uri = "/OTAsession/finalize",
 				.method = HTTP_POST,
-				.handler = http_server_OTA_status_handler,
+				.handler = http_server_OTA_session_finalize_handler,
 				.user_ctx = NULL
 		};
-		httpd_register_uri_handler(http_server_handle, &OTA_status);
+		httpd_register_uri_handler(http_server_handle, &OTA_session_finalize);
 
 		// register wifiConnect.json handler
 		httpd_uri_t wifi_connect_json = {
@@ -1040,6 +3095,120 @@ static httpd_handle_t http_server_configure(void)
 		};
 		httpd_register_uri_handler(http_server_handle, &eth_config_json);
 
+		// register status.json handler
+		httpd_uri_t status_json = {
+				.uri = "/status.json",
+				.method = HTTP_GET,
+				.handler = http_server_status_json_handler,
+				.user_ctx = NULL
+		};
+		httpd_register_uri_handler(http_server_handle, &status_json);
+
+		// register selftest.json handler
+		httpd_uri_t self_test_json = {
+				.uri = "/selftest.json",
+				.method = HTTP_GET,
+				.handler = http_server_self_test_json_handler,
+				.user_ctx = NULL
+		};
+		httpd_register_uri_handler(http_server_handle, &self_test_json);
+
+		// register ethRxMode handlers
+		httpd_uri_t eth_rx_mode_json = {
+				.uri = "/ethRxMode.json",
+				.method = HTTP_GET,
+				.handler = http_server_eth_rx_mode_json_handler,
+				.user_ctx = NULL
+		};
+		httpd_register_uri_handler(http_server_handle, &eth_rx_mode_json);
+
+		httpd_uri_t eth_rx_mode = {
+				.uri = "/ethRxMode",
+				.method = HTTP_POST,
+				.handler = http_server_eth_rx_mode_handler,
+				.user_ctx = NULL
+		};
+		httpd_register_uri_handler(http_server_handle, &eth_rx_mode);
+
+		// register ethTx handler
+		httpd_uri_t eth_tx_json = {
+				.uri = "/ethTx.json",
+				.method = HTTP_GET,
+				.handler = http_server_eth_tx_json_handler,
+				.user_ctx = NULL
+		};
+		httpd_register_uri_handler(http_server_handle, &eth_tx_json);
+
+		// register netBench handlers
+		httpd_uri_t net_bench_json = {
+				.uri = "/netBench.json",
+				.method = HTTP_GET,
+				.handler = http_server_net_bench_json_handler,
+				.user_ctx = NULL
+		};
+		httpd_register_uri_handler(http_server_handle, &net_bench_json);
+
+		httpd_uri_t net_bench = {
+				.uri = "/netBench",
+				.method = HTTP_POST,
+				.handler = http_server_net_bench_handler,
+				.user_ctx = NULL
+		};
+		httpd_register_uri_handler(http_server_handle, &net_bench);
+
+		// register bench handlers
+		httpd_uri_t bench_download = {
+				.uri = "/bench/download",
+				.method = HTTP_GET,
+				.handler = http_server_bench_download_handler,
+				.user_ctx = NULL
+		};
+		httpd_register_uri_handler(http_server_handle, &bench_download);
+
+		httpd_uri_t bench_upload = {
+				.uri = "/bench/upload",
+				.method = HTTP_POST,
+				.handler = http_server_bench_upload_handler,
+				.user_ctx = NULL
+		};
+		httpd_register_uri_handler(http_server_handle, &bench_upload);
+
+		httpd_uri_t bench_stats_json = {
+				.uri = "/bench/stats.json",
+				.method = HTTP_GET,
+				.handler = http_server_bench_stats_json_handler,
+				.user_ctx = NULL
+		};
+		httpd_register_uri_handler(http_server_handle, &bench_stats_json);
+
+		// register events handler
+		httpd_uri_t events = {
+				.uri = "/events",
+				.method = HTTP_GET,
+				.handler = http_server_events_handler,
+				.user_ctx = NULL
+		};
+		httpd_register_uri_handler(http_server_handle, &events);
+
+		// register WebSocket handler
+		httpd_uri_t ws = {
+				.uri = "/ws",
+				.method = HTTP_GET,
+				.handler = http_server_ws_handler,
+				.user_ctx = NULL,
+				.is_websocket = true
+		};
+		httpd_register_uri_handler(http_server_handle, &ws);
+
+		// register the static asset handler last, it matches every GET not handled above
+		httpd_uri_t web_asset = {
+				.uri = "/*",
+				.method = HTTP_GET,
+				.handler = http_server_web_asset_handler,
+				.user_ctx = NULL
+		};
+		httpd_register_uri_handler(http_server_handle, &web_asset);
+
 		return http_server_handle;
 	}
 
@@ -1058,6 +3227,21 @@ void http_server_stop(void)
 {
 	if (http_server_handle)
 	{
+		// End the /events streams while their sockets are still managed by the server
+		xSemaphoreTake(g_sse_clients_mutex, portMAX_DELAY);
+		for (int i = 0; i < HTTP_SSE_MAX_CLIENTS; i++)
+		{
+			if (g_sse_clients[i] != NULL)
+			{
+				http_server_sse_close(g_sse_clients[i]);
+				g_sse_clients[i] = NULL;
+			}
+		}
+		xSemaphoreGive(g_sse_clients_mutex);
+
+		// Answer the held /status.json requests
+		http_server_status_release(true);
+
 		httpd_stop(http_server_handle);
 		ESP_LOGI(TAG, "http_server_stop: stoping HTTP server");
 		http_server_handle = NULL;
@@ -1068,6 +3252,14 @@ void http_server_stop(void)
 		ESP_LOGI(TAG, "http_server_stop: stopping HTTP server monitor");
 		task_http_server_monitor = NULL;
 	}
+	for (int i = 0; i < HTTP_ASSET_SENDER_COUNT; i++)
+	{
+		if (task_http_asset_sender[i])
+		{
+			vTaskDelete(task_http_asset_sender[i]);
+			task_http_asset_sender[i] = NULL;
+		}
+	}
 }
 
 BaseType_t http_server_monitor_send_message(http_server_message_e msgID)
@@ -50,7 +50,8 @@ typedef enum http_server_message
 	HTTP_MSG_ETH_CONNECT_INIT,
 	HTTP_MSG_ETH_CONNECT_SUCCESS,
 	HTTP_MSG_ETH_CONNECT_FAIL,
-	HTTP_MSG_ETH_USER_DISCONNECT
+	HTTP_MSG_ETH_USER_DISCONNECT,
+	HTTP_MSG_ETH_IP_CONFIG_CHANGED
 } http_server_message_e;
 
 /**
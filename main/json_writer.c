@@ -0,0 +1,334 @@
+/*
+ * json_writer.c
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include <string.h>
+
+#include "json_writer.h"
+
+static const char json_writer_hex[] = "0123456789abcdef";
+
+/**
+ * Appends raw bytes, flushing the buffer when it is full.
+ */
+static void json_writer_put(json_writer_t *w, const char *data, size_t len)
+{
+	// Fast path: fits without flushing, keeping the terminator byte
+	if (w->len + len < w->size && w->err == ESP_OK)
+	{
+		memcpy(w->buf + w->len, data, len);
+		w->len += len;
+		return;
+	}
+
+	while (len > 0 && w->err == ESP_OK)
+	{
+		// Without flush callback one byte stays free for the null terminator
+		size_t room = w->size - w->len - (w->flush == NULL ? 1 : 0);
+
+		if (room == 0)
+		{
+			if (w->flush == NULL)
+			{
+				w->err = ESP_ERR_INVALID_SIZE;
+				return;
+			}
+
+			w->err = w->flush(w->ctx, w->buf, w->len);
+			w->len = 0;
+			continue;
+		}
+
+		size_t n = len < room ? len : room;
+		memcpy(w->buf + w->len, data, n);
+		w->len += n;
+		data += n;
+		len -= n;
+	}
+}
+
+static inline void json_writer_putc(json_writer_t *w, char c)
+{
+	// Fast path, the room check matches json_writer_put
+	if (w->len + 1 < w->size || (w->flush != NULL && w->len < w->size))
+	{
+		if (w->err == ESP_OK)
+		{
+			w->buf[w->len++] = c;
+		}
+		return;
+	}
+
+	json_writer_put(w, &c, 1);
+}
+
+/**
+ * Length of the well-formed UTF-8 sequence starting with a byte from 0x80 up.
+ * Overlong forms, surrogates and code points past U+10FFFF are not well-formed.
+ * @param s sequence, its first byte is at least 0x80.
+ * @param len bytes available from s.
+ * @return 2 to 4, or 0 if the bytes are not a well-formed sequence.
+ */
+static size_t json_writer_utf8_len(const uint8_t *s, size_t len)
+{
+	uint8_t c = s[0];
+	size_t n;
+	uint8_t lo = 0x80;
+	uint8_t hi = 0xbf;
+
+	if (c >= 0xc2 && c <= 0xdf)
+	{
+		n = 2;
+	}
+	else if (c >= 0xe0 && c <= 0xef)
+	{
+		n = 3;
+		lo = (c == 0xe0) ? 0xa0 : 0x80;
+		hi = (c == 0xed) ? 0x9f : 0xbf;
+	}
+	else if (c >= 0xf0 && c <= 0xf4)
+	{
+		n = 4;
+		lo = (c == 0xf0) ? 0x90 : 0x80;
+		hi = (c == 0xf4) ? 0x8f : 0xbf;
+	}
+	else
+	{
+		return 0;
+	}
+
+	if (len < n || s[1] < lo || s[1] > hi)
+	{
+		return 0;
+	}
+
+	// Continuation bytes are never 0x00, so a null byte in the sequence ends it here
+	for (size_t i = 2; i < n; i++)
+	{
+		if (s[i] < 0x80 || s[i] > 0xbf)
+		{
+			return 0;
+		}
+	}
+
+	return n;
+}
+
+/**
+ * Appends an escaped, quoted string of at most len bytes (stops at a null byte).
+ */
+static void json_writer_put_escaped(json_writer_t *w, const char *s, size_t len)
+{
+	json_writer_putc(w, '"');
+
+	size_t run = 0;
+	size_t i;
+	for (i = 0; i < len && s[i] != '\0'; i++)
+	{
+		uint8_t c = (uint8_t)s[i];
+
+		if (c >= 0x20 && c < 0x80 && c != '"' && c != '\\')
+		{
+			continue;
+		}
+
+		// Well-formed UTF-8 goes through as it is
+		size_t utf8_len = (c >= 0x80) ? json_writer_utf8_len((const uint8_t*)s + i, len - i) : 0;
+		if (utf8_len > 0)
+		{
+			i += utf8_len - 1;
+			continue;
+		}
+
+		json_writer_put(w, s + run, i - run);
+		run = i + 1;
+
+		// Anything else from 0x80 up is replaced, one U+FFFD per byte, so the output stays valid JSON
+		if (c >= 0x80)
+		{
+			json_writer_put(w, "\\ufffd", 6);
+			continue;
+		}
+
+		char esc[6] = {'\\', 0};
+		switch (c)
+		{
+			case '"':	esc[1] = '"';	json_writer_put(w, esc, 2);	break;
+			case '\\':	esc[1] = '\\';	json_writer_put(w, esc, 2);	break;
+			case '\n':	esc[1] = 'n';	json_writer_put(w, esc, 2);	break;
+			case '\r':	esc[1] = 'r';	json_writer_put(w, esc, 2);	break;
+			case '\t':	esc[1] = 't';	json_writer_put(w, esc, 2);	break;
+			default:
+				esc[1] = 'u';
+				esc[2] = '0';
+				esc[3] = '0';
+				esc[4] = json_writer_hex[c >> 4];
+				esc[5] = json_writer_hex[c & 0x0f];
+				json_writer_put(w, esc, 6);
+				break;
+		}
+	}
+	json_writer_put(w, s + run, i - run);
+
+	json_writer_putc(w, '"');
+}
+
+/**
+ * Writes the comma and the member name in front of a value.
+ */
+static void json_writer_value_prefix(json_writer_t *w, const char *key)
+{
+	uint8_t bit = 1u << w->depth;
+
+	if (w->has_members & bit)
+	{
+		json_writer_putc(w, ',');
+	}
+	w->has_members |= bit;
+
+	if (key != NULL)
+	{
+		json_writer_put_escaped(w, key, SIZE_MAX);
+		json_writer_putc(w, ':');
+	}
+}
+
+static void json_writer_begin(json_writer_t *w, const char *key, char open)
+{
+	json_writer_value_prefix(w, key);
+	json_writer_putc(w, open);
+
+	if (w->depth + 1 >= JSON_WRITER_MAX_DEPTH)
+	{
+		w->err = ESP_ERR_INVALID_SIZE;
+		return;
+	}
+
+	w->depth++;
+	w->has_members &= ~(1u << w->depth);
+}
+
+static void json_writer_end(json_writer_t *w, char close)
+{
+	if (w->depth > 0)
+	{
+		w->depth--;
+	}
+	json_writer_putc(w, close);
+}
+
+/**
+ * Appends an unsigned number, digits formatted backwards into a small buffer.
+ */
+static void json_writer_put_uint(json_writer_t *w, uint32_t value, bool negative)
+{
+	char digits[11];
+	size_t pos = sizeof(digits);
+
+	do
+	{
+		digits[--pos] = '0' + (value % 10);
+		value /= 10;
+	} while (value != 0);
+
+	if (negative)
+	{
+		digits[--pos] = '-';
+	}
+
+	json_writer_put(w, digits + pos, sizeof(digits) - pos);
+}
+
+void json_writer_init(json_writer_t *w, char *buf, size_t size, json_writer_flush_t flush, void *ctx)
+{
+	memset(w, 0, sizeof(json_writer_t));
+	w->buf = buf;
+	w->size = size;
+	w->flush = flush;
+	w->ctx = ctx;
+	w->err = (size > 1) ? ESP_OK : ESP_ERR_INVALID_SIZE;
+}
+
+void json_writer_begin_object(json_writer_t *w, const char *key)
+{
+	json_writer_begin(w, key, '{');
+}
+
+void json_writer_end_object(json_writer_t *w)
+{
+	json_writer_end(w, '}');
+}
+
+void json_writer_begin_array(json_writer_t *w, const char *key)
+{
+	json_writer_begin(w, key, '[');
+}
+
+void json_writer_end_array(json_writer_t *w)
+{
+	json_writer_end(w, ']');
+}
+
+void json_writer_string(json_writer_t *w, const char *key, const char *value)
+{
+	json_writer_string_n(w, key, value, SIZE_MAX);
+}
+
+void json_writer_string_n(json_writer_t *w, const char *key, const char *value, size_t len)
+{
+	if (value == NULL)
+	{
+		json_writer_null(w, key);
+		return;
+	}
+
+	json_writer_value_prefix(w, key);
+	json_writer_put_escaped(w, value, len);
+}
+
+void json_writer_int(json_writer_t *w, const char *key, int32_t value)
+{
+	json_writer_value_prefix(w, key);
+
+	// Negate in unsigned arithmetic, INT32_MIN has no positive counterpart
+	json_writer_put_uint(w, value < 0 ? 0u - (uint32_t)value : (uint32_t)value, value < 0);
+}
+
+void json_writer_uint(json_writer_t *w, const char *key, uint32_t value)
+{
+	json_writer_value_prefix(w, key);
+	json_writer_put_uint(w, value, false);
+}
+
+void json_writer_bool(json_writer_t *w, const char *key, bool value)
+{
+	json_writer_value_prefix(w, key);
+	json_writer_put(w, value ? "true" : "false", value ? 4 : 5);
+}
+
+void json_writer_null(json_writer_t *w, const char *key)
+{
+	json_writer_value_prefix(w, key);
+	json_writer_put(w, "null", 4);
+}
+
+esp_err_t json_writer_finish(json_writer_t *w)
+{
+	if (w->flush == NULL)
+	{
+		// json_writer_put always keeps room for the terminator
+		if (w->size > 0)
+		{
+			w->buf[w->len] = '\0';
+		}
+	}
+	else if (w->err == ESP_OK && w->len > 0)
+	{
+		w->err = w->flush(w->ctx, w->buf, w->len);
+		w->len = 0;
+	}
+
+	return w->err;
+}
@@ -0,0 +1,130 @@
+/*
+ * json_writer.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef MAIN_JSON_WRITER_H_
+#define MAIN_JSON_WRITER_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+// Deepest object/array nesting a writer tracks
+#define JSON_WRITER_MAX_DEPTH		8
+
+/**
+ * Receives the buffered output when the buffer is full and on json_writer_finish.
+ * @param ctx context given to json_writer_init.
+ * @param data output bytes.
+ * @param len number of bytes.
+ * @return ESP_OK to continue, otherwise the writer stops and reports the error.
+ */
+typedef esp_err_t (*json_writer_flush_t)(void *ctx, const char *data, size_t len);
+
+/**
+ * Streaming JSON writer: no allocation, output escaped and bounded by the caller buffer.
+ * Without a flush callback the output must fit the buffer, it is then null terminated.
+ * With a flush callback the buffer is only a staging area (e.g. one httpd chunk).
+ */
+typedef struct json_writer
+{
+	char *buf;
+	size_t size;
+	size_t len;
+	json_writer_flush_t flush;
+	void *ctx;
+	esp_err_t err;					// First error, ESP_ERR_INVALID_SIZE when the output did not fit
+	uint8_t depth;
+	uint8_t has_members;			// Bit per nesting level: a value was written, the next one needs a comma
+} json_writer_t;
+
+/**
+ * Initializes a writer.
+ * @param w writer.
+ * @param buf output buffer (or staging buffer with a flush callback).
+ * @param size size of the buffer.
+ * @param flush flush callback, NULL to write into the buffer only.
+ * @param ctx context passed to the flush callback.
+ */
+void json_writer_init(json_writer_t *w, char *buf, size_t size, json_writer_flush_t flush, void *ctx);
+
+/**
+ * Opens an object.
+ * @param w writer.
+ * @param key member name inside an object, NULL at the top level or inside an array.
+ */
+void json_writer_begin_object(json_writer_t *w, const char *key);
+
+/**
+ * Closes the current object.
+ */
+void json_writer_end_object(json_writer_t *w);
+
+/**
+ * Opens an array.
+ * @param key member name inside an object, NULL at the top level or inside an array.
+ */
+void json_writer_begin_array(json_writer_t *w, const char *key);
+
+/**
+ * Closes the current array.
+ */
+void json_writer_end_array(json_writer_t *w);
+
+/**
+ * Writes an escaped string value, bytes that are not well-formed UTF-8 are written as \ufffd.
+ * @param key member name, NULL inside an array.
+ * @param value null terminated string, NULL writes null.
+ */
+void json_writer_string(json_writer_t *w, const char *key, const char *value);
+
+/**
+ * Writes an escaped string value of at most len bytes, for fields that are not always
+ * null terminated (e.g. the 32 byte SSID of wifi_config_t).
+ * @param key member name, NULL inside an array.
+ * @param value string, stops at a null byte or after len bytes.
+ * @param len maximum length.
+ */
+void json_writer_string_n(json_writer_t *w, const char *key, const char *value, size_t len);
+
+/**
+ * Writes a signed integer value.
+ */
+void json_writer_int(json_writer_t *w, const char *key, int32_t value);
+
+/**
+ * Writes an unsigned integer value.
+ */
+void json_writer_uint(json_writer_t *w, const char *key, uint32_t value);
+
+/**
+ * Writes a boolean value.
+ */
+void json_writer_bool(json_writer_t *w, const char *key, bool value);
+
+/**
+ * Writes a null value.
+ */
+void json_writer_null(json_writer_t *w, const char *key);
+
+/**
+ * Ends the output: flushes the rest with a flush callback, null terminates the buffer otherwise.
+ * @param w writer.
+ * @return ESP_OK, ESP_ERR_INVALID_SIZE if the output did not fit the buffer or the nesting was too deep,
+ * otherwise the error returned by the flush callback
+ */
+esp_err_t json_writer_finish(json_writer_t *w);
+
+/**
+ * @return length of the output in the buffer (without flush callback: the whole output).
+ */
+static inline size_t json_writer_len(const json_writer_t *w)
+{
+	return w->len;
+}
+
+#endif /* MAIN_JSON_WRITER_H_ */
@@ -16,6 +16,8 @@
 #include "wifi_reset_button.h"
 #include "http_server.h"
 #include "ethernet_app.h"
+#include "ota_tcp.h"
+#include "self_test.h"
 
 
 static const char TAG[] = "main";
@@ -53,6 +55,9 @@ void app_main(void)
         ESP_ERROR_CHECK(err);
     }
     
+    // Self-test of this image, started first so boot-to-IP is timed from boot
+    self_test_start();
+    
     // LANGKAH 1: Inisialisasi HTTP server
     http_server_start();
     
@@ -60,6 +65,11 @@ void app_main(void)
     ethernet_app_set_callback(&eth_application_connected_events);
     ethernet_app_start();
     
+#if CONFIG_OTA_TCP_ENABLE
+    // Raw TCP firmware receiver, listens on all interfaces once they are up
+    ota_tcp_start();
+#endif
+    
     // LANGKAH 3: Start WiFi (setelah Ethernet, untuk menghindari konflik)
     wifi_app_start();
     
@@ -0,0 +1,284 @@
+/*
+ * multipart_parser.c
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include <ctype.h>
+#include <string.h>
+#include <strings.h>
+
+#include "multipart_parser.h"
+
+/**
+ * Passes file bytes to the callback, only for the file part.
+ */
+static void multipart_parser_emit(multipart_parser_t *p, const char *data, size_t len, bool emit)
+{
+	if (!emit || len == 0 || p->err != ESP_OK)
+	{
+		return;
+	}
+
+	p->err = p->on_data(p->ctx, data, len);
+	p->file_len += len;
+}
+
+/**
+ * Looks for the delimiter, passing the bytes in front of it to the callback if emit is set.
+ * A partial match at the end of the chunk is carried over to the next one (p->match), those
+ * bytes are the start of the delimiter, so they can be passed on later from p->delimiter
+ * if the match fails.
+ * @return bytes consumed, up to the end of the delimiter if it was found (p->match is then delimiter_len).
+ */
+static size_t multipart_parser_scan(multipart_parser_t *p, const char *data, size_t len, bool emit)
+{
+	size_t m = p->match;
+	size_t carried = p->match;		// Matched bytes that came with earlier chunks
+	size_t run = 0;					// Start of the bytes of this chunk not passed on yet
+	size_t i = 0;
+
+	while (i < len)
+	{
+		// Nothing matched: skip to the next possible delimiter start
+		if (m == 0)
+		{
+			const char *start = memchr(data + i, p->delimiter[0], len - i);
+			if (start == NULL)
+			{
+				i = len;
+				break;
+			}
+			i = start - data;
+		}
+
+		char c = data[i++];
+
+		while (m > 0 && p->delimiter[m] != c)
+		{
+			// The oldest bytes of the match turn out to be content
+			size_t dropped = m - p->fallback[m];
+			if (carried > 0)
+			{
+				size_t n = dropped < carried ? dropped : carried;
+				multipart_parser_emit(p, p->delimiter, n, emit);
+				carried -= n;
+			}
+			m = p->fallback[m];
+		}
+
+		if (p->delimiter[m] == c)
+		{
+			m++;
+		}
+
+		if (m == p->delimiter_len)
+		{
+			multipart_parser_emit(p, data + run, i - (m - carried) - run, emit);
+			p->match = m;
+			return i;
+		}
+	}
+
+	// Keep the bytes of the partial match, this chunk holds m - carried of them
+	multipart_parser_emit(p, data + run, len - (m - carried) - run, emit);
+	p->match = m;
+
+	return len;
+}
+
+/**
+ * Handles a complete part header line (stored in lower case).
+ */
+static void multipart_parser_header_line(multipart_parser_t *p)
+{
+	p->header_line[p->header_len] = '\0';
+
+	if (strncmp(p->header_line, "content-disposition:", 20) == 0 && strstr(p->header_line, "filename=") != NULL)
+	{
+		p->part_is_file = true;
+	}
+}
+
+esp_err_t multipart_parser_init(multipart_parser_t *p, const char *content_type, multipart_parser_data_cb_t on_data, void *ctx)
+{
+	memset(p, 0, sizeof(multipart_parser_t));
+	p->on_data = on_data;
+	p->ctx = ctx;
+
+	if (content_type == NULL || strncasecmp(content_type, "multipart/form-data", 19) != 0)
+	{
+		return ESP_ERR_INVALID_ARG;
+	}
+
+	const char *boundary = NULL;
+	for (const char *s = content_type + 19; *s != '\0'; s++)
+	{
+		if (strncasecmp(s, "boundary=", 9) == 0)
+		{
+			boundary = s + 9;
+			break;
+		}
+	}
+	if (boundary == NULL)
+	{
+		return ESP_ERR_INVALID_ARG;
+	}
+
+	size_t boundary_len;
+	if (*boundary == '"')
+	{
+		boundary++;
+		const char *end = strchr(boundary, '"');
+		boundary_len = (end != NULL) ? (size_t)(end - boundary) : 0;
+	}
+	else
+	{
+		boundary_len = strcspn(boundary, "; \t");
+	}
+	if (boundary_len == 0 || boundary_len > MULTIPART_BOUNDARY_MAX_LEN)
+	{
+		return ESP_ERR_INVALID_ARG;
+	}
+
+	memcpy(p->delimiter, "\r\n--", 4);
+	memcpy(p->delimiter + 4, boundary, boundary_len);
+	p->delimiter_len = boundary_len + 4;
+
+	// fallback[m]: longest proper prefix of the first m delimiter bytes that is also their suffix
+	size_t k = 0;
+	for (size_t q = 1; q < p->delimiter_len; q++)
+	{
+		while (k > 0 && p->delimiter[q] != p->delimiter[k])
+		{
+			k = p->fallback[k];
+		}
+		if (p->delimiter[q] == p->delimiter[k])
+		{
+			k++;
+		}
+		p->fallback[q + 1] = k;
+	}
+
+	// The body may start with the boundary line right away: count it as preceded by CRLF
+	p->state = MULTIPART_STATE_PREAMBLE;
+	p->match = 2;
+	p->err = ESP_OK;
+
+	return ESP_OK;
+}
+
+esp_err_t multipart_parser_feed(multipart_parser_t *p, const char *data, size_t len)
+{
+	size_t i = 0;
+
+	while (i < len && p->err == ESP_OK)
+	{
+		char c = data[i];
+
+		switch (p->state)
+		{
+			case MULTIPART_STATE_PREAMBLE:
+			case MULTIPART_STATE_BODY:
+				i += multipart_parser_scan(p, data + i, len - i, p->state == MULTIPART_STATE_BODY && p->part_is_file);
+				if (p->match == p->delimiter_len)
+				{
+					p->match = 0;
+					p->state = MULTIPART_STATE_BOUNDARY_END;
+				}
+				continue;
+
+			case MULTIPART_STATE_BOUNDARY_END:
+				if (c == '-')
+				{
+					p->state = MULTIPART_STATE_BOUNDARY_CLOSE;
+				}
+				else if (c == '\r')
+				{
+					p->state = MULTIPART_STATE_BOUNDARY_LF;
+				}
+				else if (c != ' ' && c != '\t')
+				{
+					// Only transport padding may follow the boundary
+					p->err = ESP_ERR_INVALID_RESPONSE;
+				}
+				break;
+
+			case MULTIPART_STATE_BOUNDARY_CLOSE:
+				if (c == '-')
+				{
+					p->state = MULTIPART_STATE_EPILOGUE;
+				}
+				else
+				{
+					p->err = ESP_ERR_INVALID_RESPONSE;
+				}
+				break;
+
+			case MULTIPART_STATE_BOUNDARY_LF:
+				if (c == '\n')
+				{
+					p->state = MULTIPART_STATE_HEADERS;
+					p->header_len = 0;
+					p->part_is_file = false;
+				}
+				else
+				{
+					p->err = ESP_ERR_INVALID_RESPONSE;
+				}
+				break;
+
+			case MULTIPART_STATE_HEADERS:
+				if (c == '\r')
+				{
+					p->state = MULTIPART_STATE_HEADERS_LF;
+				}
+				else if (p->header_len < MULTIPART_HEADER_LINE_LEN - 1)
+				{
+					p->header_line[p->header_len++] = tolower((unsigned char)c);
+				}
+				break;
+
+			case MULTIPART_STATE_HEADERS_LF:
+				if (c != '\n')
+				{
+					p->err = ESP_ERR_INVALID_RESPONSE;
+				}
+				else if (p->header_len > 0)
+				{
+					multipart_parser_header_line(p);
+					p->header_len = 0;
+					p->state = MULTIPART_STATE_HEADERS;
+				}
+				else
+				{
+					// Empty line: the content follows, only the first file is kept
+					p->part_is_file = p->part_is_file && !p->file_found;
+					p->file_found |= p->part_is_file;
+					p->state = MULTIPART_STATE_BODY;
+				}
+				break;
+
+			case MULTIPART_STATE_EPILOGUE:
+				return ESP_OK;
+		}
+
+		i++;
+	}
+
+	return p->err;
+}
+
+esp_err_t multipart_parser_finish(multipart_parser_t *p)
+{
+	if (p->err != ESP_OK)
+	{
+		return p->err;
+	}
+	if (p->state != MULTIPART_STATE_EPILOGUE)
+	{
+		return ESP_ERR_INVALID_RESPONSE;
+	}
+
+	return p->file_found ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
@@ -0,0 +1,104 @@
+/*
+ * multipart_parser.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef MAIN_MULTIPART_PARSER_H_
+#define MAIN_MULTIPART_PARSER_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+// Longest boundary allowed by RFC 2046
+#define MULTIPART_BOUNDARY_MAX_LEN		70
+
+// Part header lines are kept up to this length, the rest of a longer line is ignored
+#define MULTIPART_HEADER_LINE_LEN		128
+
+/**
+ * Receives the content of the file part.
+ * @param ctx context given to multipart_parser_init.
+ * @param data file bytes.
+ * @param len number of bytes.
+ * @return ESP_OK to continue, otherwise the parser stops and reports the error.
+ */
+typedef esp_err_t (*multipart_parser_data_cb_t)(void *ctx, const char *data, size_t len);
+
+/**
+ * Parser states.
+ */
+typedef enum multipart_parser_state
+{
+	MULTIPART_STATE_PREAMBLE = 0,		// Before the first boundary
+	MULTIPART_STATE_BOUNDARY_END,		// After a boundary: "--" closes the body, CRLF starts a part
+	MULTIPART_STATE_BOUNDARY_CLOSE,		// Second '-' of the closing boundary
+	MULTIPART_STATE_BOUNDARY_LF,		// LF ending the boundary line
+	MULTIPART_STATE_HEADERS,			// Part headers, up to the empty line
+	MULTIPART_STATE_HEADERS_LF,			// LF ending a header line
+	MULTIPART_STATE_BODY,				// Part content, up to the next boundary
+	MULTIPART_STATE_EPILOGUE,			// After the closing boundary, ignored
+} multipart_parser_state_e;
+
+/**
+ * Incremental multipart/form-data parser: the body can be fed in chunks of any size,
+ * boundaries split between chunks are found without buffering the content.
+ * The content of the first part carrying a file (filename= in its Content-Disposition)
+ * is passed to the data callback, the other parts are skipped.
+ */
+typedef struct multipart_parser
+{
+	multipart_parser_state_e state;
+	char delimiter[MULTIPART_BOUNDARY_MAX_LEN + 4];		// CRLF "--" boundary
+	uint8_t delimiter_len;
+	uint8_t fallback[MULTIPART_BOUNDARY_MAX_LEN + 5];	// Partial match fallback table (KMP) of the delimiter
+	uint8_t match;										// Delimiter bytes matched at the end of the input so far
+	char header_line[MULTIPART_HEADER_LINE_LEN];
+	uint8_t header_len;
+	bool part_is_file;
+	bool file_found;									// The file part was seen, later parts are skipped
+	multipart_parser_data_cb_t on_data;
+	void *ctx;
+	size_t file_len;									// File bytes passed to the callback
+	esp_err_t err;
+} multipart_parser_t;
+
+/**
+ * Initializes a parser for a request.
+ * @param p parser.
+ * @param content_type value of the Content-Type header of the request, it holds the boundary.
+ * @param on_data callback receiving the file content.
+ * @param ctx context passed to the callback.
+ * @return ESP_OK, ESP_ERR_INVALID_ARG if the content type is not multipart/form-data with a valid boundary.
+ */
+esp_err_t multipart_parser_init(multipart_parser_t *p, const char *content_type, multipart_parser_data_cb_t on_data, void *ctx);
+
+/**
+ * Parses the next chunk of the request body.
+ * @param p parser.
+ * @param data body bytes.
+ * @param len number of bytes.
+ * @return ESP_OK, ESP_ERR_INVALID_RESPONSE for a malformed body, otherwise the error returned by the callback.
+ */
+esp_err_t multipart_parser_feed(multipart_parser_t *p, const char *data, size_t len);
+
+/**
+ * Ends the body.
+ * @param p parser.
+ * @return ESP_OK if the closing boundary was seen and a file part was found,
+ * ESP_ERR_INVALID_RESPONSE for a truncated body, ESP_ERR_NOT_FOUND without file part.
+ */
+esp_err_t multipart_parser_finish(multipart_parser_t *p);
+
+/**
+ * @return number of file bytes passed to the data callback.
+ */
+static inline size_t multipart_parser_file_len(const multipart_parser_t *p)
+{
+	return p->file_len;
+}
+
+#endif /* MAIN_MULTIPART_PARSER_H_ */
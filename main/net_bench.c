@@ -0,0 +1,702 @@
+/*
+ * net_bench.c
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_netif.h"
+#include "esp_timer.h"
+#include "lwip/sockets.h"
+#include "lwip/stats.h"
+#include "net/if.h"
+#include "sys/param.h"
+
+#include "cpu_load.h"
+#include "ethernet_app.h"
+#include "net_bench.h"
+#include "tasks_common.h"
+#include "wifi_app.h"
+
+// Tag used for ESP serial console messages
+static const char TAG[] = "net_bench";
+
+// Socket timeout, how often the loops look at the stop flag
+#define NET_BENCH_POLL_MS			250
+
+// iperf 2 UDP datagram header: sequence number, send time (s, us), upper sequence number bits
+#define NET_BENCH_UDP_HEADER_LEN	16
+
+// iperf 2 server report that answers the final datagram: flags, bytes (2 words), stop time (s, us),
+// lost, out of order, datagrams, jitter (s, us)
+#define NET_BENCH_UDP_REPORT_LEN	40
+#define NET_BENCH_UDP_REPORT_FLAG	0x80000000
+
+// Final datagrams sent until the server reports
+#define NET_BENCH_UDP_FIN_TRIES		10
+
+// Run parameters, copied by net_bench_start
+static net_bench_config_t s_config;
+static char s_host[16];
+static struct sockaddr_in s_peer;
+static struct ifreq s_ifr;				// Empty name: not bound to an interface
+static uint32_t s_local_addr;			// Network order, 0 for any
+
+// Progress and result
+static net_bench_result_t s_result;
+static portMUX_TYPE s_result_lock = portMUX_INITIALIZER_UNLOCKED;
+static volatile bool s_stop = false;
+
+// Set when the traffic starts, benchmark task only
+static bool s_began;
+static int64_t s_start_us;
+static cpu_load_sample_t s_load_start;
+static int32_t s_retransmits_start;
+
+/**
+ * Looks up an interface by name.
+ * @param name "eth", "sta" or "ap".
+ * @param netif receives the interface, NULL if it was not created yet.
+ * @return false for an unknown name.
+ */
+static bool net_bench_get_netif(const char *name, esp_netif_t **netif)
+{
+	if (strcmp(name, "eth") == 0)
+	{
+		*netif = esp_netif_eth;
+	}
+	else if (strcmp(name, "sta") == 0)
+	{
+		*netif = esp_netif_sta;
+	}
+	else if (strcmp(name, "ap") == 0)
+	{
+		*netif = esp_netif_ap;
+	}
+	else
+	{
+		return false;
+	}
+
+	return true;
+}
+
+/**
+ * TCP segments retransmitted since boot, by any connection of the device.
+ * @return the lwIP MIB-2 counter (CONFIG_LWIP_STATS, and MIB2_STATS from main/CMakeLists.txt),
+ * -1 in a configuration without them.
+ */
+static int32_t net_bench_retransmits(void)
+{
+#if LWIP_STATS && MIB2_STATS
+	return (int32_t)(lwip_stats.mib2.tcpretranssegs & INT32_MAX);
+#else
+	return -1;
+#endif
+}
+
+static void net_bench_put_u32(char *buf, uint32_t value)
+{
+	uint32_t be = htonl(value);
+	memcpy(buf, &be, sizeof(be));
+}
+
+static uint32_t net_bench_get_u32(const char *buf)
+{
+	uint32_t be;
+	memcpy(&be, buf, sizeof(be));
+	return ntohl(be);
+}
+
+/**
+ * Sets a socket timeout.
+ * @param sock socket.
+ * @param option SO_RCVTIMEO or SO_SNDTIMEO.
+ * @param ms timeout.
+ */
+static void net_bench_set_timeout(int sock, int option, uint32_t ms)
+{
+	struct timeval timeout = {
+			.tv_sec = ms / 1000,
+			.tv_usec = (ms % 1000) * 1000,
+	};
+	setsockopt(sock, SOL_SOCKET, option, &timeout, sizeof(timeout));
+}
+
+/**
+ * Creates a socket bound to the interface of the run.
+ * @param type SOCK_STREAM or SOCK_DGRAM.
+ * @param port local port, 0 for any.
+ * @return the socket, -1 on failure.
+ */
+static int net_bench_socket(int type, uint16_t port)
+{
+	struct sockaddr_in local = {
+			.sin_family = AF_INET,
+			.sin_port = htons(port),
+			.sin_addr.s_addr = s_local_addr,
+	};
+	int opt = 1;
+
+	int sock = socket(AF_INET, type, 0);
+	if (sock < 0)
+	{
+		ESP_LOGE(TAG, "net_bench_socket: socket failed (errno %d)", errno);
+		return -1;
+	}
+
+	setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+	// The address selects the interface for incoming traffic, the device binding for outgoing
+	if ((s_ifr.ifr_name[0] != '\0' && setsockopt(sock, SOL_SOCKET, SO_BINDTODEVICE, &s_ifr, sizeof(s_ifr)) != 0)
+			|| bind(sock, (struct sockaddr*)&local, sizeof(local)) != 0)
+	{
+		ESP_LOGE(TAG, "net_bench_socket: cannot bind port %u (errno %d)", port, errno);
+		close(sock);
+		return -1;
+	}
+
+	return sock;
+}
+
+/**
+ * The traffic starts: takes the time, CPU and retransmit baselines.
+ */
+static void net_bench_begin(void)
+{
+	s_began = true;
+	s_start_us = esp_timer_get_time();
+	s_retransmits_start = net_bench_retransmits();
+	cpu_load_sample(&s_load_start);
+
+	taskENTER_CRITICAL(&s_result_lock);
+	s_result.state = NET_BENCH_RUNNING;
+	taskEXIT_CRITICAL(&s_result_lock);
+}
+
+/**
+ * Counts payload sent or received.
+ * @param bytes payload bytes.
+ * @param datagrams UDP datagrams, 0 for TCP.
+ */
+static void net_bench_count(size_t bytes, uint32_t datagrams)
+{
+	taskENTER_CRITICAL(&s_result_lock);
+	s_result.bytes += bytes;
+	s_result.datagrams += datagrams;
+	s_result.elapsed_ms = (esp_timer_get_time() - s_start_us) / 1000;
+	taskEXIT_CRITICAL(&s_result_lock);
+}
+
+/**
+ * Ends the run: throughput, CPU load and retransmits over the time since net_bench_begin.
+ * @param err result of the run.
+ */
+static void net_bench_end(esp_err_t err)
+{
+	cpu_load_sample_t load_end;
+	int64_t elapsed_us = esp_timer_get_time() - s_start_us;
+	int32_t retransmits = net_bench_retransmits();
+
+	cpu_load_sample(&load_end);
+
+	taskENTER_CRITICAL(&s_result_lock);
+	if (s_began)
+	{
+		s_result.elapsed_ms = elapsed_us / 1000;
+		s_result.kbps = (elapsed_us > 0) ? (uint32_t)(s_result.bytes * 8000 / elapsed_us) : 0;
+		s_result.retransmits = (!s_result.udp && retransmits >= 0) ? (retransmits - s_retransmits_start) & INT32_MAX : -1;
+		for (int core = 0; core < portNUM_PROCESSORS; core++)
+		{
+			s_result.cpu_load[core] = cpu_load_percent(&s_load_start, &load_end, core);
+		}
+	}
+	s_result.state = (err == ESP_OK) ? NET_BENCH_DONE : NET_BENCH_FAILED;
+	s_result.err = err;
+	taskEXIT_CRITICAL(&s_result_lock);
+}
+
+/**
+ * Server run over TCP: receives one connection until the client closes it.
+ * @param buffer NET_BENCH_BUFFER_SIZE bytes.
+ * @return ESP_OK, ESP_ERR_TIMEOUT if no client connected, ESP_FAIL.
+ */
+static esp_err_t net_bench_tcp_server(char *buffer)
+{
+	int64_t deadline = esp_timer_get_time() + NET_BENCH_ACCEPT_TIMEOUT_S * 1000000LL;
+	esp_err_t err = ESP_OK;
+	int sock = -1;
+
+	int listen_sock = net_bench_socket(SOCK_STREAM, s_config.port);
+	if (listen_sock < 0)
+	{
+		return ESP_FAIL;
+	}
+	if (listen(listen_sock, 1) != 0)
+	{
+		close(listen_sock);
+		return ESP_FAIL;
+	}
+
+	ESP_LOGI(TAG, "net_bench_tcp_server: waiting on port %u", s_config.port);
+
+	net_bench_set_timeout(listen_sock, SO_RCVTIMEO, NET_BENCH_POLL_MS);
+	while (sock < 0 && !s_stop && esp_timer_get_time() < deadline)
+	{
+		sock = accept(listen_sock, NULL, NULL);
+	}
+	close(listen_sock);
+
+	if (sock < 0)
+	{
+		return s_stop ? ESP_OK : ESP_ERR_TIMEOUT;
+	}
+
+	net_bench_set_timeout(sock, SO_RCVTIMEO, NET_BENCH_POLL_MS);
+	net_bench_begin();
+
+	while (!s_stop)
+	{
+		int len = recv(sock, buffer, NET_BENCH_BUFFER_SIZE, 0);
+		if (len > 0)
+		{
+			net_bench_count(len, 0);
+			continue;
+		}
+		if (len < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+		{
+			continue;
+		}
+
+		// 0: the client is done, some clients reset the connection instead
+		if (len < 0 && errno != ECONNRESET)
+		{
+			ESP_LOGI(TAG, "net_bench_tcp_server: recv failed (errno %d)", errno);
+			err = ESP_FAIL;
+		}
+		break;
+	}
+
+	close(sock);
+	return err;
+}
+
+/**
+ * Answers the final datagram of a UDP client with the iperf 2 server report.
+ * @param sock server socket.
+ * @param buffer the final datagram, the report is written behind its header.
+ * @param peer the client.
+ * @param datagrams datagrams the client sent (its final sequence number).
+ */
+static void net_bench_udp_report(int sock, char *buffer, const struct sockaddr_in *peer, uint32_t datagrams)
+{
+	char *report = buffer + NET_BENCH_UDP_HEADER_LEN;
+	int64_t elapsed_us = esp_timer_get_time() - s_start_us;
+
+	net_bench_put_u32(report, NET_BENCH_UDP_REPORT_FLAG);
+	net_bench_put_u32(report + 4, (uint32_t)(s_result.bytes >> 32));
+	net_bench_put_u32(report + 8, (uint32_t)s_result.bytes);
+	net_bench_put_u32(report + 12, elapsed_us / 1000000);
+	net_bench_put_u32(report + 16, elapsed_us % 1000000);
+	net_bench_put_u32(report + 20, s_result.lost);
+	net_bench_put_u32(report + 24, s_result.out_of_order);
+	net_bench_put_u32(report + 28, datagrams);
+	net_bench_put_u32(report + 32, 0);
+	net_bench_put_u32(report + 36, 0);
+
+	sendto(sock, buffer, NET_BENCH_UDP_HEADER_LEN + NET_BENCH_UDP_REPORT_LEN, 0,
+			(const struct sockaddr*)peer, sizeof(*peer));
+}
+
+/**
+ * Server run over UDP: receives one stream until its final datagram (or NET_BENCH_UDP_IDLE_MS
+ * of silence), counting lost and reordered datagrams from the sequence numbers.
+ * @param buffer NET_BENCH_BUFFER_SIZE bytes.
+ * @return ESP_OK, ESP_ERR_TIMEOUT if no client sent, ESP_FAIL.
+ */
+static esp_err_t net_bench_udp_server(char *buffer)
+{
+	int64_t deadline = esp_timer_get_time() + NET_BENCH_ACCEPT_TIMEOUT_S * 1000000LL;
+	int64_t last_us = 0;
+	uint32_t next_id = 0;
+	esp_err_t err = ESP_OK;
+
+	int sock = net_bench_socket(SOCK_DGRAM, s_config.port);
+	if (sock < 0)
+	{
+		return ESP_FAIL;
+	}
+
+	ESP_LOGI(TAG, "net_bench_udp_server: waiting on port %u", s_config.port);
+
+	net_bench_set_timeout(sock, SO_RCVTIMEO, NET_BENCH_POLL_MS);
+
+	while (!s_stop)
+	{
+		struct sockaddr_in peer;
+		socklen_t peer_len = sizeof(peer);
+
+		int len = recvfrom(sock, buffer, NET_BENCH_BUFFER_SIZE, 0, (struct sockaddr*)&peer, &peer_len);
+		int64_t now = esp_timer_get_time();
+
+		if (len < 0)
+		{
+			if (errno != EAGAIN && errno != EWOULDBLOCK)
+			{
+				ESP_LOGI(TAG, "net_bench_udp_server: recvfrom failed (errno %d)", errno);
+				err = ESP_FAIL;
+				break;
+			}
+			if (!s_began && now >= deadline)
+			{
+				err = ESP_ERR_TIMEOUT;
+				break;
+			}
+			if (s_began && now - last_us >= NET_BENCH_UDP_IDLE_MS * 1000LL)
+			{
+				break;
+			}
+			continue;
+		}
+		if (len < NET_BENCH_UDP_HEADER_LEN)
+		{
+			continue;
+		}
+
+		if (!s_began)
+		{
+			net_bench_begin();
+		}
+		last_us = now;
+
+		// A negative sequence number ends the stream, the client waits for the report
+		int32_t id = (int32_t)net_bench_get_u32(buffer);
+		if (id < 0)
+		{
+			net_bench_udp_report(sock, buffer, &peer, (uint32_t)-id);
+			break;
+		}
+
+		taskENTER_CRITICAL(&s_result_lock);
+		if ((uint32_t)id >= next_id)
+		{
+			s_result.lost += id - next_id;
+			next_id = id + 1;
+		}
+		else
+		{
+			// Counted as lost when the gap was seen
+			s_result.out_of_order++;
+			if (s_result.lost > 0)
+			{
+				s_result.lost--;
+			}
+		}
+		taskEXIT_CRITICAL(&s_result_lock);
+
+		net_bench_count(len, 1);
+	}
+
+	close(sock);
+	return err;
+}
+
+/**
+ * Client run over TCP: sends to the host's server for the run time.
+ * @param buffer NET_BENCH_BUFFER_SIZE bytes, zeros (an iperf 2 header without options).
+ * @return ESP_OK, ESP_FAIL.
+ */
+static esp_err_t net_bench_tcp_client(char *buffer)
+{
+	esp_err_t err = ESP_OK;
+
+	int sock = net_bench_socket(SOCK_STREAM, 0);
+	if (sock < 0)
+	{
+		return ESP_FAIL;
+	}
+	if (connect(sock, (struct sockaddr*)&s_peer, sizeof(s_peer)) != 0)
+	{
+		ESP_LOGI(TAG, "net_bench_tcp_client: cannot connect to %s:%u (errno %d)", s_host, s_config.port, errno);
+		close(sock);
+		return ESP_FAIL;
+	}
+
+	net_bench_set_timeout(sock, SO_SNDTIMEO, NET_BENCH_POLL_MS);
+	net_bench_begin();
+
+	int64_t end_us = s_start_us + s_config.time_s * 1000000LL;
+	while (!s_stop && esp_timer_get_time() < end_us)
+	{
+		int len = send(sock, buffer, NET_BENCH_BUFFER_SIZE, 0);
+		if (len > 0)
+		{
+			net_bench_count(len, 0);
+		}
+		else if (len < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+		{
+			ESP_LOGI(TAG, "net_bench_tcp_client: send failed (errno %d)", errno);
+			err = ESP_FAIL;
+			break;
+		}
+	}
+
+	close(sock);
+	return err;
+}
+
+/**
+ * Writes the iperf 2 header of a UDP datagram.
+ * @param buffer datagram.
+ * @param id sequence number, negative for the final datagram.
+ */
+static void net_bench_udp_header(char *buffer, int32_t id)
+{
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	net_bench_put_u32(buffer, (uint32_t)id);
+	net_bench_put_u32(buffer + 4, tv.tv_sec);
+	net_bench_put_u32(buffer + 8, tv.tv_usec);
+	net_bench_put_u32(buffer + 12, 0);
+}
+
+/**
+ * Ends a UDP client run: sends the final datagram until the server answers with its report,
+ * which tells the lost and reordered datagrams.
+ * @param sock connected client socket.
+ * @param buffer NET_BENCH_BUFFER_SIZE bytes.
+ * @param datagrams datagrams sent.
+ */
+static void net_bench_udp_finish(int sock, char *buffer, uint32_t datagrams)
+{
+	net_bench_set_timeout(sock, SO_RCVTIMEO, NET_BENCH_POLL_MS);
+
+	for (int i = 0; i < NET_BENCH_UDP_FIN_TRIES; i++)
+	{
+		net_bench_udp_header(buffer, -(int32_t)datagrams);
+		send(sock, buffer, NET_BENCH_UDP_LEN, 0);
+
+		int len = recv(sock, buffer, NET_BENCH_BUFFER_SIZE, 0);
+		if (len < NET_BENCH_UDP_HEADER_LEN + NET_BENCH_UDP_REPORT_LEN)
+		{
+			continue;
+		}
+
+		// Older iperf 2 headers lack the upper sequence number word
+		const char *report = buffer + NET_BENCH_UDP_HEADER_LEN;
+		if (!(net_bench_get_u32(report) & NET_BENCH_UDP_REPORT_FLAG))
+		{
+			report -= 4;
+		}
+
+		taskENTER_CRITICAL(&s_result_lock);
+		s_result.lost = net_bench_get_u32(report + 20);
+		s_result.out_of_order = net_bench_get_u32(report + 24);
+		taskEXIT_CRITICAL(&s_result_lock);
+		return;
+	}
+
+	ESP_LOGI(TAG, "net_bench_udp_finish: no report from %s, loss unknown", s_host);
+}
+
+/**
+ * Client run over UDP: sends NET_BENCH_UDP_LEN datagrams paced to the bandwidth for the run time.
+ * Datagrams due are sent once per tick, a datagram the stack has no buffer for is sent again.
+ * @param buffer NET_BENCH_BUFFER_SIZE bytes.
+ * @return ESP_OK, ESP_FAIL.
+ */
+static esp_err_t net_bench_udp_client(char *buffer)
+{
+	uint64_t rate = MAX((uint64_t)s_config.bandwidth_kbps * 1000 / 8 / NET_BENCH_UDP_LEN, 1);
+	uint32_t id = 0;
+	esp_err_t err = ESP_OK;
+
+	int sock = net_bench_socket(SOCK_DGRAM, 0);
+	if (sock < 0)
+	{
+		return ESP_FAIL;
+	}
+	if (connect(sock, (struct sockaddr*)&s_peer, sizeof(s_peer)) != 0)
+	{
+		close(sock);
+		return ESP_FAIL;
+	}
+
+	net_bench_begin();
+
+	int64_t end_us = s_start_us + s_config.time_s * 1000000LL;
+	int64_t now;
+	while (!s_stop && (now = esp_timer_get_time()) < end_us)
+	{
+		if (id >= (uint64_t)(now - s_start_us) * rate / 1000000)
+		{
+			vTaskDelay(1);
+			continue;
+		}
+
+		net_bench_udp_header(buffer, id);
+		int len = send(sock, buffer, NET_BENCH_UDP_LEN, 0);
+		if (len > 0)
+		{
+			id++;
+			net_bench_count(len, 1);
+		}
+		else if (errno == ENOMEM || errno == ENOBUFS || errno == EAGAIN)
+		{
+			vTaskDelay(1);
+		}
+		else
+		{
+			ESP_LOGI(TAG, "net_bench_udp_client: send failed (errno %d)", errno);
+			err = ESP_FAIL;
+			break;
+		}
+	}
+
+	if (err == ESP_OK && id > 0)
+	{
+		net_bench_udp_finish(sock, buffer, id);
+	}
+
+	close(sock);
+	return err;
+}
+
+/**
+ * Benchmark task: one run, then it deletes itself.
+ * @param pvParameters parameter which can be passed to the task.
+ */
+static void net_bench_task(void *pvParameters)
+{
+	char *buffer = calloc(1, NET_BENCH_BUFFER_SIZE);
+	esp_err_t err;
+
+	s_began = false;
+
+	if (buffer == NULL)
+	{
+		err = ESP_ERR_NO_MEM;
+	}
+	else if (s_config.role == NET_BENCH_SERVER)
+	{
+		err = s_config.udp ? net_bench_udp_server(buffer) : net_bench_tcp_server(buffer);
+	}
+	else
+	{
+		err = s_config.udp ? net_bench_udp_client(buffer) : net_bench_tcp_client(buffer);
+	}
+
+	free(buffer);
+	net_bench_end(err);
+
+	net_bench_result_t result;
+	net_bench_get_result(&result);
+	ESP_LOGI(TAG, "net_bench_task: %s %s on %s: %s, %llu bytes in %lu ms, %lu kbit/s, %ld retransmits, %lu of %lu datagrams lost",
+			result.udp ? "UDP" : "TCP", result.role == NET_BENCH_SERVER ? "server" : "client",
+			result.netif[0] ? result.netif : "any", esp_err_to_name(err), result.bytes, result.elapsed_ms,
+			result.kbps, result.retransmits, result.lost, result.datagrams + result.lost);
+
+	vTaskDelete(NULL);
+}
+
+esp_err_t net_bench_start(const net_bench_config_t *config)
+{
+	esp_netif_t *netif = NULL;
+	esp_netif_ip_info_t ip_info = {0};
+	struct sockaddr_in peer = {
+			.sin_family = AF_INET,
+			.sin_port = htons(config->port ? config->port : NET_BENCH_DEFAULT_PORT),
+	};
+
+	if (config->time_s > NET_BENCH_MAX_TIME_S
+			|| (config->role == NET_BENCH_CLIENT
+					&& (config->host == NULL || inet_pton(AF_INET, config->host, &peer.sin_addr) != 1)))
+	{
+		return ESP_ERR_INVALID_ARG;
+	}
+
+	if (config->netif != NULL)
+	{
+		if (!net_bench_get_netif(config->netif, &netif))
+		{
+			return ESP_ERR_INVALID_ARG;
+		}
+		if (netif == NULL || esp_netif_get_ip_info(netif, &ip_info) != ESP_OK || ip_info.ip.addr == 0)
+		{
+			return ESP_ERR_INVALID_STATE;
+		}
+	}
+
+	taskENTER_CRITICAL(&s_result_lock);
+	bool busy = (s_result.state == NET_BENCH_WAITING || s_result.state == NET_BENCH_RUNNING);
+	if (!busy)
+	{
+		memset(&s_result, 0, sizeof(s_result));
+		s_result.state = NET_BENCH_WAITING;
+		s_result.udp = config->udp;
+		s_result.role = config->role;
+		s_result.retransmits = -1;
+		if (config->netif != NULL)
+		{
+			strncpy(s_result.netif, config->netif, sizeof(s_result.netif) - 1);
+		}
+	}
+	taskEXIT_CRITICAL(&s_result_lock);
+
+	if (busy)
+	{
+		return ESP_ERR_INVALID_STATE;
+	}
+
+	s_config = *config;
+	s_config.port = ntohs(peer.sin_port);
+	s_config.time_s = config->time_s ? config->time_s : 10;
+	s_config.bandwidth_kbps = config->bandwidth_kbps ? config->bandwidth_kbps : 10000;
+	s_config.netif = NULL;
+	s_config.host = s_host;
+	memset(s_host, 0, sizeof(s_host));
+	if (config->role == NET_BENCH_CLIENT)
+	{
+		strncpy(s_host, config->host, sizeof(s_host) - 1);
+	}
+	s_peer = peer;
+
+	memset(&s_ifr, 0, sizeof(s_ifr));
+	if (netif != NULL)
+	{
+		esp_netif_get_netif_impl_name(netif, s_ifr.ifr_name);
+	}
+	s_local_addr = ip_info.ip.addr;
+	s_stop = false;
+
+	if (xTaskCreatePinnedToCore(&net_bench_task, "net_bench", NET_BENCH_TASK_STACK_SIZE, NULL,
+			NET_BENCH_TASK_PRIORITY, NULL, NET_BENCH_TASK_CORE_ID) != pdPASS)
+	{
+		taskENTER_CRITICAL(&s_result_lock);
+		s_result.state = NET_BENCH_FAILED;
+		s_result.err = ESP_ERR_NO_MEM;
+		taskEXIT_CRITICAL(&s_result_lock);
+		return ESP_ERR_NO_MEM;
+	}
+
+	return ESP_OK;
+}
+
+void net_bench_stop(void)
+{
+	s_stop = true;
+}
+
+void net_bench_get_result(net_bench_result_t *result)
+{
+	taskENTER_CRITICAL(&s_result_lock);
+	*result = s_result;
+	taskEXIT_CRITICAL(&s_result_lock);
+}
@@ -0,0 +1,111 @@
+/*
+ * net_bench.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef MAIN_NET_BENCH_H_
+#define MAIN_NET_BENCH_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+// Default port of iperf 2
+#define NET_BENCH_DEFAULT_PORT		5001
+
+// Bytes per send or receive call of a TCP run, and the longest UDP datagram
+#define NET_BENCH_BUFFER_SIZE		8192
+
+// UDP datagram length of a client run, fits one 1500 byte frame
+#define NET_BENCH_UDP_LEN			1470
+
+// A server run fails if no client shows up within this time
+#define NET_BENCH_ACCEPT_TIMEOUT_S	30
+
+// A UDP server run ends this long after the last datagram if the client's final datagram was lost
+#define NET_BENCH_UDP_IDLE_MS		2000
+
+// Longest run
+#define NET_BENCH_MAX_TIME_S		300
+
+/**
+ * Direction of a run.
+ */
+typedef enum net_bench_role
+{
+	NET_BENCH_SERVER = 0,			// The device receives from a host "iperf -c <device> [-u]"
+	NET_BENCH_CLIENT,				// The device sends to a host "iperf -s [-u]"
+} net_bench_role_e;
+
+/**
+ * What a run measures.
+ */
+typedef struct net_bench_config
+{
+	bool udp;						// UDP, otherwise TCP
+	net_bench_role_e role;
+	const char *netif;				// "eth", "sta" or "ap", NULL for any interface
+	const char *host;				// IPv4 address of the host iperf server, client runs only
+	uint16_t port;					// 0 for NET_BENCH_DEFAULT_PORT
+	uint32_t time_s;				// Client run length, 0 for 10 s
+	uint32_t bandwidth_kbps;		// UDP client send rate, 0 for 10 Mbit/s
+} net_bench_config_t;
+
+/**
+ * Steps of a run.
+ */
+typedef enum net_bench_state
+{
+	NET_BENCH_IDLE = 0,
+	NET_BENCH_WAITING,				// Server run waiting for the client
+	NET_BENCH_RUNNING,
+	NET_BENCH_DONE,
+	NET_BENCH_FAILED,
+} net_bench_state_e;
+
+/**
+ * Progress and result of the last (or current) run.
+ */
+typedef struct net_bench_result
+{
+	net_bench_state_e state;
+	bool udp;
+	net_bench_role_e role;
+	char netif[4];					// Interface the run was bound to, "" for any
+	uint64_t bytes;					// Payload bytes sent or received
+	uint32_t elapsed_ms;
+	uint32_t kbps;					// Payload throughput
+	int32_t retransmits;			// TCP segments retransmitted by the device during the run, -1 if lwIP does not count them
+	uint32_t datagrams;				// UDP datagrams sent or received
+	uint32_t lost;					// UDP datagrams lost, seen by the receiver (the host's report for a client run)
+	uint32_t out_of_order;			// UDP datagrams out of order, seen by the receiver
+	uint32_t cpu_load[portNUM_PROCESSORS];	// Percent per core during the run
+	esp_err_t err;					// Why the run failed
+} net_bench_result_t;
+
+/**
+ * Starts a run in the benchmark task. The device speaks the iperf 2 protocol, so the host side is a
+ * stock iperf 2: a server run takes one TCP connection or UDP stream on the port and ends when the
+ * client finishes, a client run sends for time_s to the host's server (UDP paced to bandwidth_kbps).
+ * The socket is bound to the given interface, so each of W5500, WiFi station and soft AP can be measured.
+ * @param config what to measure, copied.
+ * @return ESP_OK, ESP_ERR_INVALID_STATE while a run is active or the interface has no address,
+ * ESP_ERR_INVALID_ARG for an unknown interface or host, ESP_ERR_NO_MEM.
+ */
+esp_err_t net_bench_start(const net_bench_config_t *config);
+
+/**
+ * Ends the current run early, its result covers what was measured so far.
+ */
+void net_bench_stop(void);
+
+/**
+ * Gets the progress or result of the last run.
+ * @param result receives it.
+ */
+void net_bench_get_result(net_bench_result_t *result);
+
+#endif /* MAIN_NET_BENCH_H_ */
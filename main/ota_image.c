@@ -0,0 +1,233 @@
+/*
+ * ota_image.c
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include <stdint.h>
+
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+
+#include "http_server.h"
+#include "ota_image.h"
+#include "ota_session.h"
+#include "ota_writer.h"
+
+// Tag used for ESP serial console messages
+static const char TAG[] = "ota_image";
+
+// Owner of the update partition: set from ota_image_begin to ota_image_end, or for one resumable
+// session call. One image is written at a time
+static bool s_busy = false;
+static portMUX_TYPE s_busy_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * Writes a piece of the (decompressed) firmware image to the partition,
+ * erasing it first where the OTA writer task has not done so yet.
+ * @param ctx image.
+ * @param data image bytes.
+ * @param len number of bytes.
+ * @return result of esp_ota_write.
+ */
+static esp_err_t ota_image_flash(void *ctx, const char *data, size_t len)
+{
+	ota_image_t *image = (ota_image_t*)ctx;
+
+	esp_err_t err = ota_writer_erase_to(image->written + len);
+	if (err != ESP_OK)
+	{
+		return err;
+	}
+
+	image->written += len;
+
+	return esp_ota_write(image->handle, data, len);
+}
+
+/**
+ * Takes the (decompressed) image: a firmware image is flashed as it is, a delta patch
+ * is applied to the image of the running partition first.
+ * @param ctx image.
+ * @param data image or patch bytes.
+ * @param len number of bytes.
+ * @return ESP_OK, otherwise the patch or write error.
+ */
+static esp_err_t ota_image_decompressed(void *ctx, const char *data, size_t len)
+{
+	ota_image_t *image = (ota_image_t*)ctx;
+
+	// Firmware images start with 0xE9, patches with "EDP1"
+	if (!image->image_started && len > 0)
+	{
+		image->image_started = true;
+
+		if (data[0] == DELTA_PATCH_MAGIC[0])
+		{
+			ESP_LOGI(TAG, "ota_image_decompressed: delta patch");
+
+			image->patch = delta_patch_create(esp_ota_get_running_partition(), ota_image_flash, image);
+			if (image->patch == NULL)
+			{
+				return ESP_ERR_NO_MEM;
+			}
+
+			// The upload size no longer bounds the image
+			ota_writer_set_image_size(SIZE_MAX);
+		}
+	}
+
+	image->received += len;
+
+	if (image->patch != NULL)
+	{
+		return delta_patch_feed(image->patch, data, len);
+	}
+
+	return ota_image_flash(image, data, len);
+}
+
+bool ota_image_try_lock(void)
+{
+	taskENTER_CRITICAL(&s_busy_lock);
+	bool busy = s_busy;
+	s_busy = true;
+	taskEXIT_CRITICAL(&s_busy_lock);
+
+	return !busy;
+}
+
+void ota_image_unlock(void)
+{
+	taskENTER_CRITICAL(&s_busy_lock);
+	s_busy = false;
+	taskEXIT_CRITICAL(&s_busy_lock);
+}
+
+esp_err_t ota_image_begin(ota_image_t *image, size_t upload_size)
+{
+	if (!ota_image_try_lock())
+	{
+		ESP_LOGI(TAG, "ota_image_begin: Another update is being written");
+		return ESP_ERR_INVALID_STATE;
+	}
+
+	image->partition = esp_ota_get_next_update_partition(NULL);
+	if (image->partition == NULL)
+	{
+		ESP_LOGI(TAG, "ota_image_begin: No OTA partition");
+		ota_image_unlock();
+		return ESP_ERR_NOT_FOUND;
+	}
+
+	if (upload_size > image->partition->size)
+	{
+		ESP_LOGI(TAG, "ota_image_begin: Image larger than the partition (%lu bytes)", image->partition->size);
+		ota_image_unlock();
+		return ESP_ERR_INVALID_SIZE;
+	}
+
+	// The upload overwrites the chunks of a resumable session
+	ota_session_discard();
+
+	// esp_ota_begin only erases the first sector, instead of the whole partition before the first write,
+	// the OTA writer task erases the rest of the image range while the upload is received
+	esp_err_t err = esp_ota_begin(image->partition, image->partition->erase_size, &image->handle);
+	if (err != ESP_OK)
+	{
+		ESP_LOGI(TAG, "ota_image_begin: Error with OTA begin (%s)", esp_err_to_name(err));
+		ota_image_unlock();
+		return err;
+	}
+
+	ESP_LOGI(TAG, "ota_image_begin: Writing to partition subtype %d at offset 0x%lx", image->partition->subtype, image->partition->address);
+
+	return ESP_OK;
+}
+
+esp_err_t ota_image_write(void *ctx, const char *data, size_t len)
+{
+	ota_image_t *image = (ota_image_t*)ctx;
+
+	// Firmware images start with 0xE9, gzip streams with 1f 8b
+	if (!image->started && len > 0)
+	{
+		image->started = true;
+
+		if ((uint8_t)data[0] == GZIP_INFLATE_MAGIC_0)
+		{
+			ESP_LOGI(TAG, "ota_image_write: gzip compressed image");
+
+			image->inflate = gzip_inflate_create(ota_image_decompressed, image);
+			if (image->inflate == NULL)
+			{
+				return ESP_ERR_NO_MEM;
+			}
+
+			// The upload size no longer bounds the image
+			ota_writer_set_image_size(SIZE_MAX);
+		}
+	}
+
+	if (image->inflate != NULL)
+	{
+		return gzip_inflate_feed(image->inflate, data, len);
+	}
+
+	return ota_image_decompressed(image, data, len);
+}
+
+esp_err_t ota_image_end(ota_image_t *image, esp_err_t err)
+{
+	if (image->inflate != NULL)
+	{
+		if (err == ESP_OK)
+		{
+			err = gzip_inflate_finish(image->inflate);
+		}
+		ESP_LOGI(TAG, "ota_image_end: decompressed to %d bytes", (int)image->received);
+		gzip_inflate_delete(image->inflate);
+		image->inflate = NULL;
+	}
+
+	// The rebuilt image must match the target SHA-256 of the patch before it can be booted
+	if (image->patch != NULL)
+	{
+		if (err == ESP_OK)
+		{
+			err = delta_patch_finish(image->patch);
+		}
+		ESP_LOGI(TAG, "ota_image_end: %d byte patch rebuilt %d byte image", (int)image->received, (int)image->written);
+		delta_patch_delete(image->patch);
+		image->patch = NULL;
+	}
+
+	if (err != ESP_OK)
+	{
+		ESP_LOGI(TAG, "ota_image_end: Upload ERROR %s!!!", esp_err_to_name(err));
+		esp_ota_abort(image->handle);
+	}
+	else if ((err = esp_ota_end(image->handle)) == ESP_OK)
+	{
+		if ((err = esp_ota_set_boot_partition(image->partition)) == ESP_OK)
+		{
+			const esp_partition_t *boot_partition = esp_ota_get_boot_partition();
+			ESP_LOGI(TAG, "ota_image_end: Next boot partition subtype %d at offset 0x%lx", boot_partition->subtype, boot_partition->address);
+		}
+		else
+		{
+			ESP_LOGI(TAG, "ota_image_end: FLASHED ERROR %s!!!", esp_err_to_name(err));
+		}
+	}
+	else
+	{
+		ESP_LOGI(TAG, "ota_image_end: esp_ota_end ERROR %s!!!", esp_err_to_name(err));
+	}
+
+	ota_image_unlock();
+
+	// The monitor updates the OTA status and restarts the device after a successful update
+	http_server_monitor_send_message((err == ESP_OK) ? HTTP_MSG_OTA_UPDATE_SUCCESSFUL : HTTP_MSG_OTA_UPDATE_FAILED);
+
+	return err;
+}
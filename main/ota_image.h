@@ -0,0 +1,80 @@
+/*
+ * ota_image.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef MAIN_OTA_IMAGE_H_
+#define MAIN_OTA_IMAGE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "esp_err.h"
+#include "esp_ota_ops.h"
+#include "esp_partition.h"
+
+#include "delta_patch.h"
+#include "gzip_inflate.h"
+
+/**
+ * Firmware image of an upload (HTTP or TCP), written by the OTA writer task.
+ */
+typedef struct ota_image
+{
+	const esp_partition_t *partition;	// Next update partition
+	esp_ota_handle_t handle;
+	gzip_inflate_t *inflate;		// Decompressor of a gzip compressed image, NULL otherwise
+	delta_patch_t *patch;			// Applier of a delta patch, NULL otherwise
+	bool started;					// The first byte decided whether the image is compressed
+	bool image_started;				// The first (decompressed) byte decided whether the image is a patch
+	size_t received;				// Image or patch bytes after decompression
+	size_t written;					// Image bytes written to the partition
+} ota_image_t;
+
+/**
+ * Claims the update partition for a writer that does not go through ota_image_begin
+ * (a resumable session call). Never blocks.
+ * @return true if the partition was free, the caller releases it with ota_image_unlock.
+ */
+bool ota_image_try_lock(void);
+
+/**
+ * Releases the update partition claimed with ota_image_try_lock.
+ */
+void ota_image_unlock(void);
+
+/**
+ * Starts writing an image to the next update partition. Only the first sector is erased,
+ * the OTA writer task (started by the caller on image->partition) erases the rest ahead of the writes.
+ * A resumable session is ended, the partition no longer holds its chunks. Until ota_image_end,
+ * other uploads (HTTP, pull, TCP) are refused.
+ * @param image image, zeroed by the caller.
+ * @param upload_size size of the upload if known, it must fit the partition; 0 otherwise.
+ * @return ESP_OK, ESP_ERR_INVALID_STATE while another image is written, ESP_ERR_NOT_FOUND without
+ * an update partition, ESP_ERR_INVALID_SIZE if the upload does not fit, otherwise the esp_ota_begin error.
+ */
+esp_err_t ota_image_begin(ota_image_t *image, size_t upload_size);
+
+/**
+ * Takes the uploaded bytes, OTA writer sink (ctx is the image). A gzip compressed image is
+ * decompressed on the way, a delta patch made by tools/delta_patch.py is applied to the image of
+ * the running partition, anything else is flashed as it is. Writer task only.
+ * @param ctx image.
+ * @param data image bytes as uploaded.
+ * @param len number of bytes.
+ * @return ESP_OK, otherwise the decompression, patch or write error.
+ */
+esp_err_t ota_image_write(void *ctx, const char *data, size_t len);
+
+/**
+ * Ends the image once ota_writer_finish returned: checks the decompressed stream and the rebuilt
+ * patch target, then either makes the partition the boot partition or drops the image.
+ * The result goes to the HTTP server monitor, which restarts the device after a successful update.
+ * @param image image.
+ * @param err result of the upload so far, ESP_OK if everything was received and written.
+ * @return ESP_OK if the image boots next, otherwise the first error.
+ */
+esp_err_t ota_image_end(ota_image_t *image, esp_err_t err);
+
+#endif /* MAIN_OTA_IMAGE_H_ */
@@ -0,0 +1,446 @@
+/*
+ * ota_pull.c
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "cJSON.h"
+#include "esp_crt_bundle.h"
+#include "esp_http_client.h"
+#include "esp_log.h"
+#include "esp_ota_ops.h"
+#include "mbedtls/sha256.h"
+#include "net/if.h"
+#include "sys/param.h"
+
+#include "ethernet_app.h"
+#include "http_server.h"
+#include "ota_image.h"
+#include "ota_pull.h"
+#include "ota_writer.h"
+#include "tasks_common.h"
+
+// Tag used for ESP serial console messages
+static const char TAG[] = "ota_pull";
+
+// Largest manifest accepted, it is a small JSON object
+#define OTA_PULL_MANIFEST_LEN		512
+
+// Socket timeout of the HTTP requests
+#define OTA_PULL_TIMEOUT_MS			10000
+
+/**
+ * Image being pulled, hashed and written by the OTA writer task
+ */
+typedef struct ota_pull_image
+{
+	ota_image_t image;
+	mbedtls_sha256_context sha;
+	size_t hashed;					// Bytes downloaded and hashed
+} ota_pull_image_t;
+
+// Task handle of the pull task
+static TaskHandle_t task_ota_pull = NULL;
+
+// Manifest URL of the current pull
+static char s_manifest_url[OTA_PULL_URL_LEN];
+
+// Progress, updated by the pull task and read by the HTTP server
+static ota_pull_status_t s_status;
+static portMUX_TYPE s_status_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * Moves the pull on to the next step.
+ */
+static void ota_pull_set_state(ota_pull_state_e state, esp_err_t err)
+{
+	taskENTER_CRITICAL(&s_status_lock);
+	s_status.state = state;
+	s_status.err = err;
+	taskEXIT_CRITICAL(&s_status_lock);
+}
+
+/**
+ * OTA writer sink: hashes the download and hands it to the image (flashed, decompressed or patched)
+ * in the writer task, while the pull task receives the next buffers.
+ * @param ctx pulled image.
+ * @param data downloaded bytes.
+ * @param len number of bytes.
+ * @return result of ota_image_write.
+ */
+static esp_err_t ota_pull_write(void *ctx, const char *data, size_t len)
+{
+	ota_pull_image_t *pull = (ota_pull_image_t*)ctx;
+
+	pull->hashed += len;
+	mbedtls_sha256_update(&pull->sha, (const unsigned char*)data, len);
+
+	return ota_image_write(&pull->image, data, len);
+}
+
+/**
+ * Resolves the image URL of the manifest against the manifest URL.
+ * @param url absolute URL, absolute path or path relative to the manifest.
+ * @param image_url receives the absolute URL, OTA_PULL_URL_LEN bytes.
+ * @return ESP_OK, ESP_ERR_INVALID_SIZE if the URL is too long.
+ */
+static esp_err_t ota_pull_resolve_url(const char *url, char *image_url)
+{
+	size_t base_len;
+
+	if (strstr(url, "://") != NULL)
+	{
+		base_len = 0;
+	}
+	else if (url[0] == '/')
+	{
+		const char *path = strchr(strstr(s_manifest_url, "://") + 3, '/');
+		base_len = (path != NULL) ? (size_t)(path - s_manifest_url) : strlen(s_manifest_url);
+	}
+	else
+	{
+		base_len = strrchr(s_manifest_url, '/') - s_manifest_url + 1;
+	}
+
+	if (base_len + strlen(url) >= OTA_PULL_URL_LEN)
+	{
+		return ESP_ERR_INVALID_SIZE;
+	}
+
+	memcpy(image_url, s_manifest_url, base_len);
+	strcpy(image_url + base_len, url);
+
+	return ESP_OK;
+}
+
+/**
+ * Parses the manifest.
+ * @return ESP_OK, ESP_ERR_INVALID_RESPONSE if a member is missing or malformed.
+ */
+static esp_err_t ota_pull_parse_manifest(const char *json, size_t len, char *image_url, uint32_t *size, uint8_t *sha256)
+{
+	esp_err_t err = ESP_ERR_INVALID_RESPONSE;
+	cJSON *root = cJSON_ParseWithLength(json, len);
+
+	const cJSON *url = cJSON_GetObjectItem(root, "url");
+	const cJSON *image_size = cJSON_GetObjectItem(root, "size");
+	const cJSON *hash = cJSON_GetObjectItem(root, "sha256");
+
+	if (cJSON_IsString(url) && cJSON_IsNumber(image_size) && image_size->valuedouble > 0
+			&& cJSON_IsString(hash) && strlen(hash->valuestring) == 64)
+	{
+		err = ESP_OK;
+		for (int i = 0; i < 32 && err == ESP_OK; i++)
+		{
+			char byte_str[3] = { hash->valuestring[2 * i], hash->valuestring[2 * i + 1], '\0' };
+			char *end;
+
+			sha256[i] = strtoul(byte_str, &end, 16);
+			if (*end != '\0')
+			{
+				err = ESP_ERR_INVALID_RESPONSE;
+			}
+		}
+
+		*size = (uint32_t)image_size->valuedouble;
+		if (err == ESP_OK)
+		{
+			err = ota_pull_resolve_url(url->valuestring, image_url);
+		}
+	}
+
+	cJSON_Delete(root);
+	return err;
+}
+
+/**
+ * Fetches and parses the manifest.
+ * @param config HTTP client configuration, the URL is set here.
+ * @return ESP_OK, otherwise the HTTP or manifest error.
+ */
+static esp_err_t ota_pull_fetch_manifest(esp_http_client_config_t *config, char *image_url, uint32_t *size, uint8_t *sha256)
+{
+	char *json = malloc(OTA_PULL_MANIFEST_LEN);
+	esp_err_t err;
+
+	config->url = s_manifest_url;
+	esp_http_client_handle_t client = esp_http_client_init(config);
+	if (json == NULL || client == NULL)
+	{
+		free(json);
+		esp_http_client_cleanup(client);
+		return ESP_ERR_NO_MEM;
+	}
+
+	if ((err = esp_http_client_open(client, 0)) == ESP_OK)
+	{
+		esp_http_client_fetch_headers(client);
+
+		int status = esp_http_client_get_status_code(client);
+		int len = esp_http_client_read_response(client, json, OTA_PULL_MANIFEST_LEN);
+
+		if (status != 200 || len <= 0)
+		{
+			ESP_LOGI(TAG, "ota_pull_fetch_manifest: HTTP status %d, %d bytes", status, len);
+			err = ESP_ERR_INVALID_RESPONSE;
+		}
+		else
+		{
+			err = ota_pull_parse_manifest(json, len, image_url, size, sha256);
+		}
+	}
+
+	esp_http_client_cleanup(client);
+	free(json);
+
+	return err;
+}
+
+/**
+ * Fetches the image in range requests into the OTA writer buffers. A failed request is sent
+ * again from the last byte received, the connection is kept between requests.
+ * @param config HTTP client configuration, the URL is set here.
+ * @return ESP_OK once size bytes were received, otherwise the error of the last attempt.
+ */
+static esp_err_t ota_pull_download(esp_http_client_config_t *config, const char *image_url, uint32_t size)
+{
+	char range[32];
+	uint32_t offset = 0;
+	int retries = 0;
+	bool reused = false;			// The request goes out on the connection of the previous one
+	esp_err_t err = ESP_OK;
+
+	config->url = image_url;
+	esp_http_client_handle_t client = esp_http_client_init(config);
+	if (client == NULL)
+	{
+		return ESP_ERR_NO_MEM;
+	}
+
+	while (offset < size && err == ESP_OK)
+	{
+		uint32_t end = MIN(offset + OTA_PULL_RANGE_SIZE, size);
+		esp_err_t req_err;
+
+		snprintf(range, sizeof(range), "bytes=%lu-%lu", offset, end - 1);
+		esp_http_client_set_header(client, "Range", range);
+
+		if ((req_err = esp_http_client_open(client, 0)) == ESP_OK)
+		{
+			int64_t content_length = esp_http_client_fetch_headers(client);
+			int status = esp_http_client_get_status_code(client);
+
+			// A server without range support sends the whole image, fine for the first request
+			if (status == 200 && offset == 0 && content_length == size)
+			{
+				end = size;
+			}
+			else if (status != 206 || content_length != end - offset)
+			{
+				ESP_LOGI(TAG, "ota_pull_download: HTTP status %d, %lld bytes for %s", status, content_length, range);
+				req_err = ESP_ERR_INVALID_RESPONSE;
+			}
+		}
+
+		while (req_err == ESP_OK && offset < end)
+		{
+			size_t buff_size;
+			char *buff = ota_writer_get_buffer(&buff_size);
+
+			// NULL once the writer failed, ota_writer_finish reports why
+			if (buff == NULL)
+			{
+				err = ESP_FAIL;
+				break;
+			}
+
+			int len = esp_http_client_read(client, buff, MIN(buff_size, end - offset));
+			if (len <= 0)
+			{
+				ota_writer_submit(buff, 0);
+				req_err = ESP_ERR_TIMEOUT;
+				break;
+			}
+			ota_writer_submit(buff, len);
+			offset += len;
+
+			taskENTER_CRITICAL(&s_status_lock);
+			s_status.bytes = offset;
+			taskEXIT_CRITICAL(&s_status_lock);
+		}
+
+		if (req_err == ESP_OK)
+		{
+			retries = 0;
+			reused = true;
+			continue;
+		}
+
+		esp_http_client_close(client);
+
+		// The server may have closed the kept connection meanwhile, that is not a failure
+		if (reused)
+		{
+			reused = false;
+			continue;
+		}
+
+		if (++retries > OTA_PULL_MAX_RETRIES)
+		{
+			err = req_err;
+			break;
+		}
+
+		ESP_LOGI(TAG, "ota_pull_download: retry %d at %lu of %lu bytes", retries, offset, size);
+		taskENTER_CRITICAL(&s_status_lock);
+		s_status.retries++;
+		taskEXIT_CRITICAL(&s_status_lock);
+		vTaskDelay(pdMS_TO_TICKS(1000 * retries));
+	}
+
+	esp_http_client_cleanup(client);
+	return err;
+}
+
+/**
+ * Pull task: manifest, image, verification, then the result goes to the HTTP server monitor,
+ * which restarts the device after a successful update.
+ * @param pvParameters parameter which can be passed to the task.
+ */
+static void ota_pull_task(void *pvParameters)
+{
+	char *image_url = malloc(OTA_PULL_URL_LEN);
+	uint8_t sha256[32];
+	uint8_t digest[32];
+	uint32_t size = 0;
+	ota_pull_image_t pull = {0};
+	bool began = false;				// ota_image_end reports the result from then on
+	struct ifreq ifr = {0};
+	esp_err_t err;
+
+	esp_http_client_config_t config = {
+			.timeout_ms = OTA_PULL_TIMEOUT_MS,
+			.crt_bundle_attach = esp_crt_bundle_attach,
+	};
+
+	// Bound to the W5500 uplink while it is up, otherwise the default route is taken
+	if (esp_netif_eth != NULL && esp_netif_is_netif_up(esp_netif_eth)
+			&& esp_netif_get_netif_impl_name(esp_netif_eth, ifr.ifr_name) == ESP_OK)
+	{
+		config.if_name = &ifr;
+	}
+
+	ESP_LOGI(TAG, "ota_pull_task: manifest %s via %s", s_manifest_url, config.if_name ? ifr.ifr_name : "default route");
+
+	err = (image_url != NULL) ? ota_pull_fetch_manifest(&config, image_url, &size, sha256) : ESP_ERR_NO_MEM;
+
+	if (err == ESP_OK)
+	{
+		ESP_LOGI(TAG, "ota_pull_task: %lu byte image %s", size, image_url);
+
+		taskENTER_CRITICAL(&s_status_lock);
+		s_status.state = OTA_PULL_DOWNLOADING;
+		s_status.total = size;
+		taskEXIT_CRITICAL(&s_status_lock);
+
+		// Shared with uploads: partition, erase ahead, gzip and delta patches, boot switch and status
+		err = ota_image_begin(&pull.image, size);
+		began = (err == ESP_OK);
+		if (began)
+		{
+			mbedtls_sha256_init(&pull.sha);
+			mbedtls_sha256_starts(&pull.sha, 0);
+
+			err = ota_writer_start(ota_pull_write, &pull, pull.image.partition, pull.image.partition->erase_size, size,
+					CONFIG_HTTP_OTA_RECV_BUFFER_SIZE);
+			if (err == ESP_OK)
+			{
+				err = ota_pull_download(&config, image_url, size);
+
+				// Waits until everything received is hashed and written
+				esp_err_t write_err = ota_writer_finish();
+				if (err == ESP_OK || err == ESP_FAIL)
+				{
+					err = (write_err != ESP_OK) ? write_err : err;
+				}
+			}
+
+			mbedtls_sha256_finish(&pull.sha, digest);
+			mbedtls_sha256_free(&pull.sha);
+
+			if (err == ESP_OK)
+			{
+				ota_pull_set_state(OTA_PULL_VERIFYING, ESP_OK);
+
+				if (pull.hashed != size || memcmp(digest, sha256, sizeof(digest)) != 0)
+				{
+					ESP_LOGI(TAG, "ota_pull_task: image SHA-256 does not match the manifest");
+					err = ESP_ERR_INVALID_CRC;
+				}
+			}
+
+			err = ota_image_end(&pull.image, err);
+		}
+	}
+
+	free(image_url);
+
+	ESP_LOGI(TAG, "ota_pull_task: %s", esp_err_to_name(err));
+	ota_pull_set_state((err == ESP_OK) ? OTA_PULL_DONE : OTA_PULL_FAILED, err);
+
+	if (!began)
+	{
+		http_server_monitor_send_message(HTTP_MSG_OTA_UPDATE_FAILED);
+	}
+
+	task_ota_pull = NULL;
+	vTaskDelete(NULL);
+}
+
+esp_err_t ota_pull_start(const char *manifest_url)
+{
+	if (strlen(manifest_url) >= OTA_PULL_URL_LEN
+			|| (strncmp(manifest_url, "http://", 7) != 0 && strncmp(manifest_url, "https://", 8) != 0))
+	{
+		return ESP_ERR_INVALID_ARG;
+	}
+
+	taskENTER_CRITICAL(&s_status_lock);
+	bool busy = (s_status.state == OTA_PULL_MANIFEST || s_status.state == OTA_PULL_DOWNLOADING
+			|| s_status.state == OTA_PULL_VERIFYING);
+	if (!busy)
+	{
+		memset(&s_status, 0, sizeof(s_status));
+		s_status.state = OTA_PULL_MANIFEST;
+	}
+	taskEXIT_CRITICAL(&s_status_lock);
+
+	if (busy)
+	{
+		return ESP_ERR_INVALID_STATE;
+	}
+
+	strcpy(s_manifest_url, manifest_url);
+
+	if (xTaskCreatePinnedToCore(&ota_pull_task, "ota_pull", OTA_PULL_TASK_STACK_SIZE, NULL,
+			OTA_PULL_TASK_PRIORITY, &task_ota_pull, OTA_PULL_TASK_CORE_ID) != pdPASS)
+	{
+		ota_pull_set_state(OTA_PULL_FAILED, ESP_ERR_NO_MEM);
+		return ESP_ERR_NO_MEM;
+	}
+
+	return ESP_OK;
+}
+
+void ota_pull_get_status(ota_pull_status_t *status)
+{
+	taskENTER_CRITICAL(&s_status_lock);
+	*status = s_status;
+	taskEXIT_CRITICAL(&s_status_lock);
+}
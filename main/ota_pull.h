@@ -0,0 +1,66 @@
+/*
+ * ota_pull.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef MAIN_OTA_PULL_H_
+#define MAIN_OTA_PULL_H_
+
+#include <stdint.h>
+
+#include "esp_err.h"
+
+// Longest manifest and image URL
+#define OTA_PULL_URL_LEN			256
+
+// Image bytes requested per HTTP range request, a failed request is retried from its last byte
+#define OTA_PULL_RANGE_SIZE			(64 * 1024)
+
+// Failed requests in a row before the pull gives up
+#define OTA_PULL_MAX_RETRIES		5
+
+/**
+ * Steps of a pull update.
+ */
+typedef enum ota_pull_state
+{
+	OTA_PULL_IDLE = 0,
+	OTA_PULL_MANIFEST,				// Fetching the manifest
+	OTA_PULL_DOWNLOADING,			// Fetching and flashing the image
+	OTA_PULL_VERIFYING,				// Checking the image SHA-256 and boot partition
+	OTA_PULL_DONE,					// The device restarts into the new image
+	OTA_PULL_FAILED,
+} ota_pull_state_e;
+
+/**
+ * Progress of the last (or current) pull update.
+ */
+typedef struct ota_pull_status
+{
+	ota_pull_state_e state;
+	uint32_t bytes;					// Image bytes received
+	uint32_t total;					// Image size from the manifest
+	uint32_t retries;				// Range requests sent again
+	esp_err_t err;					// Why the pull failed
+} ota_pull_status_t;
+
+/**
+ * Starts a pull update: a task fetches the manifest, a JSON object
+ *   { "url": "<image URL, absolute or relative to the manifest>", "size": <bytes>, "sha256": "<64 hex digits>" }
+ * then the image in HTTP range requests over the Ethernet uplink (the default route if it is down),
+ * hashing it while the OTA writer task flashes it. Like an upload, the image may be gzip compressed
+ * or a delta patch (size and SHA-256 are those of the file then). The boot partition is only switched
+ * if the SHA-256 matches the manifest, the result is sent to the HTTP server monitor like an upload.
+ * @param manifest_url http:// or https:// URL of the manifest.
+ * @return ESP_OK, ESP_ERR_INVALID_STATE while a pull runs, ESP_ERR_INVALID_ARG for a too long URL.
+ */
+esp_err_t ota_pull_start(const char *manifest_url);
+
+/**
+ * Gets the progress of the last (or current) pull update.
+ * @param status receives the progress.
+ */
+void ota_pull_get_status(ota_pull_status_t *status);
+
+#endif /* MAIN_OTA_PULL_H_ */
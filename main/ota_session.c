@@ -0,0 +1,327 @@
+/*
+ * ota_session.c
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_ota_ops.h"
+#include "esp_rom_crc.h"
+#include "mbedtls/sha256.h"
+#include "sdkconfig.h"
+
+#include "app_nvs.h"
+#include "ota_image.h"
+#include "ota_session.h"
+
+// Tag used for ESP serial console messages
+static const char TAG[] = "ota_session";
+
+// Bytes read back from flash at a time
+#define OTA_SESSION_READ_LEN		256
+
+// Session cached from NVS. Only used by the owner of the update partition (ota_image_try_lock),
+// an upload task in ota_image_begin or the httpd task during one session call
+static ota_session_t ota_session;
+static bool ota_session_loaded = false;
+static bool ota_session_valid = false;
+
+/**
+ * Drops the session, also one stored before this boot that was never loaded.
+ */
+static void ota_session_clear(void)
+{
+	ota_session_loaded = true;
+	ota_session_valid = false;
+	app_nvs_clear_ota_session();
+}
+
+/**
+ * Loads the session from NVS on first use and drops it if the update partition changed since.
+ * @return update partition, NULL if there is none.
+ */
+static const esp_partition_t* ota_session_load(void)
+{
+	const esp_partition_t *partition = esp_ota_get_next_update_partition(NULL);
+
+	if (!ota_session_loaded)
+	{
+		ota_session_loaded = true;
+		ota_session_valid = app_nvs_load_ota_session(&ota_session);
+		if (ota_session_valid)
+		{
+			ESP_LOGI(TAG, "ota_session_load: resuming at %lu of %lu bytes", ota_session.offset, ota_session.image_size);
+		}
+	}
+
+	if (ota_session_valid && (partition == NULL || ota_session.partition_address != partition->address
+			|| ota_session.image_size > partition->size || ota_session.offset > ota_session.image_size
+			|| ota_session.chunk_size == 0 || ota_session.chunk_size % partition->erase_size != 0))
+	{
+		ESP_LOGI(TAG, "ota_session_load: stored session does not match the update partition");
+		ota_session_clear();
+	}
+
+	return partition;
+}
+
+/**
+ * Checks what the chunk write left in flash.
+ * @return ESP_OK if the flash holds bytes with the CRC-32 crc.
+ */
+static esp_err_t ota_session_verify(const esp_partition_t *partition, uint32_t offset, size_t len, uint32_t crc)
+{
+	uint8_t buf[OTA_SESSION_READ_LEN];
+	uint32_t flash_crc = 0;
+
+	for (size_t done = 0; done < len; done += OTA_SESSION_READ_LEN)
+	{
+		size_t n = (len - done < OTA_SESSION_READ_LEN) ? len - done : OTA_SESSION_READ_LEN;
+
+		esp_err_t err = esp_partition_read(partition, offset + done, buf, n);
+		if (err != ESP_OK)
+		{
+			return err;
+		}
+		flash_crc = esp_rom_crc32_le(flash_crc, buf, n);
+	}
+
+	return (flash_crc == crc) ? ESP_OK : ESP_ERR_INVALID_CRC;
+}
+
+/**
+ * Computes the SHA-256 of the image in the update partition.
+ */
+static esp_err_t ota_session_image_sha256(const esp_partition_t *partition, uint32_t size, uint8_t *digest)
+{
+	mbedtls_sha256_context sha;
+	uint8_t buf[OTA_SESSION_READ_LEN];
+	esp_err_t err = ESP_OK;
+
+	mbedtls_sha256_init(&sha);
+	mbedtls_sha256_starts(&sha, 0);
+
+	for (uint32_t offset = 0; offset < size && err == ESP_OK; offset += OTA_SESSION_READ_LEN)
+	{
+		size_t n = (size - offset < OTA_SESSION_READ_LEN) ? size - offset : OTA_SESSION_READ_LEN;
+
+		err = esp_partition_read(partition, offset, buf, n);
+		mbedtls_sha256_update(&sha, buf, n);
+	}
+
+	mbedtls_sha256_finish(&sha, digest);
+	mbedtls_sha256_free(&sha);
+
+	return err;
+}
+
+static esp_err_t ota_session_begin_locked(uint32_t image_size, const uint8_t *sha256, ota_session_t *session)
+{
+	const esp_partition_t *partition = ota_session_load();
+
+	if (partition == NULL)
+	{
+		return ESP_ERR_NOT_FOUND;
+	}
+	if (image_size == 0 || image_size > partition->size)
+	{
+		return ESP_ERR_INVALID_SIZE;
+	}
+
+	// The same image again: the client resumes
+	if (ota_session_valid && ota_session.image_size == image_size && ota_session.has_sha256 == (sha256 != NULL)
+			&& (sha256 == NULL || memcmp(ota_session.sha256, sha256, sizeof(ota_session.sha256)) == 0))
+	{
+		*session = ota_session;
+		return ESP_OK;
+	}
+
+	memset(&ota_session, 0, sizeof(ota_session));
+	ota_session.partition_address = partition->address;
+	ota_session.image_size = image_size;
+	ota_session.chunk_size = CONFIG_HTTP_OTA_SESSION_CHUNK_SIZE - CONFIG_HTTP_OTA_SESSION_CHUNK_SIZE % partition->erase_size;
+	if (ota_session.chunk_size == 0)
+	{
+		ota_session.chunk_size = partition->erase_size;
+	}
+	if (sha256 != NULL)
+	{
+		memcpy(ota_session.sha256, sha256, sizeof(ota_session.sha256));
+		ota_session.has_sha256 = true;
+	}
+
+	esp_err_t err = app_nvs_save_ota_session(&ota_session);
+	if (err != ESP_OK)
+	{
+		return err;
+	}
+	ota_session_valid = true;
+
+	ESP_LOGI(TAG, "ota_session_begin: %lu byte image in %lu byte chunks", image_size, ota_session.chunk_size);
+
+	*session = ota_session;
+	return ESP_OK;
+}
+
+static esp_err_t ota_session_get_locked(ota_session_t *session)
+{
+	ota_session_load();
+
+	if (!ota_session_valid)
+	{
+		return ESP_ERR_NOT_FOUND;
+	}
+
+	*session = ota_session;
+	return ESP_OK;
+}
+
+static esp_err_t ota_session_write_locked(uint32_t offset, const void *data, size_t len, uint32_t crc)
+{
+	const esp_partition_t *partition = ota_session_load();
+	esp_err_t err;
+
+	if (!ota_session_valid)
+	{
+		return ESP_ERR_NOT_FOUND;
+	}
+	if (offset != ota_session.offset)
+	{
+		return ESP_ERR_INVALID_STATE;
+	}
+	if (len == 0 || len > ota_session.image_size - offset
+			|| (len != ota_session.chunk_size && offset + len != ota_session.image_size))
+	{
+		return ESP_ERR_INVALID_SIZE;
+	}
+	if (esp_rom_crc32_le(0, data, len) != crc)
+	{
+		return ESP_ERR_INVALID_CRC;
+	}
+
+	// Chunks start on a sector boundary: a chunk sent again after a failure is erased and written whole
+	size_t erase_len = (len + partition->erase_size - 1) / partition->erase_size * partition->erase_size;
+	if ((err = esp_partition_erase_range(partition, offset, erase_len)) != ESP_OK
+			|| (err = esp_partition_write(partition, offset, data, len)) != ESP_OK
+			|| (err = ota_session_verify(partition, offset, len, crc)) != ESP_OK)
+	{
+		ESP_LOGI(TAG, "ota_session_write: chunk at %lu failed (%s)", offset, esp_err_to_name(err));
+		return err;
+	}
+
+	ota_session.offset += len;
+
+	return app_nvs_save_ota_session(&ota_session);
+}
+
+static esp_err_t ota_session_finalize_locked(void)
+{
+	const esp_partition_t *partition = ota_session_load();
+	esp_err_t err;
+
+	if (!ota_session_valid)
+	{
+		return ESP_ERR_NOT_FOUND;
+	}
+	if (ota_session.offset != ota_session.image_size)
+	{
+		return ESP_ERR_INVALID_STATE;
+	}
+
+	if (ota_session.has_sha256)
+	{
+		uint8_t digest[32];
+
+		if ((err = ota_session_image_sha256(partition, ota_session.image_size, digest)) != ESP_OK)
+		{
+			return err;
+		}
+		if (memcmp(digest, ota_session.sha256, sizeof(digest)) != 0)
+		{
+			ESP_LOGI(TAG, "ota_session_finalize: image SHA-256 mismatch");
+			return ESP_ERR_INVALID_CRC;
+		}
+	}
+
+	// Verifies the image (header, segments, appended hash) before it is marked bootable
+	if ((err = esp_ota_set_boot_partition(partition)) != ESP_OK)
+	{
+		ESP_LOGI(TAG, "ota_session_finalize: esp_ota_set_boot_partition failed (%s)", esp_err_to_name(err));
+		return err;
+	}
+
+	ota_session_clear();
+	return ESP_OK;
+}
+
+esp_err_t ota_session_begin(uint32_t image_size, const uint8_t *sha256, ota_session_t *session)
+{
+	if (!ota_image_try_lock())
+	{
+		return ESP_ERR_INVALID_STATE;
+	}
+
+	esp_err_t err = ota_session_begin_locked(image_size, sha256, session);
+	ota_image_unlock();
+
+	return err;
+}
+
+esp_err_t ota_session_get(ota_session_t *session)
+{
+	if (!ota_image_try_lock())
+	{
+		return ESP_ERR_INVALID_STATE;
+	}
+
+	esp_err_t err = ota_session_get_locked(session);
+	ota_image_unlock();
+
+	return err;
+}
+
+esp_err_t ota_session_write(uint32_t offset, const void *data, size_t len, uint32_t crc)
+{
+	if (!ota_image_try_lock())
+	{
+		return ESP_ERR_INVALID_STATE;
+	}
+
+	esp_err_t err = ota_session_write_locked(offset, data, len, crc);
+	ota_image_unlock();
+
+	return err;
+}
+
+esp_err_t ota_session_finalize(void)
+{
+	if (!ota_image_try_lock())
+	{
+		return ESP_ERR_INVALID_STATE;
+	}
+
+	esp_err_t err = ota_session_finalize_locked();
+	ota_image_unlock();
+
+	return err;
+}
+
+esp_err_t ota_session_abort(void)
+{
+	if (!ota_image_try_lock())
+	{
+		return ESP_ERR_INVALID_STATE;
+	}
+
+	ota_session_clear();
+	ota_image_unlock();
+
+	return ESP_OK;
+}
+
+void ota_session_discard(void)
+{
+	ota_session_clear();
+}
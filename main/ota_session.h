@@ -0,0 +1,87 @@
+/*
+ * ota_session.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef MAIN_OTA_SESSION_H_
+#define MAIN_OTA_SESSION_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+/**
+ * Resumable OTA upload: the image is sent in chunks of chunk_size bytes (the last one may be
+ * shorter), each with its offset and CRC-32. Every chunk is written to the next update partition,
+ * read back and checked before the session offset moves on. The session is kept in NVS, so an
+ * interrupted upload, even one interrupted by a reboot, continues at the last verified offset.
+ * Every session call claims the update partition like ota_image_begin, so it fails with
+ * ESP_ERR_INVALID_STATE while an upload, pull or TCP update writes the partition.
+ */
+typedef struct ota_session
+{
+	uint32_t partition_address;		// Update partition the image is written to
+	uint32_t image_size;
+	uint32_t chunk_size;			// Multiple of the flash sector size, chunks are erased whole
+	uint32_t offset;				// Bytes written and verified
+	uint8_t sha256[32];				// SHA-256 of the whole image, checked on finalize if has_sha256
+	bool has_sha256;
+} ota_session_t;
+
+/**
+ * Starts a session, or returns the stored one if it is for the same image (size and SHA-256),
+ * so a client resumes by beginning again.
+ * @param image_size size of the image in bytes.
+ * @param sha256 SHA-256 of the image, NULL if not known.
+ * @param session receives the session.
+ * @return ESP_OK, ESP_ERR_INVALID_SIZE if the image does not fit the update partition,
+ * ESP_ERR_NOT_FOUND without an update partition, ESP_ERR_INVALID_STATE while another update
+ * writes the partition.
+ */
+esp_err_t ota_session_begin(uint32_t image_size, const uint8_t *sha256, ota_session_t *session);
+
+/**
+ * Gets the stored session.
+ * @param session receives the session.
+ * @return ESP_OK, ESP_ERR_NOT_FOUND if there is no session for the current update partition,
+ * ESP_ERR_INVALID_STATE while another update writes the partition.
+ */
+esp_err_t ota_session_get(ota_session_t *session);
+
+/**
+ * Writes the chunk at the session offset and moves the offset on once it is verified.
+ * @param offset image offset of the chunk.
+ * @param data chunk bytes.
+ * @param len chunk length, chunk_size except for the last chunk.
+ * @param crc CRC-32 (zlib) of the chunk.
+ * @return ESP_OK, ESP_ERR_NOT_FOUND without a session, ESP_ERR_INVALID_STATE if offset is not
+ * the session offset or another update writes the partition, ESP_ERR_INVALID_SIZE for a wrong length, ESP_ERR_INVALID_CRC if the chunk
+ * or its read back does not match crc, otherwise the flash error.
+ */
+esp_err_t ota_session_write(uint32_t offset, const void *data, size_t len, uint32_t crc);
+
+/**
+ * Checks the complete image and makes it the boot image. The session ends on success.
+ * @return ESP_OK, ESP_ERR_NOT_FOUND without a session, ESP_ERR_INVALID_STATE if chunks are missing
+ * or another update writes the partition,
+ * ESP_ERR_INVALID_CRC if the SHA-256 does not match, otherwise the esp_ota_set_boot_partition error.
+ */
+esp_err_t ota_session_finalize(void);
+
+/**
+ * Ends the session without changing the boot image.
+ * @return ESP_OK, ESP_ERR_INVALID_STATE while another update writes the partition (it discards
+ * the session itself).
+ */
+esp_err_t ota_session_abort(void);
+
+/**
+ * Drops the session for an upload that owns the update partition (ota_image_begin), the
+ * partition no longer holds the session's chunks.
+ */
+void ota_session_discard(void);
+
+#endif /* MAIN_OTA_SESSION_H_ */
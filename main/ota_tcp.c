@@ -0,0 +1,240 @@
+/*
+ * ota_tcp.c
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "lwip/sockets.h"
+#include "mbedtls/sha256.h"
+#include "sys/param.h"
+
+#include "ota_image.h"
+#include "ota_tcp.h"
+#include "ota_writer.h"
+#include "tasks_common.h"
+
+// Tag used for ESP serial console messages
+static const char TAG[] = "ota_tcp";
+
+/**
+ * Image being received, hashed and written by the OTA writer task
+ */
+typedef struct ota_tcp_image
+{
+	ota_image_t image;
+	mbedtls_sha256_context sha;
+} ota_tcp_image_t;
+
+/**
+ * OTA writer sink: hashes the payload and hands it to the image (flashed, decompressed or patched)
+ * in the writer task, while the receiver task reads the next buffers from the socket.
+ * @param ctx received image.
+ * @param data payload bytes.
+ * @param len number of bytes.
+ * @return result of ota_image_write.
+ */
+static esp_err_t ota_tcp_write(void *ctx, const char *data, size_t len)
+{
+	ota_tcp_image_t *tcp = (ota_tcp_image_t*)ctx;
+
+	mbedtls_sha256_update(&tcp->sha, (const unsigned char*)data, len);
+
+	return ota_image_write(&tcp->image, data, len);
+}
+
+/**
+ * Receives exactly len bytes, so each writer buffer is filled before it is queued.
+ * @return ESP_OK, ESP_ERR_TIMEOUT if the sender stalled, ESP_FAIL if the connection closed.
+ */
+static esp_err_t ota_tcp_recv_all(int sock, char *buf, size_t len)
+{
+	while (len > 0)
+	{
+		int recv_len = recv(sock, buf, len, 0);
+		if (recv_len <= 0)
+		{
+			return (recv_len < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) ? ESP_ERR_TIMEOUT : ESP_FAIL;
+		}
+		buf += recv_len;
+		len -= recv_len;
+	}
+
+	return ESP_OK;
+}
+
+/**
+ * Receives one frame into the OTA writer buffers and ends the image.
+ * @param sock connected socket.
+ * @return ESP_OK if the image boots next, otherwise the frame, receive, write or image error.
+ */
+static esp_err_t ota_tcp_receive(int sock)
+{
+	char header[OTA_TCP_HEADER_LEN];
+	ota_tcp_image_t tcp = {0};
+	uint8_t digest[32];
+	uint32_t received = 0;
+	esp_err_t err;
+
+	if ((err = ota_tcp_recv_all(sock, header, sizeof(header))) != ESP_OK)
+	{
+		return err;
+	}
+	if (memcmp(header, OTA_TCP_MAGIC, 4) != 0)
+	{
+		ESP_LOGI(TAG, "ota_tcp_receive: not a firmware frame");
+		return ESP_ERR_INVALID_ARG;
+	}
+
+	const uint8_t *p = (const uint8_t*)header;
+	uint32_t size = p[4] | (p[5] << 8) | (p[6] << 16) | ((uint32_t)p[7] << 24);
+	if (size == 0)
+	{
+		return ESP_ERR_INVALID_SIZE;
+	}
+
+	ESP_LOGI(TAG, "ota_tcp_receive: %lu byte payload", size);
+
+	if ((err = ota_image_begin(&tcp.image, size)) != ESP_OK)
+	{
+		return err;
+	}
+
+	mbedtls_sha256_init(&tcp.sha);
+	mbedtls_sha256_starts(&tcp.sha, 0);
+
+	err = ota_writer_start(ota_tcp_write, &tcp, tcp.image.partition, tcp.image.partition->erase_size, size,
+			CONFIG_OTA_TCP_RECV_BUFFER_SIZE);
+	if (err == ESP_OK)
+	{
+		while (received < size)
+		{
+			size_t buff_size;
+			char *buff = ota_writer_get_buffer(&buff_size);
+
+			// NULL once the writer failed, ota_writer_finish reports why
+			if (buff == NULL)
+			{
+				break;
+			}
+
+			size_t len = MIN(buff_size, size - received);
+			if ((err = ota_tcp_recv_all(sock, buff, len)) != ESP_OK)
+			{
+				ota_writer_submit(buff, 0);
+				ESP_LOGI(TAG, "ota_tcp_receive: %s at %lu of %lu bytes", esp_err_to_name(err), received, size);
+				break;
+			}
+			ota_writer_submit(buff, len);
+			received += len;
+		}
+
+		// Waits until everything received is hashed and written
+		esp_err_t write_err = ota_writer_finish();
+		if (err == ESP_OK)
+		{
+			err = write_err;
+		}
+
+		ota_writer_stats_t stats;
+		ota_writer_get_stats(&stats);
+		ESP_LOGI(TAG, "ota_tcp_receive: %lu bytes in %lu ms, receiver stalled %lu ms, writer stalled %lu ms",
+				stats.bytes, stats.elapsed_ms, stats.recv_stall_ms, stats.write_stall_ms);
+	}
+
+	mbedtls_sha256_finish(&tcp.sha, digest);
+	mbedtls_sha256_free(&tcp.sha);
+
+	if (err == ESP_OK && memcmp(digest, header + 8, sizeof(digest)) != 0)
+	{
+		ESP_LOGI(TAG, "ota_tcp_receive: payload SHA-256 does not match the frame");
+		err = ESP_ERR_INVALID_CRC;
+	}
+
+	// Switches the boot partition and sends the status to the HTTP server monitor
+	return ota_image_end(&tcp.image, err);
+}
+
+/**
+ * Receiver task: takes one sender at a time.
+ * @param pvParameters parameter which can be passed to the task.
+ */
+static void ota_tcp_task(void *pvParameters)
+{
+	struct sockaddr_in listen_addr = {
+			.sin_family = AF_INET,
+			.sin_port = htons(CONFIG_OTA_TCP_PORT),
+			.sin_addr.s_addr = htonl(INADDR_ANY),
+	};
+	int opt = 1;
+
+	int listen_sock = socket(AF_INET, SOCK_STREAM, IPPROTO_IP);
+	if (listen_sock < 0)
+	{
+		ESP_LOGE(TAG, "ota_tcp_task: socket failed (errno %d)", errno);
+		vTaskDelete(NULL);
+		return;
+	}
+
+	setsockopt(listen_sock, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+	if (bind(listen_sock, (struct sockaddr*)&listen_addr, sizeof(listen_addr)) != 0 || listen(listen_sock, 1) != 0)
+	{
+		ESP_LOGE(TAG, "ota_tcp_task: cannot listen on port %d (errno %d)", CONFIG_OTA_TCP_PORT, errno);
+		close(listen_sock);
+		vTaskDelete(NULL);
+		return;
+	}
+
+	ESP_LOGI(TAG, "ota_tcp_task: listening on port %d", CONFIG_OTA_TCP_PORT);
+
+	for (;;)
+	{
+		struct sockaddr_in source_addr;
+		socklen_t addr_len = sizeof(source_addr);
+		char addr_str[16];
+		char reply[48];
+
+		int sock = accept(listen_sock, (struct sockaddr*)&source_addr, &addr_len);
+		if (sock < 0)
+		{
+			ESP_LOGI(TAG, "ota_tcp_task: accept failed (errno %d)", errno);
+			vTaskDelay(pdMS_TO_TICKS(1000));
+			continue;
+		}
+
+		struct timeval timeout = {
+				.tv_sec = OTA_TCP_TIMEOUT_MS / 1000,
+				.tv_usec = (OTA_TCP_TIMEOUT_MS % 1000) * 1000,
+		};
+		setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+		inet_ntoa_r(source_addr.sin_addr, addr_str, sizeof(addr_str));
+		ESP_LOGI(TAG, "ota_tcp_task: sender %s", addr_str);
+
+		esp_err_t err = ota_tcp_receive(sock);
+
+		if (err == ESP_OK)
+		{
+			snprintf(reply, sizeof(reply), "OK\n");
+		}
+		else
+		{
+			snprintf(reply, sizeof(reply), "ERR %s\n", esp_err_to_name(err));
+		}
+		send(sock, reply, strlen(reply), 0);
+
+		shutdown(sock, SHUT_RDWR);
+		close(sock);
+	}
+}
+
+void ota_tcp_start(void)
+{
+	xTaskCreatePinnedToCore(&ota_tcp_task, "ota_tcp", OTA_TCP_TASK_STACK_SIZE, NULL,
+			OTA_TCP_TASK_PRIORITY, NULL, OTA_TCP_TASK_CORE_ID);
+}
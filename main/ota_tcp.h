@@ -0,0 +1,30 @@
+/*
+ * ota_tcp.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef MAIN_OTA_TCP_H_
+#define MAIN_OTA_TCP_H_
+
+// Frame magic, the first bytes a sender writes
+#define OTA_TCP_MAGIC				"EOTA"
+
+// Frame header: magic, payload length (32 bit little endian), SHA-256 of the payload
+#define OTA_TCP_HEADER_LEN			40
+
+// Socket receive timeout, a sender that stalls this long fails the update
+#define OTA_TCP_TIMEOUT_MS			10000
+
+/**
+ * Starts the raw TCP firmware receiver on CONFIG_OTA_TCP_PORT, a fast path for bulk updates
+ * without HTTP parsing. A sender (tools/ota_tcp_send.py) connects and writes one frame:
+ *   "EOTA" | payload length | SHA-256 of the payload | payload
+ * The payload is a firmware image, gzip compressed or not, or a delta patch, and goes straight into
+ * the OTA writer buffers (CONFIG_OTA_TCP_RECV_BUFFER_SIZE each). The image is handled like an upload
+ * to /OTAupdate; the boot partition is only switched if the SHA-256 matches. The receiver answers
+ * "OK\n" or "ERR <error name>\n" and closes the connection.
+ */
+void ota_tcp_start(void);
+
+#endif /* MAIN_OTA_TCP_H_ */
@@ -0,0 +1,378 @@
+/*
+ * ota_writer.c
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "ota_writer.h"
+#include "tasks_common.h"
+
+// Tag used for ESP serial console messages
+static const char TAG[] = "ota_writer";
+
+/**
+ * Filled buffer queued for the writer task, data NULL ends the upload.
+ */
+typedef struct ota_writer_buffer
+{
+	char *data;
+	size_t len;
+} ota_writer_buffer_t;
+
+/**
+ * Stage times in microseconds, see ota_writer_stats_t.
+ */
+typedef struct ota_writer_times
+{
+	uint32_t bytes;
+	int64_t elapsed_us;
+	int64_t recv_us;
+	int64_t recv_stall_us;
+	int64_t write_us;
+	int64_t write_stall_us;
+	uint32_t erase_bytes;
+	int64_t erase_us;
+} ota_writer_times_t;
+
+static char *s_buffers[OTA_WRITER_BUFFER_COUNT];
+static size_t s_buffer_size;
+
+// Free buffers for the receiver, filled buffers for the writer
+static QueueHandle_t s_free_queue = NULL;
+static QueueHandle_t s_full_queue = NULL;
+
+// Given by the writer task when it stops
+static SemaphoreHandle_t s_writer_done = NULL;
+
+static ota_writer_sink_t s_sink;
+static void *s_sink_ctx;
+
+// First sink error, the writer then drops the rest of the upload
+static volatile esp_err_t s_err = ESP_OK;
+
+// Erase range of the image: erased up to s_erased, to be erased up to s_erase_end
+static const esp_partition_t *s_partition;
+static size_t s_erased;
+static size_t s_erase_end;
+
+// Image offset reached by the writes, the erase ahead is counted from here
+static size_t s_write_end;
+
+// Stats, updated by both tasks
+static ota_writer_times_t s_times;
+static portMUX_TYPE s_times_lock = portMUX_INITIALIZER_UNLOCKED;
+static int64_t s_start_us;
+
+// When the receiver took its current buffer
+static int64_t s_recv_start_us;
+
+/**
+ * Erases the next step of the image range, up to the next OTA_WRITER_ERASE_STEP boundary
+ * so the flash driver can use block erases.
+ */
+static void ota_writer_erase_step(void)
+{
+	size_t len = OTA_WRITER_ERASE_STEP - (s_erased % OTA_WRITER_ERASE_STEP);
+	if (len > s_erase_end - s_erased)
+	{
+		len = s_erase_end - s_erased;
+	}
+
+	int64_t erase_start = esp_timer_get_time();
+	esp_err_t err = esp_partition_erase_range(s_partition, s_erased, len);
+	int64_t erase_end = esp_timer_get_time();
+
+	if (err != ESP_OK)
+	{
+		ESP_LOGI(TAG, "ota_writer_erase_step: erase at 0x%x failed %s", (unsigned int)s_erased, esp_err_to_name(err));
+		s_err = err;
+	}
+	s_erased += len;
+
+	taskENTER_CRITICAL(&s_times_lock);
+	s_times.erase_bytes += len;
+	s_times.erase_us += erase_end - erase_start;
+	taskEXIT_CRITICAL(&s_times_lock);
+}
+
+/**
+ * Sets the end of the erase range, rounded up to a sector and limited to the partition.
+ */
+static void ota_writer_set_erase_end(size_t image_size)
+{
+	s_erase_end = (image_size + s_partition->erase_size - 1) / s_partition->erase_size * s_partition->erase_size;
+	if (s_erase_end > s_partition->size)
+	{
+		s_erase_end = s_partition->size;
+	}
+}
+
+/**
+ * Writer task: passes the filled buffers to the sink in order and gives them back to the receiver.
+ */
+static void ota_writer_task(void *pvParameters)
+{
+	ota_writer_buffer_t buffer;
+
+	for (;;)
+	{
+		// Erase ahead while no data is waiting
+		while (s_erased < s_erase_end && s_erased < s_write_end + OTA_WRITER_ERASE_AHEAD && s_err == ESP_OK
+				&& uxQueueMessagesWaiting(s_full_queue) == 0)
+		{
+			ota_writer_erase_step();
+		}
+
+		int64_t wait_start = esp_timer_get_time();
+		xQueueReceive(s_full_queue, &buffer, portMAX_DELAY);
+		int64_t wait_end = esp_timer_get_time();
+
+		if (buffer.data == NULL)
+		{
+			break;
+		}
+
+		int64_t write_start = esp_timer_get_time();
+		int64_t erase_us = s_times.erase_us;
+
+		if (s_err == ESP_OK)
+		{
+			esp_err_t err = s_sink(s_sink_ctx, buffer.data, buffer.len);
+			if (err != ESP_OK)
+			{
+				ESP_LOGI(TAG, "ota_writer_task: write failed %s, dropping the rest", esp_err_to_name(err));
+				s_err = err;
+			}
+		}
+
+		int64_t write_end = esp_timer_get_time();
+
+		taskENTER_CRITICAL(&s_times_lock);
+		s_times.write_stall_us += wait_end - wait_start;
+		// Erasing on demand from the sink counts as erase time only
+		s_times.write_us += (write_end - write_start) - (s_times.erase_us - erase_us);
+		s_times.elapsed_us = write_end - s_start_us;
+		taskEXIT_CRITICAL(&s_times_lock);
+
+		xQueueSend(s_free_queue, &buffer.data, portMAX_DELAY);
+	}
+
+	xSemaphoreGive(s_writer_done);
+	vTaskDelete(NULL);
+}
+
+/**
+ * Frees the ring, the writer task must not be running.
+ */
+static void ota_writer_free(void)
+{
+	for (int i = 0; i < OTA_WRITER_BUFFER_COUNT; i++)
+	{
+		free(s_buffers[i]);
+		s_buffers[i] = NULL;
+	}
+
+	if (s_free_queue != NULL)
+	{
+		vQueueDelete(s_free_queue);
+		s_free_queue = NULL;
+	}
+	if (s_full_queue != NULL)
+	{
+		vQueueDelete(s_full_queue);
+		s_full_queue = NULL;
+	}
+	if (s_writer_done != NULL)
+	{
+		vSemaphoreDelete(s_writer_done);
+		s_writer_done = NULL;
+	}
+}
+
+esp_err_t ota_writer_start(ota_writer_sink_t sink, void *ctx, const esp_partition_t *partition, size_t erased, size_t image_size,
+		size_t buffer_size)
+{
+	if (s_free_queue != NULL)
+	{
+		return ESP_ERR_INVALID_STATE;
+	}
+
+	s_free_queue = xQueueCreate(OTA_WRITER_BUFFER_COUNT, sizeof(char*));
+	// One more entry for the end marker
+	s_full_queue = xQueueCreate(OTA_WRITER_BUFFER_COUNT + 1, sizeof(ota_writer_buffer_t));
+	s_writer_done = xSemaphoreCreateBinary();
+	if (s_free_queue == NULL || s_full_queue == NULL || s_writer_done == NULL)
+	{
+		ota_writer_free();
+		return ESP_ERR_NO_MEM;
+	}
+
+	for (int i = 0; i < OTA_WRITER_BUFFER_COUNT; i++)
+	{
+		s_buffers[i] = malloc(buffer_size);
+		if (s_buffers[i] == NULL)
+		{
+			ota_writer_free();
+			return ESP_ERR_NO_MEM;
+		}
+		xQueueSend(s_free_queue, &s_buffers[i], 0);
+	}
+
+	s_buffer_size = buffer_size;
+	s_sink = sink;
+	s_sink_ctx = ctx;
+	s_err = ESP_OK;
+
+	s_partition = partition;
+	s_erased = erased;
+	s_erase_end = 0;
+	s_write_end = 0;
+	if (partition != NULL)
+	{
+		ota_writer_set_erase_end(image_size);
+	}
+
+	taskENTER_CRITICAL(&s_times_lock);
+	memset(&s_times, 0, sizeof(s_times));
+	taskEXIT_CRITICAL(&s_times_lock);
+	s_start_us = esp_timer_get_time();
+
+	if (xTaskCreatePinnedToCore(&ota_writer_task, "ota_writer",
+			OTA_WRITER_TASK_STACK_SIZE, NULL, OTA_WRITER_TASK_PRIORITY,
+			NULL, OTA_WRITER_TASK_CORE_ID) != pdPASS)
+	{
+		ota_writer_free();
+		return ESP_ERR_NO_MEM;
+	}
+
+	return ESP_OK;
+}
+
+void ota_writer_set_image_size(size_t image_size)
+{
+	if (s_partition != NULL)
+	{
+		ota_writer_set_erase_end(image_size);
+	}
+}
+
+esp_err_t ota_writer_erase_to(size_t end)
+{
+	if (end > s_write_end)
+	{
+		s_write_end = end;
+	}
+
+	while (s_erased < s_erase_end && s_erased < end && s_err == ESP_OK)
+	{
+		ota_writer_erase_step();
+	}
+
+	return s_err;
+}
+
+char* ota_writer_get_buffer(size_t *size)
+{
+	char *buf = NULL;
+
+	if (s_err != ESP_OK)
+	{
+		return NULL;
+	}
+
+	// Backpressure: all buffers queued means the flash is behind
+	int64_t wait_start = esp_timer_get_time();
+	xQueueReceive(s_free_queue, &buf, portMAX_DELAY);
+	s_recv_start_us = esp_timer_get_time();
+
+	taskENTER_CRITICAL(&s_times_lock);
+	s_times.recv_stall_us += s_recv_start_us - wait_start;
+	taskEXIT_CRITICAL(&s_times_lock);
+
+	if (s_err != ESP_OK)
+	{
+		xQueueSend(s_free_queue, &buf, 0);
+		return NULL;
+	}
+
+	*size = s_buffer_size;
+
+	return buf;
+}
+
+void ota_writer_submit(char *buf, size_t len)
+{
+	int64_t recv_us = esp_timer_get_time() - s_recv_start_us;
+
+	taskENTER_CRITICAL(&s_times_lock);
+	s_times.recv_us += recv_us;
+	s_times.bytes += len;
+	taskEXIT_CRITICAL(&s_times_lock);
+
+	if (len == 0)
+	{
+		xQueueSend(s_free_queue, &buf, 0);
+		return;
+	}
+
+	ota_writer_buffer_t buffer = {
+		.data = buf,
+		.len = len
+	};
+	xQueueSend(s_full_queue, &buffer, portMAX_DELAY);
+}
+
+esp_err_t ota_writer_finish(void)
+{
+	ota_writer_buffer_t end = {
+		.data = NULL,
+		.len = 0
+	};
+
+	if (s_free_queue == NULL)
+	{
+		return ESP_ERR_INVALID_STATE;
+	}
+
+	xQueueSend(s_full_queue, &end, portMAX_DELAY);
+	xSemaphoreTake(s_writer_done, portMAX_DELAY);
+
+	ota_writer_free();
+
+	ota_writer_stats_t stats;
+	ota_writer_get_stats(&stats);
+	ESP_LOGI(TAG, "ota_writer_finish: %lu bytes in %lu ms, recv %lu ms (stalled %lu ms), write %lu ms (stalled %lu ms), erase %lu bytes in %lu ms",
+			stats.bytes, stats.elapsed_ms, stats.recv_ms, stats.recv_stall_ms, stats.write_ms, stats.write_stall_ms,
+			stats.erase_bytes, stats.erase_ms);
+
+	return s_err;
+}
+
+void ota_writer_get_stats(ota_writer_stats_t *stats)
+{
+	ota_writer_times_t times;
+
+	taskENTER_CRITICAL(&s_times_lock);
+	times = s_times;
+	taskEXIT_CRITICAL(&s_times_lock);
+
+	stats->bytes = times.bytes;
+	stats->elapsed_ms = times.elapsed_us / 1000;
+	stats->recv_ms = times.recv_us / 1000;
+	stats->recv_stall_ms = times.recv_stall_us / 1000;
+	stats->write_ms = times.write_us / 1000;
+	stats->write_stall_ms = times.write_stall_us / 1000;
+	stats->erase_bytes = times.erase_bytes;
+	stats->erase_ms = times.erase_us / 1000;
+}
@@ -0,0 +1,108 @@
+/*
+ * ota_writer.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef MAIN_OTA_WRITER_H_
+#define MAIN_OTA_WRITER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "esp_partition.h"
+
+// Receive buffers in the ring, each one of the size given to ota_writer_start
+#define OTA_WRITER_BUFFER_COUNT		4
+
+// Flash erased per step ahead of the writes, block erases are much faster per byte than sector erases
+#define OTA_WRITER_ERASE_STEP		(64 * 1024)
+
+// How far the writer task erases ahead of the last write while it waits for data
+#define OTA_WRITER_ERASE_AHEAD		(256 * 1024)
+
+/**
+ * Consumes the received bytes in the writer task (multipart parser or esp_ota_write).
+ * @param ctx context given to ota_writer_start.
+ * @param data received bytes.
+ * @param len number of bytes.
+ * @return ESP_OK to continue, otherwise the writer drops the rest of the upload.
+ */
+typedef esp_err_t (*ota_writer_sink_t)(void *ctx, const char *data, size_t len);
+
+/**
+ * Time spent in each stage of the last (or current) upload.
+ * A stall is time one side waited for the other: the receiver for a free buffer,
+ * the writer for a filled one.
+ */
+typedef struct ota_writer_stats
+{
+	uint32_t bytes;					// Bytes received
+	uint32_t elapsed_ms;			// ota_writer_start to the end of the last write
+	uint32_t recv_ms;				// Receiving into the buffers
+	uint32_t recv_stall_ms;			// Receiver waiting for a free buffer (flash slower than the network)
+	uint32_t write_ms;				// Writing (sink)
+	uint32_t write_stall_ms;		// Writer waiting for data (network slower than the flash)
+	uint32_t erase_bytes;			// Flash erased by the writer task
+	uint32_t erase_ms;				// Erasing, mostly while waiting for data
+} ota_writer_stats_t;
+
+/**
+ * Starts an upload: allocates the buffer ring and starts the writer task.
+ * The writer task erases the image range of the partition in OTA_WRITER_ERASE_STEP steps, up to
+ * OTA_WRITER_ERASE_AHEAD ahead of the writes, while it waits for data. The sink calls ota_writer_erase_to
+ * before each write, so the OTA handle must not erase itself.
+ * @param sink called by the writer task for every filled buffer, in order.
+ * @param ctx context passed to the sink.
+ * @param partition partition written by the sink, NULL if the writer does not erase.
+ * @param erased bytes already erased at the start of the partition (sector aligned).
+ * @param image_size maximum image size, the erase stops there (rounded up to a sector).
+ * @param buffer_size bytes per receive buffer.
+ * @return ESP_OK, ESP_ERR_NO_MEM, ESP_ERR_INVALID_STATE if an upload is in progress.
+ */
+esp_err_t ota_writer_start(ota_writer_sink_t sink, void *ctx, const esp_partition_t *partition, size_t erased, size_t image_size,
+		size_t buffer_size);
+
+/**
+ * Changes the maximum image size, e.g. once the image turns out to be compressed. Writer task only.
+ * @param image_size maximum image size, limited to the partition size.
+ */
+void ota_writer_set_image_size(size_t image_size);
+
+/**
+ * Erases the partition up to end unless done already, called by the sink before writing there.
+ * Writer task only.
+ * @param end image offset up to which the next write goes.
+ * @return ESP_OK, otherwise the erase error.
+ */
+esp_err_t ota_writer_erase_to(size_t end);
+
+/**
+ * Takes a free buffer to receive into, waits while all of them are queued for writing.
+ * @param size receives the buffer size.
+ * @return buffer, NULL if the writer stopped with an error.
+ */
+char* ota_writer_get_buffer(size_t *size);
+
+/**
+ * Queues a buffer taken with ota_writer_get_buffer for writing.
+ * @param buf buffer.
+ * @param len bytes received into it, 0 to give the buffer back unused.
+ */
+void ota_writer_submit(char *buf, size_t len);
+
+/**
+ * Ends the upload: waits until the queued buffers are written, stops the writer task
+ * and frees the buffers.
+ * @return ESP_OK, otherwise the first error returned by the sink.
+ */
+esp_err_t ota_writer_finish(void);
+
+/**
+ * Copies the stats of the last (or current) upload.
+ * @param stats receives the copy.
+ */
+void ota_writer_get_stats(ota_writer_stats_t *stats);
+
+#endif /* MAIN_OTA_WRITER_H_ */
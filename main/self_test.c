@@ -0,0 +1,330 @@
+/*
+ * self_test.c
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_http_client.h"
+#include "esp_log.h"
+#include "esp_ota_ops.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+#include "sys/param.h"
+
+#include "app_nvs.h"
+#include "ethernet_app.h"
+#include "self_test.h"
+#include "tasks_common.h"
+
+// Tag used for ESP serial console messages
+static const char TAG[] = "self_test";
+
+// Bits of self_test_report_t.failed
+#define SELF_TEST_FAILED_BOOT_TO_IP		BIT0
+#define SELF_TEST_FAILED_HTTP			BIT1
+#define SELF_TEST_FAILED_LOOP			BIT2
+#define SELF_TEST_FAILED_HEAP			BIT3
+
+// Report, written by the self-test task and read by the HTTP server
+static self_test_report_t s_report;
+static portMUX_TYPE s_report_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * Upper limit of a time: the baseline times CONFIG_SELF_TEST_REGRESSION_PERCENT,
+ * at least the baseline plus slack.
+ */
+static uint32_t self_test_limit(uint32_t baseline, uint32_t slack)
+{
+	uint64_t limit = (uint64_t)baseline * CONFIG_SELF_TEST_REGRESSION_PERCENT / 100;
+	if (limit < (uint64_t)baseline + slack)
+	{
+		limit = (uint64_t)baseline + slack;
+	}
+
+	return (uint32_t)MIN(limit, UINT32_MAX);
+}
+
+/**
+ * Derives the thresholds from the baseline.
+ */
+static void self_test_set_thresholds(const self_test_results_t *baseline, self_test_results_t *thresholds)
+{
+	thresholds->boot_to_ip_ms = self_test_limit(baseline->boot_to_ip_ms, SELF_TEST_BOOT_TO_IP_SLACK_MS);
+	thresholds->http_latency_us = self_test_limit(baseline->http_latency_us, SELF_TEST_HTTP_SLACK_US);
+	thresholds->loop_latency_us = self_test_limit(baseline->loop_latency_us, SELF_TEST_LOOP_SLACK_US);
+	thresholds->min_free_heap = (uint32_t)((uint64_t)baseline->min_free_heap * 100 / CONFIG_SELF_TEST_REGRESSION_PERCENT);
+}
+
+/**
+ * Finds the benchmarks that could not run for reasons outside the image: boot-to-IP has
+ * no time when the link never came up (cable unplugged, switch off), and the HTTP benchmark
+ * is only trusted if it still worked. An image that brought the link up, or replaced one
+ * that got an address, has no such excuse: its missing address is a failure (see self_test_check).
+ * @return bits of the inconclusive results, they are neither checked nor stored.
+ */
+static uint32_t self_test_inconclusive(const self_test_report_t *report)
+{
+	uint32_t inconclusive = 0;
+
+	if (report->results.boot_to_ip_ms == 0 && report->boot_to_link_ms == 0
+			&& !(report->has_baseline && report->baseline.boot_to_ip_ms != 0))
+	{
+		inconclusive |= SELF_TEST_FAILED_BOOT_TO_IP;
+
+		if (report->results.http_latency_us == 0)
+		{
+			inconclusive |= SELF_TEST_FAILED_HTTP;
+		}
+	}
+
+	return inconclusive;
+}
+
+/**
+ * Compares the measured results with the thresholds. No address without an excuse
+ * (see self_test_inconclusive) fails even without a baseline, an HTTP benchmark that
+ * worked for the baseline but fails now counts as a regression.
+ * @return failed bits, 0 if the results are within the thresholds.
+ */
+static uint32_t self_test_check(const self_test_report_t *report)
+{
+	const self_test_results_t *r = &report->results;
+	const self_test_results_t *b = &report->baseline;
+	const self_test_results_t *t = &report->thresholds;
+	uint32_t failed = 0;
+
+	if (r->boot_to_ip_ms == 0 && !(report->inconclusive & SELF_TEST_FAILED_BOOT_TO_IP))
+	{
+		failed |= SELF_TEST_FAILED_BOOT_TO_IP;
+	}
+
+	if (!report->has_baseline)
+	{
+		return failed;
+	}
+
+	if (b->boot_to_ip_ms != 0 && !(report->inconclusive & SELF_TEST_FAILED_BOOT_TO_IP)
+			&& r->boot_to_ip_ms > t->boot_to_ip_ms)
+	{
+		failed |= SELF_TEST_FAILED_BOOT_TO_IP;
+	}
+	if (b->http_latency_us != 0 && !(report->inconclusive & SELF_TEST_FAILED_HTTP)
+			&& (r->http_latency_us == 0 || r->http_latency_us > t->http_latency_us))
+	{
+		failed |= SELF_TEST_FAILED_HTTP;
+	}
+	if (r->loop_latency_us > t->loop_latency_us)
+	{
+		failed |= SELF_TEST_FAILED_LOOP;
+	}
+	if (r->min_free_heap < t->min_free_heap)
+	{
+		failed |= SELF_TEST_FAILED_HEAP;
+	}
+
+	return failed;
+}
+
+/**
+ * Keeps the better of baseline and results per benchmark: lower times, higher heap.
+ * The baseline is never loosened, so images that each pass within the allowed regression
+ * cannot add up to a larger one. A time missing from the baseline (0) is taken from the results.
+ * @return true if the baseline changed.
+ */
+static bool self_test_merge_baseline(self_test_results_t *baseline, const self_test_results_t *results)
+{
+	self_test_results_t merged = *baseline;
+
+	if (results->boot_to_ip_ms != 0 && (merged.boot_to_ip_ms == 0 || results->boot_to_ip_ms < merged.boot_to_ip_ms))
+	{
+		merged.boot_to_ip_ms = results->boot_to_ip_ms;
+	}
+	if (results->http_latency_us != 0 && (merged.http_latency_us == 0 || results->http_latency_us < merged.http_latency_us))
+	{
+		merged.http_latency_us = results->http_latency_us;
+	}
+	merged.loop_latency_us = MIN(merged.loop_latency_us, results->loop_latency_us);
+	merged.min_free_heap = MAX(merged.min_free_heap, results->min_free_heap);
+
+	if (memcmp(&merged, baseline, sizeof(merged)) == 0)
+	{
+		return false;
+	}
+
+	*baseline = merged;
+	return true;
+}
+
+/**
+ * Times loopback GETs of /status.json, the request path of the HTTP server without the network.
+ * @return mean time per request in microseconds, 0 if a request failed.
+ */
+static uint32_t self_test_http_latency(void)
+{
+	esp_http_client_config_t config = {
+			.url = "http://127.0.0.1/status.json",
+			.timeout_ms = 5000,
+	};
+	int64_t total_us = 0;
+
+	esp_http_client_handle_t client = esp_http_client_init(&config);
+	if (client == NULL)
+	{
+		return 0;
+	}
+
+	for (int i = 0; i < SELF_TEST_HTTP_REQUESTS; i++)
+	{
+		int64_t start = esp_timer_get_time();
+		esp_err_t err = esp_http_client_perform(client);
+		total_us += esp_timer_get_time() - start;
+
+		if (err != ESP_OK || esp_http_client_get_status_code(client) != 200)
+		{
+			ESP_LOGI(TAG, "self_test_http_latency: request %d failed (%s)", i, esp_err_to_name(err));
+			total_us = 0;
+			break;
+		}
+	}
+
+	esp_http_client_cleanup(client);
+
+	return (uint32_t)(total_us / SELF_TEST_HTTP_REQUESTS);
+}
+
+/**
+ * Times how late the task wakes up from one tick waits, the scheduling delay the other
+ * tasks of the image cause.
+ * @return worst delay in microseconds.
+ */
+static uint32_t self_test_loop_latency(void)
+{
+	int64_t worst_us = 0;
+
+	// Starts on a tick boundary
+	vTaskDelay(1);
+	int64_t last = esp_timer_get_time();
+
+	for (int i = 0; i < SELF_TEST_LOOP_TICKS; i++)
+	{
+		vTaskDelay(1);
+		int64_t now = esp_timer_get_time();
+
+		worst_us = MAX(worst_us, now - last - portTICK_PERIOD_MS * 1000);
+		last = now;
+	}
+
+	return (uint32_t)worst_us;
+}
+
+/**
+ * Self-test task: benchmarks, then the verdict on a pending image.
+ * @param pvParameters parameter which can be passed to the task.
+ */
+static void self_test_task(void *pvParameters)
+{
+	const esp_partition_t *running = esp_ota_get_running_partition();
+	esp_ota_img_states_t ota_state;
+	self_test_results_t results = {0};
+	self_test_results_t baseline;
+
+	bool pending = esp_ota_get_state_partition(running, &ota_state) == ESP_OK && ota_state == ESP_OTA_IMG_PENDING_VERIFY;
+	bool has_baseline = app_nvs_load_self_test_baseline(&baseline);
+
+	taskENTER_CRITICAL(&s_report_lock);
+	s_report.has_baseline = has_baseline;
+	if (has_baseline)
+	{
+		s_report.baseline = baseline;
+		self_test_set_thresholds(&baseline, &s_report.thresholds);
+	}
+	taskEXIT_CRITICAL(&s_report_lock);
+
+	ESP_LOGI(TAG, "self_test_task: %s image, %s baseline", pending ? "new" : "valid", has_baseline ? "stored" : "no");
+
+	// The Ethernet task brings the link up, this only waits for its address
+	while ((results.boot_to_ip_ms = ethernet_app_get_boot_to_ip_ms()) == 0
+			&& esp_timer_get_time() / 1000 < CONFIG_SELF_TEST_IP_TIMEOUT_MS)
+	{
+		vTaskDelay(pdMS_TO_TICKS(100));
+	}
+
+	results.http_latency_us = self_test_http_latency();
+	results.loop_latency_us = self_test_loop_latency();
+	results.min_free_heap = esp_get_minimum_free_heap_size();
+
+	uint32_t boot_to_link_ms = ethernet_app_get_boot_to_link_ms();
+
+	taskENTER_CRITICAL(&s_report_lock);
+	s_report.results = results;
+	s_report.boot_to_link_ms = boot_to_link_ms;
+	s_report.inconclusive = self_test_inconclusive(&s_report);
+	s_report.failed = self_test_check(&s_report);
+	uint32_t inconclusive = s_report.inconclusive;
+	uint32_t failed = s_report.failed;
+	taskEXIT_CRITICAL(&s_report_lock);
+
+	ESP_LOGI(TAG, "self_test_task: boot to IP %lu ms, HTTP %lu us, loop %lu us, min free heap %lu, failed 0x%lx, inconclusive 0x%lx",
+			results.boot_to_ip_ms, results.http_latency_us, results.loop_latency_us, results.min_free_heap, failed, inconclusive);
+
+	// Regressions and a broken network roll back, an image that never saw a link is kept
+	self_test_state_e state;
+	if (!pending)
+	{
+		state = SELF_TEST_MEASURED;
+	}
+	else if (failed != 0)
+	{
+		state = SELF_TEST_FAILED;
+	}
+	else
+	{
+		esp_ota_mark_app_valid_cancel_rollback();
+		state = (inconclusive == 0) ? SELF_TEST_PASSED : SELF_TEST_INCONCLUSIVE;
+	}
+
+	// The first measurement without failures is the baseline, images that passed can only improve it
+	if (!has_baseline && failed == 0)
+	{
+		app_nvs_save_self_test_baseline(&results);
+	}
+	else if (state == SELF_TEST_PASSED && self_test_merge_baseline(&baseline, &results))
+	{
+		app_nvs_save_self_test_baseline(&baseline);
+	}
+
+	taskENTER_CRITICAL(&s_report_lock);
+	s_report.state = state;
+	taskEXIT_CRITICAL(&s_report_lock);
+
+	if (state == SELF_TEST_FAILED)
+	{
+		ESP_LOGE(TAG, "self_test_task: new image regressed, rolling back");
+
+		// Only returns if there is no other valid image
+		esp_err_t err = esp_ota_mark_app_invalid_rollback_and_reboot();
+		ESP_LOGE(TAG, "self_test_task: rollback failed (%s)", esp_err_to_name(err));
+	}
+
+	vTaskDelete(NULL);
+}
+
+void self_test_start(void)
+{
+	s_report.state = SELF_TEST_RUNNING;
+
+	xTaskCreatePinnedToCore(&self_test_task, "self_test", SELF_TEST_TASK_STACK_SIZE, NULL,
+			SELF_TEST_TASK_PRIORITY, NULL, SELF_TEST_TASK_CORE_ID);
+}
+
+void self_test_get_report(self_test_report_t *report)
+{
+	taskENTER_CRITICAL(&s_report_lock);
+	*report = s_report;
+	taskEXIT_CRITICAL(&s_report_lock);
+}
@@ -0,0 +1,81 @@
+/*
+ * self_test.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef MAIN_SELF_TEST_H_
+#define MAIN_SELF_TEST_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Loopback GETs of /status.json timed by the HTTP benchmark
+#define SELF_TEST_HTTP_REQUESTS		20
+
+// Ticks timed by the loop latency benchmark
+#define SELF_TEST_LOOP_TICKS		200
+
+// Absolute slack on top of the relative limit, so small baselines do not fail on noise
+#define SELF_TEST_BOOT_TO_IP_SLACK_MS	1000
+#define SELF_TEST_HTTP_SLACK_US		5000
+#define SELF_TEST_LOOP_SLACK_US		1000
+
+/**
+ * Self-test phase of this boot.
+ */
+typedef enum self_test_state
+{
+	SELF_TEST_IDLE = 0,
+	SELF_TEST_RUNNING,
+	SELF_TEST_MEASURED,				// Image already valid, measured only
+	SELF_TEST_PASSED,				// New image within the thresholds, marked valid
+	SELF_TEST_FAILED,				// New image regressed, rolled back unless no other image exists
+	SELF_TEST_INCONCLUSIVE,			// New image that never saw a link but otherwise within the thresholds, marked valid
+} self_test_state_e;
+
+/**
+ * Benchmark results, also the stored baseline and the thresholds derived from it.
+ */
+typedef struct self_test_results
+{
+	uint32_t boot_to_ip_ms;			// Boot to the first Ethernet IP address, 0 if none in time
+	uint32_t http_latency_us;		// Mean time of a loopback GET of /status.json, 0 if it failed
+	uint32_t loop_latency_us;		// Worst wake-up delay of a task waiting one tick
+	uint32_t min_free_heap;			// Lowest free heap since boot, after the benchmarks
+} self_test_results_t;
+
+/**
+ * Self-test state and numbers, for the selftest.json handler.
+ */
+typedef struct self_test_report
+{
+	self_test_state_e state;
+	bool has_baseline;
+	self_test_results_t results;
+	self_test_results_t baseline;	// Best results of the images that passed (or the first measured)
+	self_test_results_t thresholds;	// Limits derived from the baseline, heap is a lower limit
+	uint32_t failed;				// Bit per results member (in order) that was out of its limit
+	uint32_t inconclusive;			// Bit per results member (in order) that could not be measured (no link)
+	uint32_t boot_to_link_ms;		// Boot to the first Ethernet link up, 0 if it never came up
+} self_test_report_t;
+
+/**
+ * Starts the self-test task, call early in app_main so the boot-to-IP time is measured.
+ * With rollback enabled, a new image runs the benchmarks in the pending verify state and is
+ * marked valid if they are within CONFIG_SELF_TEST_REGRESSION_PERCENT of the baseline,
+ * otherwise the previous image is booted again. No address within CONFIG_SELF_TEST_IP_TIMEOUT_MS
+ * rolls back as well if the link came up or the baseline had an address (driver or DHCP broken);
+ * only without both the network benchmarks are inconclusive: they neither roll back nor change
+ * the baseline.
+ * A valid image only measures.
+ */
+void self_test_start(void);
+
+/**
+ * Gets the self-test state, results, baseline and thresholds.
+ * @param report receives the report.
+ */
+void self_test_get_report(self_test_report_t *report);
+
+#endif /* MAIN_SELF_TEST_H_ */
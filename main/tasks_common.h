@@ -23,6 +23,41 @@
 #define HTTP_SERVER_MONITOR_PRIORITY		3
 #define HTTP_SERVER_MONITOR_CORE_ID			0
 
+// HTTP Server asset sender tasks (stream large static assets off the httpd task)
+#define HTTP_ASSET_SENDER_STACK_SIZE		3072
+#define HTTP_ASSET_SENDER_PRIORITY			4
+#define HTTP_ASSET_SENDER_CORE_ID			0
+
+// OTA writer task (writes the received firmware image to flash while the httpd task receives)
+#define OTA_WRITER_TASK_STACK_SIZE			4096
+#define OTA_WRITER_TASK_PRIORITY			5
+#define OTA_WRITER_TASK_CORE_ID				1
+
+// OTA pull task (fetches a firmware image over HTTP(S), the OTA writer task flashes it)
+#define OTA_PULL_TASK_STACK_SIZE			8192
+#define OTA_PULL_TASK_PRIORITY				4
+#define OTA_PULL_TASK_CORE_ID				0
+
+// Raw TCP firmware receiver task (reads the socket, the OTA writer task flashes it)
+#define OTA_TCP_TASK_STACK_SIZE				4096
+#define OTA_TCP_TASK_PRIORITY				5
+#define OTA_TCP_TASK_CORE_ID				0
+
+// Post-OTA self-test task (benchmarks after boot, marks a new image valid or rolls it back)
+#define SELF_TEST_TASK_STACK_SIZE			6144
+#define SELF_TEST_TASK_PRIORITY				3
+#define SELF_TEST_TASK_CORE_ID				1
+
+// Network benchmark task (iperf 2 compatible TCP/UDP runs, see net_bench.h)
+#define NET_BENCH_TASK_STACK_SIZE			4096
+#define NET_BENCH_TASK_PRIORITY				4
+#define NET_BENCH_TASK_CORE_ID				1
+
+// W5500 burst RX task (replaces the RX task of the MAC driver, same priority, see w5500_burst_rx.h)
+#define W5500_BURST_RX_TASK_STACK_SIZE		4096
+#define W5500_BURST_RX_TASK_PRIORITY		15
+#define W5500_BURST_RX_TASK_CORE_ID			1
+
 // WiFi Reset Button task
 #define WIFI_RESET_BUTTON_TASK_STACK_SIZE	2048
 #define WIFI_RESET_BUTTON_TASK_PRIORITY		6
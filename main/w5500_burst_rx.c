@@ -0,0 +1,501 @@
+/*
+ * w5500_burst_rx.c
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "driver/gpio.h"
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "lwip/netif.h"
+#include "lwip/pbuf.h"
+#include "sdkconfig.h"
+
+#include "tasks_common.h"
+#include "w5500_burst_rx.h"
+#include "w5500_rx_mode.h"
+#include "w5500_spi.h"
+
+// Tag used for ESP serial console messages
+static const char TAG[] = "w5500_burst_rx";
+
+// The SPI master copies DMA reads through a temporary buffer unless the length is a multiple of 4
+#define W5500_BURST_RX_READ_LEN(len)    (((len) + 3) & ~3)
+#define W5500_BURST_RX_BUF_LEN          W5500_BURST_RX_READ_LEN(CONFIG_ETH_RX_BURST_SIZE)
+
+/**
+ * Burst buffer, DMA capable
+ */
+typedef struct w5500_burst_buf
+{
+    uint8_t *data;
+    uint32_t refs;                      // The RX task while it parses, plus one per pbuf of its frames
+} w5500_burst_buf_t;
+
+/**
+ * pbuf referencing a frame in a burst buffer
+ */
+typedef struct w5500_burst_pbuf
+{
+    struct pbuf_custom p;               // First, the free function gets the pbuf back
+    w5500_burst_buf_t *buf;
+    struct w5500_burst_pbuf *next;      // Free list
+} w5500_burst_pbuf_t;
+
+// Burst buffers, allocated on the first start and kept: frames held by the stack outlive a stop.
+// The last one is only copied from, for bursts while the others are all referenced
+static w5500_burst_buf_t s_bufs[CONFIG_ETH_RX_BURST_BUFFERS + 1];
+static w5500_burst_buf_t *const s_copy_buf = &s_bufs[CONFIG_ETH_RX_BURST_BUFFERS];
+static QueueHandle_t s_free_bufs = NULL;
+
+// pbufs referencing burst buffers, lwIP frees them from any task
+static w5500_burst_pbuf_t s_pbufs[CONFIG_ETH_RX_BURST_PBUFS];
+static w5500_burst_pbuf_t *s_free_pbufs = NULL;
+static portMUX_TYPE s_pool_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// RX task, the INT pin that wakes it and the netif it feeds
+static TaskHandle_t s_task = NULL;
+static SemaphoreHandle_t s_exit = NULL;
+static volatile bool s_stop = false;
+static int s_int_gpio = -1;
+static esp_netif_t *s_netif = NULL;
+
+// Counters, added up per wakeup
+static w5500_burst_rx_stats_t s_stats;
+static portMUX_TYPE s_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * Drops a reference to a burst buffer, the last one returns it to the pool.
+ */
+static void w5500_burst_rx_release(w5500_burst_buf_t *buf)
+{
+    taskENTER_CRITICAL(&s_pool_lock);
+    bool unused = (--buf->refs == 0);
+    taskEXIT_CRITICAL(&s_pool_lock);
+
+    if (unused) {
+        xQueueSend(s_free_bufs, &buf, 0);
+    }
+}
+
+/**
+ * pbuf free function, called by lwIP once the frame is no longer used.
+ */
+static void w5500_burst_rx_pbuf_free(struct pbuf *p)
+{
+    w5500_burst_pbuf_t *bp = (w5500_burst_pbuf_t*)p;
+    w5500_burst_buf_t *buf = bp->buf;
+
+    taskENTER_CRITICAL(&s_pool_lock);
+    bp->next = s_free_pbufs;
+    s_free_pbufs = bp;
+    taskEXIT_CRITICAL(&s_pool_lock);
+
+    w5500_burst_rx_release(buf);
+}
+
+/**
+ * Wraps a frame of a burst buffer in a pbuf of the pool.
+ * @return pbuf, NULL if the pool is empty.
+ */
+static struct pbuf* w5500_burst_rx_ref_frame(w5500_burst_buf_t *buf, uint8_t *frame, uint16_t len)
+{
+    taskENTER_CRITICAL(&s_pool_lock);
+    w5500_burst_pbuf_t *bp = s_free_pbufs;
+    if (bp != NULL) {
+        s_free_pbufs = bp->next;
+        buf->refs++;
+    }
+    taskEXIT_CRITICAL(&s_pool_lock);
+
+    if (bp == NULL) {
+        return NULL;
+    }
+
+    bp->buf = buf;
+    bp->p.custom_free_function = w5500_burst_rx_pbuf_free;
+
+    return pbuf_alloced_custom(PBUF_RAW, len, PBUF_REF, &bp->p, frame, len);
+}
+
+/**
+ * Passes one frame to the stack, referenced in the burst buffer or copied.
+ * @param buf burst buffer, s_copy_buf to copy.
+ */
+static void w5500_burst_rx_deliver(struct netif *lwip_netif, w5500_burst_buf_t *buf, uint8_t *frame, uint16_t len,
+                                   w5500_burst_rx_stats_t *counts)
+{
+    struct pbuf *p = NULL;
+
+    if (buf != s_copy_buf) {
+        p = w5500_burst_rx_ref_frame(buf, frame, len);
+    }
+    if (p == NULL) {
+        p = pbuf_alloc(PBUF_RAW, len, PBUF_RAM);
+        if (p == NULL) {
+            counts->dropped++;
+            return;
+        }
+        memcpy(p->payload, frame, len);
+        counts->copied++;
+    }
+
+    w5500_rx_mode_count_frame(len);
+
+    // Same as the netif glue: the input function queues the frame for the TCP/IP thread
+    if (lwip_netif->input(p, lwip_netif) != ERR_OK) {
+        pbuf_free(p);
+        counts->dropped++;
+        return;
+    }
+    counts->frames++;
+}
+
+/**
+ * Passes the complete frames of a burst to the stack.
+ * @param lwip_netif netif, NULL to drop the frames.
+ * @param len bytes in the burst.
+ * @param bad set if a frame length is invalid.
+ * @return bytes of complete frames, a partial frame at the end is read again by the next burst.
+ */
+static uint32_t w5500_burst_rx_parse(struct netif *lwip_netif, w5500_burst_buf_t *buf, uint32_t len, bool *bad,
+                                     w5500_burst_rx_stats_t *counts)
+{
+    uint32_t offset = 0;
+
+    while (offset + W5500_BURST_RX_HEADER_LEN <= len) {
+        uint32_t frame_len = (buf->data[offset] << 8) | buf->data[offset + 1];
+        if (frame_len < W5500_BURST_RX_HEADER_LEN + W5500_BURST_RX_MIN_FRAME
+            || frame_len > W5500_BURST_RX_HEADER_LEN + W5500_BURST_RX_MAX_FRAME) {
+            *bad = true;
+            break;
+        }
+        if (offset + frame_len > len) {
+            break;
+        }
+
+        if (lwip_netif != NULL) {
+            w5500_burst_rx_deliver(lwip_netif, buf, &buf->data[offset + W5500_BURST_RX_HEADER_LEN],
+                                   frame_len - W5500_BURST_RX_HEADER_LEN, counts);
+        } else {
+            counts->dropped++;
+        }
+        offset += frame_len;
+    }
+
+    return offset;
+}
+
+/**
+ * Reads Sn_RX_RSR and Sn_RX_RD in one transaction, until two RSR reads agree.
+ * @return true if read.
+ */
+static bool w5500_burst_rx_read_pointers(uint16_t *rsr, uint16_t *rd)
+{
+    uint8_t regs[4];
+    uint16_t last = 0;
+
+    for (int i = 0; i < W5500_BURST_RX_RSR_READS; i++) {
+        if (w5500_spi_read(W5500_BURST_RX_REG_SOCK_RX_RSR, W5500_SPI_BSB_SOCK_REG(0), regs, sizeof(regs)) != ESP_OK) {
+            return false;
+        }
+
+        uint16_t value = (regs[0] << 8) | regs[1];
+        if (i > 0 && value == last) {
+            *rsr = value;
+            *rd = (regs[2] << 8) | regs[3];
+            return true;
+        }
+        last = value;
+    }
+
+    return false;
+}
+
+/**
+ * Frees the RX buffer up to rd: one RD write and one RECV command for all bursts of a wakeup.
+ * @return ESP_OK, ESP_ERR_TIMEOUT if the W5500 did not take the command, ESP_FAIL.
+ */
+static esp_err_t w5500_burst_rx_consume(uint16_t rd)
+{
+    uint8_t regs[2] = { rd >> 8, rd & 0xff };
+    uint8_t cmd = W5500_BURST_RX_SCR_RECV;
+
+    if (w5500_spi_write(W5500_BURST_RX_REG_SOCK_RX_RD, W5500_SPI_BSB_SOCK_REG(0), regs, sizeof(regs)) != ESP_OK
+        || w5500_spi_write(W5500_BURST_RX_REG_SOCK_CR, W5500_SPI_BSB_SOCK_REG(0), &cmd, sizeof(cmd)) != ESP_OK) {
+        return ESP_FAIL;
+    }
+
+    // The W5500 clears the command register once it took the command
+    for (int waited = 0; waited < W5500_BURST_RX_CMD_TIMEOUT_MS; waited += 10) {
+        if (w5500_spi_read(W5500_BURST_RX_REG_SOCK_CR, W5500_SPI_BSB_SOCK_REG(0), &cmd, sizeof(cmd)) != ESP_OK) {
+            return ESP_FAIL;
+        }
+        if (cmd == 0) {
+            return ESP_OK;
+        }
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+
+    return ESP_ERR_TIMEOUT;
+}
+
+/**
+ * Reads everything in the RX buffer, in bursts of up to CONFIG_ETH_RX_BURST_SIZE bytes.
+ */
+static void w5500_burst_rx_drain(void)
+{
+    w5500_burst_rx_stats_t counts = { 0 };
+    uint8_t status = 0;
+    uint16_t rsr = 0;
+    uint16_t rd = 0;
+
+    if (w5500_spi_read(W5500_BURST_RX_REG_SOCK_IR, W5500_SPI_BSB_SOCK_REG(0), &status, sizeof(status)) != ESP_OK
+        || !(status & W5500_BURST_RX_SIR_RECV)) {
+        return;
+    }
+
+    // Frames arriving from here on raise the interrupt again
+    status = W5500_BURST_RX_SIR_RECV;
+    w5500_spi_write(W5500_BURST_RX_REG_SOCK_IR, W5500_SPI_BSB_SOCK_REG(0), &status, sizeof(status));
+
+    if (!w5500_burst_rx_read_pointers(&rsr, &rd)) {
+        return;
+    }
+
+    struct netif *lwip_netif = esp_netif_get_netif_impl(s_netif);
+    if (lwip_netif != NULL && !netif_is_up(lwip_netif)) {
+        lwip_netif = NULL;
+    }
+
+    uint16_t start = rd;
+    while (rsr > 0) {
+        w5500_burst_buf_t *buf = NULL;
+        if (xQueueReceive(s_free_bufs, &buf, 0) == pdTRUE) {
+            buf->refs = 1;
+        } else {
+            buf = s_copy_buf;
+        }
+
+        uint32_t len = (rsr < CONFIG_ETH_RX_BURST_SIZE) ? rsr : CONFIG_ETH_RX_BURST_SIZE;
+        bool bad = false;
+        uint32_t used = 0;
+
+        // The RX buffer wraps around in the W5500, one read whatever rd is
+        if (w5500_spi_read(rd, W5500_SPI_BSB_SOCK_RX(0), buf->data, W5500_BURST_RX_READ_LEN(len)) == ESP_OK) {
+            counts.bursts++;
+            used = w5500_burst_rx_parse(lwip_netif, buf, len, &bad, &counts);
+        }
+        if (buf != s_copy_buf) {
+            w5500_burst_rx_release(buf);
+        }
+
+        if (bad) {
+            // Lost framing, nothing after it can be trusted
+            ESP_LOGW(TAG, "w5500_burst_rx_drain: bad frame length, %u bytes flushed", (unsigned)(rsr - used));
+            counts.flushed++;
+            rd += rsr;
+            break;
+        }
+        if (used == 0) {
+            break;
+        }
+        rd += used;
+        rsr -= used;
+    }
+
+    if (rd != start && w5500_burst_rx_consume(rd) != ESP_OK) {
+        ESP_LOGE(TAG, "w5500_burst_rx_drain: RECV command failed");
+    }
+
+    taskENTER_CRITICAL(&s_stats_lock);
+    s_stats.bursts += counts.bursts;
+    s_stats.frames += counts.frames;
+    s_stats.copied += counts.copied;
+    s_stats.dropped += counts.dropped;
+    s_stats.flushed += counts.flushed;
+    taskEXIT_CRITICAL(&s_stats_lock);
+}
+
+/**
+ * INT pin interrupt, replaces the driver's.
+ */
+static void IRAM_ATTR w5500_burst_rx_isr(void *arg)
+{
+    BaseType_t high_task_wakeup = pdFALSE;
+
+    vTaskNotifyGiveFromISR(s_task, &high_task_wakeup);
+    if (high_task_wakeup == pdTRUE) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+/**
+ * RX task, woken by the INT pin or the poll timer of w5500_rx_mode.
+ */
+static void w5500_burst_rx_task(void *arg)
+{
+    while (!s_stop) {
+        // INT stays low while an interrupt is pending, so a missed edge shows up here
+        if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(W5500_BURST_RX_IDLE_CHECK_MS)) == 0
+            && gpio_get_level(s_int_gpio) != 0) {
+            continue;
+        }
+        if (!s_stop) {
+            w5500_burst_rx_drain();
+        }
+    }
+
+    xSemaphoreGive(s_exit);
+    vTaskDelete(NULL);
+}
+
+/**
+ * Frees what w5500_burst_rx_alloc got before it failed.
+ */
+static void w5500_burst_rx_free(void)
+{
+    for (int i = 0; i <= CONFIG_ETH_RX_BURST_BUFFERS; i++) {
+        heap_caps_free(s_bufs[i].data);
+        s_bufs[i].data = NULL;
+    }
+    if (s_free_bufs != NULL) {
+        vQueueDelete(s_free_bufs);
+        s_free_bufs = NULL;
+    }
+    if (s_exit != NULL) {
+        vSemaphoreDelete(s_exit);
+        s_exit = NULL;
+    }
+}
+
+/**
+ * Allocates the burst buffers and fills the pools, once.
+ * @return ESP_OK, ESP_ERR_NO_MEM.
+ */
+static esp_err_t w5500_burst_rx_alloc(void)
+{
+    if (s_free_bufs != NULL) {
+        return ESP_OK;
+    }
+
+    s_exit = xSemaphoreCreateBinary();
+    s_free_bufs = xQueueCreate(CONFIG_ETH_RX_BURST_BUFFERS, sizeof(w5500_burst_buf_t*));
+    if (s_exit == NULL || s_free_bufs == NULL) {
+        w5500_burst_rx_free();
+        return ESP_ERR_NO_MEM;
+    }
+
+    for (int i = 0; i <= CONFIG_ETH_RX_BURST_BUFFERS; i++) {
+        s_bufs[i].data = heap_caps_malloc(W5500_BURST_RX_BUF_LEN, MALLOC_CAP_DMA);
+        if (s_bufs[i].data == NULL) {
+            ESP_LOGE(TAG, "w5500_burst_rx_alloc: no memory for %d burst buffers of %d bytes",
+                     CONFIG_ETH_RX_BURST_BUFFERS + 1, W5500_BURST_RX_BUF_LEN);
+            w5500_burst_rx_free();
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    for (int i = 0; i < CONFIG_ETH_RX_BURST_BUFFERS; i++) {
+        w5500_burst_buf_t *buf = &s_bufs[i];
+        xQueueSend(s_free_bufs, &buf, 0);
+    }
+
+    for (int i = 0; i < CONFIG_ETH_RX_BURST_PBUFS; i++) {
+        s_pbufs[i].next = s_free_pbufs;
+        s_free_pbufs = &s_pbufs[i];
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t w5500_burst_rx_start(esp_netif_t *netif, int int_gpio, TaskHandle_t *rx_task)
+{
+    uint8_t status;
+
+    if (int_gpio < 0) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    if (s_task != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // The W5500 is only reachable here if the driver was created with w5500_spi_custom_driver
+    if (w5500_spi_read(W5500_BURST_RX_REG_SOCK_IR, W5500_SPI_BSB_SOCK_REG(0), &status, sizeof(status)) == ESP_ERR_INVALID_STATE) {
+        ESP_LOGE(TAG, "w5500_burst_rx_start: MAC driver without the custom SPI driver");
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    TaskHandle_t driver_task = xTaskGetHandle(W5500_RX_MODE_DRIVER_TASK);
+    if (driver_task == NULL) {
+        ESP_LOGE(TAG, "w5500_burst_rx_start: W5500 driver task not found");
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    if (w5500_burst_rx_alloc() != ESP_OK) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    // The driver task is parked between SPI transactions, never with the device selected or the lock held
+    esp_err_t ret = w5500_spi_lock();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "w5500_burst_rx_start: SPI device busy");
+        return ret;
+    }
+
+    s_netif = netif;
+    s_int_gpio = int_gpio;
+    s_stop = false;
+    xSemaphoreTake(s_exit, 0);
+
+    if (xTaskCreatePinnedToCore(w5500_burst_rx_task, "w5500_burst_rx", W5500_BURST_RX_TASK_STACK_SIZE, NULL,
+                                W5500_BURST_RX_TASK_PRIORITY, &s_task, W5500_BURST_RX_TASK_CORE_ID) != pdPASS) {
+        w5500_spi_unlock();
+        s_task = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    // Until the driver starts, its task only waits for the interrupt, which now wakes ours
+    vTaskSuspend(driver_task);
+    w5500_spi_unlock();
+    gpio_isr_handler_remove(int_gpio);
+    gpio_isr_handler_add(int_gpio, w5500_burst_rx_isr, NULL);
+
+    *rx_task = s_task;
+
+    ESP_LOGI(TAG, "w5500_burst_rx_start: %d byte bursts, %d buffers, %d pbufs",
+             CONFIG_ETH_RX_BURST_SIZE, CONFIG_ETH_RX_BURST_BUFFERS, CONFIG_ETH_RX_BURST_PBUFS);
+
+    return ESP_OK;
+}
+
+void w5500_burst_rx_stop(void)
+{
+    if (s_task == NULL) {
+        return;
+    }
+
+    // Nothing wakes the task once its interrupt is gone
+    gpio_isr_handler_remove(s_int_gpio);
+
+    s_stop = true;
+    xTaskNotifyGive(s_task);
+    if (xSemaphoreTake(s_exit, pdMS_TO_TICKS(W5500_BURST_RX_STOP_TIMEOUT_MS)) != pdTRUE) {
+        ESP_LOGW(TAG, "w5500_burst_rx_stop: RX task did not end");
+    }
+    s_task = NULL;
+}
+
+void w5500_burst_rx_get_stats(w5500_burst_rx_stats_t *stats)
+{
+    taskENTER_CRITICAL(&s_stats_lock);
+    *stats = s_stats;
+    taskEXIT_CRITICAL(&s_stats_lock);
+}
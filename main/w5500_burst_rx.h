@@ -0,0 +1,84 @@
+/*
+ * w5500_burst_rx.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef MAIN_W5500_BURST_RX_H_
+#define MAIN_W5500_BURST_RX_H_
+
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "esp_netif.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// Socket 0 registers (MACRAW socket of the MAC driver)
+#define W5500_BURST_RX_REG_SOCK_CR      0x0001
+#define W5500_BURST_RX_REG_SOCK_IR      0x0002
+#define W5500_BURST_RX_REG_SOCK_RX_RSR  0x0026  // Followed by Sn_RX_RD at 0x0028, read together
+#define W5500_BURST_RX_REG_SOCK_RX_RD   0x0028
+#define W5500_BURST_RX_SIR_RECV         0x04
+#define W5500_BURST_RX_SCR_RECV         0x40
+
+// MACRAW frame: 2-byte big-endian length (including itself), then the frame without FCS
+#define W5500_BURST_RX_HEADER_LEN       2
+#define W5500_BURST_RX_MIN_FRAME        14      // Ethernet header
+#define W5500_BURST_RX_MAX_FRAME        1518    // VLAN tagged, without FCS
+
+// RSR reads until two in a row agree, as the W5500 datasheet asks
+#define W5500_BURST_RX_RSR_READS        4
+
+// Longest wait for the W5500 to take the RECV command
+#define W5500_BURST_RX_CMD_TIMEOUT_MS   100
+
+// Wakeup without notification to check for an INT edge that was missed
+#define W5500_BURST_RX_IDLE_CHECK_MS    1000
+
+// Longest wait for the RX task to end
+#define W5500_BURST_RX_STOP_TIMEOUT_MS  1000
+
+/**
+ * Counters, all wrap.
+ */
+typedef struct w5500_burst_rx_stats
+{
+    uint32_t bursts;                    // SPI reads of the RX buffer
+    uint32_t frames;                    // Frames passed to the stack
+    uint32_t copied;                    // Frames copied because every burst buffer or pbuf was in use
+    uint32_t dropped;                   // Frames without pbuf, refused by the stack or while the netif was down
+    uint32_t flushed;                   // RX buffer flushes after a bad frame length
+} w5500_burst_rx_stats_t;
+
+/**
+ * Takes RX over from the W5500 MAC driver. The driver's RX task is suspended and a task of its own,
+ * woken by the INT pin, reads everything queued in the 16 kB RX buffer in SPI DMA bursts of up to
+ * CONFIG_ETH_RX_BURST_SIZE bytes: one SPI transaction per burst instead of a register read, a header
+ * read, a frame read and a copy per frame. Each frame goes to lwIP as a pbuf from a dedicated pool
+ * (CONFIG_ETH_RX_BURST_PBUFS) that references the burst buffer, which returns to its pool
+ * (CONFIG_ETH_RX_BURST_BUFFERS) when the stack has freed all of its frames. While every buffer or
+ * pbuf is in use, frames are copied into pbufs from the heap.
+ * Call after the driver is installed with w5500_spi_custom_driver and before it is started, while
+ * its RX task is idle. The driver's TX path keeps working. The RX task stays suspended until the driver
+ * is uninstalled, so a stopped driver must be uninstalled before it is started again.
+ * @param netif netif attached to the driver.
+ * @param int_gpio INT pin of the W5500.
+ * @param rx_task receives the RX task, for w5500_rx_mode_start.
+ * @return ESP_OK, ESP_ERR_NOT_SUPPORTED without INT pin or custom SPI driver, ESP_ERR_NOT_FOUND if
+ * the driver task is missing, ESP_ERR_INVALID_STATE if already started, ESP_ERR_NO_MEM.
+ */
+esp_err_t w5500_burst_rx_start(esp_netif_t *netif, int int_gpio, TaskHandle_t *rx_task);
+
+/**
+ * Ends the RX task, call before the driver stops. Frames still held by the stack stay valid.
+ */
+void w5500_burst_rx_stop(void);
+
+/**
+ * Gets the counters.
+ * @param stats receives them.
+ */
+void w5500_burst_rx_get_stats(w5500_burst_rx_stats_t *stats);
+
+#endif /* MAIN_W5500_BURST_RX_H_ */
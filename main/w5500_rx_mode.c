@@ -0,0 +1,299 @@
+/*
+ * w5500_rx_mode.c
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/gpio.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "lwip/tcpip.h"
+#include "lwip/udp.h"
+#include "sdkconfig.h"
+
+#include "cpu_load.h"
+#include "w5500_rx_mode.h"
+
+// Tag used for ESP serial console messages
+static const char TAG[] = "w5500_rx_mode";
+
+#if CONFIG_ETH_RX_MODE_POLLING
+#define W5500_RX_MODE_DEFAULT   W5500_RX_MODE_POLLING
+#elif CONFIG_ETH_RX_MODE_ADAPTIVE
+#define W5500_RX_MODE_DEFAULT   W5500_RX_MODE_ADAPTIVE
+#else
+#define W5500_RX_MODE_DEFAULT   W5500_RX_MODE_INTERRUPT
+#endif
+
+// RX task (the MAC driver's or the burst RX task) and the INT pin that wakes it
+static TaskHandle_t s_rx_task = NULL;
+static int s_int_gpio = -1;
+
+// Poll timer, and the window timer that measures the RX rate and switches the mode
+static esp_timer_handle_t s_poll_timer = NULL;
+static esp_timer_handle_t s_window_timer = NULL;
+
+// Mode and counters, updated by the RX task and the timers
+static w5500_rx_mode_stats_t s_stats = { .mode = W5500_RX_MODE_DEFAULT };
+static portMUX_TYPE s_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Window state, window timer only
+static uint32_t s_window_frames = 0;
+static int s_quiet_windows = 0;
+static int s_load_windows = 0;
+static cpu_load_sample_t s_load_start;
+
+// Discard service, bound once
+static struct udp_pcb *s_discard_pcb = NULL;
+
+/**
+ * Input path of the MAC driver: counts the frame and passes it to the netif like the netif glue.
+ */
+static esp_err_t w5500_rx_mode_input(esp_eth_handle_t eth_handle, uint8_t *buffer, uint32_t length, void *priv)
+{
+    w5500_rx_mode_count_frame(length);
+
+    return esp_netif_receive((esp_netif_t*)priv, buffer, length, NULL);
+}
+
+/**
+ * Poll timer: wakes the RX task as the INT pin would.
+ */
+static void w5500_rx_mode_poll(void *arg)
+{
+    taskENTER_CRITICAL(&s_stats_lock);
+    s_stats.polls++;
+    taskEXIT_CRITICAL(&s_stats_lock);
+
+    xTaskNotifyGive(s_rx_task);
+}
+
+/**
+ * Moves the wakeups between the INT pin and the poll timer. Window timer only.
+ * @param poll true to poll.
+ * @param adaptive counted as an adaptive switch.
+ */
+static void w5500_rx_mode_switch(bool poll, bool adaptive)
+{
+    if (poll) {
+        gpio_intr_disable(s_int_gpio);
+        esp_timer_start_periodic(s_poll_timer, CONFIG_ETH_RX_POLL_PERIOD_US);
+    } else {
+        esp_timer_stop(s_poll_timer);
+        gpio_intr_enable(s_int_gpio);
+
+        // The interrupt is edge triggered, INT may have gone low while it was disabled
+        xTaskNotifyGive(s_rx_task);
+    }
+
+    taskENTER_CRITICAL(&s_stats_lock);
+    s_stats.polling = poll;
+    if (adaptive) {
+        if (poll) {
+            s_stats.to_polling++;
+        } else {
+            s_stats.to_interrupt++;
+        }
+    }
+    taskEXIT_CRITICAL(&s_stats_lock);
+}
+
+/**
+ * Window timer: RX rate, mode decision with hysteresis, CPU load.
+ */
+static void w5500_rx_mode_window(void *arg)
+{
+    taskENTER_CRITICAL(&s_stats_lock);
+    uint32_t frames = s_stats.rx_frames - s_window_frames;
+    s_window_frames = s_stats.rx_frames;
+    uint32_t fps = frames * 1000 / W5500_RX_MODE_WINDOW_MS;
+    s_stats.rx_fps = fps;
+    w5500_rx_mode_e mode = s_stats.mode;
+    bool polling = s_stats.polling;
+    taskEXIT_CRITICAL(&s_stats_lock);
+
+    bool poll = polling;
+    switch (mode) {
+        case W5500_RX_MODE_INTERRUPT:
+            poll = false;
+            break;
+
+        case W5500_RX_MODE_POLLING:
+            poll = true;
+            break;
+
+        case W5500_RX_MODE_ADAPTIVE:
+            // Polls at once above the upper threshold, stops only after a while below the lower one
+            if (!polling) {
+                poll = (fps >= CONFIG_ETH_RX_ADAPTIVE_POLL_FPS);
+                s_quiet_windows = 0;
+            } else {
+                s_quiet_windows = (fps <= CONFIG_ETH_RX_ADAPTIVE_IRQ_FPS) ? s_quiet_windows + 1 : 0;
+                poll = (s_quiet_windows < W5500_RX_MODE_HOLD_WINDOWS);
+            }
+            break;
+    }
+
+    if (poll != polling) {
+        w5500_rx_mode_switch(poll, mode == W5500_RX_MODE_ADAPTIVE);
+    }
+
+    if (++s_load_windows >= W5500_RX_MODE_LOAD_WINDOWS) {
+        cpu_load_sample_t now;
+        cpu_load_sample(&now);
+
+        taskENTER_CRITICAL(&s_stats_lock);
+        for (int core = 0; core < portNUM_PROCESSORS; core++) {
+            s_stats.cpu_load[core] = cpu_load_percent(&s_load_start, &now, core);
+        }
+        taskEXIT_CRITICAL(&s_stats_lock);
+
+        s_load_start = now;
+        s_load_windows = 0;
+    }
+}
+
+/**
+ * Discard service receive callback.
+ */
+static void w5500_rx_mode_discard(void *arg, struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *addr, u16_t port)
+{
+    pbuf_free(p);
+}
+
+/**
+ * Binds the discard service, in the TCP/IP thread.
+ */
+static void w5500_rx_mode_bind_discard(void *ctx)
+{
+    s_discard_pcb = udp_new();
+    if (s_discard_pcb != NULL) {
+        udp_bind(s_discard_pcb, IP_ANY_TYPE, W5500_RX_MODE_DISCARD_PORT);
+        udp_recv(s_discard_pcb, w5500_rx_mode_discard, NULL);
+    }
+}
+
+esp_err_t w5500_rx_mode_start(esp_eth_handle_t eth_handle, esp_netif_t *netif, int int_gpio, TaskHandle_t rx_task)
+{
+    if (int_gpio < 0) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    s_rx_task = (rx_task != NULL) ? rx_task : xTaskGetHandle(W5500_RX_MODE_DRIVER_TASK);
+    if (s_rx_task == NULL) {
+        ESP_LOGE(TAG, "W5500 driver task not found");
+        return ESP_ERR_NOT_FOUND;
+    }
+    s_int_gpio = int_gpio;
+
+    if (s_poll_timer == NULL) {
+        const esp_timer_create_args_t poll_args = {
+            .callback = w5500_rx_mode_poll,
+            .name = "w5500_poll",
+        };
+        const esp_timer_create_args_t window_args = {
+            .callback = w5500_rx_mode_window,
+            .name = "w5500_rx_window",
+        };
+
+        if (esp_timer_create(&poll_args, &s_poll_timer) != ESP_OK
+            || esp_timer_create(&window_args, &s_window_timer) != ESP_OK) {
+            return ESP_ERR_NO_MEM;
+        }
+
+        tcpip_callback(w5500_rx_mode_bind_discard, NULL);
+    }
+
+    // Replaces the input path the netif glue set on attach
+    esp_eth_update_input_path(eth_handle, w5500_rx_mode_input, netif);
+
+    taskENTER_CRITICAL(&s_stats_lock);
+    s_stats.polling = false;
+    s_window_frames = s_stats.rx_frames;
+    taskEXIT_CRITICAL(&s_stats_lock);
+
+    s_quiet_windows = 0;
+    s_load_windows = 0;
+    cpu_load_sample(&s_load_start);
+
+    // The first window applies the mode
+    esp_timer_start_periodic(s_window_timer, W5500_RX_MODE_WINDOW_MS * 1000);
+
+    ESP_LOGI(TAG, "RX mode %s", w5500_rx_mode_name(s_stats.mode));
+
+    return ESP_OK;
+}
+
+void w5500_rx_mode_stop(void)
+{
+    if (s_window_timer == NULL) {
+        return;
+    }
+
+    esp_timer_stop(s_window_timer);
+    if (s_stats.polling) {
+        w5500_rx_mode_switch(false, false);
+    }
+    s_rx_task = NULL;
+}
+
+esp_err_t w5500_rx_mode_set(w5500_rx_mode_e mode)
+{
+    if (mode > W5500_RX_MODE_ADAPTIVE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_rx_task == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // Applied by the next window, so only the window timer switches
+    taskENTER_CRITICAL(&s_stats_lock);
+    s_stats.mode = mode;
+    taskEXIT_CRITICAL(&s_stats_lock);
+
+    ESP_LOGI(TAG, "RX mode %s", w5500_rx_mode_name(mode));
+
+    return ESP_OK;
+}
+
+bool w5500_rx_mode_from_name(const char *name, w5500_rx_mode_e *mode)
+{
+    for (w5500_rx_mode_e m = W5500_RX_MODE_INTERRUPT; m <= W5500_RX_MODE_ADAPTIVE; m++) {
+        if (strcmp(name, w5500_rx_mode_name(m)) == 0) {
+            *mode = m;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+const char* w5500_rx_mode_name(w5500_rx_mode_e mode)
+{
+    switch (mode) {
+        case W5500_RX_MODE_INTERRUPT:   return "interrupt";
+        case W5500_RX_MODE_POLLING:     return "polling";
+        case W5500_RX_MODE_ADAPTIVE:    return "adaptive";
+    }
+
+    return "unknown";
+}
+
+void w5500_rx_mode_count_frame(uint32_t length)
+{
+    taskENTER_CRITICAL(&s_stats_lock);
+    s_stats.rx_frames++;
+    s_stats.rx_bytes += length;
+    taskEXIT_CRITICAL(&s_stats_lock);
+}
+
+void w5500_rx_mode_get_stats(w5500_rx_mode_stats_t *stats)
+{
+    taskENTER_CRITICAL(&s_stats_lock);
+    *stats = s_stats;
+    taskEXIT_CRITICAL(&s_stats_lock);
+}
@@ -0,0 +1,110 @@
+/*
+ * w5500_rx_mode.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef MAIN_W5500_RX_MODE_H_
+#define MAIN_W5500_RX_MODE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "esp_eth.h"
+#include "esp_netif.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// Name of the RX task of the W5500 MAC driver, woken by its GPIO interrupt or by the poll timer
+#define W5500_RX_MODE_DRIVER_TASK       "w5500_tsk"
+
+// RX rate window of the adaptive mode
+#define W5500_RX_MODE_WINDOW_MS         100
+
+// Windows in a row below the interrupt threshold before the adaptive mode stops polling
+#define W5500_RX_MODE_HOLD_WINDOWS      5
+
+// Windows per CPU load measurement
+#define W5500_RX_MODE_LOAD_WINDOWS      10
+
+// UDP discard service (RFC 863), a sink for benchmark traffic
+#define W5500_RX_MODE_DISCARD_PORT      9
+
+/**
+ * How the W5500 RX task is woken.
+ */
+typedef enum w5500_rx_mode
+{
+    W5500_RX_MODE_INTERRUPT = 0,        // INT pin, one wakeup per interrupt
+    W5500_RX_MODE_POLLING,              // Every CONFIG_ETH_RX_POLL_PERIOD_US, INT pin disabled
+    W5500_RX_MODE_ADAPTIVE,             // Polling above CONFIG_ETH_RX_ADAPTIVE_POLL_FPS, interrupt again below CONFIG_ETH_RX_ADAPTIVE_IRQ_FPS
+} w5500_rx_mode_e;
+
+/**
+ * Mode and counters.
+ */
+typedef struct w5500_rx_mode_stats
+{
+    w5500_rx_mode_e mode;               // Configured mode
+    bool polling;                       // Current wakeup source
+    uint32_t rx_frames;                 // Frames passed to the stack (wraps)
+    uint32_t rx_bytes;                  // Bytes passed to the stack (wraps)
+    uint32_t rx_fps;                    // Frames per second in the last window
+    uint32_t polls;                     // Poll timer wakeups
+    uint32_t to_polling;                // Adaptive switches to polling
+    uint32_t to_interrupt;              // Adaptive switches back to interrupt
+    uint32_t cpu_load[portNUM_PROCESSORS];  // Percent per core over the last W5500_RX_MODE_LOAD_WINDOWS windows
+} w5500_rx_mode_stats_t;
+
+/**
+ * Starts counting RX frames and applies the mode (CONFIG_ETH_RX_MODE until w5500_rx_mode_set changes it).
+ * Call once the netif is attached (the frame counter replaces its input path) and the driver is
+ * started in interrupt mode. Also binds the UDP discard service.
+ * @param eth_handle Ethernet handle.
+ * @param netif netif attached to eth_handle.
+ * @param int_gpio INT pin of the W5500.
+ * @param rx_task task the INT pin and the poll timer wake, NULL for the MAC driver's RX task.
+ * @return ESP_OK, ESP_ERR_NOT_SUPPORTED without INT pin, ESP_ERR_NOT_FOUND if the driver task is missing,
+ * ESP_ERR_NO_MEM.
+ */
+esp_err_t w5500_rx_mode_start(esp_eth_handle_t eth_handle, esp_netif_t *netif, int int_gpio, TaskHandle_t rx_task);
+
+/**
+ * Stops the timers and gives the INT pin back to the driver, call before the driver stops.
+ */
+void w5500_rx_mode_stop(void);
+
+/**
+ * Changes the mode.
+ * @param mode new mode.
+ * @return ESP_OK, ESP_ERR_INVALID_STATE if not started, ESP_ERR_INVALID_ARG.
+ */
+esp_err_t w5500_rx_mode_set(w5500_rx_mode_e mode);
+
+/**
+ * Parses a mode name: "interrupt", "polling" or "adaptive".
+ * @param name mode name.
+ * @param mode receives the mode.
+ * @return true if the name is known.
+ */
+bool w5500_rx_mode_from_name(const char *name, w5500_rx_mode_e *mode);
+
+/**
+ * Gets the name of a mode.
+ */
+const char* w5500_rx_mode_name(w5500_rx_mode_e mode);
+
+/**
+ * Counts a frame passed to the stack, for RX paths that bypass the driver's input path.
+ * @param length frame length.
+ */
+void w5500_rx_mode_count_frame(uint32_t length);
+
+/**
+ * Gets the mode and the counters.
+ * @param stats receives them.
+ */
+void w5500_rx_mode_get_stats(w5500_rx_mode_stats_t *stats);
+
+#endif /* MAIN_W5500_RX_MODE_H_ */
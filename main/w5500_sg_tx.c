@@ -0,0 +1,263 @@
+/*
+ * w5500_sg_tx.c
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "lwip/netif.h"
+#include "lwip/pbuf.h"
+#include "lwip/tcpip.h"
+
+#include "w5500_sg_tx.h"
+#include "w5500_spi.h"
+
+// Tag used for ESP serial console messages
+static const char TAG[] = "w5500_sg_tx";
+
+// netif with the replaced link output, and the netif glue's, TCP/IP thread only
+static esp_netif_t *s_esp_netif = NULL;
+static struct netif *s_netif = NULL;
+static netif_linkoutput_fn s_glue_output = NULL;
+
+// Sn_TX_WR as written by the last SEND, and whether that SEND may still be running
+static uint16_t s_wr = 0;
+static bool s_wr_valid = false;
+static bool s_send_pending = false;
+
+// Frames with too many pbufs are copied here, DMA capable
+static uint8_t *s_copy_buf = NULL;
+
+// Counters
+static w5500_sg_tx_stats_t s_stats;
+static portMUX_TYPE s_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * Waits for SEND_OK of the previous frame and acknowledges it.
+ * @param waited set if it was not there at the first read.
+ * @return ESP_OK, ESP_ERR_TIMEOUT, ESP_FAIL.
+ */
+static esp_err_t w5500_sg_tx_wait_send(bool *waited)
+{
+    int64_t start = esp_timer_get_time();
+    uint8_t status = 0;
+
+    for (;;) {
+        if (w5500_spi_read(W5500_SG_TX_REG_SOCK_IR, W5500_SPI_BSB_SOCK_REG(0), &status, sizeof(status)) != ESP_OK) {
+            return ESP_FAIL;
+        }
+        if (status & W5500_SG_TX_SIR_SEND_OK) {
+            break;
+        }
+        if (esp_timer_get_time() - start > W5500_SG_TX_SEND_TIMEOUT_US) {
+            return ESP_ERR_TIMEOUT;
+        }
+        *waited = true;
+    }
+
+    s_send_pending = false;
+    status = W5500_SG_TX_SIR_SEND_OK;
+
+    return w5500_spi_write(W5500_SG_TX_REG_SOCK_IR, W5500_SPI_BSB_SOCK_REG(0), &status, sizeof(status));
+}
+
+/**
+ * Writes the frame behind the previous one and sends it once the previous one is out.
+ * @return ESP_OK, ESP_ERR_TIMEOUT, ESP_FAIL.
+ */
+static esp_err_t w5500_sg_tx_send(const w5500_spi_segment_t *segments, int count, uint16_t len, bool *waited)
+{
+    if (!s_wr_valid) {
+        uint8_t regs[2];
+        if (w5500_spi_read(W5500_SG_TX_REG_SOCK_TX_WR, W5500_SPI_BSB_SOCK_REG(0), regs, sizeof(regs)) != ESP_OK) {
+            return ESP_FAIL;
+        }
+        s_wr = (regs[0] << 8) | regs[1];
+        s_wr_valid = true;
+    }
+
+    // The TX buffer holds 16 kB, the frame on the wire and this one always fit
+    if (w5500_spi_write_segments(s_wr, W5500_SPI_BSB_SOCK_TX(0), segments, count) != ESP_OK) {
+        return ESP_FAIL;
+    }
+
+    if (s_send_pending) {
+        esp_err_t ret = w5500_sg_tx_wait_send(waited);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+
+    uint16_t wr = s_wr + len;
+    uint8_t regs[2] = { wr >> 8, wr & 0xff };
+    uint8_t cmd = W5500_SG_TX_SCR_SEND;
+
+    if (w5500_spi_write(W5500_SG_TX_REG_SOCK_TX_WR, W5500_SPI_BSB_SOCK_REG(0), regs, sizeof(regs)) != ESP_OK
+        || w5500_spi_write(W5500_SG_TX_REG_SOCK_CR, W5500_SPI_BSB_SOCK_REG(0), &cmd, sizeof(cmd)) != ESP_OK) {
+        return ESP_FAIL;
+    }
+
+    s_wr = wr;
+    s_send_pending = true;
+
+    return ESP_OK;
+}
+
+/**
+ * Link output of the netif, in the TCP/IP thread.
+ */
+static err_t w5500_sg_tx_output(struct netif *netif, struct pbuf *p)
+{
+    w5500_spi_segment_t segments[W5500_SG_TX_MAX_SEGMENTS];
+    int count = 0;
+    bool copied = false;
+    bool waited = false;
+
+    if (p->tot_len > W5500_SG_TX_MAX_FRAME) {
+        return ERR_IF;
+    }
+
+    for (struct pbuf *q = p; q != NULL; q = q->next) {
+        if (q->len == 0) {
+            continue;
+        }
+        if (count == W5500_SG_TX_MAX_SEGMENTS) {
+            copied = true;
+            break;
+        }
+        segments[count].data = q->payload;
+        segments[count].len = q->len;
+        count++;
+    }
+
+    if (copied) {
+        pbuf_copy_partial(p, s_copy_buf, p->tot_len, 0);
+        segments[0].data = s_copy_buf;
+        segments[0].len = p->tot_len;
+        count = 1;
+    }
+
+    esp_err_t ret = (count > 0) ? w5500_sg_tx_send(segments, count, p->tot_len, &waited) : ESP_FAIL;
+    if (ret != ESP_OK) {
+        // Starts over from the W5500's pointer. A SEND still on the wire keeps the next frame waiting
+        // for its SEND_OK, unless that already timed out
+        s_wr_valid = false;
+        if (ret == ESP_ERR_TIMEOUT) {
+            s_send_pending = false;
+        }
+    }
+
+    taskENTER_CRITICAL(&s_stats_lock);
+    if (ret == ESP_OK) {
+        s_stats.frames++;
+        s_stats.segments += copied ? 0 : count;
+        s_stats.copied += copied;
+        s_stats.send_waits += waited;
+    } else {
+        s_stats.errors++;
+    }
+    taskEXIT_CRITICAL(&s_stats_lock);
+
+    return (ret == ESP_OK) ? ERR_OK : ERR_IF;
+}
+
+/**
+ * Replaces the link output, in the TCP/IP thread.
+ */
+static err_t w5500_sg_tx_hook(struct tcpip_api_call_data *call)
+{
+    struct netif *lwip_netif = esp_netif_get_netif_impl(s_esp_netif);
+
+    if (lwip_netif == NULL || lwip_netif->linkoutput == NULL) {
+        return ERR_IF;
+    }
+
+    if (lwip_netif->linkoutput != w5500_sg_tx_output) {
+        // The glue's output waits for SEND_OK itself, nothing is pending
+        s_glue_output = lwip_netif->linkoutput;
+        lwip_netif->linkoutput = w5500_sg_tx_output;
+        s_netif = lwip_netif;
+        s_wr_valid = false;
+        s_send_pending = false;
+    }
+
+    return ERR_OK;
+}
+
+/**
+ * Gives the link output back, in the TCP/IP thread.
+ */
+static err_t w5500_sg_tx_unhook(struct tcpip_api_call_data *call)
+{
+    bool waited = false;
+
+    if (s_netif == NULL) {
+        return ERR_OK;
+    }
+
+    // The glue's output expects no SEND in flight
+    if (s_send_pending) {
+        w5500_sg_tx_wait_send(&waited);
+    }
+
+    if (s_netif->linkoutput == w5500_sg_tx_output) {
+        s_netif->linkoutput = s_glue_output;
+    }
+    s_netif = NULL;
+    s_wr_valid = false;
+    s_send_pending = false;
+
+    return ERR_OK;
+}
+
+esp_err_t w5500_sg_tx_start(esp_netif_t *netif)
+{
+    struct tcpip_api_call_data call;
+    uint8_t regs[2];
+
+    // The W5500 is only reachable here if the driver was created with w5500_spi_custom_driver
+    if (w5500_spi_read(W5500_SG_TX_REG_SOCK_TX_WR, W5500_SPI_BSB_SOCK_REG(0), regs, sizeof(regs)) == ESP_ERR_INVALID_STATE) {
+        ESP_LOGE(TAG, "w5500_sg_tx_start: MAC driver without the custom SPI driver");
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    if (s_copy_buf == NULL) {
+        s_copy_buf = heap_caps_malloc(W5500_SG_TX_MAX_FRAME, MALLOC_CAP_DMA);
+        if (s_copy_buf == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    s_esp_netif = netif;
+    if (tcpip_api_call(w5500_sg_tx_hook, &call) != ERR_OK) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    ESP_LOGI(TAG, "w5500_sg_tx_start: scatter-gather TX active");
+
+    return ESP_OK;
+}
+
+void w5500_sg_tx_stop(void)
+{
+    struct tcpip_api_call_data call;
+
+    if (s_esp_netif == NULL) {
+        return;
+    }
+
+    tcpip_api_call(w5500_sg_tx_unhook, &call);
+    s_esp_netif = NULL;
+}
+
+void w5500_sg_tx_get_stats(w5500_sg_tx_stats_t *stats)
+{
+    taskENTER_CRITICAL(&s_stats_lock);
+    *stats = s_stats;
+    taskEXIT_CRITICAL(&s_stats_lock);
+}
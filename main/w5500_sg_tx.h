@@ -0,0 +1,71 @@
+/*
+ * w5500_sg_tx.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef MAIN_W5500_SG_TX_H_
+#define MAIN_W5500_SG_TX_H_
+
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "esp_netif.h"
+
+// Socket 0 registers (MACRAW socket of the MAC driver)
+#define W5500_SG_TX_REG_SOCK_CR         0x0001
+#define W5500_SG_TX_REG_SOCK_IR         0x0002
+#define W5500_SG_TX_REG_SOCK_TX_WR      0x0024
+#define W5500_SG_TX_SIR_SEND_OK         0x10
+#define W5500_SG_TX_SCR_SEND            0x20
+
+// Longest frame without FCS (VLAN tagged), the W5500 adds the FCS
+#define W5500_SG_TX_MAX_FRAME           1518
+
+// pbufs per frame written in place, longer chains are copied into one buffer first
+#define W5500_SG_TX_MAX_SEGMENTS        8
+
+// Longest wait for SEND_OK of the previous frame, a 1518 byte frame takes 1.2 ms at 10 Mbit/s
+#define W5500_SG_TX_SEND_TIMEOUT_US     5000
+
+/**
+ * Counters, all wrap.
+ */
+typedef struct w5500_sg_tx_stats
+{
+    uint32_t frames;                    // Frames sent
+    uint32_t segments;                  // pbufs written in place
+    uint32_t copied;                    // Frames with more than W5500_SG_TX_MAX_SEGMENTS pbufs, copied
+    uint32_t send_waits;                // Frames that found the previous one still being sent
+    uint32_t errors;                    // Frames dropped: SPI failure or SEND_OK timeout
+} w5500_sg_tx_stats_t;
+
+/**
+ * Replaces the link output of the netif with a TX path to the W5500 that skips the MAC driver:
+ * - the pbuf chain is written to the TX buffer as one SPI frame, a DMA transaction per pbuf with
+ *   chip select held, where the netif glue copies chains into one buffer first
+ * - Sn_TX_WR is kept here instead of reading Sn_TX_FSR and Sn_TX_WR for every frame
+ * - SEND_OK is acknowledged lazily: the next frame is written behind the one on the wire and only
+ *   then waits for SEND_OK before its SEND, so no frame polls for its own completion
+ * - the command register is not polled after SEND, SEND_OK implies the W5500 took it
+ * MACRAW sends everything between Sn_TX_RD and Sn_TX_WR as one frame, so every frame still gets
+ * its own SEND. Call once the driver is started and the netif is added (link up), again after each
+ * link up is fine. Needs the MAC driver created with w5500_spi_custom_driver.
+ * @param netif netif attached to the driver.
+ * @return ESP_OK, ESP_ERR_NOT_SUPPORTED without custom SPI driver, ESP_ERR_INVALID_STATE if the netif
+ * is not added, ESP_ERR_NO_MEM.
+ */
+esp_err_t w5500_sg_tx_start(esp_netif_t *netif);
+
+/**
+ * Gives the link output back to the netif glue, call before the driver stops.
+ */
+void w5500_sg_tx_stop(void);
+
+/**
+ * Gets the counters.
+ * @param stats receives them.
+ */
+void w5500_sg_tx_get_stats(w5500_sg_tx_stats_t *stats);
+
+#endif /* MAIN_W5500_SG_TX_H_ */
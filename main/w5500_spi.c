@@ -0,0 +1,429 @@
+/*
+ * w5500_spi.c
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_rom_crc.h"
+#include "sdkconfig.h"
+
+#include "app_nvs.h"
+#include "w5500_spi.h"
+
+// Tag used for ESP serial console messages
+static const char TAG[] = "w5500_spi";
+
+/**
+ * Probe connection: an SPI device at one clock plus DMA capable buffers
+ */
+typedef struct w5500_spi_probe
+{
+    spi_device_handle_t dev;
+    uint8_t *tx;
+    uint8_t *rx;
+} w5500_spi_probe_t;
+
+/**
+ * Custom SPI driver: the device the MAC driver was created with, shared through w5500_spi_read/write
+ */
+typedef struct w5500_spi_driver
+{
+    spi_host_device_t host;
+    spi_device_interface_config_t devcfg;
+    spi_device_handle_t dev;
+    SemaphoreHandle_t lock;
+} w5500_spi_driver_t;
+
+static w5500_spi_driver_t s_driver = { .dev = NULL };
+
+/**
+ * One W5500 SPI frame: the address goes in the command phase, the control byte in the address phase.
+ * @param write true to write len bytes from tx, false to read len bytes into rx.
+ * @return result of spi_device_polling_transmit.
+ */
+static esp_err_t w5500_spi_transfer(spi_device_handle_t dev, uint16_t address, uint8_t bsb, bool write,
+                                    const void *tx, void *rx, size_t len)
+{
+    spi_transaction_t trans = {
+        .cmd = address,
+        .addr = W5500_SPI_CONTROL(bsb, write),
+        .length = len * 8,
+        .tx_buffer = write ? tx : NULL,
+        .rx_buffer = write ? NULL : rx,
+    };
+
+    return spi_device_polling_transmit(dev, &trans);
+}
+
+/**
+ * xorshift32, the loopback data differs in every pass without a table in flash.
+ */
+static uint32_t w5500_spi_next_random(uint32_t *state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+/**
+ * Checks VERSIONR and the register write/read-back patterns: all zeros, all ones, alternating bits
+ * and shifted walking bytes, each written to the scratch registers and read back.
+ * @return true if every read matched.
+ */
+static bool w5500_spi_check_registers(const w5500_spi_probe_t *probe, int patterns)
+{
+    if (w5500_spi_transfer(probe->dev, W5500_SPI_REG_VERSIONR, W5500_SPI_BSB_COMMON, false, NULL, probe->rx, 1) != ESP_OK
+        || probe->rx[0] != W5500_SPI_VERSION) {
+        return false;
+    }
+
+    for (int p = 0; p < patterns; p++) {
+        static const uint8_t fills[] = { 0x00, 0xff, 0x55, 0xaa };
+
+        for (int i = 0; i < W5500_SPI_REG_GAR_LEN; i++) {
+            probe->tx[i] = (p < sizeof(fills)) ? fills[p] : (uint8_t)(1 << ((i + p) & 7));
+        }
+
+        if (w5500_spi_transfer(probe->dev, W5500_SPI_REG_GAR, W5500_SPI_BSB_COMMON, true, probe->tx, NULL, W5500_SPI_REG_GAR_LEN) != ESP_OK
+            || w5500_spi_transfer(probe->dev, W5500_SPI_REG_GAR, W5500_SPI_BSB_COMMON, false, NULL, probe->rx, W5500_SPI_REG_GAR_LEN) != ESP_OK
+            || memcmp(probe->tx, probe->rx, W5500_SPI_REG_GAR_LEN) != 0) {
+            return false;
+        }
+    }
+
+    // Leaves the scratch registers as after reset
+    memset(probe->tx, 0, W5500_SPI_REG_GAR_LEN);
+    w5500_spi_transfer(probe->dev, W5500_SPI_REG_GAR, W5500_SPI_BSB_COMMON, true, probe->tx, NULL, W5500_SPI_REG_GAR_LEN);
+
+    return true;
+}
+
+/**
+ * Writes pseudo-random buffers to the socket 0 TX memory in one burst each and compares
+ * the CRC-32 of what reads back, the long DMA bursts of frame transfers.
+ * @return true if every pass matched.
+ */
+static bool w5500_spi_check_buffer(const w5500_spi_probe_t *probe, int passes, uint32_t seed)
+{
+    uint32_t state = seed | 1;
+
+    for (int pass = 0; pass < passes; pass++) {
+        for (int i = 0; i < W5500_SPI_SOCK_BUF_LEN; i += 4) {
+            uint32_t r = w5500_spi_next_random(&state);
+            memcpy(&probe->tx[i], &r, 4);
+        }
+        uint32_t crc = esp_rom_crc32_le(0, probe->tx, W5500_SPI_SOCK_BUF_LEN);
+
+        if (w5500_spi_transfer(probe->dev, 0, W5500_SPI_BSB_SOCK_TX(0), true, probe->tx, NULL, W5500_SPI_SOCK_BUF_LEN) != ESP_OK
+            || w5500_spi_transfer(probe->dev, 0, W5500_SPI_BSB_SOCK_TX(0), false, NULL, probe->rx, W5500_SPI_SOCK_BUF_LEN) != ESP_OK
+            || esp_rom_crc32_le(0, probe->rx, W5500_SPI_SOCK_BUF_LEN) != crc) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Runs the checks at one clock.
+ * @return true if the W5500 passed them.
+ */
+static bool w5500_spi_check_clock(w5500_spi_probe_t *probe, spi_host_device_t host, int cs_gpio, uint32_t clock_hz,
+                                  int patterns, int passes)
+{
+    // Same frame layout as the W5500 MAC driver
+    spi_device_interface_config_t devcfg = {
+        .command_bits = 16,
+        .address_bits = 8,
+        .mode = 0,
+        .clock_speed_hz = clock_hz,
+        .queue_size = 1,
+        .spics_io_num = cs_gpio,
+    };
+
+    // Clocks the pins cannot carry (GPIO matrix above 26 MHz full duplex) are refused here
+    if (spi_bus_add_device(host, &devcfg, &probe->dev) != ESP_OK) {
+        return false;
+    }
+
+    bool passed = w5500_spi_check_registers(probe, patterns)
+                  && w5500_spi_check_buffer(probe, passes, clock_hz);
+
+    spi_bus_remove_device(probe->dev);
+    probe->dev = NULL;
+
+    return passed;
+}
+
+/**
+ * Probes the clocks, slowest first, the first clock that fails ends the probe.
+ * @return index of the fastest divider that passed, -1 if none did.
+ */
+static int w5500_spi_probe_clocks(w5500_spi_probe_t *probe, spi_host_device_t host, int cs_gpio,
+                                  const uint8_t *dividers, int count, uint32_t max_hz)
+{
+    int passed = -1;
+
+    for (int i = 0; i < count; i++) {
+        uint32_t hz = W5500_SPI_SOURCE_HZ / dividers[i];
+        if (hz > max_hz) {
+            break;
+        }
+
+        bool ok = w5500_spi_check_clock(probe, host, cs_gpio, hz, W5500_SPI_PROBE_REG_PATTERNS, W5500_SPI_PROBE_BUF_PASSES);
+        ESP_LOGI(TAG, "SPI clock %lu Hz: %s", hz, ok ? "passed" : "failed");
+        if (!ok) {
+            break;
+        }
+        passed = i;
+    }
+
+    return passed;
+}
+
+uint32_t w5500_spi_tune_clock(spi_host_device_t host, int cs_gpio, uint32_t fallback_hz)
+{
+    static const uint8_t dividers[] = W5500_SPI_PROBE_DIVIDERS;
+    const uint32_t max_hz = CONFIG_ETH_SPI_CLOCK_MAX_MHZ * 1000 * 1000;
+    w5500_spi_probe_t probe = {
+        .tx = heap_caps_malloc(W5500_SPI_SOCK_BUF_LEN, MALLOC_CAP_DMA),
+        .rx = heap_caps_malloc(W5500_SPI_SOCK_BUF_LEN, MALLOC_CAP_DMA),
+    };
+    uint32_t clock_hz = fallback_hz;
+    uint32_t cached_hz = 0;
+
+    if (probe.tx == NULL || probe.rx == NULL) {
+        ESP_LOGE(TAG, "No memory for the SPI clock probe, using %lu Hz", fallback_hz);
+    } else if (app_nvs_load_eth_spi_clock(&cached_hz) && cached_hz != 0 && cached_hz <= max_hz
+               && w5500_spi_check_clock(&probe, host, cs_gpio, cached_hz, W5500_SPI_PROBE_REG_PATTERNS, W5500_SPI_VERIFY_BUF_PASSES)) {
+        // Fast boot: the cached clock only needs a short check
+        ESP_LOGI(TAG, "Cached SPI clock %lu Hz verified", cached_hz);
+        clock_hz = cached_hz;
+    } else {
+        int passed = w5500_spi_probe_clocks(&probe, host, cs_gpio, dividers, sizeof(dividers), max_hz);
+        if (passed < 0) {
+            ESP_LOGW(TAG, "No probed SPI clock passed, using %lu Hz", fallback_hz);
+            app_nvs_clear_eth_spi_clock();
+        } else {
+            // Margin below the fastest clock that passed, unless that is the slowest one
+            int chosen = (passed > W5500_SPI_PROBE_MARGIN_STEPS) ? passed - W5500_SPI_PROBE_MARGIN_STEPS : 0;
+            clock_hz = W5500_SPI_SOURCE_HZ / dividers[chosen];
+
+            ESP_LOGI(TAG, "SPI clock %lu Hz (fastest passed %lu Hz)", clock_hz, W5500_SPI_SOURCE_HZ / dividers[passed]);
+            app_nvs_save_eth_spi_clock(clock_hz);
+        }
+    }
+
+    heap_caps_free(probe.tx);
+    heap_caps_free(probe.rx);
+
+    return clock_hz;
+}
+
+/**
+ * Custom SPI driver init, called when the MAC driver is created.
+ * @param config the w5500_spi_driver_t.
+ * @return context passed to read, write and deinit, NULL on failure.
+ */
+static void* w5500_spi_driver_init(const void *config)
+{
+    w5500_spi_driver_t *driver = (w5500_spi_driver_t*)config;
+
+    // W5500 frame: 16-bit address in the command phase, control byte in the address phase
+    driver->devcfg.command_bits = 16;
+    driver->devcfg.address_bits = 8;
+
+    if (spi_bus_add_device(driver->host, &driver->devcfg, &driver->dev) != ESP_OK) {
+        ESP_LOGE(TAG, "w5500_spi_driver_init: adding the SPI device failed");
+        return NULL;
+    }
+
+    driver->lock = xSemaphoreCreateMutex();
+    if (driver->lock == NULL) {
+        spi_bus_remove_device(driver->dev);
+        driver->dev = NULL;
+        return NULL;
+    }
+
+    return driver;
+}
+
+/**
+ * Custom SPI driver deinit, called when the MAC driver is deleted.
+ */
+static esp_err_t w5500_spi_driver_deinit(void *ctx)
+{
+    w5500_spi_driver_t *driver = (w5500_spi_driver_t*)ctx;
+
+    spi_bus_remove_device(driver->dev);
+    vSemaphoreDelete(driver->lock);
+    driver->dev = NULL;
+    driver->lock = NULL;
+
+    return ESP_OK;
+}
+
+/**
+ * Custom SPI driver read. Up to 4 bytes go through the transaction's own RX data,
+ * so register reads need no DMA capable buffer.
+ * @param cmd register address.
+ * @param addr control byte.
+ */
+static esp_err_t w5500_spi_driver_read(void *ctx, uint32_t cmd, uint32_t addr, void *data, uint32_t len)
+{
+    w5500_spi_driver_t *driver = (w5500_spi_driver_t*)ctx;
+    spi_transaction_t trans = {
+        .flags = (len <= 4) ? SPI_TRANS_USE_RXDATA : 0,
+        .cmd = cmd,
+        .addr = addr,
+        .length = len * 8,
+        .rx_buffer = (len <= 4) ? NULL : data,
+    };
+    esp_err_t ret = ESP_OK;
+
+    if (xSemaphoreTake(driver->lock, pdMS_TO_TICKS(W5500_SPI_LOCK_TIMEOUT_MS)) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+    if (spi_device_polling_transmit(driver->dev, &trans) != ESP_OK) {
+        ret = ESP_FAIL;
+    }
+    xSemaphoreGive(driver->lock);
+
+    if (ret == ESP_OK && len <= 4) {
+        memcpy(data, trans.rx_data, len);
+    }
+
+    return ret;
+}
+
+/**
+ * Custom SPI driver write.
+ * @param cmd register address.
+ * @param addr control byte.
+ */
+static esp_err_t w5500_spi_driver_write(void *ctx, uint32_t cmd, uint32_t addr, const void *data, uint32_t len)
+{
+    w5500_spi_driver_t *driver = (w5500_spi_driver_t*)ctx;
+    spi_transaction_t trans = {
+        .cmd = cmd,
+        .addr = addr,
+        .length = len * 8,
+        .tx_buffer = data,
+    };
+    esp_err_t ret = ESP_OK;
+
+    if (xSemaphoreTake(driver->lock, pdMS_TO_TICKS(W5500_SPI_LOCK_TIMEOUT_MS)) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+    if (spi_device_polling_transmit(driver->dev, &trans) != ESP_OK) {
+        ret = ESP_FAIL;
+    }
+    xSemaphoreGive(driver->lock);
+
+    return ret;
+}
+
+eth_spi_custom_driver_config_t w5500_spi_custom_driver(spi_host_device_t host, const spi_device_interface_config_t *devcfg)
+{
+    s_driver.host = host;
+    s_driver.devcfg = *devcfg;
+
+    eth_spi_custom_driver_config_t config = {
+        .config = &s_driver,
+        .init = w5500_spi_driver_init,
+        .deinit = w5500_spi_driver_deinit,
+        .read = w5500_spi_driver_read,
+        .write = w5500_spi_driver_write,
+    };
+
+    return config;
+}
+
+esp_err_t w5500_spi_read(uint16_t address, uint8_t bsb, void *data, size_t len)
+{
+    if (s_driver.dev == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    return w5500_spi_driver_read(&s_driver, address, W5500_SPI_CONTROL(bsb, false), data, len);
+}
+
+esp_err_t w5500_spi_write(uint16_t address, uint8_t bsb, const void *data, size_t len)
+{
+    if (s_driver.dev == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    return w5500_spi_driver_write(&s_driver, address, W5500_SPI_CONTROL(bsb, true), data, len);
+}
+
+esp_err_t w5500_spi_write_segments(uint16_t address, uint8_t bsb, const w5500_spi_segment_t *segments, int count)
+{
+    esp_err_t ret = ESP_OK;
+
+    if (s_driver.dev == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (xSemaphoreTake(s_driver.lock, pdMS_TO_TICKS(W5500_SPI_LOCK_TIMEOUT_MS)) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+
+    // Chip select can only be kept active by the device that holds the bus
+    if (spi_device_acquire_bus(s_driver.dev, portMAX_DELAY) != ESP_OK) {
+        xSemaphoreGive(s_driver.lock);
+        return ESP_FAIL;
+    }
+
+    for (int i = 0; i < count && ret == ESP_OK; i++) {
+        // Segments after the first continue the data phase, without command and address phases
+        spi_transaction_ext_t trans = {
+            .base = {
+                .flags = ((i > 0) ? (SPI_TRANS_VARIABLE_CMD | SPI_TRANS_VARIABLE_ADDR) : 0)
+                         | ((i < count - 1) ? SPI_TRANS_CS_KEEP_ACTIVE : 0),
+                .cmd = address,
+                .addr = W5500_SPI_CONTROL(bsb, true),
+                .length = segments[i].len * 8,
+                .tx_buffer = segments[i].data,
+            },
+            .command_bits = 0,
+            .address_bits = 0,
+        };
+
+        if (spi_device_polling_transmit(s_driver.dev, &trans.base) != ESP_OK) {
+            ret = ESP_FAIL;
+        }
+    }
+
+    spi_device_release_bus(s_driver.dev);
+    xSemaphoreGive(s_driver.lock);
+
+    return ret;
+}
+
+esp_err_t w5500_spi_lock(void)
+{
+    if (s_driver.dev == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (xSemaphoreTake(s_driver.lock, pdMS_TO_TICKS(W5500_SPI_LOCK_TIMEOUT_MS)) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+
+    return ESP_OK;
+}
+
+void w5500_spi_unlock(void)
+{
+    xSemaphoreGive(s_driver.lock);
+}
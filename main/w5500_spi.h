@@ -0,0 +1,131 @@
+/*
+ * w5500_spi.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef MAIN_W5500_SPI_H_
+#define MAIN_W5500_SPI_H_
+
+#include <stdint.h>
+
+#include "driver/spi_master.h"
+#include "esp_err.h"
+#include "esp_eth.h"
+
+// SPI frame control byte: block select, read/write, variable length data mode
+#define W5500_SPI_BSB_COMMON            0x00
+#define W5500_SPI_BSB_SOCK_REG(n)       (((n) << 2) + 1)
+#define W5500_SPI_BSB_SOCK_TX(n)        (((n) << 2) + 2)
+#define W5500_SPI_BSB_SOCK_RX(n)        (((n) << 2) + 3)
+#define W5500_SPI_RWB_WRITE             0x04
+#define W5500_SPI_CONTROL(bsb, write)   (((bsb) << 3) | ((write) ? W5500_SPI_RWB_WRITE : 0))
+
+// Common registers used by the probe
+#define W5500_SPI_REG_GAR               0x0001  // Gateway, subnet mask, source MAC and IP: 18 scratch bytes
+#define W5500_SPI_REG_GAR_LEN           18      // until the MAC driver resets the chip
+#define W5500_SPI_REG_VERSIONR          0x0039
+#define W5500_SPI_VERSION               0x04
+
+// Socket TX buffer size after reset, the loopback pattern fills it
+#define W5500_SPI_SOCK_BUF_LEN          2048
+
+// Probed clocks: the SPI source clock divided by these, slowest first
+#define W5500_SPI_SOURCE_HZ             (80 * 1000 * 1000)
+#define W5500_SPI_PROBE_DIVIDERS        { 8, 4, 3, 2, 1 }
+
+// Register patterns and buffer loopbacks a clock must pass
+#define W5500_SPI_PROBE_REG_PATTERNS    8
+#define W5500_SPI_PROBE_BUF_PASSES      32
+
+// Loopbacks that re-check the cached clock on boot
+#define W5500_SPI_VERIFY_BUF_PASSES     4
+
+// Probed clocks the result stays below the highest one that passed
+#define W5500_SPI_PROBE_MARGIN_STEPS    1
+
+// Longest wait for the SPI device while the MAC driver or the burst RX task uses it
+#define W5500_SPI_LOCK_TIMEOUT_MS       50
+
+/**
+ * Part of a W5500 write that is not contiguous in memory
+ */
+typedef struct w5500_spi_segment
+{
+    const void *data;
+    size_t len;                         // Not 0
+} w5500_spi_segment_t;
+
+/**
+ * Picks the W5500 SPI clock. The clock cached in NVS is used if it still passes a short check,
+ * otherwise the probed clocks are tried from the slowest up to CONFIG_ETH_SPI_CLOCK_MAX_MHZ. A clock
+ * passes if VERSIONR reads back right, register write/read-back patterns match and pseudo-random
+ * buffers written to the socket 0 TX memory read back with the same CRC-32. The result is
+ * W5500_SPI_PROBE_MARGIN_STEPS below the fastest clock that passed, and is cached in NVS.
+ * Call before the MAC driver is created, it resets the registers the probe writes.
+ * @param host SPI host, the bus is initialized.
+ * @param cs_gpio chip select GPIO of the W5500.
+ * @param fallback_hz clock returned if no probed clock passes.
+ * @return SPI clock in Hz.
+ */
+uint32_t w5500_spi_tune_clock(spi_host_device_t host, int cs_gpio, uint32_t fallback_hz);
+
+/**
+ * Gets an SPI driver for eth_w5500_config_t.custom_spi_driver. It frames transfers like the MAC
+ * driver's own SPI code, but the device stays reachable through w5500_spi_read and w5500_spi_write,
+ * so other code can share it with the driver (the burst RX path). One W5500 only.
+ * @param host SPI host, the bus is initialized.
+ * @param devcfg device configuration, copied. Command and address bits are set by the driver.
+ * @return driver configuration.
+ */
+eth_spi_custom_driver_config_t w5500_spi_custom_driver(spi_host_device_t host, const spi_device_interface_config_t *devcfg);
+
+/**
+ * Reads from the W5500 through the custom SPI driver, serialized with the MAC driver.
+ * @param address offset within the block.
+ * @param bsb block select (W5500_SPI_BSB_*).
+ * @param data receives len bytes, DMA capable if len > 4.
+ * @param len bytes to read.
+ * @return ESP_OK, ESP_ERR_INVALID_STATE if the MAC driver was not created with the custom driver,
+ * ESP_ERR_TIMEOUT, ESP_FAIL.
+ */
+esp_err_t w5500_spi_read(uint16_t address, uint8_t bsb, void *data, size_t len);
+
+/**
+ * Writes to the W5500 through the custom SPI driver, serialized with the MAC driver.
+ * @param address offset within the block.
+ * @param bsb block select (W5500_SPI_BSB_*).
+ * @param data len bytes to write.
+ * @param len bytes to write.
+ * @return ESP_OK, ESP_ERR_INVALID_STATE if the MAC driver was not created with the custom driver,
+ * ESP_ERR_TIMEOUT, ESP_FAIL.
+ */
+esp_err_t w5500_spi_write(uint16_t address, uint8_t bsb, const void *data, size_t len);
+
+/**
+ * Writes segments to consecutive W5500 addresses as one SPI frame: chip select stays active from the
+ * first segment, which carries the address and control phases, to the last, so each segment is DMA'd
+ * from where it is without being gathered into one buffer first.
+ * @param address offset within the block of the first segment.
+ * @param bsb block select (W5500_SPI_BSB_*).
+ * @param segments data to write, in order.
+ * @param count number of segments, at least 1.
+ * @return ESP_OK, ESP_ERR_INVALID_STATE if the MAC driver was not created with the custom driver,
+ * ESP_ERR_TIMEOUT, ESP_FAIL.
+ */
+esp_err_t w5500_spi_write_segments(uint16_t address, uint8_t bsb, const w5500_spi_segment_t *segments, int count);
+
+/**
+ * Takes the lock the custom SPI driver holds for each transfer, so the caller runs while no other task
+ * is inside an SPI transaction. Every w5500_spi_* call takes it too, the holder must not call them.
+ * @return ESP_OK, ESP_ERR_INVALID_STATE if the MAC driver was not created with the custom driver,
+ * ESP_ERR_TIMEOUT.
+ */
+esp_err_t w5500_spi_lock(void);
+
+/**
+ * Gives back the lock taken with w5500_spi_lock.
+ */
+void w5500_spi_unlock(void);
+
+#endif /* MAIN_W5500_SPI_H_ */
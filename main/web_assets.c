@@ -0,0 +1,48 @@
+/*
+ * web_assets.c
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include <string.h>
+
+#include "web_assets.h"
+
+// FNV-1a constants, must match tools/gen_web_assets.py
+#define WEB_ASSETS_FNV_OFFSET_BASIS		2166136261u
+#define WEB_ASSETS_FNV_PRIME			16777619u
+
+/**
+ * Seeded FNV-1a hash of the request path.
+ */
+static uint32_t web_assets_hash(const char *path, size_t len)
+{
+	uint32_t h = WEB_ASSETS_FNV_OFFSET_BASIS ^ web_assets_hash_seed;
+
+	for (size_t i = 0; i < len; i++)
+	{
+		h ^= (uint8_t)path[i];
+		h *= WEB_ASSETS_FNV_PRIME;
+	}
+
+	return h;
+}
+
+const web_asset_t* web_assets_find(const char *path, size_t len)
+{
+	// The generator picked the seed so that every known path lands in its own slot,
+	// a single comparison then tells a hit from an unknown path
+	int8_t index = web_assets_hash_index[web_assets_hash(path, len) & (web_assets_hash_size - 1)];
+	if (index < 0)
+	{
+		return NULL;
+	}
+
+	const web_asset_t *asset = &web_assets[index];
+	if (strncmp(asset->path, path, len) != 0 || asset->path[len] != '\0')
+	{
+		return NULL;
+	}
+
+	return asset;
+}
@@ -0,0 +1,43 @@
+/*
+ * web_assets.h
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#ifndef MAIN_WEB_ASSETS_H_
+#define MAIN_WEB_ASSETS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Embedded web page file, served by the HTTP server.
+ * The table is generated at build time from main/webpage (tools/gen_web_assets.py).
+ */
+typedef struct web_asset
+{
+	const char *path;			// Request path, e.g. "/app.js"
+	const char *type;			// MIME type
+	const char *version;		// Content hash, used as ETag and as the ?v= cache buster
+	const uint8_t *start;		// Identity content
+	const uint8_t *end;
+	const uint8_t *gz_start;	// Gzip encoded content
+	const uint8_t *gz_end;
+} web_asset_t;
+
+// Generated asset table and its perfect hash index (web_assets_table.c)
+extern const web_asset_t web_assets[];
+extern const size_t web_assets_count;
+extern const uint32_t web_assets_hash_seed;
+extern const size_t web_assets_hash_size;
+extern const int8_t web_assets_hash_index[];
+
+/**
+ * Finds the embedded asset served at a request path.
+ * @param path request path, not necessarily null terminated (e.g. the URI up to the query string).
+ * @param len length of the path.
+ * @return the asset, or NULL if no asset is served at this path.
+ */
+const web_asset_t* web_assets_find(const char *path, size_t len);
+
+#endif /* MAIN_WEB_ASSETS_H_ */
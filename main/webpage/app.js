@@ -5,6 +5,16 @@ var seconds 	= null;
 var otaTimerVar =  null;
 var wifiConnectInterval = null;
 
+// Server-Sent Events stream, null while the page falls back to polling
+var eventSource = null;
+
+// WebSocket connection to /ws, carries the status and the commands when open
+var webSocket = null;
+
+// Last device state version received from /status.json, the long-poll waits for a newer one
+var statusVersion = 0;
+var statusLongPoll = false;
+
 // Ethernet connection status timer
 var ethernetStatusTimerID;
 // Timer interval for connection status
@@ -14,15 +24,15 @@ var ethernetStatusInterval = 2000;
  * Initialize functions here.
  */
 $(document).ready(function(){
-	getSSID();
 	getUpdateStatus();
 	//startDHTSensorInterval();
 	//startMd02SensorInterval();
-	startLocalTimeInterval();
-	// Mengecek status koneksi awal
-    getEthernetConfigInfo();
-    getEthernetConnectionStatus();
-	getConnectInfo();
+	// Mengecek status awal (SSID, konfigurasi dan status koneksi) dengan satu request
+	getStatus();
+	if (!startWebSocket())
+	{
+		startStatusFallback();
+	}
 	$("#connect_wifi").on("click", function(){
 		checkCredentials();
 	}); 
@@ -34,6 +44,219 @@ $(document).ready(function(){
     $('#ethDisconnectButton').click(disconnectEthernet);
 });   
 
+/**
+ * Opens the /ws connection, the server then pushes the whole device state on every change
+ * and the commands are sent over it instead of separate requests.
+ * @return false if the browser does not support WebSockets.
+ */
+function startWebSocket()
+{
+	if (!window.WebSocket)
+	{
+		return false;
+	}
+
+	var ws = new WebSocket('ws://' + window.location.host + '/ws');
+
+	ws.onopen = function() {
+		webSocket = ws;
+	};
+	ws.onmessage = function(e) {
+		var msg = JSON.parse(e.data);
+		if (msg.type == "status")
+		{
+			handleStatus(msg);
+		}
+		else if (msg.type == "ack")
+		{
+			handleCommandAck(msg);
+		}
+	};
+	ws.onclose = function() {
+		// Refused (all slots taken) or lost: fall back to /events, then to polling
+		webSocket = null;
+		startStatusFallback();
+	};
+
+	return true;
+}
+
+/**
+ * Starts the /events stream, or the /status.json long-poll if it is not supported.
+ */
+function startStatusFallback()
+{
+	if (eventSource == null && !startEventStream())
+	{
+		startStatusLongPoll();
+	}
+}
+
+/**
+ * @return true if the page receives status changes (/ws, /events or the /status.json long-poll)
+ * and does not need the per-endpoint polling.
+ */
+function statusPushed()
+{
+	return webSocket != null || eventSource != null || statusLongPoll;
+}
+
+/**
+ * Gets the whole device state once and fills in the page, including the Ethernet configuration form.
+ */
+function getStatus()
+{
+	$.getJSON('/status.json', function(status) {
+		$("#ap_ssid").text(status.ap_ssid);
+		showEthernetConfigInfo(status.eth_config);
+		handleStatus(status);
+	});
+}
+
+/**
+ * Starts the /status.json long-poll, the last fallback when /ws and /events are not available.
+ */
+function startStatusLongPoll()
+{
+	if (!statusLongPoll)
+	{
+		statusLongPoll = true;
+		pollStatus();
+	}
+}
+
+/**
+ * Requests /status.json newer than statusVersion, the server holds the request until the state changes.
+ */
+function pollStatus()
+{
+	$.ajax({
+		url: '/status.json?since=' + statusVersion,
+		dataType: 'json',
+		cache: false,
+		success: function(status) {
+			// An unchanged version means the server timed out or could not hold the request
+			var changed = status.version != statusVersion;
+			statusVersion = status.version;
+			handleStatus(status);
+			setTimeout(pollStatus, changed ? 0 : 1000);
+		},
+		error: function() {
+			setTimeout(pollStatus, 5000);
+		}
+	});
+}
+
+/**
+ * Sends a command over the /ws connection.
+ * @return false if the connection is not open, the caller then uses the HTTP request.
+ */
+function sendCommand(cmd)
+{
+	if (webSocket == null || webSocket.readyState != WebSocket.OPEN)
+	{
+		return false;
+	}
+
+	webSocket.send(JSON.stringify(cmd));
+
+	return true;
+}
+
+/**
+ * Updates the page with the device state pushed over /ws.
+ */
+function handleStatus(status)
+{
+	handleWifiConnectStatus(status);
+	handleEthernetConnectionStatus(status);
+	handleOtaEvent(status);
+	if (status.time)
+	{
+		$("#local_time").text(status.time);
+	}
+}
+
+/**
+ * Handles the acknowledge of a command sent over /ws.
+ */
+function handleCommandAck(ack)
+{
+	if (ack.cmd == "wifiConnect" && !ack.ok)
+	{
+		document.getElementById("wifi_connect_status").innerHTML = "<h4 class='rd'>Failed to Connect: " + ack.error + "</h4>";
+	}
+	else if (ack.cmd == "ethConnect")
+	{
+		if (ack.ok)
+		{
+			ethernetConnectRequested();
+		}
+		else
+		{
+			alert('Failed to connect: ' + ack.error);
+		}
+	}
+	else if (ack.cmd == "ethDisconnect" && ack.ok)
+	{
+		ethernetDisconnected();
+	}
+}
+
+/**
+ * Opens the /events stream, the server then pushes status changes instead of the page polling for them.
+ * @return false if the browser does not support Server-Sent Events.
+ */
+function startEventStream()
+{
+	if (!window.EventSource)
+	{
+		return false;
+	}
+
+	eventSource = new EventSource('/events');
+
+	eventSource.addEventListener('wifi', function(e) {
+		handleWifiConnectStatus(JSON.parse(e.data));
+	});
+	eventSource.addEventListener('eth', function(e) {
+		handleEthernetConnectionStatus(JSON.parse(e.data));
+	});
+	eventSource.addEventListener('ota', function(e) {
+		handleOtaEvent(JSON.parse(e.data));
+	});
+	eventSource.addEventListener('time', function(e) {
+		$("#local_time").text(JSON.parse(e.data)["time"]);
+	});
+
+	eventSource.onerror = function() {
+		// The browser reconnects by itself unless the server refused the stream
+		if (eventSource.readyState == EventSource.CLOSED)
+		{
+			eventSource = null;
+			startStatusLongPoll();
+		}
+	};
+
+	return true;
+}
+
+/**
+ * Handles the OTA status pushed over the /events stream.
+ */
+function handleOtaEvent(response)
+{
+	if (response.ota_update_status == 1 && otaTimerVar == null)
+	{
+		seconds = 10;
+		otaRebootTimer();
+	}
+	else if (response.ota_update_status == 2)
+	{
+		document.getElementById("ota_update_status").innerHTML = "!!! Upload Error !!!";
+	}
+}
+
 /**
  * Gets file name and size for display on the web page.
  */        
@@ -205,15 +428,34 @@ function getWifiConnectStatus()
 		
 		document.getElementById("wifi_connect_status").innerHTML = "Connecting...";
 		
-		if (response.wifi_connect_status == 2)
+		handleWifiConnectStatus(response);
+	}
+}
+
+/**
+ * Updates the page with the WiFi connection status, polled or pushed over /ws or /events.
+ */
+function handleWifiConnectStatus(response)
+{
+	if (response.wifi_connect_status == 1)
+	{
+		document.getElementById("wifi_connect_status").innerHTML = "Connecting...";
+	}
+	else if (response.wifi_connect_status == 2)
+	{
+		document.getElementById("wifi_connect_status").innerHTML = "<h4 class='rd'>Failed to Connect. Please check your AP credentials and compatibility</h4>";
+		stopWifiConnectStatusInterval();
+	}
+	else if (response.wifi_connect_status == 3)
+	{
+		document.getElementById("wifi_connect_status").innerHTML = "<h4 class='gr'>Connection Success!</h4>";
+		stopWifiConnectStatusInterval();
+		if (response.wifi && response.wifi.ip)
 		{
-			document.getElementById("wifi_connect_status").innerHTML = "<h4 class='rd'>Failed to Connect. Please check your AP credentials and compatibility</h4>";
-			stopWifiConnectStatusInterval();
+			showConnectInfo(response.wifi);
 		}
-		else if (response.wifi_connect_status == 3)
+		else
 		{
-			document.getElementById("wifi_connect_status").innerHTML = "<h4 class='gr'>Connection Success!</h4>";
-			stopWifiConnectStatusInterval();
 			getConnectInfo();
 		}
 	}
@@ -243,22 +485,29 @@ function connectWifi() {
         pwd = pwd.substring(0, 64);
     }
     
-    $.ajax({
-        url: '/wifiConnect.json',
-        dataType: 'json',
-        method: 'POST',
-        cache: false,
-        headers: {
-            'my-connect-ssid': selectedSSID,
-            'my-connect-pwd': pwd
-        },
-        error: function(xhr, status, error) {
-            // Handle error
-            stopWifiConnectStatusInterval();
-        }
-    });
+    if (!sendCommand({ cmd: 'wifiConnect', ssid: selectedSSID, pwd: pwd }))
+    {
+        $.ajax({
+            url: '/wifiConnect.json',
+            dataType: 'json',
+            method: 'POST',
+            cache: false,
+            headers: {
+                'my-connect-ssid': selectedSSID,
+                'my-connect-pwd': pwd
+            },
+            error: function(xhr, status, error) {
+                // Handle error
+                stopWifiConnectStatusInterval();
+            }
+        });
+    }
     
-    startWifiConnectStatusInterval();
+    // With /ws or /events the status is pushed, polling is only the fallback
+    if (!statusPushed())
+    {
+        startWifiConnectStatusInterval();
+    }
 }
 
 /**
@@ -317,22 +566,27 @@ function showPassword()
  */
 function getConnectInfo()
 {
-	$.getJSON('/wifiConnectInfo.json', function(data)
-	{
-		$("#connected_ap_label").html("Connected to: ");
-		$("#connected_ap").text(data["ap"]);
-		
-		$("#ip_address_label").html("IP Address: ");
-		$("#wifi_connect_ip").text(data["ip"]);
-		
-		$("#netmask_label").html("Netmask: ");
-		$("#wifi_connect_netmask").text(data["netmask"]);
-		
-		$("#gateway_label").html("Gateway: ");
-		$("#wifi_connect_gw").text(data["gw"]);
-		
-		document.getElementById('disconnect_wifi').style.display = 'block';
-	});
+	$.getJSON('/wifiConnectInfo.json', showConnectInfo);
+}
+
+/**
+ * Shows the WiFi connection information, requested or pushed over /ws.
+ */
+function showConnectInfo(data)
+{
+	$("#connected_ap_label").html("Connected to: ");
+	$("#connected_ap").text(data["ap"]);
+	
+	$("#ip_address_label").html("IP Address: ");
+	$("#wifi_connect_ip").text(data["ip"]);
+	
+	$("#netmask_label").html("Netmask: ");
+	$("#wifi_connect_netmask").text(data["netmask"]);
+	
+	$("#gateway_label").html("Gateway: ");
+	$("#wifi_connect_gw").text(data["gw"]);
+	
+	document.getElementById('disconnect_wifi').style.display = 'block';
 }
 
 /**
@@ -340,13 +594,16 @@ function getConnectInfo()
  */
 function disconnectWifi()
 {
-	$.ajax({
-		url: '/wifiDisconnect.json',
-		dataType: 'json',
-		method: 'DELETE',
-		cache: false,
-		data: { 'timestamp': Date.now() }
-	});
+	if (!sendCommand({ cmd: 'wifiDisconnect' }))
+	{
+		$.ajax({
+			url: '/wifiDisconnect.json',
+			dataType: 'json',
+			method: 'DELETE',
+			cache: false,
+			data: { 'timestamp': Date.now() }
+		});
+	}
 	// Update the web page
 	setTimeout("location.reload(true);", 2000);
 }
@@ -385,26 +642,31 @@ function getSSID()
  * Inisialisasi koneksi Ethernet
  */
 function getEthernetConfigInfo() {
-    $.getJSON('/ethConfig.json', function(response) {
-        // Mengatur radio button sesuai mode
-        if (response.mode === 0) { // Static IP
-            $('#staticIPRadio').prop('checked', true);
-            $('#dhcpRadio').prop('checked', false);
-            enableStaticIPFields(true);
-        } else { // DHCP
-            $('#dhcpRadio').prop('checked', true);
-            $('#staticIPRadio').prop('checked', false);
-            enableStaticIPFields(false);
-        }
+    $.getJSON('/ethConfig.json', showEthernetConfigInfo);
+}
 
-        // Mengisi input field untuk IP statis
-        $('#staticIP').val(response.ip);
-        $('#staticSubnet').val(response.subnet);
-        $('#staticGateway').val(response.gateway);
-        
-        // Tampilkan MAC Address
-        $('#macAddress').text(response.mac);
-    });
+/**
+ * Menampilkan konfigurasi Ethernet di form (hasil /ethConfig.json atau /status.json)
+ */
+function showEthernetConfigInfo(response) {
+    // Mengatur radio button sesuai mode
+    if (response.mode === 2) { // Static IP (ETH_MANAGER_IP_STATIC)
+        $('#staticIPRadio').prop('checked', true);
+        $('#dhcpRadio').prop('checked', false);
+        enableStaticIPFields(true);
+    } else { // DHCP
+        $('#dhcpRadio').prop('checked', true);
+        $('#staticIPRadio').prop('checked', false);
+        enableStaticIPFields(false);
+    }
+
+    // Mengisi input field untuk IP statis
+    $('#staticIP').val(response.ip);
+    $('#staticSubnet').val(response.subnet);
+    $('#staticGateway').val(response.gateway);
+    
+    // Tampilkan MAC Address
+    $('#macAddress').text(response.mac);
 }
 
 /**
@@ -434,45 +696,73 @@ function connectEthernet() {
         }
     }
     
+    // Kirim perintah lewat /ws jika terbuka, jika tidak lewat request HTTP
+    var cmd = {
+        cmd: 'ethConnect',
+        mode: ipMode,
+        ip: headers['static-ip'],
+        subnet: headers['static-subnet'],
+        gateway: headers['static-gateway']
+    };
+    if (sendCommand(cmd)) {
+        return;
+    }
+
     // Kirim request untuk menghubungkan Ethernet
     $.ajax({
         url: '/ethConnect.json',
         method: 'POST',
         headers: headers,
         dataType: 'json',
-        success: function() {
-            // Mulai polling status koneksi
-            startEthernetStatusTimer();
-            $('#ethConnectButton').prop('disabled', true);
-            $('#ethDisconnectButton').prop('disabled', false);
-            $('#statusMessage').text('Connecting to Ethernet...');
-        },
+        success: ethernetConnectRequested,
         error: function(xhr) {
             alert('Failed to connect: ' + xhr.responseText);
         }
     });
 }
 
+/**
+ * Ethernet connect diterima oleh perangkat
+ */
+function ethernetConnectRequested() {
+    // Mulai polling status koneksi (status dikirim lewat /ws atau /events jika tersedia)
+    if (!statusPushed()) {
+        startEthernetStatusTimer();
+    }
+    $('#ethConnectButton').prop('disabled', true);
+    $('#ethDisconnectButton').prop('disabled', false);
+    $('#statusMessage').text('Connecting to Ethernet...');
+}
+
 /**
  * Memutuskan koneksi Ethernet
  */
 function disconnectEthernet() {
+    if (sendCommand({ cmd: 'ethDisconnect' })) {
+        return;
+    }
+
     $.ajax({
         url: '/ethDisconnect.json',
         method: 'DELETE',
         dataType: 'json',
-        success: function() {
-            clearTimeout(ethernetStatusTimerID);
-            $('#ethConnectButton').prop('disabled', false);
-            $('#ethDisconnectButton').prop('disabled', true);
-            $('#statusMessage').text('Disconnected from Ethernet');
-            $('#ipAddress').text('');
-            $('#subnetMask').text('');
-            $('#gateway').text('');
-        }
+        success: ethernetDisconnected
     });
 }
 
+/**
+ * Ethernet sudah diputus oleh perangkat
+ */
+function ethernetDisconnected() {
+    clearTimeout(ethernetStatusTimerID);
+    $('#ethConnectButton').prop('disabled', false);
+    $('#ethDisconnectButton').prop('disabled', true);
+    $('#statusMessage').text('Disconnected from Ethernet');
+    $('#ipAddress').text('');
+    $('#subnetMask').text('');
+    $('#gateway').text('');
+}
+
 /**
  * Memulai timer untuk memeriksa status koneksi
  */
@@ -490,53 +780,67 @@ function getEthernetConnectionStatus() {
         url: '/ethConnectStatus',
         method: 'POST',
         dataType: 'json',
-        success: function(response) {
-            var EthStatus = {
-                0: 'Idle',
-                1: 'Connecting...',
-                2: 'Failed',
-                3: 'Connected',
-                4: 'Disconnected'
-            };
-            
-            // Update status text
-            $('#statusMessage').text('Status: ' + EthStatus[response.eth_connect_status]);
-            
-            // Enable/disable buttons based on status
-            if (response.eth_connect_status === 3) { // Connected
-                $('#ethConnectButton').prop('disabled', true);
-                $('#ethDisconnectButton').prop('disabled', false);
-                // Get IP information
-                getEthernetConnectionInfo();
-                // Stop polling
-                clearTimeout(ethernetStatusTimerID);
-            } else if (response.eth_connect_status === 2) { // Failed
-                $('#ethConnectButton').prop('disabled', false);
-                $('#ethDisconnectButton').prop('disabled', true);
-                // Stop polling
-                clearTimeout(ethernetStatusTimerID);
-            } else if (response.eth_connect_status === 1) { // Connecting
-                // Continue polling
-                ethernetStatusTimerID = setTimeout(function() {
-                    getEthernetConnectionStatus();
-                }, ethernetStatusInterval);
-            }
-        }
+        success: handleEthernetConnectionStatus
     });
 }
 
+/**
+ * Memperbarui status koneksi Ethernet di halaman (hasil polling, /ws atau event /events)
+ */
+function handleEthernetConnectionStatus(response) {
+    var EthStatus = {
+        0: 'Idle',
+        1: 'Connecting...',
+        2: 'Failed',
+        3: 'Connected',
+        4: 'Disconnected'
+    };
+    
+    // Update status text
+    $('#statusMessage').text('Status: ' + EthStatus[response.eth_connect_status]);
+    
+    // Enable/disable buttons based on status
+    if (response.eth_connect_status === 3) { // Connected
+        $('#ethConnectButton').prop('disabled', true);
+        $('#ethDisconnectButton').prop('disabled', false);
+        // Get IP information (sudah ada di status /ws)
+        if (response.eth && response.eth.ip) {
+            showEthernetConnectionInfo(response.eth);
+        } else {
+            getEthernetConnectionInfo();
+        }
+        // Stop polling
+        clearTimeout(ethernetStatusTimerID);
+    } else if (response.eth_connect_status === 2) { // Failed
+        $('#ethConnectButton').prop('disabled', false);
+        $('#ethDisconnectButton').prop('disabled', true);
+        // Stop polling
+        clearTimeout(ethernetStatusTimerID);
+    } else if (response.eth_connect_status === 1 && !statusPushed()) { // Connecting
+        // Continue polling
+        ethernetStatusTimerID = setTimeout(function() {
+            getEthernetConnectionStatus();
+        }, ethernetStatusInterval);
+    }
+}
+
 /**
  * Mendapatkan informasi koneksi Ethernet (IP, subnet, gateway)
  */
 function getEthernetConnectionInfo() {
-    $.getJSON('/ethConnectInfo.json', function(response) {
-        if (response.ip) {
-            $('#ipAddress').text(response.ip);
-            $('#subnetMask').text(response.netmask);
-            $('#gateway').text(response.gw);
-            $('#connectionType').text(response.mode);
-        }
-    });
+    $.getJSON('/ethConnectInfo.json', showEthernetConnectionInfo);
+}
+
+/**
+ * Menampilkan informasi koneksi Ethernet (hasil request atau status /ws)
+ */
+function showEthernetConnectionInfo(response) {
+    if (response.ip) {
+        $('#ipAddress').text(response.ip);
+        $('#subnetMask').text(response.netmask);
+        $('#gateway').text(response.gw);
+        $('#connectionType').text(response.mode);
+    }
 }
 
 /**
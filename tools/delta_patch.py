@@ -0,0 +1,207 @@
+#!/usr/bin/env python3
+#
+# delta_patch.py
+#
+# Delta OTA patches for /OTAupdate, which rebuilds the new image from the image
+# in the running partition while flashing it (see main/delta_patch.c for the format).
+#
+#   delta_patch.py create old.bin new.bin out.patch [--gzip]
+#   delta_patch.py apply old.bin in.patch out.bin
+#   delta_patch.py check old.bin new.bin
+#
+# old.bin must be the exact image running on the device, e.g. the build/<project>.bin
+# of the released firmware. check creates a patch, applies it with the same rules
+# as the device and compares the result with new.bin.
+#
+
+import argparse
+import gzip
+import hashlib
+import struct
+import sys
+
+MAGIC = b'EDP1'
+HEADER = struct.Struct('<4sII32s32s')
+
+OP_END = 0x00
+OP_COPY = 0x01
+OP_ADD = 0x02
+OP_DATA = 0x03
+
+# Length of the exact matches looked up in the source index
+KEY_LEN = 8
+# Positions kept per key, more only slow the search down on padding
+KEY_POSITIONS = 8
+# Shorter matches cost more as commands than as data
+MIN_MATCH = 24
+
+
+def index_source(old):
+    index = {}
+    for i in range(len(old) - KEY_LEN + 1):
+        positions = index.setdefault(old[i:i + KEY_LEN], [])
+        if len(positions) < KEY_POSITIONS:
+            positions.append(i)
+    return index
+
+
+def exact_length(old, o, new, n):
+    length = 0
+    limit = min(len(old) - o, len(new) - n)
+    while length < limit and old[o + length] == new[n + length]:
+        length += 1
+    return length
+
+
+def approximate_length(old, o, new, n):
+    # bsdiff style: the length keeping most of the bytes equal, so code moved
+    # by a few bytes becomes one ADD with a sparse difference
+    best, best_score, score = 0, 0, 0
+    limit = min(len(old) - o, len(new) - n)
+    for length in range(1, limit + 1):
+        score += 1 if old[o + length - 1] == new[n + length - 1] else -1
+        if score > best_score:
+            best, best_score = length, score
+        elif score < best_score - 32:
+            break
+    return best
+
+
+def find_match(index, old, new, n, last):
+    # Continuing from the previous match first keeps the commands sequential
+    candidates = index.get(new[n:n + KEY_LEN], [])
+    if last is not None and last not in candidates and last + KEY_LEN <= len(old):
+        candidates = [last] + candidates
+    best_offset, best_length = None, 0
+    for o in candidates:
+        length = exact_length(old, o, new, n)
+        if length > best_length:
+            best_offset, best_length = o, length
+    return best_offset, best_length
+
+
+def commands(old, new):
+    index = index_source(old)
+    literal_start = 0
+    n = 0
+    last = None
+    while n < len(new):
+        offset, length = find_match(index, old, new, n, last)
+        if length < MIN_MATCH:
+            n += 1
+            continue
+        if literal_start < n:
+            yield OP_DATA, new[literal_start:n]
+        length = max(length, approximate_length(old, offset, new, n))
+        diff = bytes((new[n + i] - old[offset + i]) & 0xff for i in range(length))
+        if diff.count(0) == length:
+            yield OP_COPY, (offset, length)
+        else:
+            yield OP_ADD, (offset, length, diff)
+        n += length
+        literal_start = n
+        last = offset + length
+    if literal_start < len(new):
+        yield OP_DATA, new[literal_start:]
+
+
+def create(old, new):
+    out = [HEADER.pack(MAGIC, len(old), len(new), hashlib.sha256(old).digest(), hashlib.sha256(new).digest())]
+    for op, args in commands(old, new):
+        if op == OP_DATA:
+            out.append(struct.pack('<BI', op, len(args)) + args)
+        elif op == OP_COPY:
+            out.append(struct.pack('<BII', op, *args))
+        else:
+            out.append(struct.pack('<BII', op, args[0], args[1]) + args[2])
+    out.append(bytes([OP_END]))
+    return b''.join(out)
+
+
+def apply(old, patch):
+    if patch[:2] == b'\x1f\x8b':
+        patch = gzip.decompress(patch)
+    magic, source_size, target_size, source_sha, target_sha = HEADER.unpack_from(patch)
+    if magic != MAGIC:
+        raise ValueError('not a delta patch')
+    if source_size > len(old) or hashlib.sha256(old[:source_size]).digest() != source_sha:
+        raise ValueError('patch is for another source image')
+    old = old[:source_size]
+    out = bytearray()
+    pos = HEADER.size
+    while True:
+        op = patch[pos]
+        pos += 1
+        if op == OP_END:
+            break
+        if op == OP_DATA:
+            (length,) = struct.unpack_from('<I', patch, pos)
+            out += patch[pos + 4:pos + 4 + length]
+            pos += 4 + length
+            continue
+        if op not in (OP_COPY, OP_ADD):
+            raise ValueError('unknown command 0x%02x' % op)
+        offset, length = struct.unpack_from('<II', patch, pos)
+        pos += 8
+        if offset + length > source_size:
+            raise ValueError('command outside the source image')
+        if op == OP_COPY:
+            out += old[offset:offset + length]
+        else:
+            out += bytes((a + b) & 0xff for a, b in zip(old[offset:offset + length], patch[pos:pos + length]))
+            pos += length
+    if pos != len(patch):
+        raise ValueError('data after the end command')
+    if len(out) != target_size or hashlib.sha256(out).digest() != target_sha:
+        raise ValueError('target image mismatch')
+    return bytes(out)
+
+
+def read(path):
+    with open(path, 'rb') as f:
+        return f.read()
+
+
+def write(path, data):
+    with open(path, 'wb') as f:
+        f.write(data)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Delta OTA patch tool')
+    sub = parser.add_subparsers(dest='command', required=True)
+    p = sub.add_parser('create', help='create a patch from old.bin to new.bin')
+    p.add_argument('old')
+    p.add_argument('new')
+    p.add_argument('output')
+    p.add_argument('--gzip', action='store_true', help='gzip the patch, the device inflates it first')
+    p = sub.add_parser('apply', help='rebuild the new image from old.bin and a patch')
+    p.add_argument('old')
+    p.add_argument('patch')
+    p.add_argument('output')
+    p = sub.add_parser('check', help='create a patch and verify that it rebuilds new.bin')
+    p.add_argument('old')
+    p.add_argument('new')
+    args = parser.parse_args()
+
+    if args.command == 'apply':
+        write(args.output, apply(read(args.old), read(args.patch)))
+        return 0
+
+    old, new = read(args.old), read(args.new)
+    patch = create(old, new)
+    compressed = gzip.compress(patch, compresslevel=9, mtime=0)
+
+    # Never ship a patch that does not rebuild the image
+    if apply(old, patch) != new or apply(old, compressed) != new:
+        sys.exit('round trip mismatch')
+
+    if args.command == 'create':
+        write(args.output, compressed if args.gzip else patch)
+    print('%d byte image: %d byte patch, %d gzip compressed (%.1f%%)' % (
+        len(new), len(patch), len(compressed), 100.0 * len(compressed) / max(len(new), 1)))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
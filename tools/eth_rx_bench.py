@@ -0,0 +1,164 @@
+#!/usr/bin/env python3
+#
+# eth_rx_bench.py
+#
+# RX benchmark of the W5500 wakeup modes (CONFIG_ETH_RX_MODE, see main/w5500_rx_mode.h).
+# For each mode it sends bursty UDP traffic to the device's discard port and reads back
+# what the device received and its CPU load per core:
+#
+#   eth_rx_bench.py <device>
+#   eth_rx_bench.py <device> --modes adaptive --burst-ms 50 --idle-ms 450 --rate 20000
+#
+# The mode is restored to the one the device had before the run.
+#
+# The traffic only goes to the device, so it measures the RX path alone. With the burst RX path
+# (CONFIG_ETH_RX_BURST) the SPI bursts, frames per burst and frames copied because every burst
+# buffer or pbuf was in use are printed too: build with and without it and compare the two runs.
+#
+
+import argparse
+import json
+import socket
+import sys
+import threading
+import time
+import urllib.request
+
+DISCARD_PORT = 9
+
+
+def get_stats(host):
+    with urllib.request.urlopen('http://%s/ethRxMode.json' % host, timeout=5) as resp:
+        return json.load(resp)
+
+
+def set_mode(host, mode):
+    req = urllib.request.Request('http://%s/ethRxMode' % host, data=b'', method='POST',
+                                 headers={'eth-rx-mode': mode})
+    with urllib.request.urlopen(req, timeout=5) as resp:
+        resp.read()
+
+
+def send_bursts(host, duration, burst_ms, idle_ms, rate, size):
+    """Sends bursts of UDP datagrams, paced to rate per second within a burst (0: as fast as possible)."""
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    payload = bytes(size)
+    sent = 0
+    end = time.monotonic() + duration
+
+    while time.monotonic() < end:
+        burst_start = time.monotonic()
+        burst_end = burst_start + burst_ms / 1000
+        burst_sent = 0
+        while True:
+            now = time.monotonic()
+            if now >= burst_end:
+                break
+            if rate and burst_sent >= (now - burst_start) * rate:
+                continue
+            try:
+                sock.sendto(payload, (host, DISCARD_PORT))
+            except OSError:
+                # Host queue full, the datagram is not counted
+                continue
+            burst_sent += 1
+        sent += burst_sent
+        time.sleep(idle_ms / 1000)
+
+    sock.close()
+    return sent
+
+
+def delta(after, before, key):
+    return (after[key] - before[key]) & 0xffffffff
+
+
+def run_mode(args, mode):
+    set_mode(args.host, mode)
+    # The device applies the mode in its next 100 ms window, the load covers the last second
+    time.sleep(1.5)
+
+    samples = []
+    done = threading.Event()
+
+    def poll():
+        while not done.wait(1.0):
+            try:
+                samples.append(get_stats(args.host))
+            except OSError:
+                pass
+
+    poller = threading.Thread(target=poll, daemon=True)
+    before = get_stats(args.host)
+    start = time.monotonic()
+    poller.start()
+    sent = send_bursts(args.host, args.duration, args.burst_ms, args.idle_ms, args.rate, args.size)
+    elapsed = time.monotonic() - start
+    done.set()
+    poller.join()
+    after = get_stats(args.host)
+
+    frames = delta(after, before, 'rx_frames')
+    rx_bytes = delta(after, before, 'rx_bytes')
+    loads = [s['cpu_load'] for s in samples] or [after['cpu_load']]
+    cores = len(loads[0])
+
+    burst = None
+    if after.get('burst') and before.get('burst'):
+        burst = {key: delta(after['burst'], before['burst'], key)
+                 for key in ('bursts', 'frames', 'copied', 'dropped', 'flushed')}
+
+    return {
+        'mode': mode,
+        'sent': sent,
+        'received': frames,
+        'mbps': rx_bytes * 8 / elapsed / 1e6,
+        'cpu_avg': [sum(l[c] for l in loads) / len(loads) for c in range(cores)],
+        'cpu_max': [max(l[c] for l in loads) for c in range(cores)],
+        'polls': delta(after, before, 'polls'),
+        'switches': delta(after, before, 'to_polling') + delta(after, before, 'to_interrupt'),
+        'burst': burst,
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(description='W5500 RX wakeup mode benchmark')
+    parser.add_argument('host', help='device address')
+    parser.add_argument('--modes', default='interrupt,polling,adaptive')
+    parser.add_argument('--duration', type=float, default=10.0, help='seconds of traffic per mode')
+    parser.add_argument('--burst-ms', type=int, default=100)
+    parser.add_argument('--idle-ms', type=int, default=400)
+    parser.add_argument('--rate', type=int, default=0, help='datagrams per second within a burst, 0: unpaced')
+    parser.add_argument('--size', type=int, default=1024, help='UDP payload bytes')
+    args = parser.parse_args()
+
+    initial = get_stats(args.host)['mode']
+    results = []
+    try:
+        for mode in args.modes.split(','):
+            print('%s ...' % mode, file=sys.stderr)
+            results.append(run_mode(args, mode))
+    finally:
+        set_mode(args.host, initial)
+
+    print('%-10s %9s %9s %7s %9s %7s %9s %8s %8s' % ('mode', 'sent', 'received', 'loss%', 'Mbit/s',
+                                                     'polls', 'switches', 'cpu avg', 'cpu max'))
+    for r in results:
+        loss = 100.0 * max(r['sent'] - r['received'], 0) / r['sent'] if r['sent'] else 0.0
+        print('%-10s %9d %9d %7.1f %9.2f %7d %9d %8s %8s' % (
+            r['mode'], r['sent'], r['received'], loss, r['mbps'], r['polls'], r['switches'],
+            '/'.join('%.0f' % c for c in r['cpu_avg']), '/'.join('%d' % c for c in r['cpu_max'])))
+
+    bursts = [r for r in results if r['burst']]
+    if bursts:
+        print()
+        print('%-10s %9s %12s %9s %9s %9s' % ('burst rx', 'bursts', 'frames/burst', 'copied', 'dropped', 'flushed'))
+        for r in bursts:
+            b = r['burst']
+            print('%-10s %9d %12.2f %9d %9d %9d' % (r['mode'], b['bursts'], b['frames'] / b['bursts'] if b['bursts'] else 0.0,
+                                                    b['copied'], b['dropped'], b['flushed']))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,190 @@
+#!/usr/bin/env python3
+#
+# gen_web_assets.py
+#
+# Build-time processing of the embedded web page files (main/webpage).
+# Invoked from main/CMakeLists.txt, never at runtime.
+#
+# For every asset it writes, into the output directory:
+#   <name>      the file to embed (index.html gets versioned asset references)
+#   <name>.gz   its gzip variant
+# and web_assets_table.c, the asset table served by http_server.c: path, embedded
+# data, MIME type and content hash (ETag) of every asset, indexed by a perfect hash
+# of the request path (see web_assets.h).
+#
+
+import argparse
+import gzip
+import hashlib
+import os
+import re
+import sys
+
+# Number of hex digits of the SHA-256 kept as the asset version
+VERSION_LEN = 16
+
+# MIME types by file extension, application/octet-stream otherwise
+MIME_TYPES = {
+    '.css': 'text/css',
+    '.gif': 'image/gif',
+    '.htm': 'text/html',
+    '.html': 'text/html',
+    '.ico': 'image/x-icon',
+    '.jpg': 'image/jpeg',
+    '.js': 'application/javascript',
+    '.json': 'application/json',
+    '.png': 'image/png',
+    '.svg': 'image/svg+xml',
+    '.txt': 'text/plain',
+    '.woff2': 'font/woff2',
+}
+
+# FNV-1a constants, must match web_assets_hash() in main/web_assets.c
+FNV_OFFSET_BASIS = 2166136261
+FNV_PRIME = 16777619
+
+
+def write_if_changed(path, data):
+    """Only touch the output when the content changes, so the embed step is not rerun needlessly."""
+    if os.path.exists(path):
+        with open(path, 'rb') as f:
+            if f.read() == data:
+                return
+    os.makedirs(os.path.dirname(os.path.abspath(path)), exist_ok=True)
+    with open(path, 'wb') as f:
+        f.write(data)
+
+
+def asset_version(data):
+    return hashlib.sha256(data).hexdigest()[:VERSION_LEN]
+
+
+def c_identifier(name):
+    """Same mangling as CMake's MAKE_C_IDENTIFIER, which names the embedded file symbols."""
+    ident = re.sub(r'[^0-9A-Za-z_]', '_', name)
+    return '_' + ident if ident[0].isdigit() else ident
+
+
+def fnv1a(data, seed):
+    h = FNV_OFFSET_BASIS ^ seed
+    for b in data:
+        h ^= b
+        h = (h * FNV_PRIME) & 0xFFFFFFFF
+    return h
+
+
+def perfect_hash(paths):
+    """Finds the smallest power of two slot count and a seed with no collisions between the paths."""
+    size = 1
+    while size < 2 * len(paths):
+        size *= 2
+    while True:
+        for seed in range(1 << 16):
+            slots = [fnv1a(p.encode('utf-8'), seed) & (size - 1) for p in paths]
+            if len(set(slots)) == len(paths):
+                return size, seed, slots
+        size *= 2
+
+
+def generate_table(routes, contents, versions):
+    """routes: list of (request path, asset name)."""
+    size, seed, slots = perfect_hash([path for path, _ in routes])
+    index = [-1] * size
+    for i, slot in enumerate(slots):
+        index[slot] = i
+
+    lines = [
+        '/*',
+        ' * web_assets_table.c',
+        ' *',
+        ' * Generated by tools/gen_web_assets.py, do not edit.',
+        ' */',
+        '',
+        '#include "web_assets.h"',
+        '',
+    ]
+    for name in sorted(contents):
+        for variant in (name, name + '.gz'):
+            ident = c_identifier(variant)
+            lines.append('extern const uint8_t %s_start[]\tasm("_binary_%s_start");' % (ident, ident))
+            lines.append('extern const uint8_t %s_end[]\tasm("_binary_%s_end");' % (ident, ident))
+    lines += ['', 'const web_asset_t web_assets[] = {']
+    for path, name in routes:
+        ident = c_identifier(name)
+        gz = c_identifier(name + '.gz')
+        mime = MIME_TYPES.get(os.path.splitext(name)[1].lower(), 'application/octet-stream')
+        lines += [
+            '\t{',
+            '\t\t.path = "%s",' % path,
+            '\t\t.type = "%s",' % mime,
+            '\t\t.version = "%s",' % versions[name],
+            '\t\t.start = %s_start,' % ident,
+            '\t\t.end = %s_end,' % ident,
+            '\t\t.gz_start = %s_start,' % gz,
+            '\t\t.gz_end = %s_end,' % gz,
+            '\t},',
+        ]
+    lines += [
+        '};',
+        '',
+        'const size_t web_assets_count = %d;' % len(routes),
+        '',
+        '// Perfect hash of the request paths: slot = fnv1a(path, seed) & (size - 1), -1 for empty slots',
+        'const uint32_t web_assets_hash_seed = %d;' % seed,
+        'const size_t web_assets_hash_size = %d;' % size,
+        'const int8_t web_assets_hash_index[] = {%s};' % ', '.join(str(i) for i in index),
+        '',
+    ]
+    return '\n'.join(lines)
+
+
+def version_references(html, versions):
+    """Appends ?v=<version> to quoted references of the other assets, so they can be cached forever."""
+    for name, version in versions.items():
+        pattern = r'(["\'])(/?)' + re.escape(name) + r'\1'
+        html = re.sub(pattern, lambda m: '%s%s%s?v=%s%s' % (m.group(1), m.group(2), name, version, m.group(1)), html)
+    return html
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Embedded web asset generator')
+    parser.add_argument('--out-dir', required=True, help='directory receiving the generated files')
+    parser.add_argument('--index', required=True, help='html page whose asset references are versioned')
+    parser.add_argument('--alias', action='append', default=[], metavar='PATH=NAME',
+                        help='additional request path serving an asset, e.g. /=index.html')
+    parser.add_argument('assets', nargs='+', help='web asset files')
+    args = parser.parse_args()
+
+    contents = {}
+    for path in args.assets:
+        with open(path, 'rb') as f:
+            contents[os.path.basename(path)] = f.read()
+
+    index_name = os.path.basename(args.index)
+    if index_name not in contents:
+        parser.error('%s is not one of the assets' % index_name)
+
+    versions = {name: asset_version(data) for name, data in contents.items() if name != index_name}
+    html = contents[index_name].decode('utf-8')
+    contents[index_name] = version_references(html, versions).encode('utf-8')
+    versions[index_name] = asset_version(contents[index_name])
+
+    for name, data in contents.items():
+        write_if_changed(os.path.join(args.out_dir, name), data)
+        # mtime=0 keeps the output reproducible between builds
+        write_if_changed(os.path.join(args.out_dir, name + '.gz'), gzip.compress(data, compresslevel=9, mtime=0))
+
+    routes = [('/' + name, name) for name in sorted(contents)]
+    for alias in args.alias:
+        path, _, name = alias.partition('=')
+        if name not in contents:
+            parser.error('alias %s names an unknown asset' % alias)
+        routes.append((path, name))
+
+    write_if_changed(os.path.join(args.out_dir, 'web_assets_table.c'),
+                     generate_table(routes, contents, versions).encode('utf-8'))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,41 @@
+#!/usr/bin/env python3
+#
+# gzip_image.py
+#
+# Build-time compression of the application image for /OTAupdate, which
+# decompresses gzip images while flashing them (see main/gzip_inflate.c).
+# Invoked from the top level CMakeLists.txt after the .bin is built.
+#
+
+import argparse
+import gzip
+import os
+import sys
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Compressed OTA image generator')
+    parser.add_argument('image', help='application image (.bin)')
+    parser.add_argument('output', help='compressed image (.bin.gz)')
+    args = parser.parse_args()
+
+    with open(args.image, 'rb') as f:
+        data = f.read()
+
+    # mtime=0 and no file name keep the output reproducible between builds
+    compressed = gzip.compress(data, compresslevel=9, mtime=0)
+
+    # The device inflates one member only, check the round trip before shipping the file
+    if gzip.decompress(compressed) != data:
+        sys.exit('%s: round trip mismatch' % args.output)
+
+    with open(args.output, 'wb') as f:
+        f.write(compressed)
+
+    print('%s: %d -> %d bytes (%.1f%%)' % (os.path.basename(args.output), len(data), len(compressed),
+                                           100.0 * len(compressed) / max(len(data), 1)))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,251 @@
+#!/usr/bin/env python3
+#
+# host_check.py
+#
+# Host-side checks and benchmarks of the firmware modules that do not touch the hardware.
+# Each check compiles its main/*.c sources together with a driver from tools/host_check
+# (and the minimal ESP-IDF headers in tools/host_check/stub) for the host and runs it:
+#
+#   host_check.py                 all checks
+#   host_check.py web_assets      only the named ones
+#   host_check.py --list
+#   host_check.py gzip --image build/<project>.bin
+#   host_check.py delta --image build/<project>.bin
+#
+# Timings are host numbers: they compare implementations, not what the device achieves.
+# Needs a C compiler (--cc, gcc by default).
+#
+
+import argparse
+import os
+import random
+import socket
+import struct
+import subprocess
+import sys
+import tempfile
+import zlib
+
+TOOLS_DIR = os.path.dirname(os.path.abspath(__file__))
+PROJECT_DIR = os.path.dirname(TOOLS_DIR)
+MAIN_DIR = os.path.join(PROJECT_DIR, 'main')
+CHECK_DIR = os.path.join(TOOLS_DIR, 'host_check')
+STUB_DIR = os.path.join(CHECK_DIR, 'stub')
+
+CFLAGS = ['-std=gnu11', '-O2', '-Wall', '-Werror', '-I', STUB_DIR, '-I', MAIN_DIR]
+
+
+def c_symbol(ident):
+    return 'const unsigned char %s[1] asm("%s") = {0};' % (ident, ident)
+
+
+def web_assets(build_dir, options):
+    """Perfect hash lookup of the web assets against linear searches."""
+    sys.dont_write_bytecode = True
+    sys.path.insert(0, TOOLS_DIR)
+    import gen_web_assets
+
+    webpage = os.path.join(MAIN_DIR, 'webpage')
+    assets = sorted(os.path.join(webpage, name) for name in os.listdir(webpage))
+    out_dir = os.path.join(build_dir, 'webpage')
+    subprocess.check_call([sys.executable, os.path.join(TOOLS_DIR, 'gen_web_assets.py'), '--out-dir', out_dir,
+                           '--index', os.path.join(webpage, 'index.html'), '--alias', '/=index.html'] + assets)
+
+    # The table only takes the addresses of the embedded data, one byte per symbol is enough
+    symbols = []
+    for name in sorted(os.path.basename(path) for path in assets):
+        for variant in (name, name + '.gz'):
+            ident = gen_web_assets.c_identifier(variant)
+            symbols += [c_symbol('_binary_%s_start' % ident), c_symbol('_binary_%s_end' % ident)]
+    data = os.path.join(build_dir, 'web_assets_data.c')
+    with open(data, 'w') as f:
+        f.write('\n'.join(symbols) + '\n')
+
+    sources = [os.path.join(MAIN_DIR, 'web_assets.c'), os.path.join(out_dir, 'web_assets_table.c'), data]
+    return sources, []
+
+
+def json_writer(build_dir, options):
+    """Escaping, UTF-8 replacement, overflow and streaming of json_writer, and its speed against snprintf."""
+    return [os.path.join(MAIN_DIR, 'json_writer.c')], []
+
+
+def multipart(build_dir, options):
+    """Random form bodies split into chunks of every size, and malformed ones, through multipart_parser."""
+    return [os.path.join(MAIN_DIR, 'multipart_parser.c')], []
+
+
+def synthetic_image():
+    """About 600 kB that compress like an application image: repeated code-like runs, tables and padding."""
+    rnd = random.Random(1)
+    words = [struct.pack('<I', rnd.getrandbits(32)) for _ in range(512)]
+    data = bytearray(b'\xe9' + bytes(23))
+    while len(data) < 600 * 1024:
+        kind = rnd.random()
+        if kind < 0.6:
+            data += b''.join(rnd.choice(words) for _ in range(rnd.randint(4, 64)))
+        elif kind < 0.9:
+            data += bytes(rnd.getrandbits(8) for _ in range(rnd.randint(16, 256)))
+        else:
+            data += b'\xff' * rnd.randint(64, 4096)
+    return bytes(data)
+
+
+def gzip_member(data, name):
+    """gzip stream with every optional header field (FEXTRA, FNAME, FCOMMENT, FHCRC) set."""
+    header = b'\x1f\x8b\x08\x1e' + bytes(4) + b'\x02\x03'
+    header += struct.pack('<H', 6) + b'ab\x02\x00xy' + name.encode() + b'\x00' + b'comment\x00'
+    header += struct.pack('<H', zlib.crc32(header) & 0xffff)
+    deflate = zlib.compressobj(9, zlib.DEFLATED, -zlib.MAX_WBITS)
+    body = deflate.compress(data) + deflate.flush()
+    return header + body + struct.pack('<II', zlib.crc32(data), len(data) & 0xffffffff)
+
+
+def gzip_image(build_dir, options):
+    """gzip_inflate round trip of an image compressed like the ota_image_gz target, chunked, corrupt and truncated."""
+    if options.image:
+        raw = options.image
+    else:
+        raw = os.path.join(build_dir, 'image.bin')
+        with open(raw, 'wb') as f:
+            f.write(synthetic_image())
+    with open(raw, 'rb') as f:
+        data = f.read()
+
+    # The build's compressor, and a stream with all optional header fields
+    build_gz = os.path.join(build_dir, 'image.bin.gz')
+    subprocess.check_call([sys.executable, '-B', os.path.join(TOOLS_DIR, 'gzip_image.py'), raw, build_gz])
+    fields_gz = os.path.join(build_dir, 'image-fields.bin.gz')
+    with open(fields_gz, 'wb') as f:
+        f.write(gzip_member(data, os.path.basename(raw)))
+
+    return [os.path.join(MAIN_DIR, 'gzip_inflate.c')], [raw, build_gz, fields_gz]
+
+
+def next_release(data):
+    """The image after a small change: code moved by insertions and deletions, relocated words, a new table."""
+    rnd = random.Random(2)
+    new = bytearray(data)
+    for _ in range(20):
+        at = rnd.randrange(len(new))
+        if rnd.random() < 0.5:
+            new[at:at] = bytes(rnd.getrandbits(8) for _ in range(rnd.randint(1, 512)))
+        else:
+            del new[at:at + rnd.randint(1, 512)]
+    for _ in range(300):
+        at = rnd.randrange(len(new) - 4) & ~3
+        (word,) = struct.unpack_from('<I', new, at)
+        struct.pack_into('<I', new, at, (word + rnd.choice((4, 8, 16, 32))) & 0xffffffff)
+    new += bytes(rnd.getrandbits(8) for _ in range(4096))
+    return bytes(new)
+
+
+def delta_image(build_dir, options):
+    """delta_patch round trip of a plain and a gzipped patch, chunked, for another source, corrupt and truncated."""
+    if options.image:
+        old = options.image
+    else:
+        old = os.path.join(build_dir, 'old.bin')
+        with open(old, 'wb') as f:
+            f.write(synthetic_image())
+    with open(old, 'rb') as f:
+        data = f.read()
+
+    new = os.path.join(build_dir, 'new.bin')
+    with open(new, 'wb') as f:
+        f.write(next_release(data))
+
+    tool = os.path.join(TOOLS_DIR, 'delta_patch.py')
+    patch = os.path.join(build_dir, 'new.patch')
+    patch_gz = os.path.join(build_dir, 'new.patch.gz')
+    subprocess.check_call([sys.executable, '-B', tool, 'create', old, new, patch])
+    subprocess.check_call([sys.executable, '-B', tool, 'create', old, new, patch_gz, '--gzip'])
+
+    sources = [os.path.join(MAIN_DIR, 'delta_patch.c'), os.path.join(MAIN_DIR, 'gzip_inflate.c')]
+    return sources, [old, new, patch, patch_gz]
+
+
+def net_bench(build_dir, options):
+    """net_bench on the loopback interface against an iperf 2 stand-in, TCP and UDP, as server and client."""
+    with socket.socket() as sock:
+        sock.bind(('127.0.0.1', 0))
+        port = sock.getsockname()[1]
+
+    sources = [os.path.join(MAIN_DIR, 'net_bench.c'), os.path.join(MAIN_DIR, 'cpu_load.c')]
+    return sources, [sys.executable + ' -B', os.path.join(CHECK_DIR, 'iperf2_peer.py'), str(port)]
+
+
+def w5500_burst_rx(build_dir, options):
+    """w5500_burst_rx against a simulated W5500 RX buffer: bursts, wraparound, pool exhaustion, flushes."""
+    return [os.path.join(MAIN_DIR, 'w5500_burst_rx.c')], []
+
+
+def w5500_sg_tx(build_dir, options):
+    """w5500_sg_tx against a simulated W5500 TX buffer: pbuf chains, wraparound, SEND_OK order, SPI failures."""
+    return [os.path.join(MAIN_DIR, 'w5500_sg_tx.c')], []
+
+
+# name: (driver in tools/host_check, setup returning the extra sources and the driver arguments, libraries)
+CHECKS = {
+    'web_assets': ('web_assets_bench.c', web_assets, []),
+    'json_writer': ('json_writer_check.c', json_writer, []),
+    'multipart': ('multipart_check.c', multipart, []),
+    'gzip': ('gzip_inflate_check.c', gzip_image, ['-lz']),
+    'delta': ('delta_patch_check.c', delta_image, ['-lz']),
+    'net_bench': ('net_bench_check.c', net_bench, ['-lpthread']),
+    'w5500_burst_rx': ('w5500_burst_rx_check.c', w5500_burst_rx, ['-lpthread']),
+    'w5500_sg_tx': ('w5500_sg_tx_check.c', w5500_sg_tx, []),
+}
+
+
+def run_check(cc, name, build_dir, options):
+    driver, setup, libs = CHECKS[name]
+    check_dir = os.path.join(build_dir, name)
+    os.makedirs(check_dir)
+
+    sources, args = setup(check_dir, options)
+    exe = os.path.join(check_dir, name)
+    subprocess.check_call([cc] + CFLAGS + ['-o', exe, os.path.join(CHECK_DIR, driver)] + sources + libs)
+
+    return subprocess.call([exe] + args) == 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Host-side checks of the firmware modules')
+    parser.add_argument('checks', nargs='*', help='checks to run, all by default')
+    parser.add_argument('--cc', default=os.environ.get('CC', 'gcc'), help='host C compiler')
+    parser.add_argument('--list', action='store_true', help='list the checks')
+    parser.add_argument('--image', help='application image for gzip and delta instead of synthetic data, e.g. build/<project>.bin')
+    args = parser.parse_args()
+
+    if args.list:
+        for name, (_, setup, _) in CHECKS.items():
+            print('%-16s %s' % (name, setup.__doc__))
+        return 0
+
+    names = args.checks or list(CHECKS)
+    for name in names:
+        if name not in CHECKS:
+            parser.error('unknown check %s' % name)
+
+    failed = []
+    with tempfile.TemporaryDirectory(prefix='host_check_') as build_dir:
+        for name in names:
+            print('== %s' % name, flush=True)
+            try:
+                ok = run_check(args.cc, name, build_dir, args)
+            except subprocess.CalledProcessError as e:
+                print('%s: %s' % (name, e))
+                ok = False
+            print('== %s %s' % (name, 'passed' if ok else 'FAILED'), flush=True)
+            if not ok:
+                failed.append(name)
+
+    if failed:
+        print('failed: %s' % ' '.join(failed))
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
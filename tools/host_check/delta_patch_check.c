@@ -0,0 +1,285 @@
+/*
+ * delta_patch_check.c
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "delta_patch.h"
+#include "gzip_inflate.h"
+
+// Flash erase block, the source partition is the image padded with 0xff to it
+#define FLASH_BLOCK_SIZE		65536
+
+/**
+ * How a patch is cut into feed calls
+ */
+typedef enum chunk_mode
+{
+	CHUNK_BYTES = 0,		// One byte per call
+	CHUNK_SMALL,			// 1 to 16 bytes, splits every header and command
+	CHUNK_RECV,				// 1 to 5000 bytes, about what one httpd_req_recv returns
+	CHUNK_WHOLE,			// The whole patch at once
+	CHUNK_MODE_COUNT
+} chunk_mode_e;
+
+static const char *const chunk_mode_names[CHUNK_MODE_COUNT] = {"1 byte", "1-16 bytes", "1-5000 bytes", "whole"};
+
+/**
+ * File read into memory
+ */
+typedef struct blob
+{
+	uint8_t *data;
+	size_t len;
+} blob_t;
+
+// Running partition, the old image padded to the flash block size
+static uint8_t *flash;
+static esp_partition_t source;
+
+// Rebuilt image, compared with the new one
+static blob_t out;
+static size_t out_size;
+
+// xorshift32, the chunking is the same on every host
+static uint32_t rng_state = 1;
+
+static uint32_t rng(void)
+{
+	rng_state ^= rng_state << 13;
+	rng_state ^= rng_state >> 17;
+	rng_state ^= rng_state << 5;
+
+	return rng_state;
+}
+
+static bool read_file(const char *path, blob_t *blob)
+{
+	FILE *f = fopen(path, "rb");
+	if (f == NULL)
+	{
+		return false;
+	}
+
+	fseek(f, 0, SEEK_END);
+	blob->len = ftell(f);
+	rewind(f);
+	blob->data = malloc(blob->len + 1);
+	bool ok = blob->data != NULL && fread(blob->data, 1, blob->len, f) == blob->len;
+	fclose(f);
+
+	return ok;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t *partition, size_t src_offset, void *dst, size_t size)
+{
+	if (src_offset > partition->size || size > partition->size - src_offset)
+	{
+		return ESP_ERR_INVALID_SIZE;
+	}
+
+	memcpy(dst, flash + src_offset, size);
+
+	return ESP_OK;
+}
+
+static esp_err_t on_data(void *ctx, const char *data, size_t len)
+{
+	if (out.len + len > out_size)
+	{
+		return ESP_ERR_NO_MEM;
+	}
+
+	memcpy(out.data + out.len, data, len);
+	out.len += len;
+
+	return ESP_OK;
+}
+
+static esp_err_t on_inflated(void *ctx, const char *data, size_t len)
+{
+	return delta_patch_feed((delta_patch_t*)ctx, data, len);
+}
+
+/**
+ * Applies a patch, gzipped ones through gzip_inflate first as /OTAupdate does.
+ * @param patch plain or gzipped patch.
+ * @param len bytes of the patch fed.
+ * @param mode chunking of the patch.
+ * @return result of the first failing feed, otherwise of the finish calls.
+ */
+static esp_err_t apply_patch(const uint8_t *patch, size_t len, chunk_mode_e mode)
+{
+	delta_patch_t *p = delta_patch_create(&source, on_data, NULL);
+	gzip_inflate_t *g = NULL;
+	esp_err_t err = (p != NULL) ? ESP_OK : ESP_ERR_NO_MEM;
+	size_t pos = 0;
+
+	if (err == ESP_OK && len >= 2 && patch[0] == 0x1f && patch[1] == 0x8b)
+	{
+		g = gzip_inflate_create(on_inflated, p);
+		err = (g != NULL) ? ESP_OK : ESP_ERR_NO_MEM;
+	}
+
+	out.len = 0;
+
+	while (err == ESP_OK && pos < len)
+	{
+		size_t n = (mode == CHUNK_BYTES) ? 1 : (mode == CHUNK_SMALL) ? rng() % 16 + 1 : (mode == CHUNK_RECV) ? rng() % 5000 + 1 : len;
+		n = (n < len - pos) ? n : len - pos;
+
+		err = (g != NULL) ? gzip_inflate_feed(g, (const char*)patch + pos, n) : delta_patch_feed(p, (const char*)patch + pos, n);
+		pos += n;
+	}
+	if (err == ESP_OK && g != NULL)
+	{
+		err = gzip_inflate_finish(g);
+	}
+	if (err == ESP_OK)
+	{
+		err = delta_patch_finish(p);
+	}
+
+	gzip_inflate_delete(g);
+	delta_patch_delete(p);
+
+	return err;
+}
+
+static int expect(const char *what, esp_err_t err, esp_err_t expected)
+{
+	if (err != expected)
+	{
+		printf("%s: %s, expected %s\n", what, esp_err_to_name(err), esp_err_to_name(expected));
+		return 1;
+	}
+
+	return 0;
+}
+
+/**
+ * Round trip of one patch in every chunking mode, then against another source, corrupted and truncated.
+ * @return number of failures.
+ */
+static int check_patch(const char *name, const blob_t *old, const blob_t *new, blob_t *patch)
+{
+	int failures = 0;
+	char what[96];
+
+	for (chunk_mode_e mode = 0; mode < CHUNK_MODE_COUNT; mode++)
+	{
+		esp_err_t err = apply_patch(patch->data, patch->len, mode);
+
+		snprintf(what, sizeof(what), "%s, %s chunks", name, chunk_mode_names[mode]);
+		failures += expect(what, err, ESP_OK);
+		if (err == ESP_OK && (out.len != new->len || memcmp(out.data, new->data, new->len) != 0))
+		{
+			printf("%s: %zu bytes differ from the %zu new bytes\n", what, out.len, new->len);
+			failures++;
+		}
+	}
+
+	// One byte of the running image changed, the patch must stop before any output
+	flash[old->len / 2] ^= 1;
+	snprintf(what, sizeof(what), "%s, other source", name);
+	failures += expect(what, apply_patch(patch->data, patch->len, CHUNK_RECV), ESP_ERR_INVALID_VERSION);
+	if (out.len != 0)
+	{
+		printf("%s: %zu bytes written\n", what, out.len);
+		failures++;
+	}
+	flash[old->len / 2] ^= 1;
+
+	snprintf(what, sizeof(what), "%s, truncated", name);
+	failures += expect(what, apply_patch(patch->data, patch->len - 1, CHUNK_RECV), ESP_ERR_INVALID_RESPONSE);
+
+	// Only a plain patch can be corrupted in place, a gzipped one fails its CRC first
+	if (patch->data[0] != 0x1f)
+	{
+		// Target SHA-256 of the header
+		patch->data[DELTA_PATCH_MAGIC_LEN + 8 + 32] ^= 1;
+		snprintf(what, sizeof(what), "%s, corrupt target hash", name);
+		failures += expect(what, apply_patch(patch->data, patch->len, CHUNK_RECV), ESP_ERR_INVALID_CRC);
+		patch->data[DELTA_PATCH_MAGIC_LEN + 8 + 32] ^= 1;
+
+		// Anywhere in the commands: a bad command, or data that does not hash to the target
+		patch->data[patch->len * 2 / 3] ^= 0x40;
+		snprintf(what, sizeof(what), "%s, corrupt command", name);
+		esp_err_t err = apply_patch(patch->data, patch->len, CHUNK_RECV);
+		if (err == ESP_OK)
+		{
+			printf("%s: ESP_OK, expected an error\n", what);
+			failures++;
+		}
+		patch->data[patch->len * 2 / 3] ^= 0x40;
+
+		// Nothing may follow the END command
+		patch->data[patch->len] = 0;
+		snprintf(what, sizeof(what), "%s, trailing byte", name);
+		failures += expect(what, apply_patch(patch->data, patch->len + 1, CHUNK_WHOLE), ESP_ERR_INVALID_RESPONSE);
+	}
+
+	return failures;
+}
+
+int main(int argc, char **argv)
+{
+	blob_t old;
+	blob_t new;
+	int failures = 0;
+
+	if (argc < 4)
+	{
+		printf("usage: %s <old.bin> <new.bin> <patch>...\n", argv[0]);
+		return 2;
+	}
+	if (!read_file(argv[1], &old) || !read_file(argv[2], &new))
+	{
+		printf("%s, %s: cannot read\n", argv[1], argv[2]);
+		return 2;
+	}
+
+	source.size = (old.len + FLASH_BLOCK_SIZE - 1) / FLASH_BLOCK_SIZE * FLASH_BLOCK_SIZE;
+	flash = malloc(source.size);
+	memset(flash, 0xff, source.size);
+	memcpy(flash, old.data, old.len);
+
+	out_size = new.len;
+	out.data = malloc(out_size + 1);
+
+	for (int i = 3; i < argc; i++)
+	{
+		blob_t patch;
+
+		if (!read_file(argv[i], &patch))
+		{
+			printf("%s: cannot read\n", argv[i]);
+			return 2;
+		}
+
+		const char *name = strrchr(argv[i], '/') ? strrchr(argv[i], '/') + 1 : argv[i];
+		int patch_failures = check_patch(name, &old, &new, &patch);
+		printf("%s: %zu -> %zu bytes with a %zu byte patch, %d chunkings, other source, corrupt, truncated: %s\n", name,
+				old.len, new.len, patch.len, CHUNK_MODE_COUNT, patch_failures == 0 ? "ok" : "FAILED");
+
+		failures += patch_failures;
+		free(patch.data);
+	}
+
+	// Source partition smaller than the image the patch was made for
+	blob_t patch;
+	if (read_file(argv[3], &patch))
+	{
+		source.size = old.len - 1;
+		failures += expect("source partition too small", apply_patch(patch.data, patch.len, CHUNK_WHOLE),
+				ESP_ERR_INVALID_VERSION);
+		free(patch.data);
+	}
+
+	return failures == 0 ? 0 : 1;
+}
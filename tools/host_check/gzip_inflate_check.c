@@ -0,0 +1,221 @@
+/*
+ * gzip_inflate_check.c
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gzip_inflate.h"
+
+/**
+ * How a stream is cut into gzip_inflate_feed calls
+ */
+typedef enum chunk_mode
+{
+	CHUNK_BYTES = 0,		// One byte per call
+	CHUNK_SMALL,			// 1 to 16 bytes
+	CHUNK_RECV,				// 1 to 5000 bytes, about what one httpd_req_recv returns
+	CHUNK_WHOLE,			// The whole stream at once
+	CHUNK_MODE_COUNT
+} chunk_mode_e;
+
+static const char *const chunk_mode_names[CHUNK_MODE_COUNT] = {"1 byte", "1-16 bytes", "1-5000 bytes", "whole"};
+
+/**
+ * File read into memory
+ */
+typedef struct blob
+{
+	uint8_t *data;
+	size_t len;
+} blob_t;
+
+// Decompressed output, compared with the original
+static blob_t out;
+static size_t out_size;
+
+// xorshift32, the chunking is the same on every host
+static uint32_t rng_state = 1;
+
+static uint32_t rng(void)
+{
+	rng_state ^= rng_state << 13;
+	rng_state ^= rng_state >> 17;
+	rng_state ^= rng_state << 5;
+
+	return rng_state;
+}
+
+static bool read_file(const char *path, blob_t *blob)
+{
+	FILE *f = fopen(path, "rb");
+	if (f == NULL)
+	{
+		return false;
+	}
+
+	fseek(f, 0, SEEK_END);
+	blob->len = ftell(f);
+	rewind(f);
+	blob->data = malloc(blob->len + 1);
+	bool ok = blob->data != NULL && fread(blob->data, 1, blob->len, f) == blob->len;
+	fclose(f);
+
+	return ok;
+}
+
+static esp_err_t on_data(void *ctx, const char *data, size_t len)
+{
+	if (out.len + len > out_size)
+	{
+		return ESP_ERR_NO_MEM;
+	}
+
+	memcpy(out.data + out.len, data, len);
+	out.len += len;
+
+	return ESP_OK;
+}
+
+/**
+ * Decompresses a stream.
+ * @param gz gzip stream.
+ * @param len bytes of the stream fed.
+ * @param mode chunking of the stream.
+ * @return result of the first failing gzip_inflate_feed, otherwise of gzip_inflate_finish.
+ */
+static esp_err_t inflate_stream(const uint8_t *gz, size_t len, chunk_mode_e mode)
+{
+	gzip_inflate_t *g = gzip_inflate_create(on_data, NULL);
+	esp_err_t err = (g != NULL) ? ESP_OK : ESP_ERR_NO_MEM;
+	size_t pos = 0;
+
+	out.len = 0;
+
+	while (err == ESP_OK && pos < len)
+	{
+		size_t n = (mode == CHUNK_BYTES) ? 1 : (mode == CHUNK_SMALL) ? rng() % 16 + 1 : (mode == CHUNK_RECV) ? rng() % 5000 + 1 : len;
+		n = (n < len - pos) ? n : len - pos;
+
+		err = gzip_inflate_feed(g, (const char*)gz + pos, n);
+		pos += n;
+	}
+	if (err == ESP_OK)
+	{
+		err = gzip_inflate_finish(g);
+	}
+	if (err == ESP_OK && gzip_inflate_out_len(g) != out.len)
+	{
+		err = ESP_FAIL;
+	}
+
+	gzip_inflate_delete(g);
+
+	return err;
+}
+
+static int expect(const char *what, esp_err_t err, esp_err_t expected)
+{
+	if (err != expected)
+	{
+		printf("%s: %s, expected %s\n", what, esp_err_to_name(err), esp_err_to_name(expected));
+		return 1;
+	}
+
+	return 0;
+}
+
+/**
+ * Round trip of one gzip stream in every chunking mode, then corrupted and truncated.
+ * @return number of failures.
+ */
+static int check_stream(const char *name, const blob_t *raw, blob_t *gz)
+{
+	int failures = 0;
+	char what[96];
+
+	for (chunk_mode_e mode = 0; mode < CHUNK_MODE_COUNT; mode++)
+	{
+		esp_err_t err = inflate_stream(gz->data, gz->len, mode);
+
+		snprintf(what, sizeof(what), "%s, %s chunks", name, chunk_mode_names[mode]);
+		failures += expect(what, err, ESP_OK);
+		if (err == ESP_OK && (out.len != raw->len || memcmp(out.data, raw->data, raw->len) != 0))
+		{
+			printf("%s: %zu bytes differ from the %zu original bytes\n", what, out.len, raw->len);
+			failures++;
+		}
+	}
+
+	// CRC-32, then ISIZE of the trailer
+	gz->data[gz->len - 5] ^= 1;
+	snprintf(what, sizeof(what), "%s, corrupt CRC", name);
+	failures += expect(what, inflate_stream(gz->data, gz->len, CHUNK_RECV), ESP_ERR_INVALID_CRC);
+	gz->data[gz->len - 5] ^= 1;
+
+	gz->data[gz->len - 1] ^= 1;
+	snprintf(what, sizeof(what), "%s, corrupt size", name);
+	failures += expect(what, inflate_stream(gz->data, gz->len, CHUNK_RECV), ESP_ERR_INVALID_CRC);
+	gz->data[gz->len - 1] ^= 1;
+
+	snprintf(what, sizeof(what), "%s, truncated trailer", name);
+	failures += expect(what, inflate_stream(gz->data, gz->len - 3, CHUNK_RECV), ESP_ERR_INVALID_RESPONSE);
+
+	snprintf(what, sizeof(what), "%s, truncated data", name);
+	failures += expect(what, inflate_stream(gz->data, gz->len / 2, CHUNK_RECV), ESP_ERR_INVALID_RESPONSE);
+
+	// Only one member is inflated, nothing may follow it
+	gz->data[gz->len] = 0;
+	snprintf(what, sizeof(what), "%s, trailing byte", name);
+	failures += expect(what, inflate_stream(gz->data, gz->len + 1, CHUNK_WHOLE), ESP_ERR_INVALID_RESPONSE);
+
+	return failures;
+}
+
+int main(int argc, char **argv)
+{
+	blob_t raw;
+	int failures = 0;
+
+	if (argc < 3)
+	{
+		printf("usage: %s <data> <data.gz>...\n", argv[0]);
+		return 2;
+	}
+	if (!read_file(argv[1], &raw))
+	{
+		printf("%s: cannot read\n", argv[1]);
+		return 2;
+	}
+
+	out_size = raw.len;
+	out.data = malloc(out_size + 1);
+
+	for (int i = 2; i < argc; i++)
+	{
+		blob_t gz;
+
+		if (!read_file(argv[i], &gz))
+		{
+			printf("%s: cannot read\n", argv[i]);
+			return 2;
+		}
+
+		const char *name = strrchr(argv[i], '/') ? strrchr(argv[i], '/') + 1 : argv[i];
+		int stream_failures = check_stream(name, &raw, &gz);
+		printf("%s: %zu -> %zu bytes, %d chunkings, corrupt, truncated, trailing data: %s\n", name, gz.len, raw.len,
+				CHUNK_MODE_COUNT, stream_failures == 0 ? "ok" : "FAILED");
+
+		failures += stream_failures;
+		free(gz.data);
+	}
+
+	// Not a gzip stream at all, e.g. a plain image
+	failures += expect("plain data", inflate_stream(raw.data, raw.len < 64 ? raw.len : 64, CHUNK_WHOLE), ESP_ERR_INVALID_RESPONSE);
+
+	return failures == 0 ? 0 : 1;
+}
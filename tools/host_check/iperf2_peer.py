@@ -0,0 +1,156 @@
+#!/usr/bin/env python3
+#
+# iperf2_peer.py
+#
+# Host end of the net_bench check (tools/host_check.py net_bench): a small iperf 2 stand-in
+# on the loopback interface, the other side of one device run. The device role is given,
+# the peer takes the opposite one:
+#
+#   iperf2_peer.py tcp server <port>    connects and sends for about 0.5 s, like "iperf -c"
+#   iperf2_peer.py udp server <port>    sends a stream with known gaps and reordering, then
+#                                       the final datagram, and reads the server report
+#   iperf2_peer.py tcp client <port>    accepts one connection and counts it, like "iperf -s"
+#   iperf2_peer.py udp client <port>    counts one stream and answers its final datagram
+#                                       with a server report (3 lost, 1 out of order)
+#
+# Client modes print "ready" once the port is bound. Every mode ends with one "result" line
+# of key=value pairs for the driver to compare with what the device measured.
+#
+
+import argparse
+import socket
+import struct
+import sys
+import time
+
+# iperf 2 UDP datagram header: sequence number, send time (s, us), upper sequence number bits
+UDP_HEADER = struct.Struct('!iIII')
+# Server report behind the header: flags, bytes (2 words), stop time (s, us), lost, out of order,
+# datagrams, jitter (s, us)
+UDP_REPORT = struct.Struct('!iIIIIIIIII')
+UDP_REPORT_FLAG = -0x80000000
+UDP_LEN = 1470
+
+# Datagrams of the UDP server stream, and the ones left out and swapped
+UDP_STREAM = 1000
+UDP_MISSING = (10, 11)
+UDP_SWAPPED = (497, 498)
+
+# What the UDP client report claims
+REPORT_LOST = 3
+REPORT_OUT_OF_ORDER = 1
+
+
+def result(**values):
+    print('result ' + ' '.join('%s=%d' % item for item in values.items()), flush=True)
+
+
+def tcp_server(port):
+    """The device receives: sends 64 kB blocks for about 0.5 s, then closes."""
+    deadline = time.monotonic() + 5
+    while True:
+        try:
+            sock = socket.create_connection(('127.0.0.1', port))
+            break
+        except ConnectionRefusedError:
+            if time.monotonic() > deadline:
+                raise
+            time.sleep(0.05)
+
+    block = bytes(65536)
+    sent = 0
+    end = time.monotonic() + 0.5
+    while time.monotonic() < end:
+        sock.sendall(block)
+        sent += len(block)
+        time.sleep(0.01)
+    sock.close()
+    result(sent=sent)
+
+
+def udp_server(port):
+    """The device receives: a stream with gaps and reordering, then the final datagram."""
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    ids = [i for i in range(UDP_STREAM) if i not in UDP_MISSING]
+    a, b = ids.index(UDP_SWAPPED[0]), ids.index(UDP_SWAPPED[1])
+    ids[a], ids[b] = ids[b], ids[a]
+
+    payload = bytes(UDP_LEN - UDP_HEADER.size)
+    for i in ids:
+        sock.sendto(UDP_HEADER.pack(i, 0, 0, 0) + payload, ('127.0.0.1', port))
+        time.sleep(0.0002)
+
+    sock.settimeout(0.5)
+    for _ in range(10):
+        sock.sendto(UDP_HEADER.pack(-UDP_STREAM, 0, 0, 0) + payload, ('127.0.0.1', port))
+        try:
+            report = sock.recv(2048)
+        except socket.timeout:
+            continue
+        fields = UDP_REPORT.unpack_from(report, UDP_HEADER.size)
+        if fields[0] != UDP_REPORT_FLAG:
+            sys.exit('not a server report')
+        result(sent=len(ids), lost=fields[5], out_of_order=fields[6], datagrams=fields[7])
+        return
+    sys.exit('no server report')
+
+
+def tcp_client(port):
+    """The device sends: one connection, counted until the device closes it."""
+    listener = socket.socket()
+    listener.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    listener.bind(('127.0.0.1', port))
+    listener.listen(1)
+    listener.settimeout(10)
+    print('ready', flush=True)
+
+    sock, _ = listener.accept()
+    received = 0
+    while True:
+        data = sock.recv(65536)
+        if not data:
+            break
+        received += len(data)
+    result(received=received)
+
+
+def udp_client(port):
+    """The device sends: one stream counted until its final datagram, answered with a report."""
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, 1 << 20)
+    sock.bind(('127.0.0.1', port))
+    sock.settimeout(10)
+    print('ready', flush=True)
+
+    datagrams = 0
+    while True:
+        data, peer = sock.recvfrom(4096)
+        (seq,) = struct.unpack_from('!i', data)
+        if seq >= 0:
+            datagrams += 1
+            continue
+        report = UDP_REPORT.pack(UDP_REPORT_FLAG, 0, 0, 0, 0, REPORT_LOST, REPORT_OUT_OF_ORDER, -seq, 0, 0)
+        sock.sendto(data[:UDP_HEADER.size] + report, peer)
+        result(received=datagrams, final=-seq)
+        return
+
+
+def main():
+    parser = argparse.ArgumentParser(description='iperf 2 stand-in for the net_bench host check')
+    parser.add_argument('proto', choices=('tcp', 'udp'))
+    parser.add_argument('role', choices=('server', 'client'), help='role of the device')
+    parser.add_argument('port', type=int)
+    args = parser.parse_args()
+
+    modes = {
+        ('tcp', 'server'): tcp_server,
+        ('udp', 'server'): udp_server,
+        ('tcp', 'client'): tcp_client,
+        ('udp', 'client'): udp_client,
+    }
+    modes[(args.proto, args.role)](args.port)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
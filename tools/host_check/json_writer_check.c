@@ -0,0 +1,226 @@
+/*
+ * json_writer_check.c
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "json_writer.h"
+
+// Objects formatted per timed run
+#define BENCH_OBJECTS			2000000
+
+/**
+ * String written with json_writer_string_n and the JSON expected for it
+ */
+typedef struct string_case
+{
+	const char *value;
+	size_t len;
+	const char *expected;
+} string_case_t;
+
+static const string_case_t string_cases[] = {
+	{"plain", SIZE_MAX, "\"plain\""},
+	{"a\"b\\c", SIZE_MAX, "\"a\\\"b\\\\c\""},
+	{"\n\r\t\x01\x1f", SIZE_MAX, "\"\\n\\r\\t\\u0001\\u001f\""},
+	{"caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80", SIZE_MAX, "\"caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80\""},
+	{"\xc3", SIZE_MAX, "\"\\ufffd\""},								// Cut 2 byte sequence
+	{"\xc3(", SIZE_MAX, "\"\\ufffd(\""},							// Bad continuation byte
+	{"\xe9t\xe9", SIZE_MAX, "\"\\ufffdt\\ufffd\""},					// Latin-1
+	{"\xc0\xaf", SIZE_MAX, "\"\\ufffd\\ufffd\""},					// Overlong '/'
+	{"\xe0\x80\xaf", SIZE_MAX, "\"\\ufffd\\ufffd\\ufffd\""},		// Overlong '/'
+	{"\xed\xa0\x80", SIZE_MAX, "\"\\ufffd\\ufffd\\ufffd\""},		// Surrogate
+	{"\xf4\x90\x80\x80", SIZE_MAX, "\"\\ufffd\\ufffd\\ufffd\\ufffd\""},	// Past U+10FFFF
+	{"\xff\xfe", SIZE_MAX, "\"\\ufffd\\ufffd\""},
+	{"x\xe2\x82\xac", 3, "\"x\\ufffd\\ufffd\""},					// Sequence cut by the length
+	{"0123456789abcdef0123456789abcdefXXXX", 32, "\"0123456789abcdef0123456789abcdef\""},
+	{"ab\0cd", 5, "\"ab\""},
+};
+
+#define STRING_CASE_COUNT		(sizeof(string_cases) / sizeof(string_cases[0]))
+
+/**
+ * Collects the flushed output of a streaming writer.
+ */
+typedef struct flush_sink
+{
+	char out[512];
+	size_t len;
+	size_t calls;
+} flush_sink_t;
+
+static esp_err_t sink_flush(void *ctx, const char *data, size_t len)
+{
+	flush_sink_t *sink = (flush_sink_t*)ctx;
+
+	if (sink->len + len >= sizeof(sink->out))
+	{
+		return ESP_ERR_NO_MEM;
+	}
+
+	memcpy(sink->out + sink->len, data, len);
+	sink->len += len;
+	sink->out[sink->len] = '\0';
+	sink->calls++;
+
+	return ESP_OK;
+}
+
+/**
+ * Writes the document every writer configuration is checked with.
+ */
+static void write_document(json_writer_t *w)
+{
+	json_writer_begin_object(w, NULL);
+	json_writer_string(w, "ssid", "a\"b\\c\n\x01 \xc3\xa9\xff");
+	json_writer_int(w, "min", INT32_MIN);
+	json_writer_int(w, "neg", -42);
+	json_writer_uint(w, "max", UINT32_MAX);
+	json_writer_begin_object(w, "empty");
+	json_writer_end_object(w);
+	json_writer_begin_array(w, "list");
+	json_writer_int(w, NULL, 0);
+	json_writer_bool(w, NULL, true);
+	json_writer_bool(w, NULL, false);
+	json_writer_null(w, NULL);
+	json_writer_string(w, NULL, NULL);
+	json_writer_end_array(w);
+	json_writer_end_object(w);
+}
+
+static const char document[] =
+		"{\"ssid\":\"a\\\"b\\\\c\\n\\u0001 \xc3\xa9\\ufffd\",\"min\":-2147483648,\"neg\":-42,\"max\":4294967295,"
+		"\"empty\":{},\"list\":[0,true,false,null,null]}";
+
+static int check(bool ok, const char *what, const char *got)
+{
+	if (!ok)
+	{
+		printf("%s: got %s\n", what, got);
+	}
+
+	return ok ? 0 : 1;
+}
+
+/**
+ * Checks escaping, numbers, nesting, overflow and streaming.
+ * @return number of errors.
+ */
+static int check_writer(void)
+{
+	int errors = 0;
+	char buf[256];
+	json_writer_t w;
+
+	for (size_t i = 0; i < STRING_CASE_COUNT; i++)
+	{
+		json_writer_init(&w, buf, sizeof(buf), NULL, NULL);
+		json_writer_string_n(&w, NULL, string_cases[i].value, string_cases[i].len);
+
+		char what[32];
+		snprintf(what, sizeof(what), "string case %zu", i);
+		errors += check(json_writer_finish(&w) == ESP_OK && strcmp(buf, string_cases[i].expected) == 0, what, buf);
+	}
+
+	json_writer_init(&w, buf, sizeof(buf), NULL, NULL);
+	write_document(&w);
+	errors += check(json_writer_finish(&w) == ESP_OK && strcmp(buf, document) == 0, "document", buf);
+
+	// Without a flush callback the output is cut, still null terminated, and the error reported
+	char small[8];
+	json_writer_init(&w, small, sizeof(small), NULL, NULL);
+	write_document(&w);
+	errors += check(json_writer_finish(&w) == ESP_ERR_INVALID_SIZE && strlen(small) == sizeof(small) - 1,
+			"overflow", small);
+
+	// With a flush callback any staging size gives the same output
+	for (size_t size = 2; size <= 64; size++)
+	{
+		flush_sink_t sink = {0};
+		char stage[64];
+
+		json_writer_init(&w, stage, size, sink_flush, &sink);
+		write_document(&w);
+
+		char what[32];
+		snprintf(what, sizeof(what), "streaming, %zu byte chunks", size);
+		errors += check(json_writer_finish(&w) == ESP_OK && strcmp(sink.out, document) == 0, what, sink.out);
+	}
+
+	// A failing flush stops the writer
+	flush_sink_t full = {.len = sizeof(full.out) - 4};
+	char stage[16];
+	json_writer_init(&w, stage, sizeof(stage), sink_flush, &full);
+	write_document(&w);
+	errors += check(json_writer_finish(&w) == ESP_ERR_NO_MEM, "flush error", "no error");
+
+	// Nesting deeper than JSON_WRITER_MAX_DEPTH is refused
+	json_writer_init(&w, buf, sizeof(buf), NULL, NULL);
+	for (int i = 0; i < JSON_WRITER_MAX_DEPTH + 1; i++)
+	{
+		json_writer_begin_array(&w, NULL);
+	}
+	errors += check(json_writer_finish(&w) == ESP_ERR_INVALID_SIZE, "nesting", buf);
+
+	return errors;
+}
+
+static double now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/**
+ * Times the wifiConnectInfo.json object, formatted with snprintf as before the writer and with the writer.
+ */
+static void bench_writer(void)
+{
+	volatile size_t sink = 0;
+	char buf[200];
+	json_writer_t w;
+
+	double start = now_ns();
+	for (int i = 0; i < BENCH_OBJECTS; i++)
+	{
+		sink += snprintf(buf, sizeof(buf), "{\"ip\":\"%s\",\"netmask\":\"%s\",\"gw\":\"%s\",\"ap\":\"%s\",\"rssi\":%d}",
+				"192.168.1.100", "255.255.255.0", "192.168.1.1", "MyAccessPoint", -(i & 63));
+	}
+	double snprintf_ns = (now_ns() - start) / BENCH_OBJECTS;
+
+	start = now_ns();
+	for (int i = 0; i < BENCH_OBJECTS; i++)
+	{
+		json_writer_init(&w, buf, sizeof(buf), NULL, NULL);
+		json_writer_begin_object(&w, NULL);
+		json_writer_string(&w, "ip", "192.168.1.100");
+		json_writer_string(&w, "netmask", "255.255.255.0");
+		json_writer_string(&w, "gw", "192.168.1.1");
+		json_writer_string(&w, "ap", "MyAccessPoint");
+		json_writer_int(&w, "rssi", -(i & 63));
+		json_writer_end_object(&w);
+		json_writer_finish(&w);
+		sink += w.len;
+	}
+	double writer_ns = (now_ns() - start) / BENCH_OBJECTS;
+
+	printf("snprintf      %6.1f ns/object (unescaped)\n", snprintf_ns);
+	printf("json_writer   %6.1f ns/object\n", writer_ns);
+}
+
+int main(void)
+{
+	int errors = check_writer();
+	printf("%zu string cases, document, overflow, streaming: %s\n", STRING_CASE_COUNT,
+			errors == 0 ? "ok" : "FAILED");
+
+	bench_writer();
+
+	return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,215 @@
+/*
+ * multipart_check.c
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "multipart_parser.h"
+
+// Random bodies of the corpus, each one fed in every chunking mode
+#define CORPUS_BODIES			3000
+
+// Largest file part of a random body
+#define CORPUS_FILE_MAX			2000
+
+// Boundary of the corpus, as browsers generate it
+#define CORPUS_BOUNDARY			"----WebKitFormBoundaryabc"
+
+/**
+ * How a body is cut into multipart_parser_feed calls
+ */
+typedef enum chunk_mode
+{
+	CHUNK_BYTES = 0,		// One byte per call
+	CHUNK_SMALL,			// 1 to 7 bytes, splits every delimiter and header line
+	CHUNK_LARGE,			// 1 to 300 bytes
+	CHUNK_MODE_COUNT
+} chunk_mode_e;
+
+static const char *const chunk_mode_names[CHUNK_MODE_COUNT] = {"1 byte", "1-7 bytes", "1-300 bytes"};
+
+// File content received by the data callback
+static char received[CORPUS_FILE_MAX + 64];
+static size_t received_len;
+
+// xorshift32, the corpus is the same on every host
+static uint32_t rng_state = 1;
+
+static uint32_t rng(void)
+{
+	rng_state ^= rng_state << 13;
+	rng_state ^= rng_state >> 17;
+	rng_state ^= rng_state << 5;
+
+	return rng_state;
+}
+
+static esp_err_t on_data(void *ctx, const char *data, size_t len)
+{
+	if (received_len + len > sizeof(received))
+	{
+		return ESP_ERR_NO_MEM;
+	}
+
+	memcpy(received + received_len, data, len);
+	received_len += len;
+
+	return ESP_OK;
+}
+
+/**
+ * Parses a body and compares the result.
+ * @param content_type Content-Type header of the request.
+ * @param body request body.
+ * @param body_len length of the body.
+ * @param file expected file content, checked if expected_err is ESP_OK.
+ * @param file_len length of the file.
+ * @param mode chunking of the body.
+ * @param expected_err result expected from init, feed or finish.
+ * @return 0 if the result is the expected one, 1 otherwise.
+ */
+static int parse(const char *content_type, const char *body, size_t body_len, const char *file, size_t file_len,
+		chunk_mode_e mode, esp_err_t expected_err)
+{
+	multipart_parser_t p;
+	esp_err_t err = multipart_parser_init(&p, content_type, on_data, NULL);
+	size_t pos = 0;
+
+	received_len = 0;
+
+	while (err == ESP_OK && pos < body_len)
+	{
+		size_t n = (mode == CHUNK_BYTES) ? 1 : (mode == CHUNK_SMALL) ? rng() % 7 + 1 : rng() % 300 + 1;
+		n = (n < body_len - pos) ? n : body_len - pos;
+
+		err = multipart_parser_feed(&p, body + pos, n);
+		pos += n;
+	}
+	if (err == ESP_OK)
+	{
+		err = multipart_parser_finish(&p);
+	}
+
+	if (err != expected_err)
+	{
+		printf("%s chunks: %s, expected %s\n", chunk_mode_names[mode], esp_err_to_name(err), esp_err_to_name(expected_err));
+		return 1;
+	}
+	if (err == ESP_OK && (received_len != file_len || memcmp(received, file, file_len) != 0))
+	{
+		printf("%s chunks: %zu file bytes received, expected %zu\n", chunk_mode_names[mode], received_len, file_len);
+		return 1;
+	}
+
+	return 0;
+}
+
+/**
+ * Random file content, rich in CR, LF, '-' and boundary characters, sometimes with
+ * a partial delimiter in it.
+ */
+static size_t random_file(char *file)
+{
+	static const char boundary[] = CORPUS_BOUNDARY;
+	size_t len = rng() % CORPUS_FILE_MAX;
+
+	for (size_t i = 0; i < len; i++)
+	{
+		uint32_t r = rng() % 10;
+		file[i] = (r == 0) ? '\r' : (r == 1) ? '\n' : (r == 2) ? '-' : (r < 5) ? boundary[rng() % (sizeof(boundary) - 1)] : (char)rng();
+	}
+
+	if (len > 60 && rng() % 2)
+	{
+		char delimiter[] = "\r\n--" CORPUS_BOUNDARY;
+		size_t partial = rng() % (sizeof(delimiter) - 1);
+
+		memcpy(file + rng() % (len - 60), delimiter, partial < 60 ? partial : 60);
+	}
+
+	return len;
+}
+
+/**
+ * Random form bodies: optional preamble, a text field with transport padding after its
+ * boundary, the file part, a second file part that must be skipped, and an epilogue.
+ * Each one is parsed in every chunking mode, and truncated.
+ * @return number of failures.
+ */
+static int check_corpus(void)
+{
+	static char body[CORPUS_FILE_MAX + 1024];
+	static char file[CORPUS_FILE_MAX];
+	const char *content_type = "multipart/form-data; boundary=" CORPUS_BOUNDARY;
+	int failures = 0;
+
+	for (int i = 0; i < CORPUS_BODIES; i++)
+	{
+		size_t file_len = random_file(file);
+		size_t n = 0;
+
+		n += sprintf(body + n, "%s--" CORPUS_BOUNDARY "\r\n", (rng() % 2) ? "preamble\r\n" : "");
+		n += sprintf(body + n, "Content-Disposition: form-data; name=\"x\"\r\n\r\nvalue\r\n--" CORPUS_BOUNDARY "  \r\n");
+		n += sprintf(body + n, "Content-Disposition: form-data; name=\"file\"; filename=\"a.bin\"\r\n"
+				"Content-Type: application/octet-stream\r\n\r\n");
+		memcpy(body + n, file, file_len);
+		n += file_len;
+		n += sprintf(body + n, "\r\n--" CORPUS_BOUNDARY "\r\nContent-Disposition: form-data; name=\"f2\"; filename=\"b\"\r\n\r\n"
+				"zzz\r\n--" CORPUS_BOUNDARY "--\r\nepilogue");
+
+		for (chunk_mode_e mode = 0; mode < CHUNK_MODE_COUNT; mode++)
+		{
+			failures += parse(content_type, body, n, file, file_len, mode, ESP_OK);
+		}
+
+		// Without the closing boundary
+		failures += parse(content_type, body, n - 30, file, file_len, CHUNK_LARGE, ESP_ERR_INVALID_RESPONSE);
+	}
+
+	return failures;
+}
+
+/**
+ * Single bodies for the rules the corpus does not reach.
+ * @return number of failures.
+ */
+static int check_cases(void)
+{
+	static const char quoted[] = "--q q\r\nContent-Disposition: form-data; filename=\"a\"\r\n\r\nhi\r\n--q q--";
+	static const char no_file[] = "--a\r\nX: y\r\n\r\nhi\r\n--a--";
+	static const char overlapping[] = "--aaa\r\nContent-Disposition: x; filename=1\r\n\r\n\r\n--aa\r\n--aaaa\r\n--aaa--";
+	int failures = 0;
+
+	// Quoted boundary with a space
+	failures += parse("multipart/form-data; boundary=\"q q\"", quoted, strlen(quoted), "hi", 2, CHUNK_BYTES, ESP_OK);
+
+	// Not multipart, no boundary, boundary too long
+	failures += parse("text/plain", "", 0, "", 0, CHUNK_BYTES, ESP_ERR_INVALID_ARG);
+	failures += parse("multipart/form-data", "", 0, "", 0, CHUNK_BYTES, ESP_ERR_INVALID_ARG);
+	failures += parse("multipart/form-data; boundary=0123456789012345678901234567890123456789012345678901234567890123456789X",
+			"", 0, "", 0, CHUNK_BYTES, ESP_ERR_INVALID_ARG);
+
+	// No part with a filename
+	failures += parse("multipart/form-data; boundary=a", no_file, strlen(no_file), "", 0, CHUNK_BYTES, ESP_ERR_NOT_FOUND);
+
+	// Self-overlapping boundary: "--aaaa" is content followed by a delimiter, then the part needs "--" or CRLF
+	failures += parse("multipart/form-data; boundary=aaa", overlapping, strlen(overlapping), "", 0, CHUNK_BYTES,
+			ESP_ERR_INVALID_RESPONSE);
+
+	return failures;
+}
+
+int main(void)
+{
+	int corpus = check_corpus();
+	int cases = check_cases();
+
+	printf("%d bodies x %d chunkings + truncated: %d failures, single cases: %d failures\n",
+			CORPUS_BODIES, CHUNK_MODE_COUNT, corpus, cases);
+
+	return (corpus + cases) == 0 ? 0 : 1;
+}
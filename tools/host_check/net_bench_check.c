@@ -0,0 +1,334 @@
+/*
+ * net_bench_check.c
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "lwip/sockets.h"
+#include "lwip/stats.h"
+
+#include "ethernet_app.h"
+#include "net_bench.h"
+#include "wifi_app.h"
+
+// Length of the client runs
+#define RUN_TIME_S				2
+
+// UDP client rate
+#define RUN_BANDWIDTH_KBPS		20000
+
+// Retransmissions the driver counts while a run is active, TCP runs report them
+#define RUN_RETRANSMITS			3
+
+// Load the idle counters of core 1 simulate, core 0 idles all the time
+#define CORE1_LOAD_PERCENT		75
+
+// The device's "eth" interface is the loopback interface, the WiFi interfaces were not created
+static int loopback;
+esp_netif_t *esp_netif_eth = (esp_netif_t*)&loopback;
+esp_netif_t *esp_netif_sta = NULL;
+esp_netif_t *esp_netif_ap = NULL;
+
+// Starts close to the wrap, the retransmit count must survive it
+struct stats_ lwip_stats = {.mib2.tcpretranssegs = UINT32_MAX - 1};
+
+// iperf 2 stand-in: Python interpreter, script and port
+static const char *python;
+static const char *peer_script;
+static uint16_t port;
+
+int64_t esp_timer_get_time(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
+esp_err_t esp_netif_get_ip_info(esp_netif_t *esp_netif, esp_netif_ip_info_t *ip_info)
+{
+	memset(ip_info, 0, sizeof(*ip_info));
+	ip_info->ip.addr = htonl(INADDR_LOOPBACK);
+	ip_info->netmask.addr = htonl(0xff000000);
+
+	return ESP_OK;
+}
+
+esp_err_t esp_netif_get_netif_impl_name(esp_netif_t *esp_netif, char *name)
+{
+	strcpy(name, "lo");
+
+	return ESP_OK;
+}
+
+/**
+ * Task started by xTaskCreatePinnedToCore.
+ */
+typedef struct task_start
+{
+	TaskFunction_t code;
+	void *parameters;
+} task_start_t;
+
+static void* task_thread(void *arg)
+{
+	task_start_t start = *(task_start_t*)arg;
+
+	free(arg);
+	start.code(start.parameters);
+
+	return NULL;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t pxTaskCode, const char *pcName, uint32_t usStackDepth,
+		void *pvParameters, UBaseType_t uxPriority, TaskHandle_t *pxCreatedTask, BaseType_t xCoreID)
+{
+	task_start_t *start = malloc(sizeof(task_start_t));
+	pthread_t thread;
+
+	start->code = pxTaskCode;
+	start->parameters = pvParameters;
+	if (pthread_create(&thread, NULL, task_thread, start) != 0)
+	{
+		free(start);
+		return pdFAIL;
+	}
+	pthread_detach(thread);
+
+	return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t xTaskToDelete)
+{
+	pthread_exit(NULL);
+}
+
+void vTaskDelay(TickType_t xTicksToDelay)
+{
+	usleep(xTicksToDelay * portTICK_PERIOD_MS * 1000);
+}
+
+TaskHandle_t xTaskGetIdleTaskHandleForCore(BaseType_t xCoreID)
+{
+	return (TaskHandle_t)(intptr_t)(xCoreID + 1);
+}
+
+uint32_t ulTaskGetRunTimeCounter(TaskHandle_t xTask)
+{
+	uint64_t now = esp_timer_get_time();
+
+	// Idle task of core 0, then of core 1
+	return (uint32_t)((xTask == (TaskHandle_t)1) ? now : now * (100 - CORE1_LOAD_PERCENT) / 100);
+}
+
+static int expect(const char *what, bool ok)
+{
+	if (!ok)
+	{
+		printf("%s: FAILED\n", what);
+	}
+
+	return ok ? 0 : 1;
+}
+
+/**
+ * Waits for the end of the run, counting retransmissions once it is running.
+ */
+static void wait_run(net_bench_result_t *result)
+{
+	bool counted = false;
+
+	for (;;)
+	{
+		net_bench_get_result(result);
+		if (result->state != NET_BENCH_WAITING && result->state != NET_BENCH_RUNNING)
+		{
+			break;
+		}
+		if (result->state == NET_BENCH_RUNNING && !counted)
+		{
+			lwip_stats.mib2.tcpretranssegs += RUN_RETRANSMITS;
+			counted = true;
+		}
+		usleep(5000);
+	}
+
+	// The task ends right after the result, the next run must find the port free
+	usleep(50000);
+}
+
+/**
+ * Reads a "result" value of the peer.
+ */
+static long long peer_value(const char *line, const char *key)
+{
+	char pattern[32];
+	snprintf(pattern, sizeof(pattern), " %s=", key);
+
+	const char *value = strstr(line, pattern);
+
+	return (value != NULL) ? atoll(value + strlen(pattern)) : -1;
+}
+
+/**
+ * One run of the device against the iperf 2 stand-in, over the loopback interface as "eth".
+ * @param udp UDP, otherwise TCP.
+ * @param role role of the device.
+ * @return number of failures.
+ */
+static int check_run(bool udp, net_bench_role_e role)
+{
+	net_bench_config_t config = {
+			.udp = udp,
+			.role = role,
+			.netif = "eth",
+			.host = "127.0.0.1",
+			.port = port,
+			.time_s = RUN_TIME_S,
+			.bandwidth_kbps = RUN_BANDWIDTH_KBPS,
+	};
+	const char *name = udp ? (role == NET_BENCH_SERVER ? "UDP server" : "UDP client") : (role == NET_BENCH_SERVER ? "TCP server" : "TCP client");
+	char command[512];
+	char line[256] = "";
+	net_bench_result_t result;
+	int failures = 0;
+	FILE *peer;
+
+	snprintf(command, sizeof(command), "%s %s %s %s %u", python, peer_script, udp ? "udp" : "tcp",
+			role == NET_BENCH_SERVER ? "server" : "client", port);
+
+	if (role == NET_BENCH_CLIENT)
+	{
+		// The host's server listens before the device connects
+		peer = popen(command, "r");
+		if (peer == NULL || fgets(line, sizeof(line), peer) == NULL || strncmp(line, "ready", 5) != 0)
+		{
+			printf("%s: the peer did not start\n", name);
+			return 1;
+		}
+		failures += expect("start", net_bench_start(&config) == ESP_OK);
+	}
+	else
+	{
+		failures += expect("start", net_bench_start(&config) == ESP_OK);
+		failures += expect("start while waiting", net_bench_start(&config) == ESP_ERR_INVALID_STATE);
+		peer = popen(command, "r");
+		if (peer == NULL)
+		{
+			return failures + 1;
+		}
+	}
+
+	wait_run(&result);
+	while (fgets(line, sizeof(line), peer) != NULL && strncmp(line, "result ", 7) != 0)
+	{
+	}
+	failures += expect("peer", pclose(peer) == 0 && strncmp(line, "result ", 7) == 0);
+
+	failures += expect("done", result.state == NET_BENCH_DONE && result.err == ESP_OK);
+	failures += expect("interface", strcmp(result.netif, "eth") == 0);
+	// The idle counters are read a few microseconds after the sample time, an idle core shows up to 1 %
+	failures += expect("CPU load", result.cpu_load[0] <= 1
+			&& result.cpu_load[1] >= CORE1_LOAD_PERCENT - 5 && result.cpu_load[1] <= CORE1_LOAD_PERCENT + 5);
+	failures += expect("retransmits", result.retransmits == (udp ? -1 : RUN_RETRANSMITS));
+
+	if (!udp && role == NET_BENCH_SERVER)
+	{
+		failures += expect("bytes received", (long long)result.bytes == peer_value(line, "sent"));
+	}
+	else if (udp && role == NET_BENCH_SERVER)
+	{
+		// The stream leaves out 2 datagrams and swaps 2
+		failures += expect("datagrams received", (long long)result.datagrams == peer_value(line, "sent")
+				&& result.bytes == (uint64_t)result.datagrams * NET_BENCH_UDP_LEN);
+		failures += expect("loss seen", result.lost == 2 && result.out_of_order == 1);
+		failures += expect("server report", peer_value(line, "lost") == 2 && peer_value(line, "out_of_order") == 1
+				&& peer_value(line, "datagrams") == 1000);
+	}
+	else if (!udp)
+	{
+		failures += expect("bytes sent", (long long)result.bytes == peer_value(line, "received"));
+		failures += expect("run time", result.elapsed_ms >= RUN_TIME_S * 1000 && result.elapsed_ms < RUN_TIME_S * 1000 + 500);
+	}
+	else
+	{
+		failures += expect("datagrams sent", (long long)result.datagrams == peer_value(line, "received")
+				&& (long long)result.datagrams == peer_value(line, "final"));
+		failures += expect("server report", result.lost == 3 && result.out_of_order == 1);
+		failures += expect("pacing", result.kbps >= RUN_BANDWIDTH_KBPS * 9 / 10 && result.kbps <= RUN_BANDWIDTH_KBPS * 11 / 10);
+	}
+
+	printf("%s: %llu bytes in %u ms, %u kbit/s, %d retransmits, %u datagrams, %u lost, %u out of order, CPU %u/%u %%: %s\n",
+			name, (unsigned long long)result.bytes, (unsigned)result.elapsed_ms, (unsigned)result.kbps, (int)result.retransmits,
+			(unsigned)result.datagrams, (unsigned)result.lost, (unsigned)result.out_of_order, (unsigned)result.cpu_load[0],
+			(unsigned)result.cpu_load[1], failures == 0 ? "ok" : "FAILED");
+
+	return failures;
+}
+
+/**
+ * Arguments and interfaces net_bench_start refuses, and a server run stopped before a client came.
+ * @return number of failures.
+ */
+static int check_start(void)
+{
+	net_bench_config_t config = {.role = NET_BENCH_SERVER, .port = port};
+	net_bench_result_t result;
+	int failures = 0;
+
+	config.netif = "wlan";
+	failures += expect("unknown interface", net_bench_start(&config) == ESP_ERR_INVALID_ARG);
+	config.netif = "sta";
+	failures += expect("interface not created", net_bench_start(&config) == ESP_ERR_INVALID_STATE);
+	config.netif = NULL;
+	config.time_s = NET_BENCH_MAX_TIME_S + 1;
+	failures += expect("run too long", net_bench_start(&config) == ESP_ERR_INVALID_ARG);
+	config.time_s = 0;
+	config.role = NET_BENCH_CLIENT;
+	config.host = "example.com";
+	failures += expect("host not an address", net_bench_start(&config) == ESP_ERR_INVALID_ARG);
+
+	config.role = NET_BENCH_SERVER;
+	config.netif = "eth";
+	failures += expect("start", net_bench_start(&config) == ESP_OK);
+	usleep(300000);
+	net_bench_stop();
+	wait_run(&result);
+	failures += expect("stopped while waiting", result.state == NET_BENCH_DONE && result.bytes == 0);
+
+	printf("refused arguments, stop while waiting: %s\n", failures == 0 ? "ok" : "FAILED");
+
+	return failures;
+}
+
+int main(int argc, char **argv)
+{
+	int failures = 0;
+
+	if (argc < 4)
+	{
+		printf("usage: %s <python> <iperf2_peer.py> <port>\n", argv[0]);
+		return 2;
+	}
+	python = argv[1];
+	peer_script = argv[2];
+	port = atoi(argv[3]);
+
+	failures += check_start();
+	failures += check_run(false, NET_BENCH_SERVER);
+	failures += check_run(true, NET_BENCH_SERVER);
+	failures += check_run(false, NET_BENCH_CLIENT);
+	failures += check_run(true, NET_BENCH_CLIENT);
+
+	return failures == 0 ? 0 : 1;
+}
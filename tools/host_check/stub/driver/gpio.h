@@ -0,0 +1,20 @@
+/*
+ * gpio.h
+ *
+ * Host stand-in for the ESP-IDF GPIO calls the firmware modules make, defined by the check driver
+ * (the INT pin of a simulated chip).
+ */
+
+#ifndef HOST_CHECK_GPIO_H_
+#define HOST_CHECK_GPIO_H_
+
+#include "esp_err.h"
+
+typedef int gpio_num_t;
+typedef void (*gpio_isr_t)(void *arg);
+
+esp_err_t gpio_isr_handler_add(gpio_num_t gpio_num, gpio_isr_t isr_handler, void *args);
+esp_err_t gpio_isr_handler_remove(gpio_num_t gpio_num);
+int gpio_get_level(gpio_num_t gpio_num);
+
+#endif /* HOST_CHECK_GPIO_H_ */
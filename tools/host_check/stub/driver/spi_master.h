@@ -0,0 +1,24 @@
+/*
+ * spi_master.h
+ *
+ * Host stand-in for the ESP-IDF SPI master types that w5500_spi.h names. The checks replace the
+ * SPI driver as a whole, no transfer calls are declared.
+ */
+
+#ifndef HOST_CHECK_SPI_MASTER_H_
+#define HOST_CHECK_SPI_MASTER_H_
+
+#include <stdint.h>
+
+typedef int spi_host_device_t;
+
+typedef struct
+{
+	uint8_t command_bits;
+	uint8_t address_bits;
+	int clock_speed_hz;
+	int spics_io_num;
+	int queue_size;
+} spi_device_interface_config_t;
+
+#endif /* HOST_CHECK_SPI_MASTER_H_ */
@@ -0,0 +1,12 @@
+/*
+ * esp_attr.h
+ *
+ * Host stand-in for the ESP-IDF placement attributes, all empty.
+ */
+
+#ifndef HOST_CHECK_ESP_ATTR_H_
+#define HOST_CHECK_ESP_ATTR_H_
+
+#define IRAM_ATTR
+
+#endif /* HOST_CHECK_ESP_ATTR_H_ */
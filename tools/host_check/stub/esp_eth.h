@@ -0,0 +1,26 @@
+/*
+ * esp_eth.h
+ *
+ * Host stand-in for the ESP-IDF Ethernet driver header, the handle type ethernet_app.h names and
+ * the custom SPI driver hooks w5500_spi.h returns.
+ */
+
+#ifndef HOST_CHECK_ESP_ETH_H_
+#define HOST_CHECK_ESP_ETH_H_
+
+#include <stdint.h>
+
+#include "esp_err.h"
+
+typedef void* esp_eth_handle_t;
+
+typedef struct
+{
+	void *config;
+	void* (*init)(const void *spi_config);
+	esp_err_t (*deinit)(void *spi_ctx);
+	esp_err_t (*read)(void *spi_ctx, uint32_t cmd, uint32_t addr, void *data, uint32_t data_len);
+	esp_err_t (*write)(void *spi_ctx, uint32_t cmd, uint32_t addr, const void *data, uint32_t data_len);
+} eth_spi_custom_driver_config_t;
+
+#endif /* HOST_CHECK_ESP_ETH_H_ */
@@ -0,0 +1,25 @@
+/*
+ * esp_heap_caps.h
+ *
+ * Host stand-in for the ESP-IDF capability allocator: every host allocation is DMA capable.
+ */
+
+#ifndef HOST_CHECK_ESP_HEAP_CAPS_H_
+#define HOST_CHECK_ESP_HEAP_CAPS_H_
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#define MALLOC_CAP_DMA					(1 << 3)
+
+static inline void* heap_caps_malloc(size_t size, uint32_t caps)
+{
+	return malloc(size);
+}
+
+static inline void heap_caps_free(void *ptr)
+{
+	free(ptr);
+}
+
+#endif /* HOST_CHECK_ESP_HEAP_CAPS_H_ */
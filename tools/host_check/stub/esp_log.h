@@ -0,0 +1,16 @@
+/*
+ * esp_log.h
+ *
+ * Host stand-in for the ESP-IDF logging macros. The checks print their own results, the
+ * firmware messages are dropped (their formats are for the 32 bit target).
+ */
+
+#ifndef HOST_CHECK_ESP_LOG_H_
+#define HOST_CHECK_ESP_LOG_H_
+
+#define ESP_LOGE(tag, format, ...)		((void)(tag))
+#define ESP_LOGW(tag, format, ...)		((void)(tag))
+#define ESP_LOGI(tag, format, ...)		((void)(tag))
+#define ESP_LOGD(tag, format, ...)		((void)(tag))
+
+#endif /* HOST_CHECK_ESP_LOG_H_ */
@@ -0,0 +1,34 @@
+/*
+ * esp_netif.h
+ *
+ * Host stand-in for the ESP-IDF network interface API, the types and calls the firmware modules
+ * use. The check driver defines the calls, e.g. on top of the loopback interface.
+ */
+
+#ifndef HOST_CHECK_ESP_NETIF_H_
+#define HOST_CHECK_ESP_NETIF_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+typedef struct esp_netif_obj esp_netif_t;
+
+typedef struct
+{
+	uint32_t addr;					// Network order
+} esp_ip4_addr_t;
+
+typedef struct
+{
+	esp_ip4_addr_t ip;
+	esp_ip4_addr_t netmask;
+	esp_ip4_addr_t gw;
+} esp_netif_ip_info_t;
+
+esp_err_t esp_netif_get_ip_info(esp_netif_t *esp_netif, esp_netif_ip_info_t *ip_info);
+esp_err_t esp_netif_get_netif_impl_name(esp_netif_t *esp_netif, char *name);
+void* esp_netif_get_netif_impl(esp_netif_t *esp_netif);
+
+#endif /* HOST_CHECK_ESP_NETIF_H_ */
@@ -0,0 +1,25 @@
+/*
+ * esp_partition.h
+ *
+ * Host stand-in for the ESP-IDF partition API, the fields and the read call the firmware
+ * modules use. The check driver defines esp_partition_read on top of memory.
+ */
+
+#ifndef HOST_CHECK_ESP_PARTITION_H_
+#define HOST_CHECK_ESP_PARTITION_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+typedef struct
+{
+	uint32_t address;
+	uint32_t size;
+	char label[17];
+} esp_partition_t;
+
+esp_err_t esp_partition_read(const esp_partition_t *partition, size_t src_offset, void *dst, size_t size);
+
+#endif /* HOST_CHECK_ESP_PARTITION_H_ */
@@ -0,0 +1,18 @@
+/*
+ * esp_rom_crc.h
+ *
+ * Host stand-in for the ROM CRC functions, the gzip CRC-32 from zlib.
+ */
+
+#ifndef HOST_CHECK_ESP_ROM_CRC_H_
+#define HOST_CHECK_ESP_ROM_CRC_H_
+
+#include <stdint.h>
+#include <zlib.h>
+
+static inline uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t *buf, uint32_t len)
+{
+	return (uint32_t)crc32(crc, buf, len);
+}
+
+#endif /* HOST_CHECK_ESP_ROM_CRC_H_ */
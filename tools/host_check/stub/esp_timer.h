@@ -0,0 +1,14 @@
+/*
+ * esp_timer.h
+ *
+ * Host stand-in for the ESP-IDF timer, esp_timer_get_time is defined by the check driver.
+ */
+
+#ifndef HOST_CHECK_ESP_TIMER_H_
+#define HOST_CHECK_ESP_TIMER_H_
+
+#include <stdint.h>
+
+int64_t esp_timer_get_time(void);
+
+#endif /* HOST_CHECK_ESP_TIMER_H_ */
@@ -0,0 +1,12 @@
+/*
+ * esp_wifi_types.h
+ *
+ * Host stand-in for the ESP-IDF WiFi types, only the configuration type wifi_app.h names.
+ */
+
+#ifndef HOST_CHECK_ESP_WIFI_TYPES_H_
+#define HOST_CHECK_ESP_WIFI_TYPES_H_
+
+typedef union wifi_config wifi_config_t;
+
+#endif /* HOST_CHECK_ESP_WIFI_TYPES_H_ */
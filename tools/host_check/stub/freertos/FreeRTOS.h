@@ -0,0 +1,40 @@
+/*
+ * FreeRTOS.h
+ *
+ * Host stand-in for the FreeRTOS types the firmware modules use. Critical sections are pthread
+ * mutexes; the check driver defines the task functions of freertos/task.h on top of pthreads.
+ */
+
+#ifndef HOST_CHECK_FREERTOS_H_
+#define HOST_CHECK_FREERTOS_H_
+
+#include <pthread.h>
+#include <stdint.h>
+
+#define portNUM_PROCESSORS				2
+#define portTICK_PERIOD_MS				10
+
+#define pdFALSE							0
+#define pdTRUE							1
+#define pdPASS							pdTRUE
+#define pdFAIL							pdFALSE
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define portMAX_DELAY					((TickType_t)0xffffffff)
+#define pdMS_TO_TICKS(ms)				((TickType_t)(ms) / portTICK_PERIOD_MS)
+#define portYIELD_FROM_ISR()
+
+typedef struct
+{
+	pthread_mutex_t mutex;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED	{ PTHREAD_MUTEX_INITIALIZER }
+
+#define taskENTER_CRITICAL(mux)			pthread_mutex_lock(&(mux)->mutex)
+#define taskEXIT_CRITICAL(mux)			pthread_mutex_unlock(&(mux)->mutex)
+
+#endif /* HOST_CHECK_FREERTOS_H_ */
@@ -0,0 +1,12 @@
+/*
+ * portmacro.h
+ *
+ * Host stand-in, the port definitions are in freertos/FreeRTOS.h.
+ */
+
+#ifndef HOST_CHECK_PORTMACRO_H_
+#define HOST_CHECK_PORTMACRO_H_
+
+#include "freertos/FreeRTOS.h"
+
+#endif /* HOST_CHECK_PORTMACRO_H_ */
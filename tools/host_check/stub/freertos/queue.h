@@ -0,0 +1,19 @@
+/*
+ * queue.h
+ *
+ * Host stand-in for the FreeRTOS queue calls the firmware modules make, defined by the check driver.
+ */
+
+#ifndef HOST_CHECK_QUEUE_H_
+#define HOST_CHECK_QUEUE_H_
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct QueueDefinition* QueueHandle_t;
+
+QueueHandle_t xQueueCreate(UBaseType_t uxQueueLength, UBaseType_t uxItemSize);
+void vQueueDelete(QueueHandle_t xQueue);
+BaseType_t xQueueSend(QueueHandle_t xQueue, const void *pvItemToQueue, TickType_t xTicksToWait);
+BaseType_t xQueueReceive(QueueHandle_t xQueue, void *pvBuffer, TickType_t xTicksToWait);
+
+#endif /* HOST_CHECK_QUEUE_H_ */
@@ -0,0 +1,20 @@
+/*
+ * semphr.h
+ *
+ * Host stand-in for the FreeRTOS semaphore calls the firmware modules make, defined by the check
+ * driver.
+ */
+
+#ifndef HOST_CHECK_SEMPHR_H_
+#define HOST_CHECK_SEMPHR_H_
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct SemaphoreDefinition* SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
+void vSemaphoreDelete(SemaphoreHandle_t xSemaphore);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t xSemaphore, TickType_t xBlockTime);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t xSemaphore);
+
+#endif /* HOST_CHECK_SEMPHR_H_ */
@@ -0,0 +1,27 @@
+/*
+ * task.h
+ *
+ * Host stand-in for the FreeRTOS task calls the firmware modules make, defined by the check driver.
+ */
+
+#ifndef HOST_CHECK_TASK_H_
+#define HOST_CHECK_TASK_H_
+
+#include "freertos/FreeRTOS.h"
+
+typedef void* TaskHandle_t;
+typedef void (*TaskFunction_t)(void *pvParameters);
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t pxTaskCode, const char *pcName, uint32_t usStackDepth,
+		void *pvParameters, UBaseType_t uxPriority, TaskHandle_t *pxCreatedTask, BaseType_t xCoreID);
+void vTaskDelete(TaskHandle_t xTaskToDelete);
+void vTaskDelay(TickType_t xTicksToDelay);
+uint32_t ulTaskGetRunTimeCounter(TaskHandle_t xTask);
+TaskHandle_t xTaskGetIdleTaskHandleForCore(BaseType_t xCoreID);
+TaskHandle_t xTaskGetHandle(const char *pcNameToQuery);
+void vTaskSuspend(TaskHandle_t xTaskToSuspend);
+uint32_t ulTaskNotifyTake(BaseType_t xClearCountOnExit, TickType_t xTicksToWait);
+BaseType_t xTaskNotifyGive(TaskHandle_t xTaskToNotify);
+void vTaskNotifyGiveFromISR(TaskHandle_t xTaskToNotify, BaseType_t *pxHigherPriorityTaskWoken);
+
+#endif /* HOST_CHECK_TASK_H_ */
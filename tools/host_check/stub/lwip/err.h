@@ -0,0 +1,18 @@
+/*
+ * err.h
+ *
+ * Host stand-in for the lwIP error codes the firmware modules return and compare.
+ */
+
+#ifndef HOST_CHECK_LWIP_ERR_H_
+#define HOST_CHECK_LWIP_ERR_H_
+
+#include <stdint.h>
+
+typedef int8_t err_t;
+
+#define ERR_OK							0
+#define ERR_MEM							-1
+#define ERR_IF							-12
+
+#endif /* HOST_CHECK_LWIP_ERR_H_ */
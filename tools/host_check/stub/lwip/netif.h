@@ -0,0 +1,30 @@
+/*
+ * netif.h
+ *
+ * Host stand-in for the lwIP network interface, the input and link output hooks the firmware
+ * modules call or replace.
+ */
+
+#ifndef HOST_CHECK_LWIP_NETIF_H_
+#define HOST_CHECK_LWIP_NETIF_H_
+
+#include "lwip/err.h"
+#include "lwip/pbuf.h"
+
+#define NETIF_FLAG_UP					0x01
+
+struct netif;
+
+typedef err_t (*netif_input_fn)(struct pbuf *p, struct netif *inp);
+typedef err_t (*netif_linkoutput_fn)(struct netif *netif, struct pbuf *p);
+
+struct netif
+{
+	netif_input_fn input;
+	netif_linkoutput_fn linkoutput;
+	u8_t flags;
+};
+
+#define netif_is_up(netif)				(((netif)->flags & NETIF_FLAG_UP) ? 1 : 0)
+
+#endif /* HOST_CHECK_LWIP_NETIF_H_ */
@@ -0,0 +1,56 @@
+/*
+ * pbuf.h
+ *
+ * Host stand-in for the lwIP pbufs: the fields and calls the firmware modules use, custom pbufs
+ * included. The check driver defines the calls, e.g. on top of malloc.
+ */
+
+#ifndef HOST_CHECK_LWIP_PBUF_H_
+#define HOST_CHECK_LWIP_PBUF_H_
+
+#include <stdint.h>
+
+#include "lwip/err.h"
+
+typedef uint8_t u8_t;
+typedef uint16_t u16_t;
+
+// Set in flags of pbufs allocated with pbuf_alloced_custom, as in lwIP
+#define PBUF_FLAG_IS_CUSTOM				0x02
+
+typedef enum
+{
+	PBUF_RAW = 0,
+} pbuf_layer;
+
+typedef enum
+{
+	PBUF_RAM = 0,
+	PBUF_REF,
+	PBUF_POOL,
+} pbuf_type;
+
+struct pbuf
+{
+	struct pbuf *next;
+	void *payload;
+	u16_t tot_len;
+	u16_t len;
+	u8_t flags;
+};
+
+typedef void (*pbuf_free_custom_function)(struct pbuf *p);
+
+struct pbuf_custom
+{
+	struct pbuf pbuf;						// First, as in lwIP
+	pbuf_free_custom_function custom_free_function;
+};
+
+struct pbuf* pbuf_alloc(pbuf_layer l, u16_t length, pbuf_type type);
+struct pbuf* pbuf_alloced_custom(pbuf_layer l, u16_t length, pbuf_type type, struct pbuf_custom *p, void *payload_mem,
+		u16_t payload_mem_len);
+u8_t pbuf_free(struct pbuf *p);
+u16_t pbuf_copy_partial(const struct pbuf *p, void *dataptr, u16_t len, u16_t offset);
+
+#endif /* HOST_CHECK_LWIP_PBUF_H_ */
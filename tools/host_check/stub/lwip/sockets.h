@@ -0,0 +1,16 @@
+/*
+ * sockets.h
+ *
+ * Host stand-in for the lwIP socket API: the POSIX sockets it mirrors.
+ */
+
+#ifndef HOST_CHECK_LWIP_SOCKETS_H_
+#define HOST_CHECK_LWIP_SOCKETS_H_
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#endif /* HOST_CHECK_LWIP_SOCKETS_H_ */
@@ -0,0 +1,29 @@
+/*
+ * stats.h
+ *
+ * Host stand-in for the lwIP statistics, as configured for the firmware (LWIP_STATS, MIB2_STATS).
+ * Only the MIB-2 counters the firmware modules read; the check driver defines lwip_stats and
+ * moves the counters.
+ */
+
+#ifndef HOST_CHECK_LWIP_STATS_H_
+#define HOST_CHECK_LWIP_STATS_H_
+
+#include <stdint.h>
+
+#define LWIP_STATS						1
+#define MIB2_STATS						1
+
+struct stats_mib2
+{
+	uint32_t tcpretranssegs;
+};
+
+struct stats_
+{
+	struct stats_mib2 mib2;
+};
+
+extern struct stats_ lwip_stats;
+
+#endif /* HOST_CHECK_LWIP_STATS_H_ */
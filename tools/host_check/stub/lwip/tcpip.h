@@ -0,0 +1,22 @@
+/*
+ * tcpip.h
+ *
+ * Host stand-in for the lwIP TCP/IP thread API. The check driver defines tcpip_api_call; the host
+ * has no TCP/IP thread, so it calls the function in the caller's thread.
+ */
+
+#ifndef HOST_CHECK_LWIP_TCPIP_H_
+#define HOST_CHECK_LWIP_TCPIP_H_
+
+#include "lwip/err.h"
+
+struct tcpip_api_call_data
+{
+	err_t err;
+};
+
+typedef err_t (*tcpip_api_call_fn)(struct tcpip_api_call_data *call);
+
+err_t tcpip_api_call(tcpip_api_call_fn fn, struct tcpip_api_call_data *call);
+
+#endif /* HOST_CHECK_LWIP_TCPIP_H_ */
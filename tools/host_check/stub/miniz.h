@@ -0,0 +1,85 @@
+/*
+ * miniz.h
+ *
+ * Host stand-in for the ROM miniz inflater, the tinfl calls gzip_inflate.c makes on top of zlib
+ * (raw deflate). It enforces the tinfl contract for the wrapping output window (output continues
+ * where the last call ended, modulo TINFL_LZ_DICT_SIZE) and returns the tinfl status codes, so the
+ * gzip framing, CRC and window handling of gzip_inflate.c are checked, not tinfl itself.
+ */
+
+#ifndef HOST_CHECK_MINIZ_H_
+#define HOST_CHECK_MINIZ_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <zlib.h>
+
+#define TINFL_LZ_DICT_SIZE				32768
+#define TINFL_FLAG_HAS_MORE_INPUT		2
+
+typedef enum
+{
+	TINFL_STATUS_BAD_PARAM = -3,
+	TINFL_STATUS_FAILED = -1,
+	TINFL_STATUS_DONE = 0,
+	TINFL_STATUS_NEEDS_MORE_INPUT = 1,
+	TINFL_STATUS_HAS_MORE_OUTPUT = 2,
+} tinfl_status;
+
+typedef struct
+{
+	int started;
+	size_t next_ofs;		// Window offset the next output has to start at
+	z_stream zs;
+} tinfl_decompressor;
+
+#define tinfl_init(r)	do { (r)->started = 0; (r)->next_ofs = 0; } while (0)
+
+static inline tinfl_status tinfl_decompress(tinfl_decompressor *r, const uint8_t *in, size_t *in_size,
+		uint8_t *out_start, uint8_t *out_next, size_t *out_size, uint32_t flags)
+{
+	(void)flags;
+
+	// tinfl reads its back references from the window, it has to be used as a ring
+	if ((size_t)(out_next - out_start) != r->next_ofs || r->next_ofs + *out_size > TINFL_LZ_DICT_SIZE)
+	{
+		return TINFL_STATUS_BAD_PARAM;
+	}
+
+	if (!r->started)
+	{
+		memset(&r->zs, 0, sizeof(r->zs));
+		if (inflateInit2(&r->zs, -MAX_WBITS) != Z_OK)
+		{
+			return TINFL_STATUS_BAD_PARAM;
+		}
+		r->started = 1;
+	}
+
+	r->zs.next_in = (Bytef*)in;
+	r->zs.avail_in = (uInt)*in_size;
+	r->zs.next_out = out_next;
+	r->zs.avail_out = (uInt)*out_size;
+
+	int ret = inflate(&r->zs, Z_NO_FLUSH);
+
+	*in_size -= r->zs.avail_in;
+	*out_size -= r->zs.avail_out;
+	r->next_ofs = (r->next_ofs + *out_size) & (TINFL_LZ_DICT_SIZE - 1);
+
+	if (ret == Z_STREAM_END)
+	{
+		inflateEnd(&r->zs);
+		return TINFL_STATUS_DONE;
+	}
+	if (ret != Z_OK && ret != Z_BUF_ERROR)
+	{
+		inflateEnd(&r->zs);
+		return TINFL_STATUS_FAILED;
+	}
+
+	return (r->zs.avail_out == 0) ? TINFL_STATUS_HAS_MORE_OUTPUT : TINFL_STATUS_NEEDS_MORE_INPUT;
+}
+
+#endif /* HOST_CHECK_MINIZ_H_ */
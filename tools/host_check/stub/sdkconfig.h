@@ -0,0 +1,16 @@
+/*
+ * sdkconfig.h
+ *
+ * Host stand-in for the generated configuration, the options the checked modules read.
+ */
+
+#ifndef HOST_CHECK_SDKCONFIG_H_
+#define HOST_CHECK_SDKCONFIG_H_
+
+#define CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS		1
+
+#define CONFIG_ETH_RX_BURST_SIZE					8192
+#define CONFIG_ETH_RX_BURST_BUFFERS					3
+#define CONFIG_ETH_RX_BURST_PBUFS					32
+
+#endif /* HOST_CHECK_SDKCONFIG_H_ */
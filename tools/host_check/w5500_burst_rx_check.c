@@ -0,0 +1,1035 @@
+/*
+ * w5500_burst_rx_check.c
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "driver/gpio.h"
+#include "lwip/netif.h"
+#include "lwip/pbuf.h"
+#include "sdkconfig.h"
+
+#include "w5500_burst_rx.h"
+#include "w5500_rx_mode.h"
+#include "w5500_spi.h"
+
+// Size of the socket 0 RX buffer, the MAC driver gives socket 0 all 16 kB
+#define RX_BUF_LEN				16384
+
+// INT pin of the simulated W5500
+#define INT_GPIO				4
+
+// Longest wait for the RX task to read everything
+#define IDLE_TIMEOUT_MS			2000
+
+// Frames the stack may hold at once in the checks
+#define MAX_HELD				256
+
+/**
+ * Simulated W5500: socket 0 registers and RX buffer, and how the module used them
+ */
+typedef struct w5500_sim
+{
+	pthread_mutex_t mutex;
+	uint8_t rx[RX_BUF_LEN];
+	uint16_t wr;							// Sn_RX_WR, where the next frame goes
+	uint16_t rd;							// Sn_RX_RD as of the last RECV command
+	uint16_t rd_reg;						// Sn_RX_RD as written
+	uint8_t ir;
+	bool custom_driver;						// w5500_spi_* reach the chip
+	bool locked;							// w5500_spi_lock held
+	bool arrive_in_burst;					// Next burst read: a frame arrives while it runs
+	uint32_t burst_reads;
+	uint32_t recv_commands;
+	uint32_t violations;					// Unaligned reads, RD past the data, transfers under the lock
+} w5500_sim_t;
+
+static w5500_sim_t w5500 = {.mutex = PTHREAD_MUTEX_INITIALIZER, .custom_driver = true};
+
+/**
+ * FreeRTOS task on a pthread. One mutex and condition for all tasks, queues and semaphores.
+ */
+typedef struct host_task
+{
+	TaskFunction_t code;
+	void *parameters;
+	uint32_t notified;
+	bool waiting;							// In ulTaskNotifyTake
+	bool suspended;
+	bool ended;
+} host_task_t;
+
+static pthread_mutex_t os_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t os_cond = PTHREAD_COND_INITIALIZER;
+static __thread host_task_t *current_task;
+
+// The MAC driver's RX task, and whether it holds the SPI lock when the module suspends it
+static host_task_t driver_task;
+static bool driver_task_exists = true;
+static bool suspended_locked;
+
+struct QueueDefinition
+{
+	uint8_t *items;
+	UBaseType_t length;
+	UBaseType_t size;
+	UBaseType_t count;
+	UBaseType_t head;
+};
+
+struct SemaphoreDefinition
+{
+	UBaseType_t count;
+};
+
+// The module's pool of free burst buffers, the only queue it creates
+static QueueHandle_t free_bufs;
+
+// INT pin interrupt the module installed
+static gpio_isr_t int_isr;
+static void *int_isr_arg;
+
+// Stack side: the netif, the frames it holds, what it expects next
+static struct netif lwip_netif;
+static struct pbuf *held[MAX_HELD];
+static int held_count;
+static bool hold_frames;
+static err_t input_result = ERR_OK;
+static uint32_t rx_seq;
+static uint32_t next_seq;
+static uint16_t frame_lens[65536];
+static uint32_t bad_frames;
+static uint32_t heap_pbufs;
+static uint32_t counted_frames;
+static pthread_mutex_t stack_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// xorshift32, the frame lengths are the same on every host
+static uint32_t rng_state = 1;
+
+static uint32_t rng(void)
+{
+	rng_state ^= rng_state << 13;
+	rng_state ^= rng_state >> 17;
+	rng_state ^= rng_state << 5;
+
+	return rng_state;
+}
+
+/**
+ * Absolute time ticks from now, for the timed waits.
+ */
+static struct timespec deadline(TickType_t ticks)
+{
+	struct timespec ts;
+	uint64_t ms = (uint64_t)ticks * portTICK_PERIOD_MS;
+
+	clock_gettime(CLOCK_REALTIME, &ts);
+	ts.tv_sec += ms / 1000;
+	ts.tv_nsec += (ms % 1000) * 1000000;
+	if (ts.tv_nsec >= 1000000000)
+	{
+		ts.tv_sec++;
+		ts.tv_nsec -= 1000000000;
+	}
+
+	return ts;
+}
+
+/**
+ * Waits on the OS condition, os_mutex held.
+ * @return false once the deadline passed.
+ */
+static bool os_wait(TickType_t ticks, const struct timespec *until)
+{
+	if (ticks == portMAX_DELAY)
+	{
+		pthread_cond_wait(&os_cond, &os_mutex);
+		return true;
+	}
+
+	return pthread_cond_timedwait(&os_cond, &os_mutex, until) == 0;
+}
+
+static void* task_thread(void *arg)
+{
+	current_task = arg;
+	current_task->code(current_task->parameters);
+
+	return NULL;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t pxTaskCode, const char *pcName, uint32_t usStackDepth,
+		void *pvParameters, UBaseType_t uxPriority, TaskHandle_t *pxCreatedTask, BaseType_t xCoreID)
+{
+	host_task_t *task = calloc(1, sizeof(host_task_t));
+	pthread_t thread;
+
+	task->code = pxTaskCode;
+	task->parameters = pvParameters;
+	*pxCreatedTask = task;
+	if (pthread_create(&thread, NULL, task_thread, task) != 0)
+	{
+		free(task);
+		return pdFAIL;
+	}
+	pthread_detach(thread);
+
+	return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t xTaskToDelete)
+{
+	pthread_mutex_lock(&os_mutex);
+	current_task->ended = true;
+	pthread_cond_broadcast(&os_cond);
+	pthread_mutex_unlock(&os_mutex);
+
+	pthread_exit(NULL);
+}
+
+void vTaskDelay(TickType_t xTicksToDelay)
+{
+	usleep(xTicksToDelay * portTICK_PERIOD_MS * 1000);
+}
+
+TaskHandle_t xTaskGetHandle(const char *pcNameToQuery)
+{
+	return (driver_task_exists && strcmp(pcNameToQuery, W5500_RX_MODE_DRIVER_TASK) == 0) ? &driver_task : NULL;
+}
+
+void vTaskSuspend(TaskHandle_t xTaskToSuspend)
+{
+	pthread_mutex_lock(&w5500.mutex);
+	suspended_locked = w5500.locked;
+	pthread_mutex_unlock(&w5500.mutex);
+
+	((host_task_t*)xTaskToSuspend)->suspended = true;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t xClearCountOnExit, TickType_t xTicksToWait)
+{
+	struct timespec until = deadline(xTicksToWait);
+	uint32_t value;
+
+	pthread_mutex_lock(&os_mutex);
+	current_task->waiting = true;
+	pthread_cond_broadcast(&os_cond);
+	while (current_task->notified == 0 && os_wait(xTicksToWait, &until))
+	{
+	}
+	value = current_task->notified;
+	current_task->notified = (xClearCountOnExit || value == 0) ? 0 : value - 1;
+	current_task->waiting = false;
+	pthread_mutex_unlock(&os_mutex);
+
+	return value;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t xTaskToNotify)
+{
+	pthread_mutex_lock(&os_mutex);
+	((host_task_t*)xTaskToNotify)->notified++;
+	pthread_cond_broadcast(&os_cond);
+	pthread_mutex_unlock(&os_mutex);
+
+	return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t xTaskToNotify, BaseType_t *pxHigherPriorityTaskWoken)
+{
+	xTaskNotifyGive(xTaskToNotify);
+	*pxHigherPriorityTaskWoken = pdTRUE;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t uxQueueLength, UBaseType_t uxItemSize)
+{
+	QueueHandle_t queue = calloc(1, sizeof(struct QueueDefinition));
+
+	queue->items = malloc(uxQueueLength * uxItemSize);
+	queue->length = uxQueueLength;
+	queue->size = uxItemSize;
+	free_bufs = queue;
+
+	return queue;
+}
+
+void vQueueDelete(QueueHandle_t xQueue)
+{
+	free(xQueue->items);
+	free(xQueue);
+}
+
+BaseType_t xQueueSend(QueueHandle_t xQueue, const void *pvItemToQueue, TickType_t xTicksToWait)
+{
+	struct timespec until = deadline(xTicksToWait);
+	BaseType_t ret = pdFAIL;
+
+	pthread_mutex_lock(&os_mutex);
+	while (xQueue->count == xQueue->length && xTicksToWait > 0 && os_wait(xTicksToWait, &until))
+	{
+	}
+	if (xQueue->count < xQueue->length)
+	{
+		memcpy(xQueue->items + (xQueue->head + xQueue->count) % xQueue->length * xQueue->size, pvItemToQueue, xQueue->size);
+		xQueue->count++;
+		pthread_cond_broadcast(&os_cond);
+		ret = pdPASS;
+	}
+	pthread_mutex_unlock(&os_mutex);
+
+	return ret;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t xQueue, void *pvBuffer, TickType_t xTicksToWait)
+{
+	struct timespec until = deadline(xTicksToWait);
+	BaseType_t ret = pdFALSE;
+
+	pthread_mutex_lock(&os_mutex);
+	while (xQueue->count == 0 && xTicksToWait > 0 && os_wait(xTicksToWait, &until))
+	{
+	}
+	if (xQueue->count > 0)
+	{
+		memcpy(pvBuffer, xQueue->items + xQueue->head * xQueue->size, xQueue->size);
+		xQueue->head = (xQueue->head + 1) % xQueue->length;
+		xQueue->count--;
+		pthread_cond_broadcast(&os_cond);
+		ret = pdTRUE;
+	}
+	pthread_mutex_unlock(&os_mutex);
+
+	return ret;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+	return calloc(1, sizeof(struct SemaphoreDefinition));
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t xSemaphore)
+{
+	free(xSemaphore);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t xSemaphore, TickType_t xBlockTime)
+{
+	struct timespec until = deadline(xBlockTime);
+	BaseType_t ret = pdFALSE;
+
+	pthread_mutex_lock(&os_mutex);
+	while (xSemaphore->count == 0 && xBlockTime > 0 && os_wait(xBlockTime, &until))
+	{
+	}
+	if (xSemaphore->count > 0)
+	{
+		xSemaphore->count--;
+		ret = pdTRUE;
+	}
+	pthread_mutex_unlock(&os_mutex);
+
+	return ret;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t xSemaphore)
+{
+	pthread_mutex_lock(&os_mutex);
+	xSemaphore->count = 1;
+	pthread_cond_broadcast(&os_cond);
+	pthread_mutex_unlock(&os_mutex);
+
+	return pdTRUE;
+}
+
+esp_err_t gpio_isr_handler_add(gpio_num_t gpio_num, gpio_isr_t isr_handler, void *args)
+{
+	pthread_mutex_lock(&w5500.mutex);
+	int_isr = isr_handler;
+	int_isr_arg = args;
+	pthread_mutex_unlock(&w5500.mutex);
+
+	return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_remove(gpio_num_t gpio_num)
+{
+	pthread_mutex_lock(&w5500.mutex);
+	int_isr = NULL;
+	pthread_mutex_unlock(&w5500.mutex);
+
+	return ESP_OK;
+}
+
+int gpio_get_level(gpio_num_t gpio_num)
+{
+	pthread_mutex_lock(&w5500.mutex);
+	int level = (w5500.ir & W5500_BURST_RX_SIR_RECV) ? 0 : 1;
+	pthread_mutex_unlock(&w5500.mutex);
+
+	return level;
+}
+
+/**
+ * A frame arrives: written to the RX buffer behind the last one, with its MACRAW length header.
+ * The payload carries the sequence number, then bytes counting up from it. w5500.mutex held.
+ * @return the INT pin fell, call the interrupt.
+ */
+static bool w5500_receive_locked(uint32_t seq, uint16_t len)
+{
+	uint16_t total = len + W5500_BURST_RX_HEADER_LEN;
+	uint8_t frame[W5500_BURST_RX_HEADER_LEN + W5500_BURST_RX_MAX_FRAME];
+
+	frame[0] = total >> 8;
+	frame[1] = total & 0xff;
+	for (int i = 0; i < len; i++)
+	{
+		frame[W5500_BURST_RX_HEADER_LEN + i] = (i < 4) ? seq >> (24 - 8 * i) : seq + i;
+	}
+	for (int i = 0; i < total; i++)
+	{
+		w5500.rx[(uint16_t)(w5500.wr + i) % RX_BUF_LEN] = frame[i];
+	}
+	w5500.wr += total;
+	frame_lens[seq & 0xffff] = len;
+
+	bool fell = !(w5500.ir & W5500_BURST_RX_SIR_RECV);
+	w5500.ir |= W5500_BURST_RX_SIR_RECV;
+
+	return fell;
+}
+
+static void w5500_interrupt(void)
+{
+	gpio_isr_t isr = int_isr;
+
+	if (isr != NULL)
+	{
+		isr(int_isr_arg);
+	}
+}
+
+/**
+ * Bytes received and not yet freed by RECV.
+ */
+static uint16_t w5500_rsr_locked(void)
+{
+	return w5500.wr - w5500.rd;
+}
+
+esp_err_t w5500_spi_read(uint16_t address, uint8_t bsb, void *data, size_t len)
+{
+	uint8_t *out = data;
+	bool fell = false;
+	esp_err_t ret = ESP_OK;
+
+	pthread_mutex_lock(&w5500.mutex);
+	if (!w5500.custom_driver)
+	{
+		pthread_mutex_unlock(&w5500.mutex);
+		return ESP_ERR_INVALID_STATE;
+	}
+	w5500.violations += w5500.locked;
+
+	if (bsb == W5500_SPI_BSB_SOCK_REG(0))
+	{
+		uint8_t regs[0x30] = {0};
+		uint16_t rsr = w5500_rsr_locked();
+
+		regs[W5500_BURST_RX_REG_SOCK_IR] = w5500.ir;
+		regs[W5500_BURST_RX_REG_SOCK_RX_RSR] = rsr >> 8;
+		regs[W5500_BURST_RX_REG_SOCK_RX_RSR + 1] = rsr & 0xff;
+		regs[W5500_BURST_RX_REG_SOCK_RX_RD] = w5500.rd_reg >> 8;
+		regs[W5500_BURST_RX_REG_SOCK_RX_RD + 1] = w5500.rd_reg & 0xff;
+		if (address + len > sizeof(regs))
+		{
+			ret = ESP_FAIL;
+		}
+		else
+		{
+			memcpy(out, regs + address, len);
+		}
+	}
+	else if (bsb == W5500_SPI_BSB_SOCK_RX(0))
+	{
+		// The RX buffer wraps around, whatever the address
+		w5500.violations += (len % 4 != 0 || len > CONFIG_ETH_RX_BURST_SIZE + 3);
+		for (size_t i = 0; i < len; i++)
+		{
+			out[i] = w5500.rx[(uint16_t)(address + i) % RX_BUF_LEN];
+		}
+		w5500.burst_reads++;
+		if (w5500.arrive_in_burst)
+		{
+			w5500.arrive_in_burst = false;
+			fell = w5500_receive_locked(rx_seq++, 100);
+		}
+	}
+	else
+	{
+		ret = ESP_FAIL;
+	}
+	pthread_mutex_unlock(&w5500.mutex);
+
+	if (fell)
+	{
+		w5500_interrupt();
+	}
+
+	return ret;
+}
+
+esp_err_t w5500_spi_write(uint16_t address, uint8_t bsb, const void *data, size_t len)
+{
+	const uint8_t *in = data;
+	esp_err_t ret = ESP_OK;
+
+	pthread_mutex_lock(&w5500.mutex);
+	if (!w5500.custom_driver)
+	{
+		pthread_mutex_unlock(&w5500.mutex);
+		return ESP_ERR_INVALID_STATE;
+	}
+	w5500.violations += w5500.locked;
+
+	if (bsb != W5500_SPI_BSB_SOCK_REG(0))
+	{
+		ret = ESP_FAIL;
+	}
+	else if (address == W5500_BURST_RX_REG_SOCK_IR && len == 1)
+	{
+		w5500.ir &= ~in[0];
+	}
+	else if (address == W5500_BURST_RX_REG_SOCK_RX_RD && len == 2)
+	{
+		w5500.rd_reg = (in[0] << 8) | in[1];
+	}
+	else if (address == W5500_BURST_RX_REG_SOCK_CR && len == 1 && in[0] == W5500_BURST_RX_SCR_RECV)
+	{
+		// RECV frees the buffer up to RD, which must not pass what was received
+		w5500.violations += ((uint16_t)(w5500.rd_reg - w5500.rd) > w5500_rsr_locked());
+		w5500.rd = w5500.rd_reg;
+		w5500.recv_commands++;
+	}
+	else
+	{
+		ret = ESP_FAIL;
+	}
+	pthread_mutex_unlock(&w5500.mutex);
+
+	return ret;
+}
+
+esp_err_t w5500_spi_lock(void)
+{
+	esp_err_t ret = ESP_OK;
+
+	pthread_mutex_lock(&w5500.mutex);
+	if (!w5500.custom_driver)
+	{
+		ret = ESP_ERR_INVALID_STATE;
+	}
+	else if (w5500.locked)
+	{
+		ret = ESP_ERR_TIMEOUT;
+	}
+	else
+	{
+		w5500.locked = true;
+	}
+	pthread_mutex_unlock(&w5500.mutex);
+
+	return ret;
+}
+
+void w5500_spi_unlock(void)
+{
+	pthread_mutex_lock(&w5500.mutex);
+	w5500.locked = false;
+	pthread_mutex_unlock(&w5500.mutex);
+}
+
+void w5500_rx_mode_count_frame(uint32_t length)
+{
+	pthread_mutex_lock(&stack_mutex);
+	counted_frames++;
+	pthread_mutex_unlock(&stack_mutex);
+}
+
+void* esp_netif_get_netif_impl(esp_netif_t *esp_netif)
+{
+	return &lwip_netif;
+}
+
+struct pbuf* pbuf_alloc(pbuf_layer l, u16_t length, pbuf_type type)
+{
+	struct pbuf *p = calloc(1, sizeof(struct pbuf) + length);
+
+	p->payload = p + 1;
+	p->len = p->tot_len = length;
+	pthread_mutex_lock(&stack_mutex);
+	heap_pbufs++;
+	pthread_mutex_unlock(&stack_mutex);
+
+	return p;
+}
+
+struct pbuf* pbuf_alloced_custom(pbuf_layer l, u16_t length, pbuf_type type, struct pbuf_custom *p, void *payload_mem,
+		u16_t payload_mem_len)
+{
+	memset(&p->pbuf, 0, sizeof(p->pbuf));
+	p->pbuf.payload = payload_mem;
+	p->pbuf.len = p->pbuf.tot_len = length;
+	p->pbuf.flags = PBUF_FLAG_IS_CUSTOM;
+
+	return &p->pbuf;
+}
+
+u8_t pbuf_free(struct pbuf *p)
+{
+	if (p->flags & PBUF_FLAG_IS_CUSTOM)
+	{
+		((struct pbuf_custom*)p)->custom_free_function(p);
+		return 1;
+	}
+
+	pthread_mutex_lock(&stack_mutex);
+	heap_pbufs--;
+	pthread_mutex_unlock(&stack_mutex);
+	free(p);
+
+	return 1;
+}
+
+/**
+ * Input function of the netif, in the RX task: frames must arrive whole, in order and intact.
+ */
+static err_t netif_input(struct pbuf *p, struct netif *inp)
+{
+	const uint8_t *data = p->payload;
+	bool ok = p->len >= 4 && p->len == p->tot_len;
+
+	if (input_result != ERR_OK)
+	{
+		return input_result;
+	}
+
+	uint32_t seq = ok ? ((uint32_t)data[0] << 24) | (data[1] << 16) | (data[2] << 8) | data[3] : 0;
+	ok = ok && seq == next_seq && p->len == frame_lens[seq & 0xffff];
+	for (int i = 4; ok && i < p->len; i++)
+	{
+		ok = data[i] == (uint8_t)(seq + i);
+	}
+
+	pthread_mutex_lock(&stack_mutex);
+	bad_frames += !ok;
+	next_seq = seq + 1;
+	if (hold_frames && held_count < MAX_HELD)
+	{
+		held[held_count++] = p;
+		p = NULL;
+	}
+	pthread_mutex_unlock(&stack_mutex);
+
+	if (p != NULL)
+	{
+		pbuf_free(p);
+	}
+
+	return ERR_OK;
+}
+
+/**
+ * The stack frees the frames it held, from this thread as from any lwIP task.
+ */
+static void free_held(void)
+{
+	pthread_mutex_lock(&stack_mutex);
+	int count = held_count;
+	held_count = 0;
+	pthread_mutex_unlock(&stack_mutex);
+
+	for (int i = 0; i < count; i++)
+	{
+		pbuf_free(held[i]);
+	}
+}
+
+/**
+ * Frames arrive at once, the INT pin falls once.
+ * @param lens frame lengths without header.
+ */
+static void receive(const uint16_t *lens, int count)
+{
+	bool fell = false;
+
+	pthread_mutex_lock(&w5500.mutex);
+	for (int i = 0; i < count; i++)
+	{
+		fell |= w5500_receive_locked(rx_seq++, lens[i]);
+	}
+	pthread_mutex_unlock(&w5500.mutex);
+
+	if (fell)
+	{
+		w5500_interrupt();
+	}
+}
+
+/**
+ * Waits until the RX task waits for the next interrupt with nothing pending.
+ * @return false on timeout.
+ */
+static bool wait_idle(TaskHandle_t rx_task)
+{
+	host_task_t *task = rx_task;
+	struct timespec until = deadline(pdMS_TO_TICKS(IDLE_TIMEOUT_MS));
+	bool idle = false;
+
+	pthread_mutex_lock(&os_mutex);
+	while (!(idle = task->waiting && task->notified == 0) && os_wait(1, &until))
+	{
+	}
+	pthread_mutex_unlock(&os_mutex);
+
+	return idle;
+}
+
+/**
+ * Waits until the RX task deleted itself, right after it let w5500_burst_rx_stop return.
+ * @return false on timeout.
+ */
+static bool wait_ended(TaskHandle_t rx_task)
+{
+	host_task_t *task = rx_task;
+	struct timespec until = deadline(pdMS_TO_TICKS(IDLE_TIMEOUT_MS));
+
+	pthread_mutex_lock(&os_mutex);
+	while (!task->ended && os_wait(1, &until))
+	{
+	}
+	pthread_mutex_unlock(&os_mutex);
+
+	return task->ended;
+}
+
+/**
+ * Counter differences since the last call.
+ */
+static w5500_burst_rx_stats_t stats_delta(void)
+{
+	static w5500_burst_rx_stats_t last;
+	w5500_burst_rx_stats_t now;
+	w5500_burst_rx_stats_t delta;
+
+	w5500_burst_rx_get_stats(&now);
+	delta.bursts = now.bursts - last.bursts;
+	delta.frames = now.frames - last.frames;
+	delta.copied = now.copied - last.copied;
+	delta.dropped = now.dropped - last.dropped;
+	delta.flushed = now.flushed - last.flushed;
+	last = now;
+
+	return delta;
+}
+
+static int expect(const char *what, bool ok)
+{
+	if (!ok)
+	{
+		printf("%s: FAILED\n", what);
+	}
+
+	return ok ? 0 : 1;
+}
+
+/**
+ * Everything received was consumed with RECV and the stack got every frame intact.
+ */
+static int expect_drained(const char *what)
+{
+	pthread_mutex_lock(&w5500.mutex);
+	bool drained = w5500.rd == w5500.wr && w5500.rd_reg == w5500.wr && !(w5500.ir & W5500_BURST_RX_SIR_RECV)
+			&& w5500.violations == 0;
+	pthread_mutex_unlock(&w5500.mutex);
+
+	return expect(what, drained && bad_frames == 0);
+}
+
+/**
+ * Arguments and drivers the start refuses, and the driver task parked under the SPI lock.
+ * @return number of failures.
+ */
+static int check_start(TaskHandle_t *rx_task)
+{
+	static int netif;
+	int failures = 0;
+
+	failures += expect("no INT pin", w5500_burst_rx_start((esp_netif_t*)&netif, -1, rx_task) == ESP_ERR_NOT_SUPPORTED);
+	w5500.custom_driver = false;
+	failures += expect("no custom SPI driver", w5500_burst_rx_start((esp_netif_t*)&netif, INT_GPIO, rx_task) == ESP_ERR_NOT_SUPPORTED);
+	w5500.custom_driver = true;
+	driver_task_exists = false;
+	failures += expect("no driver task", w5500_burst_rx_start((esp_netif_t*)&netif, INT_GPIO, rx_task) == ESP_ERR_NOT_FOUND);
+	driver_task_exists = true;
+	failures += expect("driver task running", !driver_task.suspended);
+
+	failures += expect("start", w5500_burst_rx_start((esp_netif_t*)&netif, INT_GPIO, rx_task) == ESP_OK && *rx_task != NULL);
+	failures += expect("driver task suspended under the SPI lock", driver_task.suspended && suspended_locked);
+	failures += expect("SPI lock released", !w5500.locked && w5500.violations == 0);
+	failures += expect("interrupt installed", int_isr != NULL);
+	failures += expect("started twice", w5500_burst_rx_start((esp_netif_t*)&netif, INT_GPIO, rx_task) == ESP_ERR_INVALID_STATE);
+	failures += expect("idle", wait_idle(*rx_task));
+
+	printf("start: refusals, driver task parked under the SPI lock: %s\n", failures == 0 ? "ok" : "FAILED");
+
+	return failures;
+}
+
+/**
+ * Small frames read in one burst, with one RECV command.
+ * @return number of failures.
+ */
+static int check_one_burst(TaskHandle_t rx_task)
+{
+	uint16_t lens[10];
+	int failures = 0;
+
+	for (int i = 0; i < 10; i++)
+	{
+		lens[i] = 60 + i;
+	}
+	w5500.burst_reads = w5500.recv_commands = 0;
+	receive(lens, 10);
+	failures += expect("idle", wait_idle(rx_task));
+
+	w5500_burst_rx_stats_t delta = stats_delta();
+	failures += expect_drained("drained");
+	failures += expect("one burst, one RECV", w5500.burst_reads == 1 && w5500.recv_commands == 1 && delta.bursts == 1);
+	failures += expect("frames", delta.frames == 10 && delta.copied == 0 && delta.dropped == 0 && counted_frames == 10);
+
+	printf("10 small frames: %u burst, %u RECV: %s\n", (unsigned)w5500.burst_reads, (unsigned)w5500.recv_commands,
+			failures == 0 ? "ok" : "FAILED");
+
+	return failures;
+}
+
+/**
+ * Rounds of random frames that fill most of the RX buffer, so bursts end in the middle of frames
+ * and wrap around the end of the buffer and the 16 bit pointers.
+ * @return number of failures.
+ */
+static int check_wraparound(TaskHandle_t rx_task)
+{
+	const int rounds = 200;
+	uint32_t frames = 0;
+	uint32_t bytes = 0;
+	int failures = 0;
+
+	w5500.burst_reads = w5500.recv_commands = 0;
+	for (int r = 0; r < rounds; r++)
+	{
+		uint16_t lens[64];
+		int count = 0;
+		int total = 0;
+
+		// Up to about 14 kB, the W5500 would drop frames that do not fit
+		for (;;)
+		{
+			uint16_t len = W5500_BURST_RX_MIN_FRAME + rng() % (W5500_BURST_RX_MAX_FRAME - W5500_BURST_RX_MIN_FRAME + 1);
+			if (total + len + W5500_BURST_RX_HEADER_LEN > RX_BUF_LEN - 2048 || count == 64)
+			{
+				break;
+			}
+			lens[count++] = len;
+			total += len + W5500_BURST_RX_HEADER_LEN;
+		}
+
+		// Every 10th round a frame comes in while the first burst is read, it raises INT again
+		w5500.arrive_in_burst = (r % 10 == 0);
+		receive(lens, count);
+		if (!wait_idle(rx_task))
+		{
+			failures += expect("idle", false);
+			break;
+		}
+		frames += count + (r % 10 == 0);
+		bytes += total + ((r % 10 == 0) ? 100 + W5500_BURST_RX_HEADER_LEN : 0);
+	}
+
+	w5500_burst_rx_stats_t delta = stats_delta();
+	failures += expect_drained("drained");
+	failures += expect("frames", delta.frames == frames && delta.copied == 0 && delta.dropped == 0);
+	// A round is more than a burst; every burst but the last of a wakeup takes all but a partial frame
+	failures += expect("bursts", delta.bursts == w5500.burst_reads && delta.bursts >= 2 * (uint32_t)rounds
+			&& delta.bursts <= bytes / (CONFIG_ETH_RX_BURST_SIZE - W5500_BURST_RX_HEADER_LEN - W5500_BURST_RX_MAX_FRAME)
+					+ rounds + rounds / 10);
+	failures += expect("one RECV per wakeup", w5500.recv_commands == (uint32_t)(rounds + rounds / 10));
+
+	printf("%d rounds, %u frames, %u bytes through the wrapping buffer: %u bursts, %u RECV: %s\n", rounds, (unsigned)frames,
+			(unsigned)bytes, (unsigned)delta.bursts, (unsigned)w5500.recv_commands, failures == 0 ? "ok" : "FAILED");
+
+	return failures;
+}
+
+/**
+ * The stack holds frames: first the pbuf pool runs out, then the burst buffers. The frames that do
+ * not fit are copied, and everything returns once the stack frees them.
+ * @return number of failures.
+ */
+static int check_exhaustion(TaskHandle_t rx_task)
+{
+	uint16_t lens[CONFIG_ETH_RX_BURST_PBUFS + 8];
+	w5500_burst_rx_stats_t delta;
+	int failures = 0;
+
+	for (int i = 0; i < CONFIG_ETH_RX_BURST_PBUFS + 8; i++)
+	{
+		lens[i] = 100;
+	}
+
+	// One burst with more frames than pbufs
+	hold_frames = true;
+	receive(lens, CONFIG_ETH_RX_BURST_PBUFS + 8);
+	failures += expect("idle", wait_idle(rx_task));
+	delta = stats_delta();
+	failures += expect("pbufs exhausted", delta.frames == CONFIG_ETH_RX_BURST_PBUFS + 8 && delta.copied == 8 && heap_pbufs == 8);
+	free_held();
+	failures += expect("pbufs back", heap_pbufs == 0 && free_bufs->count == CONFIG_ETH_RX_BURST_BUFFERS);
+
+	// One wakeup per burst buffer, each keeps its buffer; the next one has none left
+	for (int i = 0; i <= CONFIG_ETH_RX_BURST_BUFFERS; i++)
+	{
+		receive(lens, 4);
+		failures += expect("idle", wait_idle(rx_task));
+	}
+	delta = stats_delta();
+	failures += expect("buffers exhausted", free_bufs->count == 0 && delta.frames == 4 * (CONFIG_ETH_RX_BURST_BUFFERS + 1)
+			&& delta.copied == 4 && delta.dropped == 0);
+	free_held();
+	failures += expect("buffers back", heap_pbufs == 0 && free_bufs->count == CONFIG_ETH_RX_BURST_BUFFERS);
+
+	// Nothing held: the pools serve everything again
+	hold_frames = false;
+	receive(lens, CONFIG_ETH_RX_BURST_PBUFS);
+	failures += expect("idle", wait_idle(rx_task));
+	delta = stats_delta();
+	failures += expect("pools refilled", delta.frames == CONFIG_ETH_RX_BURST_PBUFS && delta.copied == 0);
+	failures += expect_drained("drained");
+
+	printf("%d pbufs, %d burst buffers exhausted and refilled: %s\n", CONFIG_ETH_RX_BURST_PBUFS, CONFIG_ETH_RX_BURST_BUFFERS,
+			failures == 0 ? "ok" : "FAILED");
+
+	return failures;
+}
+
+/**
+ * A bad frame length flushes the buffer, a netif that is down or refuses frames drops them.
+ * @return number of failures.
+ */
+static int check_drops(TaskHandle_t rx_task)
+{
+	uint16_t lens[3] = {100, 200, 300};
+	w5500_burst_rx_stats_t delta;
+	int failures = 0;
+
+	// A frame, a length too short to be one, a frame behind it that is lost with the rest
+	pthread_mutex_lock(&w5500.mutex);
+	uint32_t seq = rx_seq;
+	w5500_receive_locked(rx_seq++, 100);
+	w5500.rx[w5500.wr % RX_BUF_LEN] = 0;
+	w5500.rx[(uint16_t)(w5500.wr + 1) % RX_BUF_LEN] = 1;
+	w5500.wr += 40;
+	w5500_receive_locked(rx_seq++, 100);
+	pthread_mutex_unlock(&w5500.mutex);
+	w5500_interrupt();
+	failures += expect("idle", wait_idle(rx_task));
+	delta = stats_delta();
+	failures += expect("bad length flushed", delta.flushed == 1 && delta.frames == 1 && next_seq == seq + 1);
+	failures += expect_drained("drained after the flush");
+	next_seq = rx_seq;
+
+	lwip_netif.flags = 0;
+	receive(lens, 3);
+	failures += expect("idle", wait_idle(rx_task));
+	delta = stats_delta();
+	failures += expect("netif down", delta.dropped == 3 && delta.frames == 0);
+	failures += expect_drained("drained while down");
+	lwip_netif.flags = NETIF_FLAG_UP;
+	next_seq = rx_seq;
+
+	input_result = ERR_MEM;
+	receive(lens, 3);
+	failures += expect("idle", wait_idle(rx_task));
+	delta = stats_delta();
+	failures += expect("refused by the stack", delta.dropped == 3 && delta.frames == 0);
+	failures += expect("refused pbufs freed", free_bufs->count == CONFIG_ETH_RX_BURST_BUFFERS);
+	failures += expect_drained("drained while refused");
+	input_result = ERR_OK;
+	next_seq = rx_seq;
+
+	printf("bad frame length, netif down, frames refused: %s\n", failures == 0 ? "ok" : "FAILED");
+
+	return failures;
+}
+
+/**
+ * The task ends on stop; a frame the stack still holds stays valid and returns its buffer later.
+ * @return number of failures.
+ */
+static int check_stop(TaskHandle_t rx_task)
+{
+	uint16_t len = 500;
+	int failures = 0;
+
+	hold_frames = true;
+	receive(&len, 1);
+	failures += expect("idle", wait_idle(rx_task));
+	hold_frames = false;
+
+	w5500_burst_rx_stop();
+	failures += expect("task ended", wait_ended(rx_task) && int_isr == NULL);
+	failures += expect("frame held", held_count == 1 && free_bufs->count == CONFIG_ETH_RX_BURST_BUFFERS - 1);
+	free_held();
+	failures += expect("buffer back after stop", free_bufs->count == CONFIG_ETH_RX_BURST_BUFFERS && bad_frames == 0);
+
+	printf("stop with a frame held: %s\n", failures == 0 ? "ok" : "FAILED");
+
+	return failures;
+}
+
+int main(int argc, char **argv)
+{
+	TaskHandle_t rx_task = NULL;
+	int failures = 0;
+
+	lwip_netif.input = netif_input;
+	lwip_netif.flags = NETIF_FLAG_UP;
+
+	// Start near the end of the buffer and of the 16 bit pointers
+	w5500.wr = w5500.rd = w5500.rd_reg = 0x10000 - 700;
+
+	failures += check_start(&rx_task);
+	if (failures != 0)
+	{
+		return 1;
+	}
+	failures += check_one_burst(rx_task);
+	failures += check_wraparound(rx_task);
+	failures += check_exhaustion(rx_task);
+	failures += check_drops(rx_task);
+	failures += check_stop(rx_task);
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,510 @@
+/*
+ * w5500_sg_tx_check.c
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "esp_timer.h"
+#include "lwip/netif.h"
+#include "lwip/pbuf.h"
+#include "lwip/tcpip.h"
+
+#include "w5500_sg_tx.h"
+#include "w5500_spi.h"
+
+// Size of the socket 0 TX buffer, the MAC driver gives socket 0 all 16 kB
+#define TX_BUF_LEN				16384
+
+// Random frames sent through the module, from an Ethernet header up
+#define RUN_FRAMES				3000
+#define MIN_FRAME				14
+
+// pbufs a chain of the checks has at most
+#define MAX_CHAIN				12
+
+/**
+ * Simulated W5500: socket 0 registers and TX buffer, the frames it sent and how the module used it
+ */
+typedef struct w5500_sim
+{
+	uint8_t tx[TX_BUF_LEN];
+	uint16_t rd;							// Sn_TX_RD, start of the next frame to send
+	uint16_t wr;							// Sn_TX_WR as written
+	uint16_t send_start;					// Frame on the wire
+	uint16_t send_end;
+	bool sending;
+	int send_reads;							// IR reads a frame takes on the wire, < 0: it never ends
+	int reads_left;
+	uint8_t ir;
+	bool custom_driver;						// w5500_spi_* reach the chip
+	int fail_in;							// Transfer that fails, counted down, 0: none
+	uint32_t wr_reads;
+	uint32_t written_while_sending;			// Frames written behind the one on the wire
+	uint32_t violations;					// SEND or TX_WR before SEND_OK, writes into the frame on the wire
+} w5500_sim_t;
+
+static w5500_sim_t w5500 = {.custom_driver = true};
+
+// Frames the module accepted, in order, and what came out of the chip
+static uint8_t expected[RUN_FRAMES + 64][W5500_SG_TX_MAX_FRAME];
+static uint16_t expected_lens[RUN_FRAMES + 64];
+static uint32_t expected_count;
+static uint32_t sent_count;
+static uint32_t bad_frames;
+
+// netif with the glue's output, counted once it is given back
+static struct netif lwip_netif;
+static bool netif_added = true;
+static uint32_t glue_frames;
+
+// xorshift32, the frames are the same on every host
+static uint32_t rng_state = 1;
+
+static uint32_t rng(void)
+{
+	rng_state ^= rng_state << 13;
+	rng_state ^= rng_state >> 17;
+	rng_state ^= rng_state << 5;
+
+	return rng_state;
+}
+
+int64_t esp_timer_get_time(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
+err_t tcpip_api_call(tcpip_api_call_fn fn, struct tcpip_api_call_data *call)
+{
+	return fn(call);
+}
+
+void* esp_netif_get_netif_impl(esp_netif_t *esp_netif)
+{
+	return netif_added ? &lwip_netif : NULL;
+}
+
+u16_t pbuf_copy_partial(const struct pbuf *p, void *dataptr, u16_t len, u16_t offset)
+{
+	u16_t copied = 0;
+
+	for (; p != NULL && copied < len; p = p->next)
+	{
+		if (offset >= p->len)
+		{
+			offset -= p->len;
+			continue;
+		}
+
+		u16_t n = (p->len - offset < len - copied) ? p->len - offset : len - copied;
+		memcpy((uint8_t*)dataptr + copied, (uint8_t*)p->payload + offset, n);
+		copied += n;
+		offset = 0;
+	}
+
+	return copied;
+}
+
+/**
+ * Fails the transfer if its turn came.
+ */
+static bool w5500_fails(void)
+{
+	return w5500.fail_in > 0 && --w5500.fail_in == 0;
+}
+
+/**
+ * SEND: everything between Sn_TX_RD and Sn_TX_WR goes out as one frame, compared with the next
+ * frame the module accepted.
+ */
+static void w5500_send(void)
+{
+	uint16_t len = w5500.wr - w5500.rd;
+	uint32_t index = sent_count++;
+	bool ok = index < expected_count && len == expected_lens[index];
+
+	// The previous frame must be done and its SEND_OK acknowledged
+	w5500.violations += w5500.sending || (w5500.ir & W5500_SG_TX_SIR_SEND_OK);
+
+	for (uint16_t i = 0; ok && i < len; i++)
+	{
+		ok = w5500.tx[(uint16_t)(w5500.rd + i) % TX_BUF_LEN] == expected[index][i];
+	}
+	bad_frames += !ok;
+
+	w5500.send_start = w5500.rd;
+	w5500.send_end = w5500.wr;
+	w5500.rd = w5500.wr;
+	w5500.sending = true;
+	w5500.reads_left = w5500.send_reads;
+}
+
+esp_err_t w5500_spi_read(uint16_t address, uint8_t bsb, void *data, size_t len)
+{
+	uint8_t *out = data;
+
+	if (!w5500.custom_driver)
+	{
+		return ESP_ERR_INVALID_STATE;
+	}
+	if (w5500_fails())
+	{
+		return ESP_FAIL;
+	}
+	if (bsb != W5500_SPI_BSB_SOCK_REG(0))
+	{
+		return ESP_FAIL;
+	}
+
+	// The frame on the wire ends after a number of IR reads
+	if (address == W5500_SG_TX_REG_SOCK_IR && w5500.sending && w5500.reads_left >= 0 && w5500.reads_left-- == 0)
+	{
+		w5500.sending = false;
+		w5500.ir |= W5500_SG_TX_SIR_SEND_OK;
+	}
+
+	uint8_t regs[0x30] = {0};
+	regs[W5500_SG_TX_REG_SOCK_IR] = w5500.ir;
+	regs[W5500_SG_TX_REG_SOCK_TX_WR] = w5500.wr >> 8;
+	regs[W5500_SG_TX_REG_SOCK_TX_WR + 1] = w5500.wr & 0xff;
+	if (address + len > sizeof(regs))
+	{
+		return ESP_FAIL;
+	}
+	memcpy(out, regs + address, len);
+	w5500.wr_reads += (address == W5500_SG_TX_REG_SOCK_TX_WR);
+
+	return ESP_OK;
+}
+
+esp_err_t w5500_spi_write(uint16_t address, uint8_t bsb, const void *data, size_t len)
+{
+	const uint8_t *in = data;
+
+	if (!w5500.custom_driver)
+	{
+		return ESP_ERR_INVALID_STATE;
+	}
+	if (w5500_fails() || bsb != W5500_SPI_BSB_SOCK_REG(0))
+	{
+		return ESP_FAIL;
+	}
+
+	if (address == W5500_SG_TX_REG_SOCK_IR && len == 1)
+	{
+		w5500.ir &= ~in[0];
+	}
+	else if (address == W5500_SG_TX_REG_SOCK_TX_WR && len == 2)
+	{
+		w5500.violations += w5500.sending;
+		w5500.wr = (in[0] << 8) | in[1];
+	}
+	else if (address == W5500_SG_TX_REG_SOCK_CR && len == 1 && in[0] == W5500_SG_TX_SCR_SEND)
+	{
+		w5500_send();
+	}
+	else
+	{
+		return ESP_FAIL;
+	}
+
+	return ESP_OK;
+}
+
+esp_err_t w5500_spi_write_segments(uint16_t address, uint8_t bsb, const w5500_spi_segment_t *segments, int count)
+{
+	uint16_t at = address;
+
+	if (!w5500.custom_driver)
+	{
+		return ESP_ERR_INVALID_STATE;
+	}
+	if (w5500_fails() || bsb != W5500_SPI_BSB_SOCK_TX(0) || count < 1)
+	{
+		return ESP_FAIL;
+	}
+
+	for (int i = 0; i < count; i++)
+	{
+		w5500.violations += (segments[i].len == 0);
+		for (size_t j = 0; j < segments[i].len; j++, at++)
+		{
+			// Nothing of the frame on the wire may be overwritten
+			w5500.violations += w5500.sending
+					&& (uint16_t)(at - w5500.send_start) < (uint16_t)(w5500.send_end - w5500.send_start);
+			w5500.tx[at % TX_BUF_LEN] = ((const uint8_t*)segments[i].data)[j];
+		}
+	}
+	w5500.written_while_sending += w5500.sending;
+
+	return ESP_OK;
+}
+
+static err_t glue_output(struct netif *netif, struct pbuf *p)
+{
+	glue_frames++;
+
+	return ERR_OK;
+}
+
+/**
+ * Chain of pbufs over one frame, some of them empty.
+ */
+typedef struct chain
+{
+	struct pbuf pbufs[MAX_CHAIN];
+	uint8_t data[W5500_SG_TX_MAX_FRAME + 1];
+	int count;								// pbufs that are not empty
+} chain_t;
+
+static void make_chain(chain_t *chain, uint16_t len, int parts)
+{
+	int cuts[MAX_CHAIN + 1];
+
+	for (int i = 0; i < len; i++)
+	{
+		chain->data[i] = rng();
+	}
+
+	// Sorted cut points, equal ones give empty pbufs
+	cuts[0] = 0;
+	cuts[parts] = len;
+	for (int i = 1; i < parts; i++)
+	{
+		cuts[i] = (rng() % 8 == 0) ? cuts[i - 1] : cuts[i - 1] + rng() % (len - cuts[i - 1] + 1);
+	}
+
+	chain->count = 0;
+	for (int i = 0; i < parts; i++)
+	{
+		chain->pbufs[i].next = (i < parts - 1) ? &chain->pbufs[i + 1] : NULL;
+		chain->pbufs[i].payload = &chain->data[cuts[i]];
+		chain->pbufs[i].len = cuts[i + 1] - cuts[i];
+		chain->pbufs[i].tot_len = len - cuts[i];
+		chain->count += (chain->pbufs[i].len != 0);
+	}
+}
+
+/**
+ * Sends a chain through the netif, like lwIP, and expects it on the wire if it is accepted.
+ */
+static err_t output(chain_t *chain)
+{
+	struct pbuf *p = &chain->pbufs[0];
+
+	memcpy(expected[expected_count], chain->data, p->tot_len);
+	expected_lens[expected_count] = p->tot_len;
+	expected_count++;
+
+	err_t err = lwip_netif.linkoutput(&lwip_netif, p);
+	if (err != ERR_OK)
+	{
+		expected_count--;
+	}
+
+	return err;
+}
+
+/**
+ * Counter differences since the last call.
+ */
+static w5500_sg_tx_stats_t stats_delta(void)
+{
+	static w5500_sg_tx_stats_t last;
+	w5500_sg_tx_stats_t now;
+	w5500_sg_tx_stats_t delta;
+
+	w5500_sg_tx_get_stats(&now);
+	delta.frames = now.frames - last.frames;
+	delta.segments = now.segments - last.segments;
+	delta.copied = now.copied - last.copied;
+	delta.send_waits = now.send_waits - last.send_waits;
+	delta.errors = now.errors - last.errors;
+	last = now;
+
+	return delta;
+}
+
+static int expect(const char *what, bool ok)
+{
+	if (!ok)
+	{
+		printf("%s: FAILED\n", what);
+	}
+
+	return ok ? 0 : 1;
+}
+
+/**
+ * Drivers and netifs the start refuses, and the link output replaced once.
+ * @return number of failures.
+ */
+static int check_start(void)
+{
+	static int netif;
+	int failures = 0;
+
+	w5500.custom_driver = false;
+	failures += expect("no custom SPI driver", w5500_sg_tx_start((esp_netif_t*)&netif) == ESP_ERR_NOT_SUPPORTED);
+	w5500.custom_driver = true;
+	netif_added = false;
+	failures += expect("netif not added", w5500_sg_tx_start((esp_netif_t*)&netif) == ESP_ERR_INVALID_STATE);
+	netif_added = true;
+
+	failures += expect("start", w5500_sg_tx_start((esp_netif_t*)&netif) == ESP_OK && lwip_netif.linkoutput != glue_output);
+	failures += expect("start after link up", w5500_sg_tx_start((esp_netif_t*)&netif) == ESP_OK && lwip_netif.linkoutput != glue_output);
+
+	printf("start: refusals, link output replaced: %s\n", failures == 0 ? "ok" : "FAILED");
+
+	return failures;
+}
+
+/**
+ * Random frames in chains of 1 to MAX_CHAIN pbufs, while earlier frames take 0 to 3 IR reads on
+ * the wire: each frame is written behind the one on the wire and sent only after its SEND_OK, and
+ * the pointers wrap around the TX buffer and 16 bits many times.
+ * @return number of failures.
+ */
+static int check_frames(void)
+{
+	static chain_t chain;
+	uint32_t segments = 0;
+	uint32_t copied = 0;
+	uint32_t bytes = 0;
+	int failures = 0;
+
+	w5500.wr_reads = 0;
+	w5500.written_while_sending = 0;
+	for (int i = 0; i < RUN_FRAMES; i++)
+	{
+		uint16_t len = MIN_FRAME + rng() % (W5500_SG_TX_MAX_FRAME - MIN_FRAME + 1);
+
+		make_chain(&chain, len, 1 + rng() % MAX_CHAIN);
+		w5500.send_reads = rng() % 4;
+		failures += expect("frame accepted", output(&chain) == ERR_OK);
+
+		copied += (chain.count > W5500_SG_TX_MAX_SEGMENTS);
+		segments += (chain.count > W5500_SG_TX_MAX_SEGMENTS) ? 0 : chain.count;
+		bytes += len;
+	}
+
+	w5500_sg_tx_stats_t delta = stats_delta();
+	failures += expect("frames on the wire", sent_count == expected_count && bad_frames == 0);
+	failures += expect("SEND_OK order", w5500.violations == 0);
+	failures += expect("counters", delta.frames == RUN_FRAMES && delta.segments == segments && delta.copied == copied
+			&& delta.errors == 0 && delta.send_waits > 0);
+	failures += expect("written behind the frame on the wire", w5500.written_while_sending > RUN_FRAMES / 2);
+	failures += expect("TX_WR read once", w5500.wr_reads == 1);
+
+	printf("%d frames, %u bytes, %u written in place, %u copied: %u written while the previous was sent, %u waits: %s\n",
+			RUN_FRAMES, (unsigned)bytes, (unsigned)segments, (unsigned)copied, (unsigned)w5500.written_while_sending,
+			(unsigned)delta.send_waits, failures == 0 ? "ok" : "FAILED");
+
+	return failures;
+}
+
+/**
+ * Frames that are refused, and SPI failures and a SEND_OK timeout while a frame is on the wire:
+ * the next frame reads TX_WR again and still waits for the SEND_OK it may not have seen.
+ * @return number of failures.
+ */
+static int check_errors(void)
+{
+	static chain_t chain;
+	w5500_sg_tx_stats_t delta;
+	int failures = 0;
+
+	w5500.send_reads = 2;
+	make_chain(&chain, W5500_SG_TX_MAX_FRAME + 1, 3);
+	failures += expect("frame too long", output(&chain) == ERR_IF);
+	make_chain(&chain, 0, 2);
+	failures += expect("empty frame", output(&chain) == ERR_IF);
+
+	// Segment write, then the IR read of the wait, fail while the last frame is on the wire
+	for (int fail = 1; fail <= 2; fail++)
+	{
+		make_chain(&chain, 1000, 3);
+		failures += expect("on the wire", output(&chain) == ERR_OK && w5500.sending);
+		uint32_t wr_reads = w5500.wr_reads;
+		w5500.fail_in = fail;
+		make_chain(&chain, 1000, 3);
+		failures += expect("SPI failure", output(&chain) == ERR_IF);
+		make_chain(&chain, 1000, 3);
+		failures += expect("after the failure", output(&chain) == ERR_OK && w5500.wr_reads == wr_reads + 1);
+	}
+
+	// The frame on the wire never ends
+	w5500.send_reads = -1;
+	make_chain(&chain, 600, 2);
+	failures += expect("on the wire", output(&chain) == ERR_OK);
+	int64_t start = esp_timer_get_time();
+	make_chain(&chain, 600, 2);
+	failures += expect("SEND_OK timeout", output(&chain) == ERR_IF
+			&& esp_timer_get_time() - start >= W5500_SG_TX_SEND_TIMEOUT_US);
+
+	// The chip drops the stuck frame
+	w5500.sending = false;
+	w5500.send_reads = 1;
+	make_chain(&chain, 600, 2);
+	failures += expect("after the timeout", output(&chain) == ERR_OK);
+
+	delta = stats_delta();
+	failures += expect("errors counted", delta.errors == 4 && delta.frames == 6);
+	failures += expect("frames on the wire", sent_count == expected_count && bad_frames == 0);
+	failures += expect("SEND_OK order", w5500.violations == 0);
+
+	printf("frame too long, empty, SPI failures and SEND_OK timeout while sending: %s\n", failures == 0 ? "ok" : "FAILED");
+
+	return failures;
+}
+
+/**
+ * The stop waits for the last SEND_OK and gives the link output back to the glue.
+ * @return number of failures.
+ */
+static int check_stop(void)
+{
+	static chain_t chain;
+	int failures = 0;
+
+	w5500.send_reads = 3;
+	make_chain(&chain, 1500, 4);
+	failures += expect("on the wire", output(&chain) == ERR_OK && w5500.sending);
+
+	w5500_sg_tx_stop();
+	failures += expect("SEND_OK acknowledged", !w5500.sending && !(w5500.ir & W5500_SG_TX_SIR_SEND_OK));
+	failures += expect("glue output back", lwip_netif.linkoutput == glue_output);
+	lwip_netif.linkoutput(&lwip_netif, &chain.pbufs[0]);
+	failures += expect("glue sends", glue_frames == 1 && sent_count == expected_count);
+
+	printf("stop with a frame on the wire: %s\n", failures == 0 ? "ok" : "FAILED");
+
+	return failures;
+}
+
+int main(int argc, char **argv)
+{
+	int failures = 0;
+
+	lwip_netif.linkoutput = glue_output;
+	lwip_netif.flags = NETIF_FLAG_UP;
+
+	// Start near the end of the buffer and of the 16 bit pointers
+	w5500.wr = w5500.rd = 0x10000 - 900;
+
+	failures += check_start();
+	failures += check_frames();
+	failures += check_errors();
+	failures += check_stop();
+
+	return failures == 0 ? 0 : 1;
+}
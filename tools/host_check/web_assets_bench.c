@@ -0,0 +1,161 @@
+/*
+ * web_assets_bench.c
+ *
+ *  Created on: Oct 16, 2026
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "web_assets.h"
+
+// Lookups per timed run
+#define BENCH_LOOKUPS			2000000
+
+// URIs the HTTP server registered before the asset table, in registration order.
+// httpd compared a request with each of them until one matched.
+static const char *const baseline_uris[] = {
+	"/jquery-3.3.1.min.js", "/index.html", "/app.css", "/app.js", "/favicon.ico",
+	"/OTAupdate", "/OTAstatus", "/wifiConnect.json", "/wifiConnectStatus", "/wifiConnectInfo.json",
+	"/wifiDisconnect.json", "/localTime.json", "/apSSID.json", "/ethConnect.json", "/ethConnectStatus",
+	"/ethConnectInfo.json", "/ethDisconnect.json", "/ethConfig.json",
+};
+
+#define BASELINE_URI_COUNT		(sizeof(baseline_uris) / sizeof(baseline_uris[0]))
+
+// Requests the lookups are timed with: the assets a page load fetches, a query and a miss
+static const char *const bench_requests[] = {
+	"/", "/app.css?v=0123456789abcdef", "/app.js?v=0123456789abcdef", "/jquery-3.3.1.min.js?v=0123456789abcdef",
+	"/favicon.ico", "/index.html", "/missing.png",
+};
+
+#define BENCH_REQUEST_COUNT		(sizeof(bench_requests) / sizeof(bench_requests[0]))
+
+// Paths that must not match an asset
+static const char *const unknown_paths[] = {
+	"", "/app", "/app.js/", "/app.jsx", "/APP.JS", "index.html", "/index.htm", "//", "/missing.png",
+};
+
+/**
+ * Linear search of the asset table, what the lookup costs without the perfect hash.
+ */
+static const web_asset_t* linear_find(const char *path, size_t len)
+{
+	for (size_t i = 0; i < web_assets_count; i++)
+	{
+		if (strncmp(web_assets[i].path, path, len) == 0 && web_assets[i].path[len] == '\0')
+		{
+			return &web_assets[i];
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * Linear search of the baseline URI list with httpd's default matcher (httpd_uri_match_simple).
+ * @return index of the URI, -1 if none matches.
+ */
+static int baseline_find(const char *path, size_t len)
+{
+	for (size_t i = 0; i < BASELINE_URI_COUNT; i++)
+	{
+		if (strlen(baseline_uris[i]) == len && strncmp(baseline_uris[i], path, len) == 0)
+		{
+			return (int)i;
+		}
+	}
+
+	return -1;
+}
+
+static double now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/**
+ * Checks that every asset and alias is found at its path and nothing else is.
+ * @return number of errors.
+ */
+static int check_lookups(void)
+{
+	int errors = 0;
+
+	for (size_t i = 0; i < web_assets_count; i++)
+	{
+		const char *path = web_assets[i].path;
+
+		if (web_assets_find(path, strlen(path)) != &web_assets[i])
+		{
+			printf("%s: not found\n", path);
+			errors++;
+		}
+
+		// The handler passes the URI up to the query string
+		char uri[128];
+		snprintf(uri, sizeof(uri), "%s?v=%s", path, web_assets[i].version);
+		if (web_assets_find(uri, strcspn(uri, "?")) != &web_assets[i])
+		{
+			printf("%s: not found with a query\n", path);
+			errors++;
+		}
+	}
+
+	for (size_t i = 0; i < sizeof(unknown_paths) / sizeof(unknown_paths[0]); i++)
+	{
+		if (web_assets_find(unknown_paths[i], strlen(unknown_paths[i])) != NULL)
+		{
+			printf("\"%s\": found, expected no asset\n", unknown_paths[i]);
+			errors++;
+		}
+	}
+
+	return errors;
+}
+
+int main(void)
+{
+	size_t lens[BENCH_REQUEST_COUNT];
+	volatile size_t sink = 0;
+
+	int errors = check_lookups();
+	printf("%zu assets, %zu slots, seed %lu: %s\n", web_assets_count, web_assets_hash_size,
+			(unsigned long)web_assets_hash_seed, errors == 0 ? "lookups ok" : "lookups FAILED");
+
+	for (size_t i = 0; i < BENCH_REQUEST_COUNT; i++)
+	{
+		lens[i] = strcspn(bench_requests[i], "?");
+	}
+
+	double start = now_ns();
+	for (int i = 0; i < BENCH_LOOKUPS; i++)
+	{
+		sink += (size_t)web_assets_find(bench_requests[i % BENCH_REQUEST_COUNT], lens[i % BENCH_REQUEST_COUNT]);
+	}
+	double hash_ns = (now_ns() - start) / BENCH_LOOKUPS;
+
+	start = now_ns();
+	for (int i = 0; i < BENCH_LOOKUPS; i++)
+	{
+		sink += (size_t)linear_find(bench_requests[i % BENCH_REQUEST_COUNT], lens[i % BENCH_REQUEST_COUNT]);
+	}
+	double linear_ns = (now_ns() - start) / BENCH_LOOKUPS;
+
+	start = now_ns();
+	for (int i = 0; i < BENCH_LOOKUPS; i++)
+	{
+		sink += baseline_find(bench_requests[i % BENCH_REQUEST_COUNT], lens[i % BENCH_REQUEST_COUNT]);
+	}
+	double baseline_ns = (now_ns() - start) / BENCH_LOOKUPS;
+
+	printf("perfect hash          %6.1f ns/lookup\n", hash_ns);
+	printf("linear, asset table   %6.1f ns/lookup\n", linear_ns);
+	printf("linear, %zu URIs       %6.1f ns/lookup (handlers before the asset table)\n", BASELINE_URI_COUNT, baseline_ns);
+
+	return errors == 0 ? 0 : 1;
+}
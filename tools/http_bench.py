@@ -0,0 +1,287 @@
+#!/usr/bin/env python3
+#
+# http_bench.py
+#
+# HTTP load generator for the device's bench handlers and a latency check of the other handlers:
+#
+#   http_bench.py <device>                               # 1 MB download and upload, 5 runs each
+#   http_bench.py <device> --size 8388608 --runs 3 --clients 2
+#   http_bench.py <device> --only latency --requests 50
+#   http_bench.py <device> --only stall --requests 500 --slow-rate 2048
+#
+# download: GET /bench/download?size=N, the device streams generated data
+# upload:   POST /bench/upload, generated here and streamed, the device drops it
+# latency:  GET of the JSON handlers registered by http_server_configure, status and time per request
+# stall:    POST /wifiConnectStatus, first alone, then while a slow client downloads jQuery (a large
+#           asset, streamed by the asset sender tasks); fails if the p99 with the slow client is over
+#           --max-p99-ms, i.e. the download holds up the httpd task
+#
+# Client and server side are printed next to each other. The server side (time to first byte, time
+# blocked in httpd_resp_send_chunk / httpd_req_recv) comes from /bench/stats.json or the upload
+# response, so with --clients > 1 it only covers the last request. Run it once per interface address
+# of the device (W5500, WiFi station, soft AP) to compare them; the device reports which one it was.
+#
+# Downloads are TX-bound: with the W5500 scatter-gather TX path (CONFIG_ETH_TX_SG) the frames it sent
+# during the runs, pbufs per frame, frames copied and SEND_OK waits (/ethTx.json) are printed too.
+#
+
+import argparse
+import http.client
+import json
+import socket
+import statistics
+import sys
+import threading
+import time
+
+# Bytes per send call of an upload
+CHUNK = 64 * 1024
+
+# Large asset fetched by the slow client of the stall check, and the request timed meanwhile
+STALL_ASSET = '/jquery-3.3.1.min.js'
+STALL_URI = '/wifiConnectStatus'
+
+# GET handlers answered from memory, a slow or failing one is a regression
+LATENCY_URIS = ('/status.json', '/selftest.json', '/ethRxMode.json', '/ethTx.json', '/netBench.json',
+                '/bench/stats.json', '/ethConfig.json', '/ethConnectInfo.json', '/wifiConnectInfo.json', '/apSSID.json', '/localTime.json')
+
+
+def connect(host, timeout):
+    return http.client.HTTPConnection(host, timeout=timeout)
+
+
+def download(host, size, timeout):
+    conn = connect(host, timeout)
+    start = time.monotonic()
+    conn.request('GET', '/bench/download?size=%d' % size)
+    resp = conn.getresponse()
+    first = None
+    received = 0
+    while True:
+        data = resp.read(CHUNK)
+        if not data:
+            break
+        if first is None:
+            first = time.monotonic() - start
+        received += len(data)
+    elapsed = time.monotonic() - start
+    conn.close()
+    if resp.status != 200 or received != size:
+        raise RuntimeError('download: HTTP %d, %d of %d bytes' % (resp.status, received, size))
+    return {'bytes': received, 'first_byte_s': first or elapsed, 'elapsed_s': elapsed}
+
+
+def upload(host, size, timeout):
+    conn = connect(host, timeout)
+    chunk = bytes(range(256)) * (CHUNK // 256)
+    start = time.monotonic()
+    conn.putrequest('POST', '/bench/upload')
+    conn.putheader('Content-Type', 'application/octet-stream')
+    conn.putheader('Content-Length', str(size))
+    conn.endheaders()
+    sent = 0
+    while sent < size:
+        n = min(CHUNK, size - sent)
+        conn.send(chunk[:n])
+        sent += n
+    resp = conn.getresponse()
+    body = resp.read()
+    elapsed = time.monotonic() - start
+    conn.close()
+    if resp.status != 200:
+        raise RuntimeError('upload: HTTP %d' % resp.status)
+    return {'bytes': sent, 'first_byte_s': None, 'elapsed_s': elapsed, 'server': json.loads(body)}
+
+
+def server_stats(host, timeout):
+    conn = connect(host, timeout)
+    conn.request('GET', '/bench/stats.json')
+    stats = json.loads(conn.getresponse().read())
+    conn.close()
+    return stats
+
+
+def eth_tx_stats(host, timeout):
+    conn = connect(host, timeout)
+    conn.request('GET', '/ethTx.json')
+    resp = conn.getresponse()
+    stats = json.loads(resp.read()) if resp.status == 200 else {}
+    conn.close()
+    return stats if stats.get('frames') is not None else None
+
+
+def print_eth_tx(before, after):
+    d = {key: (after[key] - before[key]) & 0xffffffff for key in after}
+    if not d['frames']:
+        print('%-8s W5500 TX: no frames (another interface?)' % '')
+        return
+    print('%-8s W5500 TX: %d frames, %.2f pbufs per frame, %d copied, %d SEND_OK waits, %d errors' % (
+        '', d['frames'], d['segments'] / max(d['frames'] - d['copied'], 1), d['copied'], d['send_waits'], d['errors']))
+
+
+def run_parallel(fn, clients, *args):
+    results = [None] * clients
+    errors = []
+
+    def worker(i):
+        try:
+            results[i] = fn(*args)
+        except Exception as e:
+            errors.append(e)
+
+    threads = [threading.Thread(target=worker, args=(i,)) for i in range(clients)]
+    start = time.monotonic()
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    if errors:
+        raise errors[0]
+    return results, time.monotonic() - start
+
+
+def print_transfer(kind, run, results, wall, server):
+    total = sum(r['bytes'] for r in results)
+    client_first = results[0]['first_byte_s']
+    print('%-8s run %d: %8.2f Mbit/s client (%d x %d B in %.3f s%s)' % (
+        kind, run, total * 8 / wall / 1e6, len(results), results[0]['bytes'], wall,
+        ', first byte %.1f ms' % (client_first * 1000) if client_first is not None else ''))
+    if server:
+        print('%-8s        %8.2f Mbit/s server via %s, first byte %.1f ms, blocked %.0f %% of %.3f s' % (
+            '', server['bytes_per_s'] * 8 / 1e6, server['netif'] or '?', server['first_byte_us'] / 1000,
+            100.0 * server['blocked_us'] / server['elapsed_us'] if server['elapsed_us'] else 0,
+            server['elapsed_us'] / 1e6))
+
+
+def bench_transfer(args, kind):
+    rates = []
+    tx_before = eth_tx_stats(args.host, args.timeout)
+    for run in range(1, args.runs + 1):
+        fn = download if kind == 'download' else upload
+        results, wall = run_parallel(fn, args.clients, args.host, args.size, args.timeout)
+        server = results[-1].get('server') if kind == 'upload' else server_stats(args.host, args.timeout)['download']
+        print_transfer(kind, run, results, wall, server)
+        rates.append(sum(r['bytes'] for r in results) * 8 / wall / 1e6)
+    print('%-8s median %.2f Mbit/s, min %.2f, max %.2f' % (kind, statistics.median(rates), min(rates), max(rates)))
+    if tx_before is not None:
+        print_eth_tx(tx_before, eth_tx_stats(args.host, args.timeout))
+    print()
+
+
+def bench_latency(args):
+    conn = connect(args.host, args.timeout)
+    failed = 0
+    for uri in LATENCY_URIS:
+        times = []
+        status = None
+        for _ in range(args.requests):
+            start = time.monotonic()
+            conn.request('GET', uri)
+            resp = conn.getresponse()
+            resp.read()
+            times.append((time.monotonic() - start) * 1000)
+            status = resp.status
+        times.sort()
+        p95 = times[min(len(times) - 1, int(len(times) * 0.95))]
+        print('%-22s HTTP %d  median %6.1f ms  p95 %6.1f ms' % (uri, status, statistics.median(times), p95))
+        failed += status != 200
+    conn.close()
+    return failed
+
+
+def slow_download(host, rate, stop, result):
+    # A small receive buffer keeps the window closed, so the device's sends block like for a slow browser
+    sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    sock.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, 2048)
+    sock.settimeout(30)
+    sock.connect((host, 80))
+    sock.sendall(('GET %s HTTP/1.1\r\nHost: %s\r\nConnection: close\r\n\r\n' % (STALL_ASSET, host)).encode())
+    received = 0
+    start = time.monotonic()
+    while not stop.is_set():
+        data = sock.recv(256)
+        if not data:
+            break
+        received += len(data)
+        # Throttled to rate bytes per second
+        time.sleep(max(0.0, received / rate - (time.monotonic() - start)))
+    sock.close()
+    result['bytes'] = received
+    result['elapsed_s'] = time.monotonic() - start
+    result['done'] = not stop.is_set()
+
+
+def time_requests(host, count, timeout):
+    conn = connect(host, timeout)
+    times = []
+    for _ in range(count):
+        start = time.monotonic()
+        conn.request('POST', STALL_URI, body=b'')
+        resp = conn.getresponse()
+        resp.read()
+        times.append((time.monotonic() - start) * 1000)
+        if resp.status != 200:
+            raise RuntimeError('%s: HTTP %d' % (STALL_URI, resp.status))
+    conn.close()
+    times.sort()
+    return times
+
+
+def print_times(label, times):
+    p99 = times[min(len(times) - 1, int(len(times) * 0.99))]
+    print('%-34s median %6.1f ms  p99 %6.1f ms  max %6.1f ms  (%d requests)' % (
+        label, statistics.median(times), p99, times[-1], len(times)))
+    return p99
+
+
+def bench_stall(args):
+    print_times('%s alone' % STALL_URI, time_requests(args.host, args.requests, args.timeout))
+
+    stop = threading.Event()
+    result = {}
+    slow = threading.Thread(target=slow_download, args=(args.host, args.slow_rate, stop, result))
+    slow.start()
+    # Lets the download fill the window first
+    time.sleep(1)
+    try:
+        times = time_requests(args.host, args.requests, args.timeout)
+    finally:
+        stop.set()
+        slow.join()
+
+    p99 = print_times('%s + slow client' % STALL_URI, times)
+    print('%-34s %d bytes of %s in %.1f s%s' % ('slow client', result.get('bytes', 0), STALL_ASSET,
+                                                result.get('elapsed_s', 0),
+                                                ', finished before the requests (raise --requests or lower --slow-rate)'
+                                                if result.get('done') else ''))
+    print()
+    return p99 > args.max_p99_ms
+
+
+def main():
+    parser = argparse.ArgumentParser(description='HTTP throughput and latency of the device')
+    parser.add_argument('host', help='device address (selects the interface)')
+    parser.add_argument('--only', choices=('download', 'upload', 'latency', 'stall'))
+    parser.add_argument('--size', type=int, default=1024 * 1024, help='bytes per transfer')
+    parser.add_argument('--runs', type=int, default=5)
+    parser.add_argument('--clients', type=int, default=1, help='parallel transfers per run')
+    parser.add_argument('--requests', type=int, default=20, help='requests per URI for latency and stall')
+    parser.add_argument('--slow-rate', type=int, default=4096, help='bytes per second read by the slow client')
+    parser.add_argument('--max-p99-ms', type=float, default=200, help='stall fails above this p99')
+    parser.add_argument('--timeout', type=float, default=30)
+    args = parser.parse_args()
+
+    if args.only in (None, 'download'):
+        bench_transfer(args, 'download')
+    if args.only in (None, 'upload'):
+        bench_transfer(args, 'upload')
+    failed = False
+    if args.only in (None, 'stall'):
+        failed |= bench_stall(args)
+    if args.only in (None, 'latency'):
+        failed |= bench_latency(args) != 0
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,118 @@
+#!/usr/bin/env python3
+#
+# net_bench.py
+#
+# Runs the device's network benchmark (POST /netBench, see main/net_bench.h) against a local iperf 2
+# and prints what both sides measured:
+#
+#   net_bench.py <device> --netif eth                    # TCP, the device receives
+#   net_bench.py <device> --netif sta --direction tx     # TCP, the device sends
+#   net_bench.py <device> --netif eth --udp --bandwidth 20000
+#
+# For --direction tx the device connects back to this machine (--local-ip, guessed from the route
+# to the device), so the iperf port must be reachable. iperf 3 does not speak the iperf 2 protocol.
+#
+
+import argparse
+import json
+import socket
+import subprocess
+import sys
+import time
+import urllib.request
+
+# net_bench_state_e
+STATE_WAITING, STATE_RUNNING, STATE_DONE, STATE_FAILED = 1, 2, 3, 4
+
+
+def get_result(host):
+    with urllib.request.urlopen('http://%s/netBench.json' % host, timeout=5) as resp:
+        return json.load(resp)
+
+
+def start(host, headers):
+    req = urllib.request.Request('http://%s/netBench' % host, data=b'', method='POST', headers=headers)
+    with urllib.request.urlopen(req, timeout=5) as resp:
+        resp.read()
+
+
+def local_ip(host):
+    with socket.socket(socket.AF_INET, socket.SOCK_DGRAM) as sock:
+        sock.connect((host, 9))
+        return sock.getsockname()[0]
+
+
+def wait_result(host, timeout):
+    deadline = time.monotonic() + timeout
+    while time.monotonic() < deadline:
+        result = get_result(host)
+        if result['state'] in (STATE_DONE, STATE_FAILED):
+            return result
+        time.sleep(0.5)
+    raise TimeoutError('benchmark did not finish')
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Network benchmark of the device against iperf 2')
+    parser.add_argument('host', help='device address')
+    parser.add_argument('--netif', choices=('eth', 'sta', 'ap'), help='device interface, any if not given')
+    parser.add_argument('--direction', choices=('rx', 'tx'), default='rx', help='rx: the device receives')
+    parser.add_argument('--udp', action='store_true')
+    parser.add_argument('--time', type=int, default=10, help='seconds')
+    parser.add_argument('--bandwidth', type=int, default=10000, help='UDP rate in kbit/s')
+    parser.add_argument('--port', type=int, default=5001)
+    parser.add_argument('--local-ip', help='address of this machine for --direction tx')
+    parser.add_argument('--iperf', default='iperf', help='iperf 2 binary')
+    args = parser.parse_args()
+
+    headers = {
+        'bench-proto': 'udp' if args.udp else 'tcp',
+        'bench-role': 'server' if args.direction == 'rx' else 'client',
+        'bench-port': str(args.port),
+        'bench-time': str(args.time),
+        'bench-bandwidth': str(args.bandwidth),
+    }
+    if args.netif:
+        headers['bench-netif'] = args.netif
+
+    udp = ['-u'] if args.udp else []
+
+    if args.direction == 'rx':
+        start(args.host, headers)
+        time.sleep(0.5)
+        cmd = [args.iperf, '-c', args.host, '-p', str(args.port), '-t', str(args.time), '-e']
+        if args.udp:
+            cmd += ['-u', '-b', '%dk' % args.bandwidth, '-l', '1470']
+        iperf = subprocess.run(cmd, capture_output=True, text=True)
+        host_output = iperf.stdout + iperf.stderr
+    else:
+        headers['bench-host'] = args.local_ip or local_ip(args.host)
+        server = subprocess.Popen([args.iperf, '-s', '-p', str(args.port), '-e'] + udp,
+                                  stdout=subprocess.PIPE, stderr=subprocess.STDOUT, text=True)
+        try:
+            time.sleep(0.5)
+            start(args.host, headers)
+            wait_result(args.host, args.time + 15)
+        finally:
+            server.terminate()
+            host_output = server.communicate()[0]
+
+    result = wait_result(args.host, args.time + 15)
+
+    print(host_output.rstrip())
+    print()
+    print('device: %s %s on %s' % (result['proto'], result['role'], result['netif'] or 'any'))
+    if result['state'] == STATE_FAILED:
+        print('  failed: %s' % result['error'])
+        return 1
+    print('  %.2f Mbit/s, %d kB in %d ms' % (result['kbps'] / 1000, result['kbytes'], result['elapsed_ms']))
+    if result['retransmits'] is not None:
+        print('  %d retransmits' % result['retransmits'])
+    if 'datagrams' in result:
+        print('  %d datagrams, %d lost, %d out of order' % (result['datagrams'], result['lost'], result['out_of_order']))
+    print('  CPU load per core: %s %%' % ' / '.join(str(load) for load in result['cpu_load']))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,116 @@
+#!/usr/bin/env python3
+#
+# ota_pull_server.py
+#
+# Local stand-in for a firmware server, for pull updates (/OTApull, see main/ota_pull.h).
+# Serves one image with HTTP range support and its manifest:
+#
+#   ota_pull_server.py build/<project>.bin --port 8070
+#   curl -X POST -H "ota-manifest-url: http://<this host>:8070/manifest.json" http://<device>/OTApull
+#
+# --drop-every N closes the connection halfway through every Nth image request,
+# to exercise the device's range retries.
+#
+
+import argparse
+import hashlib
+import http.server
+import json
+import os
+import re
+import sys
+
+
+def make_handler(image, image_name, drop_every):
+    manifest = json.dumps({
+        'url': image_name,
+        'size': len(image),
+        'sha256': hashlib.sha256(image).hexdigest(),
+    }).encode()
+    counter = {'requests': 0}
+
+    class Handler(http.server.BaseHTTPRequestHandler):
+        # Keep-alive, the device sends its range requests on one connection
+        protocol_version = 'HTTP/1.1'
+
+        def send_body(self, status, body, content_type, extra_headers=()):
+            self.send_response(status)
+            self.send_header('Content-Type', content_type)
+            self.send_header('Content-Length', str(len(body)))
+            for name, value in extra_headers:
+                self.send_header(name, value)
+            self.end_headers()
+            if self.command != 'HEAD':
+                self.wfile.write(body)
+
+        def do_HEAD(self):
+            self.do_GET()
+
+        def do_GET(self):
+            if self.path == '/manifest.json':
+                self.send_body(200, manifest, 'application/json')
+                return
+            if self.path.lstrip('/') != image_name:
+                self.send_body(404, b'not found\n', 'text/plain')
+                return
+
+            start, end = 0, len(image) - 1
+            status = 200
+            match = re.fullmatch(r'bytes=(\d+)-(\d*)', self.headers.get('Range', ''))
+            if match:
+                start = int(match.group(1))
+                end = min(int(match.group(2)) if match.group(2) else end, len(image) - 1)
+                if start > end:
+                    self.send_body(416, b'', 'text/plain', [('Content-Range', 'bytes */%d' % len(image))])
+                    return
+                status = 206
+
+            body = image[start:end + 1]
+            headers = [('Accept-Ranges', 'bytes')]
+            if status == 206:
+                headers.append(('Content-Range', 'bytes %d-%d/%d' % (start, end, len(image))))
+
+            counter['requests'] += 1
+            if drop_every and counter['requests'] % drop_every == 0:
+                # Headers and half the body, then the connection goes away
+                self.send_response(status)
+                self.send_header('Content-Type', 'application/octet-stream')
+                self.send_header('Content-Length', str(len(body)))
+                for name, value in headers:
+                    self.send_header(name, value)
+                self.end_headers()
+                self.wfile.write(body[:len(body) // 2])
+                self.close_connection = True
+                self.log_message('dropped %s after %d bytes', self.headers.get('Range', 'request'), len(body) // 2)
+                return
+
+            self.send_body(status, body, 'application/octet-stream', headers)
+
+    return Handler
+
+
+def main():
+    parser = argparse.ArgumentParser(description='OTA pull test server')
+    parser.add_argument('image', help='application image (.bin)')
+    parser.add_argument('--bind', default='0.0.0.0')
+    parser.add_argument('--port', type=int, default=8070)
+    parser.add_argument('--drop-every', type=int, default=0, metavar='N',
+                        help='cut every Nth image request short')
+    args = parser.parse_args()
+
+    with open(args.image, 'rb') as f:
+        image = f.read()
+    image_name = os.path.basename(args.image)
+
+    server = http.server.ThreadingHTTPServer((args.bind, args.port),
+                                             make_handler(image, image_name, args.drop_every))
+    print('serving %s (%d bytes) and /manifest.json on %s:%d' % (image_name, len(image), args.bind, args.port))
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,108 @@
+#!/usr/bin/env python3
+#
+# ota_session_upload.py
+#
+# Resumable firmware upload to /OTAsession (see main/ota_session.h).
+#
+#   ota_session_upload.py 192.168.1.50 build/<project>.bin
+#
+# The image goes up in chunks, each with its offset and CRC-32. After a dropped
+# connection, or a device reboot, the upload continues at the last chunk the
+# device verified, running the script again does the same.
+#
+
+import argparse
+import hashlib
+import http.client
+import json
+import sys
+import time
+import zlib
+
+
+def request(host, port, method, path, headers=None, body=None, timeout=30):
+    conn = http.client.HTTPConnection(host, port, timeout=timeout)
+    try:
+        conn.request(method, path, body=body, headers=headers or {})
+        resp = conn.getresponse()
+        return resp.status, json.loads(resp.read() or b'{}')
+    finally:
+        conn.close()
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Resumable OTA upload')
+    parser.add_argument('host', help='device address')
+    parser.add_argument('image', help='application image (.bin)')
+    parser.add_argument('--port', type=int, default=80)
+    parser.add_argument('--retries', type=int, default=20, help='failed requests in a row before giving up')
+    args = parser.parse_args()
+
+    with open(args.image, 'rb') as f:
+        image = f.read()
+
+    failures = 0
+
+    def call(method, path, headers=None, body=None):
+        nonlocal failures
+        while True:
+            try:
+                status, session = request(args.host, args.port, method, path, headers, body)
+                failures = 0
+                return status, session
+            except (OSError, http.client.HTTPException, ValueError) as e:
+                failures += 1
+                if failures > args.retries:
+                    sys.exit('%s %s: %s' % (method, path, e))
+                print('%s %s: %s, retrying' % (method, path, e))
+                time.sleep(min(failures, 5))
+
+    # Beginning again with the same image resumes the stored session
+    status, session = call('POST', '/OTAsession', {
+        'ota-image-size': str(len(image)),
+        'ota-image-sha256': hashlib.sha256(image).hexdigest(),
+    })
+    if status != 200:
+        sys.exit('begin: %d %s' % (status, session.get('error')))
+    if session['offset'] > 0:
+        print('resuming at %d of %d bytes' % (session['offset'], len(image)))
+
+    start = time.monotonic()
+    sent = 0
+    rejects = 0
+    while session['offset'] < len(image):
+        offset = session['offset']
+        chunk = image[offset:offset + session['chunk_size']]
+        status, reply = call('PUT', '/OTAsession', {
+            'ota-chunk-offset': str(offset),
+            'ota-chunk-crc': '%08x' % zlib.crc32(chunk),
+            'Content-Type': 'application/octet-stream',
+        }, chunk)
+        if status == 200:
+            sent += len(chunk)
+            rejects = 0
+        elif status in (400, 409):
+            # Corrupted on the way or out of step: the reply has the offset to continue at
+            print('chunk at %d: %d %s' % (offset, status, reply.get('error')))
+            rejects += 1
+            if rejects > args.retries:
+                sys.exit('giving up')
+        else:
+            sys.exit('chunk at %d: %d %s' % (offset, status, reply.get('error')))
+        if not reply.get('active'):
+            sys.exit('the device dropped the session')
+        session = reply
+        print('%d of %d bytes' % (session['offset'], len(image)), end='\r')
+
+    elapsed = time.monotonic() - start
+    print('\n%d bytes sent in %.1f s' % (sent, elapsed))
+
+    status, reply = call('POST', '/OTAsession/finalize')
+    if status != 200:
+        sys.exit('finalize: %d %s' % (status, reply.get('error')))
+    print('image verified, the device restarts into it')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
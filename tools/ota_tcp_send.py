@@ -0,0 +1,89 @@
+#!/usr/bin/env python3
+#
+# ota_tcp_send.py
+#
+# Sends a firmware image to the raw TCP firmware receiver (CONFIG_OTA_TCP_ENABLE, see main/ota_tcp.h):
+#
+#   ota_tcp_send.py <device> build/<project>.bin
+#   ota_tcp_send.py <device> build/<project>.bin.gz --port 3232
+#
+# The file is sent as it is, so gzip compressed images and delta patches (tools/delta_patch.py)
+# work as for /OTAupdate. One frame per connection:
+#
+#   "EOTA" | payload length (uint32 little endian) | SHA-256 of the payload | payload
+#
+# The device answers "OK" once the image is the next boot image, otherwise "ERR <error name>".
+#
+
+import argparse
+import hashlib
+import socket
+import struct
+import sys
+import time
+
+MAGIC = b'EOTA'
+
+# Bytes per send call, large writes keep the socket buffer full
+SEND_CHUNK = 64 * 1024
+
+
+def make_header(payload):
+    return MAGIC + struct.pack('<I', len(payload)) + hashlib.sha256(payload).digest()
+
+
+def send_image(host, port, payload, timeout):
+    with socket.create_connection((host, port), timeout=timeout) as sock:
+        sock.setsockopt(socket.SOL_SOCKET, socket.SO_SNDBUF, 1024 * 1024)
+        sock.sendall(make_header(payload))
+
+        start = time.monotonic()
+        sent = 0
+        view = memoryview(payload)
+        while sent < len(payload):
+            sock.sendall(view[sent:sent + SEND_CHUNK])
+            sent = min(sent + SEND_CHUNK, len(payload))
+            print('\rsent %d of %d bytes' % (sent, len(payload)), end='', file=sys.stderr)
+        sock.shutdown(socket.SHUT_WR)
+
+        # The device answers after the last buffer is flashed and the image is checked
+        reply = b''
+        while not reply.endswith(b'\n'):
+            data = sock.recv(64)
+            if not data:
+                break
+            reply += data
+        elapsed = time.monotonic() - start
+
+    print(file=sys.stderr)
+    return reply.decode(errors='replace').strip(), elapsed
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Raw TCP firmware sender')
+    parser.add_argument('host', help='device address')
+    parser.add_argument('image', help='firmware image (.bin), gzip compressed image or delta patch')
+    parser.add_argument('--port', type=int, default=3232)
+    parser.add_argument('--timeout', type=float, default=60.0,
+                        help='socket timeout in seconds, the device erases flash before answering')
+    args = parser.parse_args()
+
+    with open(args.image, 'rb') as f:
+        payload = f.read()
+    if not payload:
+        print('empty image', file=sys.stderr)
+        return 1
+
+    try:
+        reply, elapsed = send_image(args.host, args.port, payload, args.timeout)
+    except OSError as e:
+        print('send failed: %s' % e, file=sys.stderr)
+        return 1
+
+    print('%s (%d bytes in %.1f s, %.1f kB/s)' % (reply or 'no reply', len(payload), elapsed,
+                                                  len(payload) / 1024 / max(elapsed, 1e-3)))
+    return 0 if reply == 'OK' else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())